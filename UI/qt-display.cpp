@@ -32,14 +32,17 @@ OBSQTDisplay::OBSQTDisplay(QWidget *parent, Qt::WindowFlags flags)
 
 	auto windowVisible = [this] (bool visible)
 	{
-		if (!visible)
+		if (!visible) {
+			UpdateVisibility();
 			return;
+		}
 
 		if (!display) {
 			CreateDisplay();
 		} else {
 			QSize size = GetPixelSize(this);
 			obs_display_resize(display, size.width(), size.height());
+			UpdateVisibility();
 		}
 	};
 
@@ -80,9 +83,29 @@ void OBSQTDisplay::CreateDisplay()
 
 	display = obs_display_create(&info, backgroundColor);
 
+	/* don't render the display while its window is minimized */
+	QWindow *topLevel = window()->windowHandle();
+	if (topLevel)
+		connect(topLevel, &QWindow::visibilityChanged,
+				this, &OBSQTDisplay::UpdateVisibility);
+
 	emit DisplayCreated(this);
 }
 
+void OBSQTDisplay::UpdateVisibility()
+{
+	QWindow *topLevel = window()->windowHandle();
+	bool visible = windowHandle()->isVisible();
+
+	if (visible && topLevel) {
+		QWindow::Visibility visibility = topLevel->visibility();
+		visible = visibility != QWindow::Hidden &&
+		          visibility != QWindow::Minimized;
+	}
+
+	obs_display_set_visible(display, visible);
+}
+
 void OBSQTDisplay::resizeEvent(QResizeEvent *event)
 {
 	QWidget::resizeEvent(event);
@@ -11,6 +11,7 @@ class OBSQTDisplay : public QWidget {
 	OBSDisplay display;
 
 	void CreateDisplay();
+	void UpdateVisibility();
 
 	void resizeEvent(QResizeEvent *event) override;
 	void paintEvent(QPaintEvent *event) override;
@@ -100,6 +100,8 @@ struct SignalContainer {
 
 extern volatile long insideEventLoop;
 
+#define SAVE_DELAY_MS 500
+
 Q_DECLARE_METATYPE(OBSScene);
 Q_DECLARE_METATYPE(OBSSceneItem);
 Q_DECLARE_METATYPE(OBSSource);
@@ -292,6 +294,12 @@ OBSBasic::OBSBasic(QWidget *parent)
 			ui->statusbar, SLOT(UpdateCPUUsage()));
 	cpuUsageTimer->start(3000);
 
+	saveTimer = new QTimer(this);
+	saveTimer->setSingleShot(true);
+	saveTimer->setInterval(SAVE_DELAY_MS);
+	connect(saveTimer.data(), SIGNAL(timeout()),
+			this, SLOT(SaveProjectDeferred()));
+
 	QAction *renameScene = new QAction(ui->scenesDock);
 	renameScene->setShortcutContext(Qt::WidgetWithChildrenShortcut);
 	connect(renameScene, SIGNAL(triggered()), this, SLOT(EditSceneName()));
@@ -601,6 +609,8 @@ obs_data_array_t *OBSBasic::SaveProjectors()
 
 void OBSBasic::Save(const char *file)
 {
+	uint64_t startTime = os_gettime_ns();
+
 	OBSScene scene = GetCurrentScene();
 	OBSSource curProgramScene = OBSGetStrongRef(programScene);
 	if (!curProgramScene)
@@ -631,9 +641,14 @@ void OBSBasic::Save(const char *file)
 		obs_data_release(moduleObj);
 	}
 
-	if (!obs_data_save_json_safe(saveData, file, "tmp", "bak"))
-		blog(LOG_ERROR, "Could not save scene data to %s", file);
+	/* the save data references live source settings, so take a deep copy
+	 * before handing it off to the save thread */
+	obs_data_t *snapshot = obs_data_create();
+	obs_data_apply(snapshot, saveData);
 
+	QueueSave(snapshot, file, os_gettime_ns() - startTime);
+
+	obs_data_release(snapshot);
 	obs_data_release(saveData);
 	obs_data_array_release(sceneOrder);
 	obs_data_array_release(quickTrData);
@@ -641,6 +656,102 @@ void OBSBasic::Save(const char *file)
 	obs_data_array_release(savedProjectorList);
 }
 
+void OBSBasic::QueueSave(obs_data_t *data, const char *file,
+		uint64_t snapshotNs)
+{
+	std::unique_lock<std::mutex> lock(saveMutex);
+
+	/* a newer snapshot simply replaces one that hasn't been written yet */
+	pendingSaveData = data;
+	pendingSavePath = file;
+	pendingSaveSnapshotNs = snapshotNs;
+
+	if (!saveThread.joinable()) {
+		saveThreadExit = false;
+		saveThread = std::thread([this] () {SaveThread();});
+	}
+
+	saveCV.notify_one();
+}
+
+void OBSBasic::SaveThread()
+{
+	os_set_thread_name("scene collection save");
+
+	std::unique_lock<std::mutex> lock(saveMutex);
+
+	for (;;) {
+		saveCV.wait(lock, [this] ()
+		{
+			return saveThreadExit || !!pendingSaveData;
+		});
+
+		if (!pendingSaveData)
+			break;
+
+		OBSData data = pendingSaveData;
+		std::string path = std::move(pendingSavePath);
+		uint64_t snapshotNs = pendingSaveSnapshotNs;
+
+		pendingSaveData = nullptr;
+		pendingSavePath.clear();
+		saveThreadBusy = true;
+		lock.unlock();
+
+		uint64_t startTime = os_gettime_ns();
+		const char *json = obs_data_get_json(data);
+		uint64_t serializedTime = os_gettime_ns();
+
+		bool success = json && *json && os_quick_write_utf8_file_safe(
+				path.c_str(), json, strlen(json), false,
+				"tmp", "bak");
+		uint64_t writtenTime = os_gettime_ns();
+
+		if (success)
+			blog(LOG_DEBUG, "Saved scene data to %s (snapshot: "
+					"%.2fms, serialize: %.2fms, "
+					"write: %.2fms)", path.c_str(),
+					double(snapshotNs) / 1000000.0,
+					double(serializedTime - startTime) /
+						1000000.0,
+					double(writtenTime - serializedTime) /
+						1000000.0);
+		else
+			blog(LOG_ERROR, "Could not save scene data to %s",
+					path.c_str());
+
+		data = nullptr;
+
+		lock.lock();
+		saveThreadBusy = false;
+		saveCV.notify_all();
+	}
+}
+
+void OBSBasic::WaitForSave()
+{
+	std::unique_lock<std::mutex> lock(saveMutex);
+	saveCV.wait(lock, [this] ()
+	{
+		return !pendingSaveData && !saveThreadBusy;
+	});
+}
+
+void OBSBasic::StopSaveThread()
+{
+	if (!saveThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(saveMutex);
+		saveThreadExit = true;
+		saveCV.notify_all();
+	}
+
+	/* any pending snapshot is written out before the thread exits */
+	saveThread.join();
+}
+
 void OBSBasic::DeferSaveBegin()
 {
 	os_atomic_inc_long(&disableSaving);
@@ -903,7 +1014,11 @@ void OBSBasic::Load(const char *file)
 		obs_data_array_push_back_array(sources, groups);
 	}
 
-	obs_load_sources(sources, nullptr, nullptr);
+	if (config_get_bool(App()->GlobalConfig(), "General",
+				"ParallelSourceLoading"))
+		obs_load_sources_parallel(sources, nullptr, nullptr);
+	else
+		obs_load_sources(sources, nullptr, nullptr);
 
 	if (transitions)
 		LoadTransitions(transitions);
@@ -2247,6 +2362,8 @@ OBSBasic::~OBSBasic()
 	delete cpuUsageTimer;
 	os_cpu_usage_info_destroy(cpuUsageInfo);
 
+	StopSaveThread();
+
 	obs_hotkey_set_callback_routing_func(nullptr, nullptr);
 	ClearHotkeys();
 
@@ -2342,6 +2459,10 @@ void OBSBasic::SaveProjectNow()
 
 	projectChanged = true;
 	SaveProjectDeferred();
+
+	/* callers expect the file to be up to date on disk when this
+	 * returns */
+	WaitForSave();
 }
 
 void OBSBasic::SaveProject()
@@ -2349,9 +2470,10 @@ void OBSBasic::SaveProject()
 	if (disableSaving)
 		return;
 
+	/* coalesce bursts of changes (renames, reorders, visibility
+	 * toggles, etc) into a single save */
 	projectChanged = true;
-	QMetaObject::invokeMethod(this, "SaveProjectDeferred",
-			Qt::QueuedConnection);
+	saveTimer->start();
 }
 
 void OBSBasic::SaveProjectDeferred()
@@ -2363,6 +2485,7 @@ void OBSBasic::SaveProjectDeferred()
 		return;
 
 	projectChanged = false;
+	saveTimer->stop();
 
 	const char *sceneCollection = config_get_string(App()->GlobalConfig(),
 			"Basic", "SceneCollectionFile");
@@ -3808,6 +3931,7 @@ void OBSBasic::closeEvent(QCloseEvent *event)
 
 	Auth::Save();
 	SaveProjectNow();
+	StopSaveThread();
 	auth.reset();
 
 	config_set_string(App()->GlobalConfig(),
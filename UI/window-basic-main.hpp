@@ -24,6 +24,9 @@
 #include <obs.hpp>
 #include <vector>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "window-main.hpp"
 #include "window-basic-interaction.hpp"
 #include "window-basic-properties.hpp"
@@ -173,6 +176,22 @@ private:
 	QPointer<QTimer>    cpuUsageTimer;
 	os_cpu_usage_info_t *cpuUsageInfo = nullptr;
 
+	QPointer<QTimer>        saveTimer;
+	std::thread             saveThread;
+	std::mutex              saveMutex;
+	std::condition_variable saveCV;
+	OBSData                 pendingSaveData;
+	std::string             pendingSavePath;
+	uint64_t                pendingSaveSnapshotNs = 0;
+	bool                    saveThreadBusy = false;
+	bool                    saveThreadExit = false;
+
+	void SaveThread();
+	void QueueSave(obs_data_t *data, const char *file,
+			uint64_t snapshotNs);
+	void WaitForSave();
+	void StopSaveThread();
+
 	OBSService service;
 	std::unique_ptr<BasicOutputHandler> outputHandler;
 	bool streamingStopping = false;
@@ -58,10 +58,14 @@ OBSBasicStats::OBSBasicStats(QWidget *parent, bool closeable)
 	cpuUsage = new QLabel(this);
 	hddSpace = new QLabel(this);
 	memUsage = new QLabel(this);
+	frameJitter = new QLabel(this);
+	drawCalls = new QLabel(this);
 
 	newStat("CPUUsage", cpuUsage, 0);
 	newStat("HDDSpaceAvailable", hddSpace, 0);
 	newStat("MemoryUsage", memUsage, 0);
+	newStat("FrameJitter", frameJitter, 0);
+	newStat("DrawCalls", drawCalls, 0);
 
 	fps = new QLabel(this);
 	renderTime = new QLabel(this);
@@ -218,6 +222,7 @@ static uint32_t first_encoded = 0xFFFFFFFF;
 static uint32_t first_skipped = 0xFFFFFFFF;
 static uint32_t first_rendered = 0xFFFFFFFF;
 static uint32_t first_lagged = 0xFFFFFFFF;
+static uint32_t first_jitter[OBS_FRAME_JITTER_BUCKETS] = {};
 
 void OBSBasicStats::InitializeValues()
 {
@@ -226,6 +231,7 @@ void OBSBasicStats::InitializeValues()
 	first_skipped  = video_output_get_skipped_frames(video);
 	first_rendered = obs_get_total_frames();
 	first_lagged   = obs_get_lagged_frames();
+	obs_get_frame_jitter_histogram(first_jitter);
 }
 
 void OBSBasicStats::Update()
@@ -326,6 +332,46 @@ void OBSBasicStats::Update()
 
 	/* ------------------ */
 
+	uint32_t jitter[OBS_FRAME_JITTER_BUCKETS];
+	uint64_t jitterTotal = 0;
+	uint64_t jitterCount = 0;
+	size_t bucket = 0;
+
+	obs_get_frame_jitter_histogram(jitter);
+	for (size_t i = 0; i < OBS_FRAME_JITTER_BUCKETS; i++) {
+		jitter[i] -= first_jitter[i];
+		jitterTotal += jitter[i];
+	}
+
+	/* find the bucket that 99% of frames woke up within */
+	for (; bucket < OBS_FRAME_JITTER_BUCKETS - 1; bucket++) {
+		jitterCount += jitter[bucket];
+		if (jitterCount * 100 >= jitterTotal * 99)
+			break;
+	}
+
+	bool lastBucket = bucket == OBS_FRAME_JITTER_BUCKETS - 1;
+	uint64_t limit = obs_get_frame_jitter_bucket_limit(
+			lastBucket ? bucket - 1 : bucket);
+
+	num = (long double)limit / 1000000.0l;
+	str = QString(lastBucket ? "> " : "< ") +
+		QString::number(num, 'f', 2) + QStringLiteral(" ms");
+	frameJitter->setText(jitterTotal ? str : QStringLiteral("-"));
+
+	if (jitterTotal && num > fpsFrameTime * 0.25l)
+		setThemeID(frameJitter, "error");
+	else if (jitterTotal && limit > 2000000)
+		setThemeID(frameJitter, "warning");
+	else
+		setThemeID(frameJitter, "");
+
+	/* ------------------ */
+
+	drawCalls->setText(QString::number(obs_get_frame_draw_calls()));
+
+	/* ------------------ */
+
 	video_t *video = obs_get_video();
 	uint32_t total_encoded = video_output_get_total_frames(video);
 	uint32_t total_skipped = video_output_get_skipped_frames(video);
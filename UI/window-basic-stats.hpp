@@ -22,6 +22,8 @@ class OBSBasicStats : public QWidget {
 	QLabel *renderTime = nullptr;
 	QLabel *skippedFrames = nullptr;
 	QLabel *missedFrames = nullptr;
+	QLabel *frameJitter = nullptr;
+	QLabel *drawCalls = nullptr;
 
 	QGridLayout *outputLayout = nullptr;
 
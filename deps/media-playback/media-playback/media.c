@@ -579,6 +579,7 @@ static bool init_avformat(mp_media_t *m)
 static inline bool mp_media_thread(mp_media_t *m)
 {
 	os_set_thread_name("mp_media_thread");
+	os_set_thread_owner(m->name);
 
 	if (!init_avformat(m)) {
 		return false;
@@ -663,6 +664,7 @@ static inline bool mp_media_init_internal(mp_media_t *m,
 		return false;
 	}
 
+	m->name = info->name ? bstrdup(info->name) : NULL;
 	m->path = info->path ? bstrdup(info->path) : NULL;
 	m->format_name = info->format ? bstrdup(info->format) : NULL;
 	m->hw = info->hardware_decoding;
@@ -739,6 +741,7 @@ void mp_media_free(mp_media_t *media)
 	os_sem_destroy(media->sem);
 	sws_freeContext(media->swscale);
 	av_freep(&media->scale_pic[0]);
+	bfree(media->name);
 	bfree(media->path);
 	bfree(media->format_name);
 	memset(media, 0, sizeof(*media));
@@ -51,6 +51,7 @@ struct mp_media {
 	mp_audio_cb a_cb;
 	void *opaque;
 
+	char *name;
 	char *path;
 	char *format_name;
 	int buffering;
@@ -105,6 +106,7 @@ struct mp_media_info {
 	mp_audio_cb a_cb;
 	mp_stop_cb stop_cb;
 
+	const char *name;
 	const char *path;
 	const char *format;
 	int buffering;
@@ -419,6 +419,11 @@ struct gs_texture_2d {
 	uint32_t             height;
 	bool                 gen_mipmaps;
 	GLuint               unpack_buffer;
+
+	/* double-buffered, see gs_texture_upload_map */
+	GLuint               upload_buffers[2];
+	size_t               upload_idx;
+	uint8_t              *upload_ptr;
 };
 
 struct gs_texture_cube {
@@ -43,6 +43,29 @@ static bool upload_texture_2d(struct gs_texture_2d *tex, const uint8_t **data)
 	return success;
 }
 
+static GLsizeiptr get_unpack_buffer_size(const struct gs_texture_2d *tex)
+{
+	GLsizeiptr size = tex->width * gs_get_format_bpp(tex->base.format);
+
+	if (!gs_is_compressed_format(tex->base.format)) {
+		size /= 8;
+		size  = (size+3) & 0xFFFFFFFC;
+		size *= tex->height;
+	} else {
+		size *= tex->height;
+		size /= 8;
+	}
+
+	return size;
+}
+
+static inline uint32_t get_unpack_linesize(const struct gs_texture_2d *tex)
+{
+	uint32_t linesize = tex->width * gs_get_format_bpp(tex->base.format);
+	linesize /= 8;
+	return (linesize + 3) & 0xFFFFFFFC;
+}
+
 static bool create_pixel_unpack_buffer(struct gs_texture_2d *tex)
 {
 	GLsizeiptr size;
@@ -54,15 +77,7 @@ static bool create_pixel_unpack_buffer(struct gs_texture_2d *tex)
 	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, tex->unpack_buffer))
 		return false;
 
-	size = tex->width * gs_get_format_bpp(tex->base.format);
-	if (!gs_is_compressed_format(tex->base.format)) {
-		size /= 8;
-		size  = (size+3) & 0xFFFFFFFC;
-		size *= tex->height;
-	} else {
-		size *= tex->height;
-		size /= 8;
-	}
+	size = get_unpack_buffer_size(tex);
 
 	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_DYNAMIC_DRAW);
 	if (!gl_success("glBufferData"))
@@ -135,6 +150,10 @@ void gs_texture_destroy(gs_texture_t *tex)
 	if (!tex->is_dummy && tex->is_dynamic && tex2d->unpack_buffer)
 		gl_delete_buffers(1, &tex2d->unpack_buffer);
 
+	/* deleting a buffer also unmaps it */
+	if (tex2d->upload_buffers[0])
+		gl_delete_buffers(2, tex2d->upload_buffers);
+
 	if (tex->texture)
 		gl_delete_textures(1, &tex->texture);
 
@@ -188,8 +207,7 @@ bool gs_texture_map(gs_texture_t *tex, uint8_t **ptr, uint32_t *linesize)
 
 	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-	*linesize = tex2d->width * gs_get_format_bpp(tex->format) / 8;
-	*linesize = (*linesize + 3) & 0xFFFFFFFC;
+	*linesize = get_unpack_linesize(tex2d);
 	return true;
 
 fail:
@@ -229,6 +247,134 @@ failed:
 	blog(LOG_ERROR, "gs_texture_unmap (GL) failed");
 }
 
+/*
+ *   Uploads alternate between two pixel unpack buffers.  The next buffer is
+ * mapped ahead of time so that it can be filled by any thread while the
+ * previous transfer is still in flight, leaving only the unmap and the
+ * (asynchronous) glTexSubImage2D to the graphics thread.
+ */
+bool gs_texture_upload_map(gs_texture_t *tex, uint8_t **ptr,
+		uint32_t *linesize)
+{
+	struct gs_texture_2d *tex2d = (struct gs_texture_2d*)tex;
+	GLuint buffer;
+
+	if (!is_texture_2d(tex, "gs_texture_upload_map"))
+		goto fail;
+
+	if (!tex2d->base.is_dynamic || tex2d->base.is_dummy) {
+		blog(LOG_ERROR, "Texture is not dynamic");
+		goto fail;
+	}
+
+	if (tex2d->upload_ptr)
+		goto mapped;
+
+	if (!tex2d->upload_buffers[0] &&
+	    !gl_gen_buffers(2, tex2d->upload_buffers))
+		goto fail;
+
+	buffer = tex2d->upload_buffers[tex2d->upload_idx];
+	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, buffer))
+		goto fail;
+
+	/* orphans the old storage in case the last transfer from this buffer
+	 * hasn't finished yet */
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, get_unpack_buffer_size(tex2d), 0,
+			GL_STREAM_DRAW);
+	if (!gl_success("glBufferData"))
+		goto fail_unbind;
+
+	tex2d->upload_ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER,
+			GL_WRITE_ONLY);
+	if (!gl_success("glMapBuffer") || !tex2d->upload_ptr)
+		goto fail_unbind;
+
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+mapped:
+	*ptr      = tex2d->upload_ptr;
+	*linesize = get_unpack_linesize(tex2d);
+	return true;
+
+fail_unbind:
+	tex2d->upload_ptr = NULL;
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+fail:
+	blog(LOG_ERROR, "gs_texture_upload_map (GL) failed");
+	return false;
+}
+
+void gs_texture_upload_async(gs_texture_t *tex)
+{
+	struct gs_texture_2d *tex2d = (struct gs_texture_2d*)tex;
+	GLuint buffer;
+
+	if (!is_texture_2d(tex, "gs_texture_upload_async"))
+		goto failed;
+
+	if (!tex2d->upload_ptr) {
+		blog(LOG_ERROR, "Texture upload buffer is not mapped");
+		goto failed;
+	}
+
+	buffer = tex2d->upload_buffers[tex2d->upload_idx];
+	tex2d->upload_ptr = NULL;
+	tex2d->upload_idx ^= 1;
+
+	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, buffer))
+		goto failed;
+
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	if (!gl_success("glUnmapBuffer"))
+		goto failed;
+
+	if (!gl_bind_texture(GL_TEXTURE_2D, tex2d->base.texture))
+		goto failed;
+
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex2d->width, tex2d->height,
+			tex->gl_format, tex->gl_type, 0);
+	if (!gl_success("glTexSubImage2D"))
+		goto failed;
+
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	gl_bind_texture(GL_TEXTURE_2D, 0);
+	return;
+
+failed:
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	gl_bind_texture(GL_TEXTURE_2D, 0);
+	blog(LOG_ERROR, "gs_texture_upload_async (GL) failed");
+}
+
+void gs_texture_upload_cancel(gs_texture_t *tex)
+{
+	struct gs_texture_2d *tex2d = (struct gs_texture_2d*)tex;
+	GLuint buffer;
+
+	if (!is_texture_2d(tex, "gs_texture_upload_cancel"))
+		return;
+	if (!tex2d->upload_ptr)
+		return;
+
+	buffer = tex2d->upload_buffers[tex2d->upload_idx];
+	tex2d->upload_ptr = NULL;
+
+	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, buffer))
+		goto failed;
+
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	if (!gl_success("glUnmapBuffer"))
+		goto failed;
+
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	return;
+
+failed:
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	blog(LOG_ERROR, "gs_texture_upload_cancel (GL) failed");
+}
+
 bool gs_texture_is_rect(const gs_texture_t *tex)
 {
 	const struct gs_texture_2d *tex2d = (const struct gs_texture_2d*)tex;
@@ -100,6 +100,8 @@ size_t gs_technique_begin(gs_technique_t *tech)
 {
 	if (!tech) return 0;
 
+	gs_sprite_batch_flush_pending(tech->effect->graphics);
+
 	tech->effect->cur_technique = tech;
 	tech->effect->graphics->cur_effect = tech->effect;
 
@@ -542,6 +544,9 @@ void gs_effect_set_next_sampler(gs_eparam_t *param, gs_samplerstate_t *sampler)
 		return;
 	}
 
+	/* queued sprites would otherwise be drawn with this sampler */
+	gs_sprite_batch_flush_pending(param->effect->graphics);
+
 	if (param->type == GS_SHADER_PARAM_TEXTURE)
 		param->next_sampler = sampler;
 }
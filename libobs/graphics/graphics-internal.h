@@ -159,6 +159,10 @@ struct gs_exports {
 	bool     (*gs_texture_map)(gs_texture_t *tex, uint8_t **ptr,
 			uint32_t *linesize);
 	void     (*gs_texture_unmap)(gs_texture_t *tex);
+	bool     (*gs_texture_upload_map)(gs_texture_t *tex, uint8_t **ptr,
+			uint32_t *linesize);
+	void     (*gs_texture_upload_async)(gs_texture_t *tex);
+	void     (*gs_texture_upload_cancel)(gs_texture_t *tex);
 	bool     (*gs_texture_is_rect)(const gs_texture_t *tex);
 	void    *(*gs_texture_get_obj)(const gs_texture_t *tex);
 
@@ -284,6 +288,68 @@ struct blend_state {
 	enum gs_blend_type dest_a;
 };
 
+struct gs_pool_texture {
+	gs_texture_t           *tex;
+	uint32_t               width;
+	uint32_t               height;
+	enum gs_color_format   format;
+	uint32_t               flags;
+	uint64_t               size;
+	uint64_t               last_used;
+};
+
+struct gs_texture_pool {
+	/* free textures are kept oldest first for LRU eviction */
+	DARRAY(struct gs_pool_texture) free;
+	DARRAY(struct gs_pool_texture) used;
+	uint64_t               free_bytes;
+	uint64_t               used_bytes;
+	uint64_t               max_bytes;
+
+	uint64_t               hits;
+	uint64_t               misses;
+	uint64_t               evictions;
+};
+
+extern void gs_texture_pool_init(struct gs_texture_pool *pool);
+extern void gs_texture_pool_free(struct gs_texture_pool *pool);
+
+struct gs_atlas_slot {
+	gs_texture_t           *tex;
+	long                   version;
+	uint32_t               x;
+	uint32_t               y;
+	uint32_t               cx;
+	uint32_t               cy;
+};
+
+struct gs_sprite_batch {
+	gs_vertbuffer_t        *vertbuffer;
+	int                    depth;
+
+	/* state shared by all queued sprites */
+	size_t                 num;
+	gs_effect_t            *effect;
+	gs_technique_t         *technique;
+	gs_texture_t           *tex;
+	struct blend_state     blend;
+
+	/* small textures that rarely change are copied here so that sprites
+	 * using different textures can still be drawn together */
+	gs_texture_t           *atlas;
+	DARRAY(struct gs_atlas_slot) slots;
+	uint32_t               shelf_x;
+	uint32_t               shelf_y;
+	uint32_t               shelf_cy;
+
+	uint64_t               draw_calls;
+	uint64_t               batched_sprites;
+	uint64_t               atlas_copies;
+};
+
+extern bool gs_sprite_batch_init(struct graphics_subsystem *graphics);
+extern void gs_sprite_batch_free(struct graphics_subsystem *graphics);
+
 struct graphics_subsystem {
 	void                   *module;
 	gs_device_t            *device;
@@ -315,4 +381,15 @@ struct graphics_subsystem {
 
 	struct blend_state     cur_blend_state;
 	DARRAY(struct blend_state) blend_state_stack;
+
+	struct gs_texture_pool texture_pool;
+	struct gs_sprite_batch sprite_batch;
 };
+
+/* sprites queued by gs_sprite_batch_draw have to be drawn before anything
+ * that changes (or reads back) the state they are drawn with */
+static inline void gs_sprite_batch_flush_pending(graphics_t *graphics)
+{
+	if (graphics->sprite_batch.num)
+		gs_sprite_batch_flush();
+}
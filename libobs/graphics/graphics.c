@@ -153,6 +153,8 @@ static bool graphics_init(struct graphics_subsystem *graphics)
 		return false;
 	if (!graphics_init_sprite_vb(graphics))
 		return false;
+	if (!gs_sprite_batch_init(graphics))
+		return false;
 	if (pthread_mutex_init(&graphics->mutex, NULL) != 0)
 		return false;
 	if (pthread_mutex_init(&graphics->effect_mutex, NULL) != 0)
@@ -179,6 +181,7 @@ int gs_create(graphics_t **pgraphics, const char *module, uint32_t adapter)
 
 	graphics_t *graphics = bzalloc(sizeof(struct graphics_subsystem));
 	pthread_mutex_init_value(&graphics->mutex);
+	gs_texture_pool_init(&graphics->texture_pool);
 	pthread_mutex_init_value(&graphics->effect_mutex);
 
 	graphics->module = os_dlopen(module);
@@ -224,6 +227,9 @@ void gs_destroy(graphics_t *graphics)
 		thread_graphics = graphics;
 		graphics->exports.device_enter_context(graphics->device);
 
+		gs_texture_pool_free(&graphics->texture_pool);
+		gs_sprite_batch_free(graphics);
+
 		while (effect) {
 			struct gs_effect *next = effect->next;
 			gs_effect_actually_destroy(effect);
@@ -1131,40 +1137,50 @@ void gs_viewport_pop(void)
 	da_pop_back(thread_graphics->viewport_stack);
 }
 
-void gs_texture_set_image(gs_texture_t *tex, const uint8_t *data,
-		uint32_t linesize, bool flip)
+void gs_copy_image_rows(uint8_t *dst, uint32_t dst_linesize,
+		const uint8_t *src, uint32_t src_linesize, uint32_t rows,
+		bool flip)
 {
-	uint8_t *ptr;
-	uint32_t linesize_out;
 	uint32_t row_copy;
-	int32_t height;
+	int32_t height = (int32_t)rows;
 	int32_t y;
 
-	if (!gs_valid_p2("gs_texture_set_image", tex, data))
+	if (!dst || !src)
 		return;
 
-	height = (int32_t)gs_texture_get_height(tex);
-
-	if (!gs_texture_map(tex, &ptr, &linesize_out))
-		return;
-
-	row_copy = (linesize < linesize_out) ? linesize : linesize_out;
+	row_copy = (src_linesize < dst_linesize) ? src_linesize : dst_linesize;
 
 	if (flip) {
 		for (y = height-1; y >= 0; y--)
-			memcpy(ptr  + (uint32_t)y * linesize_out,
-			       data + (uint32_t)(height - y - 1) * linesize,
+			memcpy(dst + (uint32_t)y * dst_linesize,
+			       src + (uint32_t)(height - y - 1) * src_linesize,
 			       row_copy);
 
-	} else if (linesize == linesize_out) {
-		memcpy(ptr, data, row_copy * height);
+	} else if (src_linesize == dst_linesize) {
+		memcpy(dst, src, row_copy * height);
 
 	} else {
 		for (y = 0; y < height; y++)
-			memcpy(ptr  + (uint32_t)y * linesize_out,
-			       data + (uint32_t)y * linesize,
+			memcpy(dst + (uint32_t)y * dst_linesize,
+			       src + (uint32_t)y * src_linesize,
 			       row_copy);
 	}
+}
+
+void gs_texture_set_image(gs_texture_t *tex, const uint8_t *data,
+		uint32_t linesize, bool flip)
+{
+	uint8_t *ptr;
+	uint32_t linesize_out;
+
+	if (!gs_valid_p2("gs_texture_set_image", tex, data))
+		return;
+
+	if (!gs_texture_map(tex, &ptr, &linesize_out))
+		return;
+
+	gs_copy_image_rows(ptr, linesize_out, data, linesize,
+			gs_texture_get_height(tex), flip);
 
 	gs_texture_unmap(tex);
 }
@@ -1188,6 +1204,8 @@ void gs_perspective(float angle, float aspect, float near, float far)
 	if (!gs_valid("gs_perspective"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	ymax = near * tanf(RAD(angle)*0.5f);
 	ymin = -ymax;
 
@@ -1544,6 +1562,8 @@ void gs_load_vertexbuffer(gs_vertbuffer_t *vertbuffer)
 	if (!gs_valid("gs_load_vertexbuffer"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_load_vertexbuffer(graphics->device,
 			vertbuffer);
 }
@@ -1555,6 +1575,8 @@ void gs_load_indexbuffer(gs_indexbuffer_t *indexbuffer)
 	if (!gs_valid("gs_load_indexbuffer"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_load_indexbuffer(graphics->device,
 			indexbuffer);
 }
@@ -1587,6 +1609,8 @@ void gs_load_vertexshader(gs_shader_t *vertshader)
 	if (!gs_valid("gs_load_vertexshader"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_load_vertexshader(graphics->device,
 			vertshader);
 }
@@ -1598,6 +1622,8 @@ void gs_load_pixelshader(gs_shader_t *pixelshader)
 	if (!gs_valid("gs_load_pixelshader"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_load_pixelshader(graphics->device,
 			pixelshader);
 }
@@ -1660,6 +1686,8 @@ void gs_set_render_target(gs_texture_t *tex, gs_zstencil_t *zstencil)
 	if (!gs_valid("gs_set_render_target"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_set_render_target(graphics->device, tex,
 			zstencil);
 }
@@ -1672,6 +1700,8 @@ void gs_set_cube_render_target(gs_texture_t *cubetex, int side,
 	if (!gs_valid("gs_set_cube_render_target"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_set_cube_render_target(graphics->device,
 			cubetex, side, zstencil);
 }
@@ -1683,6 +1713,8 @@ void gs_copy_texture(gs_texture_t *dst, gs_texture_t *src)
 	if (!gs_valid_p2("gs_copy_texture", dst, src))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_copy_texture(graphics->device, dst, src);
 }
 
@@ -1695,6 +1727,8 @@ void gs_copy_texture_region(gs_texture_t *dst, uint32_t dst_x, uint32_t dst_y,
 	if (!gs_valid_p("gs_copy_texture_region", dst))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_copy_texture_region(graphics->device,
 			dst, dst_x, dst_y,
 			src, src_x, src_y, src_w, src_h);
@@ -1707,6 +1741,8 @@ void gs_stage_texture(gs_stagesurf_t *dst, gs_texture_t *src)
 	if (!gs_valid("gs_stage_texture"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_stage_texture(graphics->device, dst, src);
 }
 
@@ -1728,6 +1764,9 @@ void gs_draw(enum gs_draw_mode draw_mode, uint32_t start_vert,
 	if (!gs_valid("gs_draw"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+	graphics->sprite_batch.draw_calls++;
+
 	graphics->exports.device_draw(graphics->device, draw_mode,
 			start_vert, num_verts);
 }
@@ -1739,6 +1778,8 @@ void gs_end_scene(void)
 	if (!gs_valid("gs_end_scene"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_end_scene(graphics->device);
 }
 
@@ -1749,6 +1790,8 @@ void gs_load_swapchain(gs_swapchain_t *swapchain)
 	if (!gs_valid("gs_load_swapchain"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_load_swapchain(graphics->device, swapchain);
 }
 
@@ -1760,6 +1803,8 @@ void gs_clear(uint32_t clear_flags, const struct vec4 *color, float depth,
 	if (!gs_valid("gs_clear"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_clear(graphics->device, clear_flags, color,
 			depth, stencil);
 }
@@ -1771,6 +1816,8 @@ void gs_present(void)
 	if (!gs_valid("gs_present"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_present(graphics->device);
 }
 
@@ -1791,6 +1838,8 @@ void gs_set_cull_mode(enum gs_cull_mode mode)
 	if (!gs_valid("gs_set_cull_mode"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_set_cull_mode(graphics->device, mode);
 }
 
@@ -1822,6 +1871,8 @@ void gs_enable_depth_test(bool enable)
 	if (!gs_valid("gs_enable_depth_test"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_enable_depth_test(graphics->device, enable);
 }
 
@@ -1832,6 +1883,8 @@ void gs_enable_stencil_test(bool enable)
 	if (!gs_valid("gs_enable_stencil_test"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_enable_stencil_test(graphics->device, enable);
 }
 
@@ -1842,6 +1895,8 @@ void gs_enable_stencil_write(bool enable)
 	if (!gs_valid("gs_enable_stencil_write"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_enable_stencil_write(graphics->device, enable);
 }
 
@@ -1852,6 +1907,8 @@ void gs_enable_color(bool red, bool green, bool blue, bool alpha)
 	if (!gs_valid("gs_enable_color"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_enable_color(graphics->device, red, green,
 			blue, alpha);
 }
@@ -1926,6 +1983,8 @@ void gs_set_viewport(int x, int y, int width, int height)
 	if (!gs_valid("gs_set_viewport"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_set_viewport(graphics->device, x, y, width,
 			height);
 }
@@ -1947,6 +2006,8 @@ void gs_set_scissor_rect(const struct gs_rect *rect)
 	if (!gs_valid("gs_set_scissor_rect"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_set_scissor_rect(graphics->device, rect);
 }
 
@@ -1958,6 +2019,8 @@ void gs_ortho(float left, float right, float top, float bottom, float znear,
 	if (!gs_valid("gs_ortho"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_ortho(graphics->device, left, right, top,
 			bottom, znear, zfar);
 }
@@ -1970,6 +2033,8 @@ void gs_frustum(float left, float right, float top, float bottom, float znear,
 	if (!gs_valid("gs_frustum"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_frustum(graphics->device, left, right, top,
 			bottom, znear, zfar);
 }
@@ -1991,6 +2056,8 @@ void gs_projection_pop(void)
 	if (!gs_valid("gs_projection_pop"))
 		return;
 
+	gs_sprite_batch_flush_pending(graphics);
+
 	graphics->exports.device_projection_pop(graphics->device);
 }
 
@@ -2261,6 +2328,42 @@ void gs_texture_unmap(gs_texture_t *tex)
 	graphics->exports.gs_texture_unmap(tex);
 }
 
+bool gs_texture_upload_map(gs_texture_t *tex, uint8_t **ptr,
+		uint32_t *linesize)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p3("gs_texture_upload_map", tex, ptr, linesize))
+		return false;
+
+	if (!graphics->exports.gs_texture_upload_map)
+		return false;
+
+	return graphics->exports.gs_texture_upload_map(tex, ptr, linesize);
+}
+
+void gs_texture_upload_async(gs_texture_t *tex)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p("gs_texture_upload_async", tex))
+		return;
+
+	if (graphics->exports.gs_texture_upload_async)
+		graphics->exports.gs_texture_upload_async(tex);
+}
+
+void gs_texture_upload_cancel(gs_texture_t *tex)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p("gs_texture_upload_cancel", tex))
+		return;
+
+	if (graphics->exports.gs_texture_upload_cancel)
+		graphics->exports.gs_texture_upload_cancel(tex);
+}
+
 bool gs_texture_is_rect(const gs_texture_t *tex)
 {
 	graphics_t *graphics = thread_graphics;
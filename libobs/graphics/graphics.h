@@ -435,6 +435,41 @@ EXPORT void gs_texrender_end(gs_texrender_t *texrender);
 EXPORT void gs_texrender_reset(gs_texrender_t *texrender);
 EXPORT gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender);
 
+/* ---------------------------------------------------
+ * texture pool
+ * --------------------------------------------------- */
+
+struct gs_texture_pool_stats {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	size_t   used_textures;
+	size_t   free_textures;
+	uint64_t used_bytes;
+	uint64_t free_bytes;
+};
+
+/**
+ * Gets a single-level texture with the given size, format and flags
+ * (GS_DYNAMIC and/or GS_RENDER_TARGET), reusing a released texture when one
+ * matches.  The contents of a reused texture are undefined.
+ */
+EXPORT gs_texture_t *gs_texture_pool_acquire(uint32_t width, uint32_t height,
+		enum gs_color_format format, uint32_t flags);
+
+/** Returns a texture from gs_texture_pool_acquire to the pool.  Textures
+ * that didn't come from the pool are destroyed. */
+EXPORT void gs_texture_pool_release(gs_texture_t *tex);
+
+/** Sets the maximum size of the textures kept for reuse, 0 disables
+ * pooling.  The least recently released textures are destroyed first. */
+EXPORT void gs_texture_pool_set_max_size(uint64_t bytes);
+
+/** Destroys pooled textures that haven't been reused for max_idle_ns */
+EXPORT void gs_texture_pool_trim(uint64_t max_idle_ns);
+
+EXPORT void gs_texture_pool_get_stats(struct gs_texture_pool_stats *stats);
+
 /* ---------------------------------------------------
  * graphics subsystem
  * --------------------------------------------------- */
@@ -556,6 +591,47 @@ EXPORT void gs_draw_sprite(gs_texture_t *tex, uint32_t flip, uint32_t width,
 EXPORT void gs_draw_sprite_subregion(gs_texture_t *tex, uint32_t flip,
 		uint32_t x, uint32_t y, uint32_t cx, uint32_t cy);
 
+/**
+ * Starts queueing sprites drawn with gs_sprite_batch_draw.  Consecutive
+ * sprites that use the same effect, technique, texture and blend state are
+ * drawn with a single draw call.  Batches may be nested.
+ */
+EXPORT void gs_sprite_batch_begin(void);
+
+/** Draws any queued sprites and stops queueing once the outermost batch
+ * ends */
+EXPORT void gs_sprite_batch_end(void);
+
+/**
+ * Draws a 2D sprite with the given effect technique, or queues it if a batch
+ * has been started.  The sprite is transformed by the current matrix when
+ * it's queued.  Only the effect's "image" parameter is set, so the technique
+ * must not depend on any other parameters.
+ *
+ *   If version is non-zero, small RGBA textures are copied to a shared atlas
+ * so sprites with different textures can be drawn together.  The copy is
+ * reused for as long as the texture is drawn with the same version, so the
+ * version must change whenever the texture's contents do.
+ *
+ *   If width or height is 0, the width or height of the texture will be used.
+ */
+EXPORT void gs_sprite_batch_draw(gs_effect_t *effect, const char *technique,
+		gs_texture_t *tex, long version, uint32_t width,
+		uint32_t height);
+
+/** Draws any queued sprites now */
+EXPORT void gs_sprite_batch_flush(void);
+
+struct gs_draw_stats {
+	uint64_t draw_calls;
+	uint64_t batched_sprites;
+	uint64_t atlas_copies;
+};
+
+/** Gets the number of draw calls, sprites drawn through a batch and textures
+ * copied to the sprite atlas since the graphics subsystem was created */
+EXPORT void gs_get_draw_stats(struct gs_draw_stats *stats);
+
 EXPORT void gs_draw_cube_backdrop(gs_texture_t *cubetex, const struct quat *rot,
 		float left, float right, float top, float bottom, float znear);
 
@@ -570,6 +646,11 @@ EXPORT void gs_set_3d_mode(double fovy, double znear, double zvar);
 EXPORT void gs_viewport_push(void);
 EXPORT void gs_viewport_pop(void);
 
+/** copies image rows between buffers with different line sizes, such as
+ * to a mapped texture.  doesn't need the graphics context */
+EXPORT void gs_copy_image_rows(uint8_t *dst, uint32_t dst_linesize,
+		const uint8_t *src, uint32_t src_linesize, uint32_t rows,
+		bool invert);
 EXPORT void gs_texture_set_image(gs_texture_t *tex, const uint8_t *data,
 		uint32_t linesize, bool invert);
 EXPORT void gs_cubetexture_set_image(gs_texture_t *cubetex, uint32_t side,
@@ -707,6 +788,20 @@ EXPORT enum gs_color_format gs_texture_get_color_format(
 EXPORT bool     gs_texture_map(gs_texture_t *tex, uint8_t **ptr,
 		uint32_t *linesize);
 EXPORT void     gs_texture_unmap(gs_texture_t *tex);
+/**
+ * Maps a buffer for an asynchronous upload to a dynamic texture.  Unlike
+ * gs_texture_map, the buffer may be filled from any thread until
+ * gs_texture_upload_async is called, and mapping it again before that
+ * returns the same buffer.  Returns false if the renderer doesn't support
+ * asynchronous uploads (currently only OpenGL does).
+ */
+EXPORT bool     gs_texture_upload_map(gs_texture_t *tex, uint8_t **ptr,
+		uint32_t *linesize);
+/** Unmaps the upload buffer and starts transferring it to the texture
+ * without waiting for the transfer to finish */
+EXPORT void     gs_texture_upload_async(gs_texture_t *tex);
+/** Unmaps the upload buffer without transferring it, if one is mapped */
+EXPORT void     gs_texture_upload_cancel(gs_texture_t *tex);
 /** special-case function (GL only) - specifies whether the texture is a
  * GL_TEXTURE_RECTANGLE type, which doesn't use normalized texture
  * coordinates, doesn't support mipmapping, and requires address clamping */
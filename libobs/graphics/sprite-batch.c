@@ -0,0 +1,456 @@
+/*
+ *   Sprites drawn through a batch are transformed on the CPU and appended to
+ * a single vertex buffer, so that consecutive sprites sharing an effect,
+ * texture and blend state only need one draw call.  Small textures that
+ * rarely change can be copied to an atlas so that sprites with different
+ * textures can share a draw call as well.
+ */
+
+#include <inttypes.h>
+#include "graphics-internal.h"
+#include "vec2.h"
+
+#define BATCH_MAX_SPRITES 128
+#define BATCH_MAX_VERTS   (BATCH_MAX_SPRITES * 6)
+
+#define ATLAS_SIZE        2048
+#define ATLAS_MAX_SPRITE  512
+#define ATLAS_PADDING     1
+
+bool gs_sprite_batch_init(struct graphics_subsystem *graphics)
+{
+	struct gs_vb_data *vbd;
+
+	vbd = gs_vbdata_create();
+	vbd->num     = BATCH_MAX_VERTS;
+	vbd->points  = bmalloc(sizeof(struct vec3) * BATCH_MAX_VERTS);
+	vbd->num_tex = 1;
+	vbd->tvarray = bmalloc(sizeof(struct gs_tvertarray));
+	vbd->tvarray[0].width = 2;
+	vbd->tvarray[0].array = bmalloc(sizeof(struct vec2) * BATCH_MAX_VERTS);
+
+	memset(vbd->points,           0, sizeof(struct vec3) * BATCH_MAX_VERTS);
+	memset(vbd->tvarray[0].array, 0, sizeof(struct vec2) * BATCH_MAX_VERTS);
+
+	graphics->sprite_batch.vertbuffer = graphics->exports.
+		device_vertexbuffer_create(graphics->device, vbd, GS_DYNAMIC);
+	return graphics->sprite_batch.vertbuffer != NULL;
+}
+
+void gs_sprite_batch_free(struct graphics_subsystem *graphics)
+{
+	struct gs_sprite_batch *batch = &graphics->sprite_batch;
+
+	if (batch->atlas)
+		graphics->exports.gs_texture_destroy(batch->atlas);
+	if (batch->vertbuffer)
+		graphics->exports.gs_vertexbuffer_destroy(batch->vertbuffer);
+	da_free(batch->slots);
+
+	blog(LOG_DEBUG, "Sprite batch: %"PRIu64" draw calls, "
+	                "%"PRIu64" sprites drawn through batches, "
+	                "%"PRIu64" atlas copies",
+	                batch->draw_calls, batch->batched_sprites,
+	                batch->atlas_copies);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static bool atlas_reset(graphics_t *graphics)
+{
+	struct gs_sprite_batch *batch = &graphics->sprite_batch;
+	gs_texture_t *prev_target;
+	gs_zstencil_t *prev_zstencil;
+	struct vec4 clear_color;
+
+	/* queued sprites may still be using the old contents */
+	gs_sprite_batch_flush_pending(graphics);
+
+	if (!batch->atlas) {
+		batch->atlas = gs_texture_create(ATLAS_SIZE, ATLAS_SIZE,
+				GS_RGBA, 1, NULL, GS_RENDER_TARGET);
+		if (!batch->atlas)
+			return false;
+	}
+
+	da_resize(batch->slots, 0);
+	batch->shelf_x  = 0;
+	batch->shelf_y  = 0;
+	batch->shelf_cy = 0;
+
+	prev_target   = gs_get_render_target();
+	prev_zstencil = gs_get_zstencil_target();
+
+	vec4_zero(&clear_color);
+	gs_set_render_target(batch->atlas, NULL);
+	gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+	gs_set_render_target(prev_target, prev_zstencil);
+	return true;
+}
+
+/* simple shelf packing, space is only reclaimed when the atlas is reset */
+static bool atlas_alloc(struct gs_sprite_batch *batch, uint32_t cx,
+		uint32_t cy, uint32_t *x, uint32_t *y)
+{
+	uint32_t padded_cx = cx + ATLAS_PADDING * 2;
+	uint32_t padded_cy = cy + ATLAS_PADDING * 2;
+
+	if (batch->shelf_x + padded_cx > ATLAS_SIZE) {
+		batch->shelf_y += batch->shelf_cy;
+		batch->shelf_x  = 0;
+		batch->shelf_cy = 0;
+	}
+
+	if (batch->shelf_y + padded_cy > ATLAS_SIZE)
+		return false;
+
+	*x = batch->shelf_x + ATLAS_PADDING;
+	*y = batch->shelf_y + ATLAS_PADDING;
+
+	batch->shelf_x += padded_cx;
+	if (padded_cy > batch->shelf_cy)
+		batch->shelf_cy = padded_cy;
+	return true;
+}
+
+static void atlas_copy(struct gs_sprite_batch *batch,
+		const struct gs_atlas_slot *slot)
+{
+	gs_texture_t *atlas = batch->atlas;
+	gs_texture_t *tex   = slot->tex;
+	uint32_t x  = slot->x;
+	uint32_t y  = slot->y;
+	uint32_t cx = slot->cx;
+	uint32_t cy = slot->cy;
+
+	gs_copy_texture_region(atlas, x, y, tex, 0, 0, cx, cy);
+
+	/* repeat the edges into the padding so that filtering at the edges
+	 * doesn't pick up neighboring sprites */
+	gs_copy_texture_region(atlas, x - 1,  y,      tex, 0,      0, 1,  cy);
+	gs_copy_texture_region(atlas, x + cx, y,      tex, cx - 1, 0, 1,  cy);
+	gs_copy_texture_region(atlas, x,      y - 1,  tex, 0,      0, cx, 1);
+	gs_copy_texture_region(atlas, x,      y + cy, tex, 0, cy - 1, cx, 1);
+
+	batch->atlas_copies++;
+}
+
+static const struct gs_atlas_slot *atlas_get_slot(graphics_t *graphics,
+		gs_texture_t *tex, long version, uint32_t cx, uint32_t cy)
+{
+	struct gs_sprite_batch *batch = &graphics->sprite_batch;
+	struct gs_atlas_slot *slot;
+	uint32_t x, y;
+
+	for (size_t i = 0; i < batch->slots.num; i++) {
+		slot = batch->slots.array + i;
+		if (slot->tex != tex)
+			continue;
+
+		if (slot->cx == cx && slot->cy == cy) {
+			if (slot->version != version) {
+				slot->version = version;
+				atlas_copy(batch, slot);
+			}
+			return slot;
+		}
+
+		da_erase(batch->slots, i);
+		break;
+	}
+
+	if (!batch->atlas && !atlas_reset(graphics))
+		return NULL;
+
+	if (!atlas_alloc(batch, cx, cy, &x, &y)) {
+		if (!atlas_reset(graphics))
+			return NULL;
+		if (!atlas_alloc(batch, cx, cy, &x, &y))
+			return NULL;
+	}
+
+	slot = da_push_back_new(batch->slots);
+	slot->tex     = tex;
+	slot->version = version;
+	slot->x       = x;
+	slot->y       = y;
+	slot->cx      = cx;
+	slot->cy      = cy;
+
+	atlas_copy(batch, slot);
+	return slot;
+}
+
+static inline bool use_atlas(gs_texture_t *tex, long version,
+		uint32_t cx, uint32_t cy)
+{
+	return version != 0 &&
+		cx <= ATLAS_MAX_SPRITE && cy <= ATLAS_MAX_SPRITE &&
+		!gs_texture_is_rect(tex) &&
+		gs_texture_get_color_format(tex) == GS_RGBA;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static inline bool blend_state_equal(const struct blend_state *a,
+		const struct blend_state *b)
+{
+	return a->enabled == b->enabled &&
+		a->src_c  == b->src_c  && a->dest_c == b->dest_c &&
+		a->src_a  == b->src_a  && a->dest_a == b->dest_a;
+}
+
+static inline bool batch_compatible(const struct gs_sprite_batch *batch,
+		const struct blend_state *blend, gs_effect_t *effect,
+		gs_technique_t *technique, gs_texture_t *tex)
+{
+	return batch->num < BATCH_MAX_SPRITES &&
+		batch->effect == effect &&
+		batch->technique == technique &&
+		batch->tex == tex &&
+		blend_state_equal(&batch->blend, blend);
+}
+
+static void queue_sprite(struct gs_sprite_batch *batch, float cx, float cy,
+		const struct vec2 *uv_start, const struct vec2 *uv_end)
+{
+	struct gs_vb_data *data = gs_vertexbuffer_get_data(batch->vertbuffer);
+	struct vec3 *points = data->points + batch->num * 6;
+	struct vec2 *tvarray = (struct vec2*)data->tvarray[0].array +
+		batch->num * 6;
+	struct matrix4 mat;
+	struct vec3 corners[4];
+	struct vec2 uvs[4];
+
+	/* same corner order as gs_draw_sprite's triangle strip */
+	static const int order[6] = {0, 1, 2, 2, 1, 3};
+
+	gs_matrix_get(&mat);
+
+	vec3_set(corners,   0.0f, 0.0f, 0.0f);
+	vec3_set(corners+1,   cx, 0.0f, 0.0f);
+	vec3_set(corners+2, 0.0f,   cy, 0.0f);
+	vec3_set(corners+3,   cx,   cy, 0.0f);
+	vec2_set(uvs,   uv_start->x, uv_start->y);
+	vec2_set(uvs+1, uv_end->x,   uv_start->y);
+	vec2_set(uvs+2, uv_start->x, uv_end->y);
+	vec2_set(uvs+3, uv_end->x,   uv_end->y);
+
+	for (size_t i = 0; i < 4; i++)
+		vec3_transform(corners + i, corners + i, &mat);
+
+	for (size_t i = 0; i < 6; i++) {
+		vec3_copy(points + i, corners + order[i]);
+		vec2_copy(tvarray + i, uvs + order[i]);
+	}
+
+	batch->num++;
+	batch->batched_sprites++;
+}
+
+void gs_sprite_batch_begin(void)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (graphics)
+		graphics->sprite_batch.depth++;
+}
+
+void gs_sprite_batch_end(void)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (!graphics || !graphics->sprite_batch.depth)
+		return;
+
+	if (--graphics->sprite_batch.depth == 0)
+		gs_sprite_batch_flush_pending(graphics);
+}
+
+void gs_sprite_batch_draw(gs_effect_t *effect, const char *technique,
+		gs_texture_t *tex, long version, uint32_t width,
+		uint32_t height)
+{
+	graphics_t *graphics = gs_get_context();
+	struct gs_sprite_batch *batch;
+	gs_technique_t *tech;
+	gs_effect_t *active;
+	gs_texture_t *draw_tex = tex;
+	uint32_t tex_cx, tex_cy;
+	struct vec2 uv_start, uv_end;
+
+	if (!graphics || !effect || !tex) {
+		blog(LOG_DEBUG, "gs_sprite_batch_draw: invalid parameters");
+		return;
+	}
+	if (gs_get_texture_type(tex) != GS_TEXTURE_2D) {
+		blog(LOG_ERROR, "A sprite must be a 2D texture");
+		return;
+	}
+
+	tech = gs_effect_get_technique(effect, technique);
+	if (!tech) {
+		blog(LOG_WARNING, "gs_sprite_batch_draw: Technique '%s' "
+		                  "not found.", technique);
+		return;
+	}
+
+	/* within another effect's loop, neither queuing the sprite nor
+	 * starting its own technique works, so draw it right away with the
+	 * active effect, like obs_source_draw does */
+	active = gs_get_effect();
+	if (active) {
+		gs_eparam_t *image = gs_effect_get_param_by_name(active,
+				"image");
+
+		gs_sprite_batch_flush_pending(graphics);
+		if (image)
+			gs_effect_set_texture(image, tex);
+		gs_draw_sprite(tex, 0, width, height);
+		return;
+	}
+
+	batch  = &graphics->sprite_batch;
+	tex_cx = gs_texture_get_width(tex);
+	tex_cy = gs_texture_get_height(tex);
+
+	vec2_zero(&uv_start);
+	if (gs_texture_is_rect(tex))
+		vec2_set(&uv_end, (float)tex_cx, (float)tex_cy);
+	else
+		vec2_set(&uv_end, 1.0f, 1.0f);
+
+	if (use_atlas(tex, version, tex_cx, tex_cy)) {
+		const struct gs_atlas_slot *slot = atlas_get_slot(graphics,
+				tex, version, tex_cx, tex_cy);
+
+		if (slot) {
+			float size = (float)ATLAS_SIZE;
+
+			draw_tex = batch->atlas;
+			vec2_set(&uv_start,
+					(float)slot->x / size,
+					(float)slot->y / size);
+			vec2_set(&uv_end,
+					(float)(slot->x + tex_cx) / size,
+					(float)(slot->y + tex_cy) / size);
+		}
+	}
+
+	if (batch->num && !batch_compatible(batch, &graphics->cur_blend_state,
+				effect, tech, draw_tex))
+		gs_sprite_batch_flush();
+
+	if (!batch->num) {
+		batch->effect    = effect;
+		batch->technique = tech;
+		batch->tex       = draw_tex;
+		batch->blend     = graphics->cur_blend_state;
+	}
+
+	queue_sprite(batch,
+			(float)(width  ? width  : tex_cx),
+			(float)(height ? height : tex_cy),
+			&uv_start, &uv_end);
+
+	if (!batch->depth)
+		gs_sprite_batch_flush();
+}
+
+/* a lone sprite is drawn with the small sprite buffer instead of uploading
+ * the whole batch buffer */
+static gs_vertbuffer_t *load_single_sprite(graphics_t *graphics)
+{
+	struct gs_vb_data *src = gs_vertexbuffer_get_data(
+			graphics->sprite_batch.vertbuffer);
+	struct gs_vb_data *dst = gs_vertexbuffer_get_data(
+			graphics->sprite_buffer);
+	struct vec2 *src_uv = src->tvarray[0].array;
+	struct vec2 *dst_uv = dst->tvarray[0].array;
+
+	for (size_t i = 0; i < 3; i++) {
+		vec3_copy(dst->points + i, src->points + i);
+		vec2_copy(dst_uv + i, src_uv + i);
+	}
+	vec3_copy(dst->points + 3, src->points + 5);
+	vec2_copy(dst_uv + 3, src_uv + 5);
+
+	return graphics->sprite_buffer;
+}
+
+void gs_sprite_batch_flush(void)
+{
+	graphics_t *graphics = gs_get_context();
+	struct gs_sprite_batch *batch;
+	gs_vertbuffer_t *vb;
+	enum gs_draw_mode mode;
+	uint32_t num_verts;
+	gs_eparam_t *image;
+	size_t passes;
+
+	if (!graphics)
+		return;
+
+	batch = &graphics->sprite_batch;
+	if (!batch->num)
+		return;
+
+	if (batch->num == 1) {
+		vb        = load_single_sprite(graphics);
+		mode      = GS_TRISTRIP;
+		num_verts = 0;
+	} else {
+		vb        = batch->vertbuffer;
+		mode      = GS_TRIS;
+		num_verts = (uint32_t)(batch->num * 6);
+	}
+
+	/* cleared first, the calls below would otherwise try to flush the
+	 * batch again */
+	batch->num = 0;
+
+	gs_vertexbuffer_flush(vb);
+	gs_load_vertexbuffer(vb);
+	gs_load_indexbuffer(NULL);
+
+	gs_blend_state_push();
+	gs_enable_blending(batch->blend.enabled);
+	gs_blend_function_separate(batch->blend.src_c, batch->blend.dest_c,
+			batch->blend.src_a, batch->blend.dest_a);
+
+	/* vertices are already transformed */
+	gs_matrix_push();
+	gs_matrix_identity();
+
+	image  = gs_effect_get_param_by_name(batch->effect, "image");
+	passes = gs_technique_begin(batch->technique);
+	for (size_t i = 0; i < passes; i++) {
+		if (!gs_technique_begin_pass(batch->technique, i))
+			continue;
+
+		gs_effect_set_texture(image, batch->tex);
+		gs_draw(mode, 0, num_verts);
+		gs_technique_end_pass(batch->technique);
+	}
+	gs_technique_end(batch->technique);
+
+	gs_matrix_pop();
+	gs_blend_state_pop();
+}
+
+void gs_get_draw_stats(struct gs_draw_stats *stats)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (!stats)
+		return;
+
+	if (!graphics) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	stats->draw_calls      = graphics->sprite_batch.draw_calls;
+	stats->batched_sprites = graphics->sprite_batch.batched_sprites;
+	stats->atlas_copies    = graphics->sprite_batch.atlas_copies;
+}
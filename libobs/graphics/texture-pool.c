@@ -0,0 +1,211 @@
+/*
+ *   Keeps released textures around so that textures of the same size,
+ * format and flags can be reused instead of being destroyed and created
+ * again, e.g. when switching between sources of different sizes.
+ */
+
+#include "../util/platform.h"
+#include "graphics-internal.h"
+
+#define DEFAULT_MAX_POOL_BYTES (256ULL * 1024ULL * 1024ULL)
+#define POOL_FLAGS             (GS_DYNAMIC | GS_RENDER_TARGET)
+
+static inline struct gs_texture_pool *get_pool(const char *f)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (!graphics) {
+		blog(LOG_DEBUG, "%s: called while not in a graphics context",
+				f);
+		return NULL;
+	}
+
+	return &graphics->texture_pool;
+}
+
+static inline uint64_t texture_size(uint32_t width, uint32_t height,
+		enum gs_color_format format)
+{
+	return (uint64_t)width * height * gs_get_format_bpp(format) / 8;
+}
+
+void gs_texture_pool_init(struct gs_texture_pool *pool)
+{
+	memset(pool, 0, sizeof(*pool));
+	pool->max_bytes = DEFAULT_MAX_POOL_BYTES;
+}
+
+void gs_texture_pool_free(struct gs_texture_pool *pool)
+{
+	for (size_t i = 0; i < pool->free.num; i++)
+		gs_texture_destroy(pool->free.array[i].tex);
+
+	if (pool->used.num)
+		blog(LOG_DEBUG, "gs_texture_pool_free: %u pooled textures "
+		                "were not released", (unsigned)pool->used.num);
+
+	blog(LOG_DEBUG, "texture pool: %llu hits, %llu misses, "
+	                "%llu evictions",
+	                (unsigned long long)pool->hits,
+	                (unsigned long long)pool->misses,
+	                (unsigned long long)pool->evictions);
+
+	da_free(pool->free);
+	da_free(pool->used);
+	pool->free_bytes = 0;
+	pool->used_bytes = 0;
+}
+
+static void evict_textures(struct gs_texture_pool *pool, uint64_t max_bytes)
+{
+	while (pool->free.num && pool->free_bytes > max_bytes) {
+		struct gs_pool_texture *entry = pool->free.array;
+
+		pool->free_bytes -= entry->size;
+		pool->evictions++;
+
+		gs_texture_destroy(entry->tex);
+		da_erase(pool->free, 0);
+	}
+}
+
+gs_texture_t *gs_texture_pool_acquire(uint32_t width, uint32_t height,
+		enum gs_color_format format, uint32_t flags)
+{
+	struct gs_texture_pool *pool = get_pool("gs_texture_pool_acquire");
+	struct gs_pool_texture entry;
+
+	if (!pool)
+		return NULL;
+	if ((flags & ~POOL_FLAGS) != 0)
+		return gs_texture_create(width, height, format, 1, NULL,
+				flags);
+
+	/* most recently released first, it's the most likely to be hot */
+	for (size_t i = pool->free.num; i > 0; i--) {
+		struct gs_pool_texture *free_entry = pool->free.array + (i - 1);
+
+		if (free_entry->width  == width  &&
+		    free_entry->height == height &&
+		    free_entry->format == format &&
+		    free_entry->flags  == flags) {
+			entry = *free_entry;
+			da_erase(pool->free, i - 1);
+
+			pool->free_bytes -= entry.size;
+			pool->used_bytes += entry.size;
+			pool->hits++;
+
+			da_push_back(pool->used, &entry);
+			return entry.tex;
+		}
+	}
+
+	entry.tex = gs_texture_create(width, height, format, 1, NULL, flags);
+	if (!entry.tex)
+		return NULL;
+
+	entry.width     = width;
+	entry.height    = height;
+	entry.format    = format;
+	entry.flags     = flags;
+	entry.size      = texture_size(width, height, format);
+	entry.last_used = 0;
+
+	pool->used_bytes += entry.size;
+	pool->misses++;
+
+	da_push_back(pool->used, &entry);
+	return entry.tex;
+}
+
+void gs_texture_pool_release(gs_texture_t *tex)
+{
+	struct gs_texture_pool *pool = get_pool("gs_texture_pool_release");
+	struct gs_pool_texture entry;
+	size_t idx = DARRAY_INVALID;
+
+	if (!pool || !tex)
+		return;
+
+	for (size_t i = 0; i < pool->used.num; i++) {
+		if (pool->used.array[i].tex == tex) {
+			idx = i;
+			break;
+		}
+	}
+
+	if (idx == DARRAY_INVALID) {
+		gs_texture_destroy(tex);
+		return;
+	}
+
+	entry = pool->used.array[idx];
+	da_erase(pool->used, idx);
+	pool->used_bytes -= entry.size;
+
+	if (!pool->max_bytes || entry.size > pool->max_bytes) {
+		gs_texture_destroy(tex);
+		return;
+	}
+
+	/* the next user of the texture must not find a buffer still mapped */
+	gs_texture_upload_cancel(tex);
+
+	entry.last_used = os_gettime_ns();
+	da_push_back(pool->free, &entry);
+	pool->free_bytes += entry.size;
+
+	evict_textures(pool, pool->max_bytes);
+}
+
+void gs_texture_pool_set_max_size(uint64_t bytes)
+{
+	struct gs_texture_pool *pool =
+		get_pool("gs_texture_pool_set_max_size");
+
+	if (!pool)
+		return;
+
+	pool->max_bytes = bytes;
+	evict_textures(pool, bytes);
+}
+
+void gs_texture_pool_trim(uint64_t max_idle_ns)
+{
+	struct gs_texture_pool *pool = get_pool("gs_texture_pool_trim");
+	uint64_t t = os_gettime_ns();
+
+	if (!pool)
+		return;
+
+	while (pool->free.num) {
+		struct gs_pool_texture *entry = pool->free.array;
+
+		if (t - entry->last_used < max_idle_ns)
+			break;
+
+		pool->free_bytes -= entry->size;
+		pool->evictions++;
+
+		gs_texture_destroy(entry->tex);
+		da_erase(pool->free, 0);
+	}
+}
+
+void gs_texture_pool_get_stats(struct gs_texture_pool_stats *stats)
+{
+	struct gs_texture_pool *pool = get_pool("gs_texture_pool_get_stats");
+
+	memset(stats, 0, sizeof(*stats));
+	if (!pool)
+		return;
+
+	stats->hits          = pool->hits;
+	stats->misses        = pool->misses;
+	stats->evictions     = pool->evictions;
+	stats->used_textures = pool->used.num;
+	stats->free_textures = pool->free.num;
+	stats->used_bytes    = pool->used_bytes;
+	stats->free_bytes    = pool->free_bytes;
+}
@@ -59,9 +59,16 @@ struct audio_output {
 
 	pthread_t                  thread;
 	os_event_t                 *stop_event;
+	volatile long              thread_priority;
+	volatile bool              precise_timing;
 
 	bool                       initialized;
 
+	uint64_t                   start_time;
+	uint64_t                   prev_time;
+	uint64_t                   audio_time;
+	uint64_t                   samples;
+
 	audio_input_callback_t     input_cb;
 	void                       *input_param;
 	pthread_mutex_t            input_mutex;
@@ -147,7 +154,7 @@ static inline void do_audio_output(struct audio_output *audio,
 	struct audio_mix *mix = &audio->mixes[mix_idx];
 	struct audio_data data;
 
-	pthread_mutex_lock(&audio->input_mutex);
+	os_mutex_lock_named(&audio->input_mutex, "audio_input_mutex");
 
 	for (size_t i = mix->inputs.num; i > 0; i--) {
 		struct audio_input *input = mix->inputs.array+(i-1);
@@ -161,7 +168,7 @@ static inline void do_audio_output(struct audio_output *audio,
 			input->callback(input->param, mix_idx, &data);
 	}
 
-	pthread_mutex_unlock(&audio->input_mutex);
+	os_mutex_unlock_named(&audio->input_mutex, "audio_input_mutex");
 }
 
 static inline void clamp_audio_output(struct audio_output *audio, size_t bytes)
@@ -189,6 +196,8 @@ static inline void clamp_audio_output(struct audio_output *audio, size_t bytes)
 	}
 }
 
+static const char *input_and_output_mix_name = "mix_audio";
+static const char *input_and_output_output_name = "output_audio";
 static void input_and_output(struct audio_output *audio,
 		uint64_t audio_time, uint64_t prev_time)
 {
@@ -206,12 +215,12 @@ static void input_and_output(struct audio_output *audio,
 #endif
 
 	/* get mixers */
-	pthread_mutex_lock(&audio->input_mutex);
+	os_mutex_lock_named(&audio->input_mutex, "audio_input_mutex");
 	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
 		if (audio->mixes[i].inputs.num)
 			active_mixes |= (1 << i);
 	}
-	pthread_mutex_unlock(&audio->input_mutex);
+	os_mutex_unlock_named(&audio->input_mutex, "audio_input_mutex");
 
 	/* clear mix buffers */
 	for (size_t mix_idx = 0; mix_idx < MAX_AUDIO_MIXES; mix_idx++) {
@@ -225,8 +234,10 @@ static void input_and_output(struct audio_output *audio,
 	}
 
 	/* get new audio data */
+	profile_start(input_and_output_mix_name);
 	success = audio->input_cb(audio->input_param, prev_time, audio_time,
 			&new_ts, active_mixes, data);
+	profile_end(input_and_output_mix_name);
 	if (!success)
 		return;
 
@@ -234,45 +245,76 @@ static void input_and_output(struct audio_output *audio,
 	clamp_audio_output(audio, bytes);
 
 	/* output */
+	profile_start(input_and_output_output_name);
 	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++)
 		do_audio_output(audio, i, new_ts, AUDIO_OUTPUT_FRAMES);
+	profile_end(input_and_output_output_name);
+}
+
+static inline void reset_audio_time(struct audio_output *audio,
+		uint64_t start_time)
+{
+	audio->samples    = 0;
+	audio->start_time = start_time;
+	audio->prev_time  = start_time;
+	audio->audio_time = start_time;
+}
+
+/* mixes and outputs every audio segment that starts at or before cur_time */
+static void output_audio_until(struct audio_output *audio, uint64_t cur_time)
+{
+	size_t rate = audio->info.samples_per_sec;
+
+	while (audio->audio_time <= cur_time) {
+		audio->samples += AUDIO_OUTPUT_FRAMES;
+		audio->audio_time = audio->start_time +
+			audio_frames_to_ns(rate, audio->samples);
+
+		input_and_output(audio, audio->audio_time, audio->prev_time);
+		audio->prev_time = audio->audio_time;
+	}
 }
 
 static void *audio_thread(void *param)
 {
 	struct audio_output *audio = param;
 	size_t rate = audio->info.samples_per_sec;
-	uint64_t samples = 0;
-	uint64_t start_time = os_gettime_ns();
-	uint64_t prev_time = start_time;
-	uint64_t audio_time = prev_time;
 	uint32_t audio_wait_time =
 		(uint32_t)(audio_frames_to_ns(rate, AUDIO_OUTPUT_FRAMES) /
 				1000000);
 
+	reset_audio_time(audio, os_gettime_ns());
+
 	os_set_thread_name("audio-io: audio thread");
+	os_set_thread_owner(audio->info.name);
 
 	const char *audio_thread_name =
 		profile_store_name(obs_get_profiler_name_store(),
 				"audio_thread(%s)", audio->info.name);
 
+	long priority = OS_THREAD_PRIORITY_NORMAL;
+	uint64_t spin_ns = 0;
+
 	while (os_event_try(audio->stop_event) == EAGAIN) {
-		uint64_t cur_time;
+		long new_priority = os_atomic_load_long(&audio->thread_priority);
+		if (new_priority != priority) {
+			if (!os_set_thread_priority(
+					(enum os_thread_priority)new_priority))
+				blog(LOG_WARNING, "audio_thread(%s): Failed "
+						"to set thread priority %ld",
+						audio->info.name,
+						new_priority);
+			priority = new_priority;
+		}
 
-		os_sleep_ms(audio_wait_time);
+		/* wake up when the next segment is due instead of polling */
+		if (os_atomic_load_bool(&audio->precise_timing))
+			os_sleepto_ns_precise(audio->audio_time, &spin_ns);
+		else
+			os_sleep_ms(audio_wait_time);
 
 		profile_start(audio_thread_name);
-
-		cur_time = os_gettime_ns();
-		while (audio_time <= cur_time) {
-			samples += AUDIO_OUTPUT_FRAMES;
-			audio_time = start_time +
-				audio_frames_to_ns(rate, samples);
-
-			input_and_output(audio, audio_time, prev_time);
-			prev_time = audio_time;
-		}
-
+		output_audio_until(audio, os_gettime_ns());
 		profile_end(audio_thread_name);
 
 		profile_reenable_thread();
@@ -337,7 +379,7 @@ bool audio_output_connect(audio_t *audio, size_t mi,
 
 	if (!audio || mi >= MAX_AUDIO_MIXES) return false;
 
-	pthread_mutex_lock(&audio->input_mutex);
+	os_mutex_lock_named(&audio->input_mutex, "audio_input_mutex");
 
 	if (audio_get_input_idx(audio, mi, callback, param) == DARRAY_INVALID) {
 		struct audio_mix *mix = &audio->mixes[mi];
@@ -367,7 +409,7 @@ bool audio_output_connect(audio_t *audio, size_t mi,
 			da_push_back(mix->inputs, &input);
 	}
 
-	pthread_mutex_unlock(&audio->input_mutex);
+	os_mutex_unlock_named(&audio->input_mutex, "audio_input_mutex");
 
 	return success;
 }
@@ -377,7 +419,7 @@ void audio_output_disconnect(audio_t *audio, size_t mix_idx,
 {
 	if (!audio || mix_idx >= MAX_AUDIO_MIXES) return;
 
-	pthread_mutex_lock(&audio->input_mutex);
+	os_mutex_lock_named(&audio->input_mutex, "audio_input_mutex");
 
 	size_t idx = audio_get_input_idx(audio, mix_idx, callback, param);
 	if (idx != DARRAY_INVALID) {
@@ -386,7 +428,7 @@ void audio_output_disconnect(audio_t *audio, size_t mix_idx,
 		da_erase(mix->inputs, idx);
 	}
 
-	pthread_mutex_unlock(&audio->input_mutex);
+	os_mutex_unlock_named(&audio->input_mutex, "audio_input_mutex");
 }
 
 static inline bool valid_audio_params(const struct audio_output_info *info)
@@ -424,10 +466,15 @@ int audio_output_open(audio_t **audio, struct audio_output_info *info)
 		goto fail;
 	if (os_event_init(&out->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
 		goto fail;
-	if (pthread_create(&out->thread, NULL, audio_thread, out) != 0)
-		goto fail;
 
-	out->initialized = true;
+	/* offline outputs are driven by audio_output_tick instead */
+	if (!info->offline) {
+		if (pthread_create(&out->thread, NULL, audio_thread, out) != 0)
+			goto fail;
+
+		out->initialized = true;
+	}
+
 	*audio = out;
 	return AUDIO_OUTPUT_SUCCESS;
 
@@ -461,6 +508,33 @@ void audio_output_close(audio_t *audio)
 	bfree(audio);
 }
 
+static const char *audio_output_tick_name = "audio_output_tick";
+void audio_output_tick(audio_t *audio, uint64_t cur_time)
+{
+	if (!audio || !audio->info.offline)
+		return;
+
+	if (!audio->start_time)
+		reset_audio_time(audio, cur_time);
+
+	profile_start(audio_output_tick_name);
+	output_audio_until(audio, cur_time);
+	profile_end(audio_output_tick_name);
+}
+
+void audio_output_set_thread_priority(audio_t *audio,
+		enum os_thread_priority priority)
+{
+	if (audio)
+		os_atomic_set_long(&audio->thread_priority, (long)priority);
+}
+
+void audio_output_set_precise_timing(audio_t *audio, bool precise)
+{
+	if (audio)
+		os_atomic_set_bool(&audio->precise_timing, precise);
+}
+
 const struct audio_output_info *audio_output_get_info(const audio_t *audio)
 {
 	return audio ? &audio->info : NULL;
@@ -20,6 +20,7 @@
 #include "media-io-defs.h"
 #include "../util/c99defs.h"
 #include "../util/util_uint128.h"
+#include "../util/threading.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -98,6 +99,10 @@ struct audio_output_info {
 
 	audio_input_callback_t input_callback;
 	void                   *input_param;
+
+	/* no audio thread is created; audio is mixed and output from
+	 * audio_output_tick instead of on a real-time clock */
+	bool                   offline;
 };
 
 struct audio_convert_info {
@@ -209,6 +214,18 @@ static inline uint64_t ns_to_audio_frames(size_t sample_rate,
 EXPORT int audio_output_open(audio_t **audio, struct audio_output_info *info);
 EXPORT void audio_output_close(audio_t *audio);
 
+/** Mixes and outputs audio up to cur_time, for offline outputs only */
+EXPORT void audio_output_tick(audio_t *audio, uint64_t cur_time);
+
+/** Sets the scheduling priority of the audio thread (and the encoders it
+ * drives), applied on its next wake-up */
+EXPORT void audio_output_set_thread_priority(audio_t *audio,
+		enum os_thread_priority priority);
+
+/** Wakes the audio thread exactly when each segment is due (using
+ * os_sleepto_ns_precise) instead of polling every segment length */
+EXPORT void audio_output_set_precise_timing(audio_t *audio, bool precise);
+
 typedef void (*audio_output_callback_t)(void *param, size_t mix_idx,
 		struct audio_data *data);
 
@@ -97,7 +97,7 @@ void compress_uyvx_to_i420(
 	uint8_t  *lum_plane   = output[0];
 	uint8_t  *u_plane     = output[1];
 	uint8_t  *v_plane     = output[2];
-	uint32_t width        = min_uint32(in_linesize, out_linesize[0]);
+	uint32_t width        = min_uint32(in_linesize/4, out_linesize[0]);
 	uint32_t y;
 
 	__m128i lum_mask = _mm_set1_epi32(0x0000FF00);
@@ -134,7 +134,7 @@ void compress_uyvx_to_nv12(
 {
 	uint8_t *lum_plane    = output[0];
 	uint8_t *chroma_plane = output[1];
-	uint32_t width        = min_uint32(in_linesize, out_linesize[0]);
+	uint32_t width        = min_uint32(in_linesize/4, out_linesize[0]);
 	uint32_t y;
 
 	__m128i lum_mask = _mm_set1_epi32(0x0000FF00);
@@ -171,7 +171,7 @@ void convert_uyvx_to_i444(
 	uint8_t  *lum_plane   = output[0];
 	uint8_t  *u_plane     = output[1];
 	uint8_t  *v_plane     = output[2];
-	uint32_t width        = min_uint32(in_linesize, out_linesize[0]);
+	uint32_t width        = min_uint32(in_linesize/4, out_linesize[0]);
 	uint32_t y;
 
 	__m128i lum_mask = _mm_set1_epi32(0x0000FF00);
@@ -181,12 +181,18 @@ void convert_uyvx_to_i444(
 	for (y = start_y; y < end_y; y += 2) {
 		uint32_t y_pos        = y      * in_linesize;
 		uint32_t lum_y_pos    = y      * out_linesize[0];
+		uint32_t u_y_pos      = y      * out_linesize[1];
+		uint32_t v_y_pos      = y      * out_linesize[2];
 		uint32_t x;
 
 		for (x = 0; x < width; x += 4) {
 			const uint8_t *img = input + y_pos + x*4;
 			uint32_t lum_pos0  = lum_y_pos + x;
 			uint32_t lum_pos1  = lum_pos0 + out_linesize[0];
+			uint32_t u_pos0    = u_y_pos + x;
+			uint32_t u_pos1    = u_pos0 + out_linesize[1];
+			uint32_t v_pos0    = v_y_pos + x;
+			uint32_t v_pos1    = v_pos0 + out_linesize[2];
 
 			__m128i line1 = _mm_load_si128((const __m128i*)img);
 			__m128i line2 = _mm_load_si128(
@@ -194,9 +200,9 @@ void convert_uyvx_to_i444(
 
 			pack_shift(lum_plane, lum_pos0, lum_pos1,
 					line1, line2, lum_mask, 1);
-			pack_val(u_plane, lum_pos0, lum_pos1,
+			pack_val(u_plane, u_pos0, u_pos1,
 					line1, line2, u_mask);
-			pack_shift(v_plane, lum_pos0, lum_pos1,
+			pack_shift(v_plane, v_pos0, v_pos1,
 					line1, line2, v_mask, 2);
 		}
 	}
@@ -208,7 +214,7 @@ void decompress_420(
 		uint8_t *output, uint32_t out_linesize)
 {
 	uint32_t start_y_d2 = start_y/2;
-	uint32_t width_d2   = in_linesize[0]/2;
+	uint32_t width_d2   = min_uint32(in_linesize[0], out_linesize/4)/2;
 	uint32_t height_d2  = end_y/2;
 	uint32_t y;
 
@@ -243,7 +249,7 @@ void decompress_nv12(
 		uint8_t *output, uint32_t out_linesize)
 {
 	uint32_t start_y_d2 = start_y/2;
-	uint32_t width_d2   = min_uint32(in_linesize[0], out_linesize)/2;
+	uint32_t width_d2   = min_uint32(in_linesize[0], out_linesize/4)/2;
 	uint32_t height_d2  = end_y/2;
 	uint32_t y;
 
@@ -277,7 +283,7 @@ void decompress_422(
 		uint8_t *output, uint32_t out_linesize,
 		bool leading_lum)
 {
-	uint32_t width_d2 = min_uint32(in_linesize, out_linesize)/2;
+	uint32_t width_d2 = min_uint32(in_linesize/2, out_linesize/4)/2;
 	uint32_t y;
 
 	register const uint32_t *input32;
@@ -58,7 +58,7 @@ void video_frame_init(struct video_frame *frame, enum video_format format,
 		size = width * height;
 		ALIGN_SIZE(size, alignment);
 		offsets[0] = size;
-		size += (width/2) * (height/2) * 2;
+		size += width * (height/2);
 		ALIGN_SIZE(size, alignment);
 		frame->data[0] = bmalloc(size);
 		frame->data[1] = (uint8_t*)frame->data[0] + offsets[0];
@@ -20,6 +20,7 @@
 #include "../util/bmem.h"
 #include "../util/platform.h"
 #include "../util/profiler.h"
+#include "../util/metrics.h"
 #include "../util/threading.h"
 #include "../util/darray.h"
 
@@ -37,6 +38,15 @@ struct cached_frame_info {
 	struct video_data frame;
 	int skipped;
 	int count;
+
+	/* set when the frame references data owned by the caller rather than
+	 * the cache's own buffer */
+	uint8_t *ref_data[MAX_AV_PLANES];
+	uint32_t ref_linesize[MAX_AV_PLANES];
+	void (*release)(void *param);
+	void *release_param;
+
+	struct video_latency_stamps latency;
 };
 
 struct video_input {
@@ -62,8 +72,10 @@ struct video_output {
 	pthread_t                  thread;
 	pthread_mutex_t            data_mutex;
 	bool                       stop;
+	volatile long              thread_priority;
 
 	os_sem_t                   *update_semaphore;
+	os_event_t                 *available_event;
 	uint64_t                   frame_time;
 	volatile long              skipped_frames;
 	volatile long              total_frames;
@@ -78,8 +90,15 @@ struct video_output {
 	size_t                     last_added;
 	struct cached_frame_info   cache[MAX_CACHE_SIZE];
 
+	/* stamps of the frame being passed to the inputs, only touched by the
+	 * video thread */
+	struct video_latency_stamps cur_latency;
+
 	volatile bool              raw_active;
 	volatile long              gpu_refs;
+
+	metric_t                   *cached_frames_metric;
+	metric_t                   *skipped_frames_metric;
 };
 
 /* ------------------------------------------------------------------------- */
@@ -115,57 +134,89 @@ static inline bool scale_video_output(struct video_input *input,
 	return success;
 }
 
+static inline void get_cached_frame_data(struct cached_frame_info *frame_info,
+		struct video_data *frame)
+{
+	*frame = frame_info->frame;
+
+	if (frame_info->release) {
+		memcpy(frame->data, frame_info->ref_data,
+				sizeof(frame->data));
+		memcpy(frame->linesize, frame_info->ref_linesize,
+				sizeof(frame->linesize));
+	}
+}
+
 static inline bool video_output_cur_frame(struct video_output *video)
 {
 	struct cached_frame_info *frame_info;
+	struct video_data cached_frame;
+	void (*release)(void *param) = NULL;
+	void *release_param = NULL;
 	bool complete;
 	bool skipped;
 
 	/* -------------------------------- */
 
-	pthread_mutex_lock(&video->data_mutex);
+	os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
 
 	frame_info = &video->cache[video->first_added];
+	get_cached_frame_data(frame_info, &cached_frame);
+	video->cur_latency = frame_info->latency;
 
-	pthread_mutex_unlock(&video->data_mutex);
+	os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
 
 	/* -------------------------------- */
 
-	pthread_mutex_lock(&video->input_mutex);
+	os_mutex_lock_named(&video->input_mutex, "video_input_mutex");
 
 	for (size_t i = 0; i < video->inputs.num; i++) {
 		struct video_input *input = video->inputs.array+i;
-		struct video_data frame = frame_info->frame;
+		struct video_data frame = cached_frame;
 
 		if (scale_video_output(input, &frame))
 			input->callback(input->param, &frame);
 	}
 
-	pthread_mutex_unlock(&video->input_mutex);
+	os_mutex_unlock_named(&video->input_mutex, "video_input_mutex");
 
 	/* -------------------------------- */
 
-	pthread_mutex_lock(&video->data_mutex);
+	os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
 
 	frame_info->frame.timestamp += video->frame_time;
 	complete = --frame_info->count == 0;
 	skipped = frame_info->skipped > 0;
 
 	if (complete) {
+		release = frame_info->release;
+		release_param = frame_info->release_param;
+		frame_info->release = NULL;
+
 		if (++video->first_added == video->info.cache_size)
 			video->first_added = 0;
 
 		if (++video->available_frames == video->info.cache_size)
 			video->last_added = video->first_added;
+
+		if (video->info.offline)
+			os_event_signal(video->available_event);
 	} else if (skipped) {
 		--frame_info->skipped;
 		os_atomic_inc_long(&video->skipped_frames);
+		metric_inc(video->skipped_frames_metric);
 	}
 
-	pthread_mutex_unlock(&video->data_mutex);
+	metric_set(video->cached_frames_metric, (long long)
+			(video->info.cache_size - video->available_frames));
+
+	os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
 
 	/* -------------------------------- */
 
+	if (release)
+		release(release_param);
+
 	return complete;
 }
 
@@ -174,15 +225,31 @@ static void *video_thread(void *param)
 	struct video_output *video = param;
 
 	os_set_thread_name("video-io: video thread");
+	os_set_thread_owner(video->info.name);
 
 	const char *video_thread_name =
 		profile_store_name(obs_get_profiler_name_store(),
 				"video_thread(%s)", video->info.name);
 
+	long priority = OS_THREAD_PRIORITY_NORMAL;
+
 	while (os_sem_wait(video->update_semaphore) == 0) {
+		long new_priority;
+
 		if (video->stop)
 			break;
 
+		new_priority = os_atomic_load_long(&video->thread_priority);
+		if (new_priority != priority) {
+			if (!os_set_thread_priority(
+					(enum os_thread_priority)new_priority))
+				blog(LOG_WARNING, "video_thread(%s): Failed "
+						"to set thread priority %ld",
+						video->info.name,
+						new_priority);
+			priority = new_priority;
+		}
+
 		profile_start(video_thread_name);
 		while (!video->stop && !video_output_cur_frame(video)) {
 			os_atomic_inc_long(&video->total_frames);
@@ -248,11 +315,22 @@ int video_output_open(video_t **video, struct video_output_info *info)
 		goto fail;
 	if (os_sem_init(&out->update_semaphore, 0) != 0)
 		goto fail;
+	if (os_event_init(&out->available_event, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail;
 	if (pthread_create(&out->thread, NULL, video_thread, out) != 0)
 		goto fail;
 
 	init_cache(out);
 
+	out->cached_frames_metric = metric_create(METRIC_GAUGE,
+			"obs_video_output_cached_frames",
+			"Frames waiting to be sent to video outputs",
+			"video", info->name);
+	out->skipped_frames_metric = metric_create(METRIC_COUNTER,
+			"obs_video_output_skipped_frames_total",
+			"Frames skipped because outputs fell behind",
+			"video", info->name);
+
 	out->initialized = true;
 	*video = out;
 	return VIDEO_OUTPUT_SUCCESS;
@@ -273,10 +351,19 @@ void video_output_close(video_t *video)
 		video_input_free(&video->inputs.array[i]);
 	da_free(video->inputs);
 
-	for (size_t i = 0; i < video->info.cache_size; i++)
-		video_frame_free((struct video_frame*)&video->cache[i]);
+	for (size_t i = 0; i < video->info.cache_size; i++) {
+		struct cached_frame_info *cfi = &video->cache[i];
+
+		if (cfi->release)
+			cfi->release(cfi->release_param);
+		video_frame_free((struct video_frame*)cfi);
+	}
+
+	metric_destroy(video->cached_frames_metric);
+	metric_destroy(video->skipped_frames_metric);
 
 	os_sem_destroy(video->update_semaphore);
+	os_event_destroy(video->available_event);
 	pthread_mutex_destroy(&video->data_mutex);
 	pthread_mutex_destroy(&video->input_mutex);
 	bfree(video);
@@ -349,7 +436,7 @@ bool video_output_connect(video_t *video,
 	if (!video || !callback)
 		return false;
 
-	pthread_mutex_lock(&video->input_mutex);
+	os_mutex_lock_named(&video->input_mutex, "video_input_mutex");
 
 	if (video_get_input_idx(video, callback, param) == DARRAY_INVALID) {
 		struct video_input input;
@@ -383,7 +470,7 @@ bool video_output_connect(video_t *video,
 		}
 	}
 
-	pthread_mutex_unlock(&video->input_mutex);
+	os_mutex_unlock_named(&video->input_mutex, "video_input_mutex");
 
 	return success;
 }
@@ -413,7 +500,7 @@ void video_output_disconnect(video_t *video,
 	if (!video || !callback)
 		return;
 
-	pthread_mutex_lock(&video->input_mutex);
+	os_mutex_lock_named(&video->input_mutex, "video_input_mutex");
 
 	size_t idx = video_get_input_idx(video, callback, param);
 	if (idx != DARRAY_INVALID) {
@@ -428,7 +515,7 @@ void video_output_disconnect(video_t *video,
 		}
 	}
 
-	pthread_mutex_unlock(&video->input_mutex);
+	os_mutex_unlock_named(&video->input_mutex, "video_input_mutex");
 }
 
 bool video_output_active(const video_t *video)
@@ -450,7 +537,16 @@ bool video_output_lock_frame(video_t *video, struct video_frame *frame,
 
 	if (!video) return false;
 
-	pthread_mutex_lock(&video->data_mutex);
+	os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
+
+	/* offline outputs wait for the cache to drain rather than skipping
+	 * frames, so that the outputs see every frame */
+	while (video->info.offline && video->available_frames == 0 &&
+	       !video->stop) {
+		os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
+		os_event_wait(video->available_event);
+		os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
+	}
 
 	if (video->available_frames == 0) {
 		video->cache[video->last_added].count += count;
@@ -465,15 +561,17 @@ bool video_output_lock_frame(video_t *video, struct video_frame *frame,
 
 		cfi = &video->cache[video->last_added];
 		cfi->frame.timestamp = timestamp;
+		memset(&cfi->latency, 0, sizeof(cfi->latency));
 		cfi->count = count;
 		cfi->skipped = 0;
+		cfi->release = NULL;
 
 		memcpy(frame, &cfi->frame, sizeof(*frame));
 
 		locked = true;
 	}
 
-	pthread_mutex_unlock(&video->data_mutex);
+	os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
 
 	return locked;
 }
@@ -482,12 +580,55 @@ void video_output_unlock_frame(video_t *video)
 {
 	if (!video) return;
 
-	pthread_mutex_lock(&video->data_mutex);
+	os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
 
 	video->available_frames--;
+	metric_set(video->cached_frames_metric, (long long)
+			(video->info.cache_size - video->available_frames));
 	os_sem_post(video->update_semaphore);
 
-	pthread_mutex_unlock(&video->data_mutex);
+	os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
+}
+
+/* makes the currently locked frame reference the caller's data instead of
+ * being copied in to the cache, must be called between
+ * video_output_lock_frame and video_output_unlock_frame */
+void video_output_set_frame_ref(video_t *video, const struct video_data *frame,
+		void (*release)(void *param), void *param)
+{
+	struct cached_frame_info *cfi;
+
+	if (!video || !frame || !release) return;
+
+	os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
+
+	cfi = &video->cache[video->last_added];
+	memcpy(cfi->ref_data, frame->data, sizeof(cfi->ref_data));
+	memcpy(cfi->ref_linesize, frame->linesize, sizeof(cfi->ref_linesize));
+	cfi->release = release;
+	cfi->release_param = param;
+
+	os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
+}
+
+/* sets the latency stamps of the currently locked frame, must be called
+ * between video_output_lock_frame and video_output_unlock_frame */
+void video_output_set_frame_latency(video_t *video,
+		const struct video_latency_stamps *latency)
+{
+	if (!video || !latency) return;
+
+	os_mutex_lock_named(&video->data_mutex, "video_data_mutex");
+	video->cache[video->last_added].latency = *latency;
+	os_mutex_unlock_named(&video->data_mutex, "video_data_mutex");
+}
+
+void video_output_get_frame_latency(const video_t *video,
+		struct video_latency_stamps *latency)
+{
+	if (!video || !latency) return;
+
+	*latency = video->cur_latency;
 }
 
 uint64_t video_output_get_frame_time(const video_t *video)
@@ -506,6 +647,7 @@ void video_output_stop(video_t *video)
 		video->initialized = false;
 		video->stop = true;
 		os_sem_post(video->update_semaphore);
+		os_event_signal(video->available_event);
 		pthread_join(video->thread, &thread_ret);
 	}
 }
@@ -551,6 +693,13 @@ uint32_t video_output_get_total_frames(const video_t *video)
 	return (uint32_t)os_atomic_load_long(&video->total_frames);
 }
 
+void video_output_set_thread_priority(video_t *video,
+		enum os_thread_priority priority)
+{
+	if (video)
+		os_atomic_set_long(&video->thread_priority, (long)priority);
+}
+
 /* Note: These four functions below are a very slight bit of a hack.  If the
  * texture encoder thread is active while the raw encoder thread is active, the
  * total frame count will just be doubled while they're both active.  Which is
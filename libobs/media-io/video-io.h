@@ -18,6 +18,7 @@
 #pragma once
 
 #include "media-io-defs.h"
+#include "../util/threading.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -64,6 +65,21 @@ enum video_range_type {
 	VIDEO_RANGE_FULL
 };
 
+/**
+ * System times (os_gettime_ns) at which a video frame passed through each
+ * stage of the pipeline, used to measure end-to-end latency.  Stages that
+ * weren't reached or recorded are 0.
+ */
+struct video_latency_stamps {
+	uint64_t          capture;          /**< Oldest new async source frame */
+	uint64_t          render;           /**< Start of composition */
+	uint64_t          convert;          /**< Converted/downloaded */
+	uint64_t          encode_submit;    /**< Submitted to the encoder */
+	uint64_t          encode_complete;  /**< Packet returned by encoder */
+	uint64_t          interleave;       /**< Packet handed to the output */
+	uint64_t          send;             /**< Packet written by the output */
+};
+
 struct video_data {
 	uint8_t           *data[MAX_AV_PLANES];
 	uint32_t          linesize[MAX_AV_PLANES];
@@ -82,6 +98,10 @@ struct video_output_info {
 
 	enum video_colorspace colorspace;
 	enum video_range_type range;
+
+	/* when the cache is full, video_output_lock_frame waits for a frame
+	 * to be output instead of skipping */
+	bool              offline;
 };
 
 static inline bool format_is_yuv(enum video_format format)
@@ -190,6 +210,26 @@ EXPORT const struct video_output_info *video_output_get_info(
 EXPORT bool video_output_lock_frame(video_t *video, struct video_frame *frame,
 		int count, uint64_t timestamp);
 EXPORT void video_output_unlock_frame(video_t *video);
+EXPORT void video_output_set_frame_latency(video_t *video,
+		const struct video_latency_stamps *latency);
+
+/**
+ * Gets the latency stamps of the frame that is being passed to the raw video
+ * callbacks.  Only valid from within a callback.
+ */
+EXPORT void video_output_get_frame_latency(const video_t *video,
+		struct video_latency_stamps *latency);
+
+/**
+ * Makes the currently locked frame reference the given data instead of the
+ * cache's own buffer, so the data doesn't have to be copied.  'release' is
+ * called (possibly from the video thread) once every output has received
+ * the frame, or when the video output is closed.  Must be called between
+ * video_output_lock_frame and video_output_unlock_frame.
+ */
+EXPORT void video_output_set_frame_ref(video_t *video,
+		const struct video_data *frame,
+		void (*release)(void *param), void *param);
 EXPORT uint64_t video_output_get_frame_time(const video_t *video);
 EXPORT void video_output_stop(video_t *video);
 EXPORT bool video_output_stopped(video_t *video);
@@ -202,6 +242,11 @@ EXPORT double video_output_get_frame_rate(const video_t *video);
 EXPORT uint32_t video_output_get_skipped_frames(const video_t *video);
 EXPORT uint32_t video_output_get_total_frames(const video_t *video);
 
+/** Sets the scheduling priority of the video thread (and the raw encoders it
+ * drives), applied on its next frame */
+EXPORT void video_output_set_thread_priority(video_t *video,
+		enum os_thread_priority priority);
+
 extern void video_output_inc_texture_encoders(video_t *video);
 extern void video_output_dec_texture_encoders(video_t *video);
 extern void video_output_inc_texture_frames(video_t *video);
@@ -255,6 +255,8 @@ static void add_audio_buffering(struct obs_core_audio *audio,
 		blog(LOG_WARNING, "Max audio buffering reached!");
 	}
 
+	metric_set(audio->buffering_metric, audio->total_buffering_ticks);
+
 	ms = ticks * AUDIO_OUTPUT_FRAMES * 1000 / sample_rate;
 	total_ms = audio->total_buffering_ticks * AUDIO_OUTPUT_FRAMES * 1000 /
 		sample_rate;
@@ -411,7 +413,7 @@ bool audio_callback(void *param,
 		}
 	}
 
-	pthread_mutex_lock(&data->audio_sources_mutex);
+	os_mutex_lock_named(&data->audio_sources_mutex, "audio_sources_mutex");
 
 	source = data->first_audio_source;
 	while (source) {
@@ -419,7 +421,8 @@ bool audio_callback(void *param,
 		source = (struct obs_source*)source->next_audio_source;
 	}
 
-	pthread_mutex_unlock(&data->audio_sources_mutex);
+	os_mutex_unlock_named(&data->audio_sources_mutex,
+			"audio_sources_mutex");
 
 	/* ------------------------------------------------ */
 	/* render audio data */
@@ -431,9 +434,10 @@ bool audio_callback(void *param,
 
 	/* ------------------------------------------------ */
 	/* get minimum audio timestamp */
-	pthread_mutex_lock(&data->audio_sources_mutex);
+	os_mutex_lock_named(&data->audio_sources_mutex, "audio_sources_mutex");
 	const char *buffering_name = calc_min_ts(data, sample_rate, &min_ts);
-	pthread_mutex_unlock(&data->audio_sources_mutex);
+	os_mutex_unlock_named(&data->audio_sources_mutex,
+			"audio_sources_mutex");
 
 	/* ------------------------------------------------ */
 	/* if a source has gone backward in time, buffer */
@@ -462,7 +466,7 @@ bool audio_callback(void *param,
 
 	/* ------------------------------------------------ */
 	/* discard audio */
-	pthread_mutex_lock(&data->audio_sources_mutex);
+	os_mutex_lock_named(&data->audio_sources_mutex, "audio_sources_mutex");
 
 	source = data->first_audio_source;
 	while (source) {
@@ -473,7 +477,8 @@ bool audio_callback(void *param,
 		source = (struct obs_source*)source->next_audio_source;
 	}
 
-	pthread_mutex_unlock(&data->audio_sources_mutex);
+	os_mutex_unlock_named(&data->audio_sources_mutex,
+			"audio_sources_mutex");
 
 	/* ------------------------------------------------ */
 	/* release audio sources */
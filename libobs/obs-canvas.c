@@ -0,0 +1,181 @@
+#include <inttypes.h>
+#include "obs.h"
+#include "obs-internal.h"
+
+static bool obs_canvas_init_textures(struct obs_canvas *canvas)
+{
+	canvas->render_texture = gs_texture_create(canvas->width,
+			canvas->height, GS_RGBA, 1, NULL, GS_RENDER_TARGET);
+	if (!canvas->render_texture)
+		return false;
+
+	canvas->output_texture = gs_texture_create(canvas->width,
+			canvas->height, GS_RGBA, 1, NULL, GS_RENDER_TARGET);
+	if (!canvas->output_texture)
+		return false;
+
+	for (size_t i = 0; i < NUM_TEXTURES; i++) {
+		canvas->copy_surfaces[i] = gs_stagesurface_create(
+				canvas->width, canvas->height, GS_RGBA);
+		if (!canvas->copy_surfaces[i])
+			return false;
+	}
+
+	return true;
+}
+
+static bool obs_canvas_init(struct obs_canvas *canvas)
+{
+	struct obs_core_video *video = &obs->video;
+	struct video_output_info vi;
+
+	if (!obs_view_init(&canvas->view))
+		return false;
+
+	if (!video->video) {
+		blog(LOG_WARNING, "obs_canvas_create: Video has not been "
+		                  "initialized");
+		return false;
+	}
+
+	vi = *video_output_get_info(video->video);
+	vi.name     = canvas->name;
+	vi.width    = canvas->width;
+	vi.height   = canvas->height;
+	vi.fps_den *= canvas->fps_divisor;
+
+	if (video_output_open(&canvas->video, &vi) != VIDEO_OUTPUT_SUCCESS) {
+		blog(LOG_WARNING, "obs_canvas_create: Could not open video "
+		                  "output for canvas '%s'", canvas->name);
+		return false;
+	}
+
+	video_output_set_thread_priority(canvas->video,
+			(enum os_thread_priority)obs->thread_priority);
+
+	obs_enter_graphics();
+	bool success = obs_canvas_init_textures(canvas);
+	obs_leave_graphics();
+
+	return success;
+}
+
+obs_canvas_t *obs_canvas_create(const char *name, uint32_t width,
+		uint32_t height, uint32_t fps_divisor)
+{
+	struct obs_canvas *canvas;
+
+	if (!obs) return NULL;
+
+	if (!width || !height) {
+		blog(LOG_WARNING, "obs_canvas_create: Invalid canvas size "
+		                  "%"PRIu32"x%"PRIu32, width, height);
+		return NULL;
+	}
+
+	canvas = bzalloc(sizeof(struct obs_canvas));
+	canvas->name        = bstrdup(name ? name : "canvas");
+	canvas->width       = width;
+	canvas->height      = height;
+	canvas->fps_divisor = fps_divisor ? fps_divisor : 1;
+
+	if (!obs_canvas_init(canvas)) {
+		obs_canvas_free(canvas);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+	canvas->prev_next      = &obs->data.first_canvas;
+	canvas->next           = obs->data.first_canvas;
+	obs->data.first_canvas = canvas;
+	if (canvas->next)
+		canvas->next->prev_next = &canvas->next;
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+
+	blog(LOG_INFO, "canvas '%s' created (%"PRIu32"x%"PRIu32", "
+	               "fps divisor %"PRIu32")", canvas->name,
+	               width, height, canvas->fps_divisor);
+
+	return canvas;
+}
+
+void obs_canvas_free(struct obs_canvas *canvas)
+{
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+	if (canvas->prev_next)
+		*canvas->prev_next = canvas->next;
+	if (canvas->next)
+		canvas->next->prev_next = canvas->prev_next;
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+
+	video_output_close(canvas->video);
+
+	obs_enter_graphics();
+	gs_texture_destroy(canvas->render_texture);
+	gs_texture_destroy(canvas->output_texture);
+	for (size_t i = 0; i < NUM_TEXTURES; i++)
+		gs_stagesurface_destroy(canvas->copy_surfaces[i]);
+	obs_leave_graphics();
+
+	obs_view_free(&canvas->view);
+
+	blog(LOG_DEBUG, "canvas '%s' destroyed", canvas->name);
+
+	bfree(canvas->name);
+	bfree(canvas);
+}
+
+bool obs_canvas_destroy(obs_canvas_t *canvas)
+{
+	if (!canvas)
+		return false;
+
+	/* closing the video output would pull it out from under whatever is
+	 * still connected to it */
+	if (video_output_active(canvas->video)) {
+		blog(LOG_WARNING, "obs_canvas_destroy: canvas '%s' still has "
+		                  "active outputs, not destroying it",
+		                  canvas->name);
+		return false;
+	}
+
+	obs_canvas_free(canvas);
+	return true;
+}
+
+const char *obs_canvas_get_name(const obs_canvas_t *canvas)
+{
+	return canvas ? canvas->name : NULL;
+}
+
+void obs_canvas_set_source(obs_canvas_t *canvas, uint32_t channel,
+		obs_source_t *source)
+{
+	if (canvas)
+		obs_view_set_source(&canvas->view, channel, source);
+}
+
+obs_source_t *obs_canvas_get_source(obs_canvas_t *canvas, uint32_t channel)
+{
+	return canvas ? obs_view_get_source(&canvas->view, channel) : NULL;
+}
+
+obs_view_t *obs_canvas_get_view(obs_canvas_t *canvas)
+{
+	return canvas ? &canvas->view : NULL;
+}
+
+video_t *obs_canvas_get_video(const obs_canvas_t *canvas)
+{
+	return canvas ? canvas->video : NULL;
+}
+
+uint32_t obs_canvas_get_width(const obs_canvas_t *canvas)
+{
+	return canvas ? canvas->width : 0;
+}
+
+uint32_t obs_canvas_get_height(const obs_canvas_t *canvas)
+{
+	return canvas ? canvas->height : 0;
+}
@@ -26,13 +26,16 @@
 #include "graphics/quat.h"
 #include "obs-data.h"
 
-#include <jansson.h>
+#include <errno.h>
+#include <math.h>
 
 struct obs_data_item {
 	volatile long        ref;
 	struct obs_data      *parent;
+	struct obs_data_item *prev;
 	struct obs_data_item *next;
 	enum obs_data_type   type;
+	uint32_t             name_hash;
 	size_t               name_len;
 	size_t               data_len;
 	size_t               data_size;
@@ -46,6 +49,12 @@ struct obs_data {
 	volatile long        ref;
 	char                 *json;
 	struct obs_data_item *first_item;
+	size_t               num_items;
+
+	/* name lookup index, only created once the object has enough items
+	 * for a linear scan to become expensive */
+	struct obs_data_item **hash_table;
+	size_t               hash_size;
 };
 
 struct obs_data_array {
@@ -261,6 +270,127 @@ static inline void item_autoselect_data_addref(struct obs_data_item *item)
 	}
 }
 
+/* ------------------------------------------------------------------------- */
+/* Item name index
+ *
+ * Open addressed table with linear probing, sized to a power of two and
+ * kept at most half full.  The linked item list stays the source of truth
+ * for iteration and serialization order; the table only maps names to
+ * items. */
+
+#define HASH_MIN_ITEMS 16
+
+static inline uint32_t hash_item_name(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (uint8_t)*(name++);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static inline size_t hash_find_slot(struct obs_data *data, const char *name,
+		uint32_t hash)
+{
+	size_t mask = data->hash_size - 1;
+	size_t idx = hash & mask;
+
+	for (;; idx = (idx + 1) & mask) {
+		struct obs_data_item *item = data->hash_table[idx];
+
+		if (!item)
+			return idx;
+		if (item->name_hash == hash &&
+		    strcmp(get_item_name(item), name) == 0)
+			return idx;
+	}
+}
+
+static inline size_t hash_find_item_slot(struct obs_data *data,
+		struct obs_data_item *item)
+{
+	size_t mask = data->hash_size - 1;
+	size_t idx = item->name_hash & mask;
+
+	while (data->hash_table[idx] != item)
+		idx = (idx + 1) & mask;
+	return idx;
+}
+
+static void hash_rebuild(struct obs_data *data, size_t size)
+{
+	struct obs_data_item *item = data->first_item;
+
+	bfree(data->hash_table);
+	data->hash_table = bzalloc(sizeof(struct obs_data_item*) * size);
+	data->hash_size  = size;
+
+	for (; item; item = item->next) {
+		size_t idx = hash_find_slot(data, get_item_name(item),
+				item->name_hash);
+		data->hash_table[idx] = item;
+	}
+}
+
+static void hash_insert(struct obs_data *data, struct obs_data_item *item)
+{
+	size_t idx;
+
+	if (!data->hash_table) {
+		if (data->num_items >= HASH_MIN_ITEMS)
+			hash_rebuild(data, HASH_MIN_ITEMS * 4);
+		return;
+	}
+
+	if (data->num_items * 2 > data->hash_size) {
+		hash_rebuild(data, data->hash_size * 2);
+		return;
+	}
+
+	idx = hash_find_slot(data, get_item_name(item), item->name_hash);
+	data->hash_table[idx] = item;
+}
+
+static void hash_remove(struct obs_data *data, struct obs_data_item *item)
+{
+	size_t mask, idx, next;
+
+	if (!data->hash_table)
+		return;
+
+	mask = data->hash_size - 1;
+	idx  = hash_find_item_slot(data, item);
+	next = idx;
+
+	/* shift any following entries of the probe chain back so that no
+	 * tombstones are needed */
+	for (;;) {
+		struct obs_data_item *cur;
+		size_t home;
+
+		data->hash_table[idx] = NULL;
+
+		for (;;) {
+			next = (next + 1) & mask;
+			cur = data->hash_table[next];
+			if (!cur)
+				return;
+
+			home = cur->name_hash & mask;
+			if (((next - home) & mask) >= ((next - idx) & mask))
+				break;
+		}
+
+		data->hash_table[idx] = cur;
+		idx = next;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
 static struct obs_data_item *obs_data_item_create(const char *name,
 		const void *data, size_t size, enum obs_data_type type,
 		bool default_data, bool autoselect_data)
@@ -296,49 +426,82 @@ static struct obs_data_item *obs_data_item_create(const char *name,
 	strcpy(get_item_name(item), name);
 	memcpy(get_item_data(item), data, size);
 
+	item->name_hash = hash_item_name(name);
+
 	item_data_addref(item);
 	return item;
 }
 
-static struct obs_data_item **get_item_prev_next(struct obs_data *data,
-		struct obs_data_item *current)
+static inline bool obs_data_item_attached(struct obs_data_item *item)
 {
-	if (!current || !data)
-		return NULL;
+	return item->parent &&
+		(item->prev || item->parent->first_item == item);
+}
 
-	struct obs_data_item **prev_next = &data->first_item;
-	struct obs_data_item *item       = data->first_item;
+/* links the item into the object after prev, or as the first item if prev
+ * is NULL */
+static void obs_data_item_attach(struct obs_data *data,
+		struct obs_data_item *prev, struct obs_data_item *item)
+{
+	struct obs_data_item *next = prev ? prev->next : data->first_item;
 
-	while (item) {
-		if (item == current)
-			return prev_next;
+	item->parent = data;
+	item->prev   = prev;
+	item->next   = next;
 
-		prev_next = &item->next;
-		item      = item->next;
-	}
+	if (prev)
+		prev->next = item;
+	else
+		data->first_item = item;
+	if (next)
+		next->prev = item;
 
-	return NULL;
+	data->num_items++;
+	hash_insert(data, item);
 }
 
 static inline void obs_data_item_detach(struct obs_data_item *item)
 {
-	struct obs_data_item **prev_next = get_item_prev_next(item->parent,
-			item);
+	struct obs_data *data = item->parent;
 
-	if (prev_next) {
-		*prev_next = item->next;
-		item->next = NULL;
-	}
+	if (!obs_data_item_attached(item))
+		return;
+
+	if (item->prev)
+		item->prev->next = item->next;
+	else
+		data->first_item = item->next;
+	if (item->next)
+		item->next->prev = item->prev;
+
+	hash_remove(data, item);
+	data->num_items--;
+
+	item->prev = NULL;
+	item->next = NULL;
 }
 
+/* old_ptr has already been freed by brealloc, so it's only compared */
 static inline void obs_data_item_reattach(struct obs_data_item *old_ptr,
 		struct obs_data_item *new_ptr)
 {
-	struct obs_data_item **prev_next = get_item_prev_next(new_ptr->parent,
-			old_ptr);
+	struct obs_data *data = new_ptr->parent;
 
-	if (prev_next)
-		*prev_next = new_ptr;
+	if (new_ptr->prev)
+		new_ptr->prev->next = new_ptr;
+	else
+		data->first_item = new_ptr;
+	if (new_ptr->next)
+		new_ptr->next->prev = new_ptr;
+
+	if (data->hash_table) {
+		size_t mask = data->hash_size - 1;
+		size_t idx = new_ptr->name_hash & mask;
+
+		while (data->hash_table[idx] != old_ptr)
+			idx = (idx + 1) & mask;
+		data->hash_table[idx] = new_ptr;
+	}
 }
 
 static struct obs_data_item *obs_data_item_ensure_capacity(
@@ -346,14 +509,18 @@ static struct obs_data_item *obs_data_item_ensure_capacity(
 {
 	size_t new_size = obs_data_item_total_size(item);
 	struct obs_data_item *new_item;
+	bool attached;
 
 	if (item->capacity >= new_size)
 		return item;
 
+	attached = obs_data_item_attached(item);
+
 	new_item = brealloc(item, new_size);
 	new_item->capacity = new_size;
 
-	obs_data_item_reattach(item, new_item);
+	if (attached)
+		obs_data_item_reattach(item, new_item);
 	return new_item;
 }
 
@@ -468,155 +635,1303 @@ static inline void obs_data_item_set_autoselect_data(
 }
 
 /* ------------------------------------------------------------------------- */
+/* Streaming JSON reader
+ *
+ * Parses JSON text straight into obs_data objects in a single pass, without
+ * building an intermediate json_t tree first.  Accepts the same input that
+ * the previous jansson based loader accepted (duplicate keys are rejected,
+ * strings must be valid UTF-8, \u0000 is not allowed), and discards the
+ * same values it discarded (nulls, and non-object array elements). */
+
+#define JSON_MAX_DEPTH 2048
+
+struct json_reader {
+	const char  *start;
+	const char  *pos;
+	const char  *error;
+	struct dstr key;
+	struct dstr str;
+	int         depth;
+};
 
-static void obs_data_add_json_item(obs_data_t *data, const char *key,
-		json_t *json);
+static struct obs_data_item *get_item(struct obs_data *data, const char *name);
+static void set_item(struct obs_data *data, obs_data_item_t **item,
+		const char *name,
+		const void *ptr, size_t size, enum obs_data_type type);
 
-static inline void obs_data_add_json_object_data(obs_data_t *data, json_t *jobj)
+/* returns the length of the UTF-8 sequence at str, or 0 if it's invalid */
+static size_t utf8_seq_len(const uint8_t *str, size_t max_len,
+		uint32_t *p_codepoint)
 {
-	const char *item_key;
-	json_t *jitem;
+	uint32_t codepoint;
+	size_t len;
 
-	json_object_foreach (jobj, item_key, jitem) {
-		obs_data_add_json_item(data, item_key, jitem);
+	if (str[0] < 0x80) {
+		len = 1;
+		codepoint = str[0];
+	} else if (str[0] < 0xC2) {
+		return 0;
+	} else if (str[0] < 0xE0) {
+		len = 2;
+		codepoint = str[0] & 0x1F;
+	} else if (str[0] < 0xF0) {
+		len = 3;
+		codepoint = str[0] & 0x0F;
+	} else if (str[0] < 0xF5) {
+		len = 4;
+		codepoint = str[0] & 0x07;
+	} else {
+		return 0;
 	}
+
+	if (len > max_len)
+		return 0;
+
+	for (size_t i = 1; i < len; i++) {
+		if ((str[i] & 0xC0) != 0x80)
+			return 0;
+		codepoint = (codepoint << 6) | (str[i] & 0x3F);
+	}
+
+	/* overlong encodings, surrogates, and out of range codepoints */
+	if ((len == 3 && codepoint < 0x800) ||
+	    (len == 4 && codepoint < 0x10000) ||
+	    (codepoint >= 0xD800 && codepoint <= 0xDFFF) ||
+	    codepoint > 0x10FFFF)
+		return 0;
+
+	if (p_codepoint)
+		*p_codepoint = codepoint;
+	return len;
 }
 
-static inline void obs_data_add_json_object(obs_data_t *data, const char *key,
-		json_t *jobj)
+static bool utf8_valid(const char *str)
 {
-	obs_data_t *sub_obj = obs_data_create();
+	const uint8_t *pos = (const uint8_t*)str;
+	size_t len = strlen(str);
 
-	obs_data_add_json_object_data(sub_obj, jobj);
-	obs_data_set_obj(data, key, sub_obj);
-	obs_data_release(sub_obj);
+	while (len) {
+		size_t seq_len = utf8_seq_len(pos, len, NULL);
+		if (!seq_len)
+			return false;
+
+		pos += seq_len;
+		len -= seq_len;
+	}
+
+	return true;
 }
 
-static void obs_data_add_json_array(obs_data_t *data, const char *key,
-		json_t *jarray)
+static inline bool json_error(struct json_reader *r, const char *error)
 {
-	obs_data_array_t *array = obs_data_array_create();
-	size_t idx;
-	json_t *jitem;
+	if (!r->error)
+		r->error = error;
+	return false;
+}
 
-	json_array_foreach (jarray, idx, jitem) {
-		obs_data_t *item;
+static inline void json_skip_whitespace(struct json_reader *r)
+{
+	while (*r->pos == ' ' || *r->pos == '\t' ||
+	       *r->pos == '\n' || *r->pos == '\r')
+		r->pos++;
+}
 
-		if (!json_is_object(jitem))
-			continue;
+static bool json_read_hex4(struct json_reader *r, uint32_t *val)
+{
+	*val = 0;
 
-		item = obs_data_create();
-		obs_data_add_json_object_data(item, jitem);
-		obs_data_array_push_back(array, item);
-		obs_data_release(item);
+	for (int i = 0; i < 4; i++) {
+		char ch = *r->pos++;
+		*val <<= 4;
+
+		if (ch >= '0' && ch <= '9')
+			*val |= (uint32_t)(ch - '0');
+		else if (ch >= 'a' && ch <= 'f')
+			*val |= (uint32_t)(ch - 'a' + 10);
+		else if (ch >= 'A' && ch <= 'F')
+			*val |= (uint32_t)(ch - 'A' + 10);
+		else
+			return json_error(r, "invalid escape");
 	}
 
-	obs_data_set_array(data, key, array);
-	obs_data_array_release(array);
+	return true;
 }
 
-static void obs_data_add_json_item(obs_data_t *data, const char *key,
-		json_t *json)
+static void dstr_cat_codepoint(struct dstr *str, uint32_t codepoint)
 {
-	if (json_is_object(json))
-		obs_data_add_json_object(data, key, json);
-	else if (json_is_array(json))
-		obs_data_add_json_array(data, key, json);
-	else if (json_is_string(json))
-		obs_data_set_string(data, key, json_string_value(json));
-	else if (json_is_integer(json))
-		obs_data_set_int(data, key, json_integer_value(json));
-	else if (json_is_real(json))
-		obs_data_set_double(data, key, json_real_value(json));
-	else if (json_is_true(json))
-		obs_data_set_bool(data, key, true);
-	else if (json_is_false(json))
-		obs_data_set_bool(data, key, false);
+	char buf[4];
+	size_t len;
+
+	if (codepoint < 0x80) {
+		buf[0] = (char)codepoint;
+		len = 1;
+	} else if (codepoint < 0x800) {
+		buf[0] = (char)(0xC0 | (codepoint >> 6));
+		buf[1] = (char)(0x80 | (codepoint & 0x3F));
+		len = 2;
+	} else if (codepoint < 0x10000) {
+		buf[0] = (char)(0xE0 | (codepoint >> 12));
+		buf[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+		buf[2] = (char)(0x80 | (codepoint & 0x3F));
+		len = 3;
+	} else {
+		buf[0] = (char)(0xF0 | (codepoint >> 18));
+		buf[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+		buf[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+		buf[3] = (char)(0x80 | (codepoint & 0x3F));
+		len = 4;
+	}
+
+	dstr_ncat(str, buf, len);
 }
 
-/* ------------------------------------------------------------------------- */
+static bool json_read_escape(struct json_reader *r, struct dstr *out)
+{
+	uint32_t codepoint;
+	char ch = *r->pos++;
+
+	switch (ch) {
+	case '"':  dstr_cat_ch(out, '"');  return true;
+	case '\\': dstr_cat_ch(out, '\\'); return true;
+	case '/':  dstr_cat_ch(out, '/');  return true;
+	case 'b':  dstr_cat_ch(out, '\b'); return true;
+	case 'f':  dstr_cat_ch(out, '\f'); return true;
+	case 'n':  dstr_cat_ch(out, '\n'); return true;
+	case 'r':  dstr_cat_ch(out, '\r'); return true;
+	case 't':  dstr_cat_ch(out, '\t'); return true;
+	case 'u':  break;
+	default:   return json_error(r, "invalid escape");
+	}
+
+	if (!json_read_hex4(r, &codepoint))
+		return false;
+
+	if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+		uint32_t low;
+
+		if (r->pos[0] != '\\' || r->pos[1] != 'u')
+			return json_error(r, "invalid Unicode surrogate pair");
+
+		r->pos += 2;
+		if (!json_read_hex4(r, &low))
+			return false;
+		if (low < 0xDC00 || low > 0xDFFF)
+			return json_error(r, "invalid Unicode surrogate pair");
+
+		codepoint = 0x10000 + ((codepoint - 0xD800) << 10) +
+			(low - 0xDC00);
+
+	} else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+		return json_error(r, "invalid Unicode surrogate pair");
 
-static inline void set_json_string(json_t *json, const char *name,
-		obs_data_item_t *item)
+	} else if (codepoint == 0) {
+		return json_error(r, "\\u0000 is not allowed");
+	}
+
+	dstr_cat_codepoint(out, codepoint);
+	return true;
+}
+
+static bool json_read_string(struct json_reader *r, struct dstr *out)
 {
-	const char *val = obs_data_item_get_string(item);
-	json_object_set_new(json, name, json_string(val));
+	const char *run;
+
+	/* reuse the buffer rather than freeing it for every string */
+	if (out->array)
+		out->array[0] = 0;
+	out->len = 0;
+
+	if (*r->pos != '"')
+		return json_error(r, "string or '}' expected");
+
+	run = ++r->pos;
+
+	for (;;) {
+		uint8_t ch = (uint8_t)*r->pos;
+
+		if (ch == '"' || ch == '\\') {
+			if (r->pos != run)
+				dstr_ncat(out, run, r->pos - run);
+
+			r->pos++;
+			if (ch == '"')
+				break;
+			if (!json_read_escape(r, out))
+				return false;
+
+			run = r->pos;
+
+		} else if (ch == 0) {
+			return json_error(r, "premature end of input");
+
+		} else if (ch < 0x20) {
+			return json_error(r, "control character in string");
+
+		} else if (ch < 0x80) {
+			r->pos++;
+
+		} else {
+			size_t len = utf8_seq_len((const uint8_t*)r->pos, 4,
+					NULL);
+			if (!len)
+				return json_error(r, "invalid UTF-8 in string");
+			r->pos += len;
+		}
+	}
+
+	/* empty strings still need a valid (zero-length) buffer */
+	if (!out->array)
+		dstr_copy(out, "");
+	return true;
+}
+
+static inline bool is_digit(char ch)
+{
+	return ch >= '0' && ch <= '9';
 }
 
-static inline void set_json_number(json_t *json, const char *name,
-		obs_data_item_t *item)
+static bool json_read_number(struct json_reader *r,
+		struct obs_data_number *num)
 {
-	enum obs_data_number_type type = obs_data_item_numtype(item);
+	const char *start = r->pos;
+	bool is_real = false;
+	char buf[64];
+	size_t len;
 
-	if (type == OBS_DATA_NUM_INT) {
-		long long val = obs_data_item_get_int(item);
-		json_object_set_new(json, name, json_integer(val));
+	if (*r->pos == '-')
+		r->pos++;
+
+	if (*r->pos == '0') {
+		r->pos++;
+	} else if (is_digit(*r->pos)) {
+		while (is_digit(*r->pos))
+			r->pos++;
 	} else {
-		double val = obs_data_item_get_double(item);
-		json_object_set_new(json, name, json_real(val));
+		return json_error(r, "invalid number");
+	}
+
+	if (*r->pos == '.') {
+		is_real = true;
+		r->pos++;
+		if (!is_digit(*r->pos))
+			return json_error(r, "invalid number");
+		while (is_digit(*r->pos))
+			r->pos++;
+	}
+
+	if (*r->pos == 'e' || *r->pos == 'E') {
+		is_real = true;
+		r->pos++;
+		if (*r->pos == '+' || *r->pos == '-')
+			r->pos++;
+		if (!is_digit(*r->pos))
+			return json_error(r, "invalid number");
+		while (is_digit(*r->pos))
+			r->pos++;
+	}
+
+	len = r->pos - start;
+	if (len >= sizeof(buf))
+		return json_error(r, "number too long");
+
+	memcpy(buf, start, len);
+	buf[len] = 0;
+
+	if (!is_real) {
+		errno = 0;
+		num->type    = OBS_DATA_NUM_INT;
+		num->int_val = strtoll(buf, NULL, 10);
+		if (errno == ERANGE)
+			return json_error(r, "too big integer");
+	} else {
+		num->type       = OBS_DATA_NUM_DOUBLE;
+		num->double_val = os_strtod(buf);
+		if (isinf(num->double_val))
+			return json_error(r, "real number overflow");
+	}
+
+	return true;
+}
+
+static bool json_read_literal(struct json_reader *r, const char *literal)
+{
+	size_t len = strlen(literal);
+
+	if (strncmp(r->pos, literal, len) != 0)
+		return json_error(r, "invalid token");
+
+	r->pos += len;
+	return true;
+}
+
+/* Adds a newly deserialized item to an object, returning NULL if the key
+ * already exists.  Objects written by obs_data are already sorted by key, so
+ * the common case is a plain append after the previously added item, which
+ * avoids rescanning the item list. */
+static struct obs_data_item *add_loaded_item(obs_data_t *data,
+		struct obs_data_item *prev, const char *key,
+		const void *ptr, size_t size, enum obs_data_type type)
+{
+	struct obs_data_item *item;
+
+	if ((prev && strcmp(get_item_name(prev), key) < 0 &&
+	     (!prev->next || strcmp(get_item_name(prev->next), key) > 0)) ||
+	    !data->first_item) {
+		item = obs_data_item_create(key, ptr, size, type, false,
+				false);
+		obs_data_item_attach(data, prev, item);
+		return item;
 	}
+
+	if (get_item(data, key))
+		return NULL;
+
+	set_item(data, NULL, key, ptr, size, type);
+	return get_item(data, key);
 }
 
-static inline void set_json_bool(json_t *json, const char *name,
-		obs_data_item_t *item)
+static bool json_add_item(struct json_reader *r, obs_data_t *data,
+		struct obs_data_item **last, const char *key,
+		const void *ptr, size_t size, enum obs_data_type type)
 {
-	bool val = obs_data_item_get_bool(item);
-	json_object_set_new(json, name, val ? json_true() : json_false());
+	struct obs_data_item *item = add_loaded_item(data, *last, key, ptr,
+			size, type);
+	if (!item)
+		return json_error(r, "duplicate object key");
+
+	*last = item;
+	return true;
 }
 
-static json_t *obs_data_to_json(obs_data_t *data);
+static bool json_read_value(struct json_reader *r, obs_data_t *data,
+		struct obs_data_item **last, const char *key);
 
-static inline void set_json_obj(json_t *json, const char *name,
-		obs_data_item_t *item)
+static bool json_read_object(struct json_reader *r, obs_data_t *data)
 {
-	obs_data_t *obj = obs_data_item_get_obj(item);
-	json_object_set_new(json, name, obs_data_to_json(obj));
-	obs_data_release(obj);
+	struct obs_data_item *last = NULL;
+
+	if (++r->depth > JSON_MAX_DEPTH)
+		return json_error(r, "maximum parsing depth reached");
+
+	r->pos++;
+	json_skip_whitespace(r);
+
+	if (*r->pos == '}') {
+		r->pos++;
+		r->depth--;
+		return true;
+	}
+
+	for (;;) {
+		if (!json_read_string(r, &r->key))
+			return false;
+
+		json_skip_whitespace(r);
+		if (*r->pos != ':')
+			return json_error(r, "':' expected");
+
+		r->pos++;
+		json_skip_whitespace(r);
+
+		if (!json_read_value(r, data, &last, r->key.array))
+			return false;
+
+		json_skip_whitespace(r);
+		if (*r->pos == '}')
+			break;
+		if (*r->pos != ',')
+			return json_error(r, "'}' expected");
+
+		r->pos++;
+		json_skip_whitespace(r);
+	}
+
+	r->pos++;
+	r->depth--;
+	return true;
+}
+
+static bool json_read_array(struct json_reader *r, obs_data_array_t *array)
+{
+	if (++r->depth > JSON_MAX_DEPTH)
+		return json_error(r, "maximum parsing depth reached");
+
+	r->pos++;
+	json_skip_whitespace(r);
+
+	if (*r->pos == ']') {
+		r->pos++;
+		r->depth--;
+		return true;
+	}
+
+	for (;;) {
+		if (*r->pos == '{' && array) {
+			obs_data_t *obj = obs_data_create();
+			obs_data_array_push_back(array, obj);
+			obs_data_release(obj);
+
+			if (!json_read_object(r, obj))
+				return false;
+
+		} else if (!json_read_value(r, NULL, NULL, NULL)) {
+			return false;
+		}
+
+		json_skip_whitespace(r);
+		if (*r->pos == ']')
+			break;
+		if (*r->pos != ',')
+			return json_error(r, "']' expected");
+
+		r->pos++;
+		json_skip_whitespace(r);
+	}
+
+	r->pos++;
+	r->depth--;
+	return true;
+}
+
+/* if data is NULL, the value is validated and then discarded */
+static bool json_read_value(struct json_reader *r, obs_data_t *data,
+		struct obs_data_item **last, const char *key)
+{
+	struct obs_data_number num;
+	bool val;
+
+	switch (*r->pos) {
+	case '{': {
+		obs_data_t *obj = data ? obs_data_create() : NULL;
+		bool success = true;
+
+		if (obj)
+			success = json_add_item(r, data, last, key, &obj,
+					sizeof(obs_data_t*), OBS_DATA_OBJECT);
+		if (success)
+			success = json_read_object(r, obj);
+
+		obs_data_release(obj);
+		return success;
+	}
+	case '[': {
+		obs_data_array_t *array = data ? obs_data_array_create() : NULL;
+		bool success = true;
+
+		if (array)
+			success = json_add_item(r, data, last, key, &array,
+					sizeof(obs_data_array_t*),
+					OBS_DATA_ARRAY);
+		if (success)
+			success = json_read_array(r, array);
+
+		obs_data_array_release(array);
+		return success;
+	}
+	case '"':
+		if (!json_read_string(r, &r->str))
+			return false;
+		if (!data)
+			return true;
+
+		return json_add_item(r, data, last, key, r->str.array,
+				r->str.len + 1, OBS_DATA_STRING);
+
+	case 't':
+	case 'f':
+		val = *r->pos == 't';
+		if (!json_read_literal(r, val ? "true" : "false"))
+			return false;
+		if (!data)
+			return true;
+
+		return json_add_item(r, data, last, key, &val, sizeof(bool),
+				OBS_DATA_BOOLEAN);
+
+	case 'n':
+		return json_read_literal(r, "null");
+
+	case 0:
+		return json_error(r, "premature end of input");
+	}
+
+	if (!json_read_number(r, &num))
+		return false;
+	if (!data)
+		return true;
+
+	return json_add_item(r, data, last, key, &num,
+			sizeof(struct obs_data_number), OBS_DATA_NUMBER);
+}
+
+static bool json_read_root(struct json_reader *r, obs_data_t *data)
+{
+	bool success;
+
+	json_skip_whitespace(r);
+
+	if (*r->pos == '{')
+		success = json_read_object(r, data);
+	else if (*r->pos == '[')
+		success = json_read_array(r, NULL);
+	else
+		return json_error(r, "'[' or '{' expected");
+
+	if (!success)
+		return false;
+
+	json_skip_whitespace(r);
+	if (*r->pos)
+		return json_error(r, "end of file expected");
+
+	return true;
+}
+
+static int json_error_line(struct json_reader *r)
+{
+	int line = 1;
+
+	for (const char *pos = r->start; pos < r->pos && *pos; pos++) {
+		if (*pos == '\n')
+			line++;
+	}
+
+	return line;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Streaming JSON writer
+ *
+ * Writes obs_data directly into a string, producing the same output as
+ * jansson's json_dumps with JSON_PRESERVE_ORDER | JSON_INDENT(4). */
+
+#define JSON_INDENT_SIZE 4
+
+static void json_write_obj(struct dstr *out, obs_data_t *data, int depth);
+
+static inline void json_write_indent(struct dstr *out, int depth)
+{
+	size_t len = out->len;
+	size_t spaces = (size_t)depth * JSON_INDENT_SIZE;
+
+	dstr_resize(out, len + spaces + 1);
+	out->array[len] = '\n';
+	memset(out->array + len + 1, ' ', spaces);
+}
+
+static void json_write_string(struct dstr *out, const char *str)
+{
+	const char *run = str;
+
+	dstr_cat_ch(out, '"');
+
+	for (; *str; str++) {
+		uint8_t ch = (uint8_t)*str;
+		const char *esc;
+		char seq[7];
+
+		if (ch >= 0x20 && ch != '"' && ch != '\\')
+			continue;
+
+		switch (ch) {
+		case '"':  esc = "\\\""; break;
+		case '\\': esc = "\\\\"; break;
+		case '\b': esc = "\\b";  break;
+		case '\f': esc = "\\f";  break;
+		case '\n': esc = "\\n";  break;
+		case '\r': esc = "\\r";  break;
+		case '\t': esc = "\\t";  break;
+		default:
+			snprintf(seq, sizeof(seq), "\\u%04X", (unsigned int)ch);
+			esc = seq;
+		}
+
+		if (str != run)
+			dstr_ncat(out, run, str - run);
+		dstr_cat(out, esc);
+		run = str + 1;
+	}
+
+	if (str != run)
+		dstr_ncat(out, run, str - run);
+	dstr_cat_ch(out, '"');
+}
+
+static void json_write_array(struct dstr *out, obs_data_array_t *array,
+		int depth)
+{
+	size_t count = array ? array->objects.num : 0;
+
+	if (!count) {
+		dstr_cat(out, "[]");
+		return;
+	}
+
+	dstr_cat_ch(out, '[');
+
+	for (size_t i = 0; i < count; i++) {
+		if (i)
+			dstr_cat_ch(out, ',');
+		json_write_indent(out, depth + 1);
+		json_write_obj(out, array->objects.array[i], depth + 1);
+	}
+
+	json_write_indent(out, depth);
+	dstr_cat_ch(out, ']');
 }
 
-static inline void set_json_array(json_t *json, const char *name,
-		obs_data_item_t *item)
+/* returns false if the item can't be represented in JSON and was skipped */
+static bool json_write_item(struct dstr *out, struct obs_data_item *item,
+		bool first, int depth)
 {
-	json_t           *jarray = json_array();
-	obs_data_array_t *array   = obs_data_item_get_array(item);
-	size_t           count   = obs_data_array_count(array);
+	const char *name = get_item_name(item);
+	void *ptr = get_item_data(item);
+	struct obs_data_number *num = ptr;
+	char buf[64];
+	int len = 0;
+
+	if (!utf8_valid(name))
+		return false;
+
+	if (item->type == OBS_DATA_STRING) {
+		if (!utf8_valid(ptr))
+			return false;
+
+	} else if (item->type == OBS_DATA_NUMBER) {
+		if (num->type == OBS_DATA_NUM_INT)
+			len = snprintf(buf, sizeof(buf), "%lld", num->int_val);
+		else if (isfinite(num->double_val))
+			len = os_dtostr(num->double_val, buf, sizeof(buf));
+		else
+			return false;
+		if (len < 0)
+			return false;
+
+	} else if (item->type != OBS_DATA_BOOLEAN &&
+	           item->type != OBS_DATA_OBJECT &&
+	           item->type != OBS_DATA_ARRAY) {
+		return false;
+	}
 
-	for (size_t idx = 0; idx < count; idx++) {
-		obs_data_t *sub_item = obs_data_array_item(array, idx);
-		json_t     *jitem   = obs_data_to_json(sub_item);
-		json_array_append_new(jarray, jitem);
-		obs_data_release(sub_item);
+	if (!first)
+		dstr_cat_ch(out, ',');
+	json_write_indent(out, depth + 1);
+	json_write_string(out, name);
+	dstr_cat(out, ": ");
+
+	switch (item->type) {
+	case OBS_DATA_STRING:
+		json_write_string(out, ptr);
+		break;
+	case OBS_DATA_NUMBER:
+		dstr_ncat(out, buf, len);
+		break;
+	case OBS_DATA_BOOLEAN:
+		dstr_cat(out, *(bool*)ptr ? "true" : "false");
+		break;
+	case OBS_DATA_OBJECT:
+		json_write_obj(out, *(obs_data_t**)ptr, depth + 1);
+		break;
+	case OBS_DATA_ARRAY:
+		json_write_array(out, *(obs_data_array_t**)ptr, depth + 1);
+		break;
+	case OBS_DATA_NULL:
+		break;
 	}
 
-	json_object_set_new(json, name, jarray);
-	obs_data_array_release(array);
+	return true;
 }
 
-static json_t *obs_data_to_json(obs_data_t *data)
+static void json_write_obj(struct dstr *out, obs_data_t *data, int depth)
 {
-	json_t *json = json_object();
-	obs_data_item_t *item = NULL;
+	struct obs_data_item *item = data ? data->first_item : NULL;
+	bool first = true;
 
-	for (item = obs_data_first(data); item; obs_data_item_next(&item)) {
-		enum obs_data_type type = obs_data_item_gettype(item);
-		const char *name        = get_item_name(item);
+	dstr_cat_ch(out, '{');
 
+	for (; item; item = item->next) {
 		if (!obs_data_item_has_user_value(item))
 			continue;
+		if (json_write_item(out, item, first, depth))
+			first = false;
+	}
+
+	if (!first)
+		json_write_indent(out, depth);
+	dstr_cat_ch(out, '}');
+}
+
+/* ------------------------------------------------------------------------- */
+/* Binary format
+ *
+ * Compact, typed encoding of obs_data that round-trips losslessly through
+ * JSON.  All values are little endian:
+ *
+ *   char     magic[4]               "OBSD"
+ *   uint32_t version
+ *   uint32_t string_count
+ *   uint32_t string_data_size
+ *   uint32_t string_offsets[string_count]
+ *   char     string_data[]          NUL-terminated, deduplicated strings
+ *   object   root
+ *
+ *   object:  uint32_t item_count, item[item_count]
+ *   item:    uint32_t name_string, uint8_t type, value
+ *   array:   uint32_t object_count, object[object_count]
+ *
+ * Strings (names and string values) are referenced by index into the string
+ * table, so names shared by many objects are only stored once and never have
+ * to be escaped or unescaped. */
+
+#define BIN_MAGIC     "OBSD"
+#define BIN_VERSION   1
+#define BIN_MAX_DEPTH 2048
+
+enum bin_type {
+	BIN_STRING,
+	BIN_INT,
+	BIN_DOUBLE,
+	BIN_FALSE,
+	BIN_TRUE,
+	BIN_OBJECT,
+	BIN_ARRAY,
+};
 
-		if (type == OBS_DATA_STRING)
-			set_json_string(json, name, item);
-		else if (type == OBS_DATA_NUMBER)
-			set_json_number(json, name, item);
-		else if (type == OBS_DATA_BOOLEAN)
-			set_json_bool(json, name, item);
-		else if (type == OBS_DATA_OBJECT)
-			set_json_obj(json, name, item);
-		else if (type == OBS_DATA_ARRAY)
-			set_json_array(json, name, item);
+struct bin_writer {
+	DARRAY(uint8_t)          body;
+
+	DARRAY(const char*)      strings;
+	size_t                   string_data_size;
+	uint32_t                 *string_table;
+	size_t                   string_table_size;
+};
+
+static void bin_string_table_insert(struct bin_writer *w, uint32_t idx)
+{
+	const char *str = w->strings.array[idx];
+	size_t mask = w->string_table_size - 1;
+	size_t pos = hash_item_name(str) & mask;
+
+	while (w->string_table[pos])
+		pos = (pos + 1) & mask;
+	w->string_table[pos] = idx + 1;
+}
+
+static uint32_t bin_string_index(struct bin_writer *w, const char *str)
+{
+	uint32_t hash = hash_item_name(str);
+	size_t mask, pos;
+	uint32_t idx;
+
+	if (w->strings.num * 2 >= w->string_table_size) {
+		size_t size = w->string_table_size ?
+			w->string_table_size * 2 : 256;
+
+		bfree(w->string_table);
+		w->string_table = bzalloc(sizeof(uint32_t) * size);
+		w->string_table_size = size;
+
+		for (idx = 0; idx < w->strings.num; idx++)
+			bin_string_table_insert(w, idx);
+	}
+
+	mask = w->string_table_size - 1;
+	pos = hash & mask;
+
+	while (w->string_table[pos]) {
+		idx = w->string_table[pos] - 1;
+		if (strcmp(w->strings.array[idx], str) == 0)
+			return idx;
+		pos = (pos + 1) & mask;
 	}
 
-	return json;
+	idx = (uint32_t)w->strings.num;
+	da_push_back(w->strings, &str);
+	w->string_data_size += strlen(str) + 1;
+	w->string_table[pos] = idx + 1;
+	return idx;
+}
+
+static inline void bin_put_u32(uint8_t *ptr, uint32_t val)
+{
+	ptr[0] = (uint8_t)val;
+	ptr[1] = (uint8_t)(val >> 8);
+	ptr[2] = (uint8_t)(val >> 16);
+	ptr[3] = (uint8_t)(val >> 24);
+}
+
+/* values are written straight into the output array rather than through a
+ * serializer, which would otherwise be called back once per byte */
+static inline uint8_t *bin_grow(struct bin_writer *w, size_t size)
+{
+	size_t pos = w->body.num;
+
+	if (pos + size > w->body.capacity)
+		da_reserve(w->body, (pos + size) * 2);
+	w->body.num += size;
+	return w->body.array + pos;
+}
+
+static inline void bin_w8(struct bin_writer *w, uint8_t val)
+{
+	*bin_grow(w, 1) = val;
+}
+
+static inline void bin_w32(struct bin_writer *w, uint32_t val)
+{
+	bin_put_u32(bin_grow(w, 4), val);
+}
+
+static inline void bin_w64(struct bin_writer *w, uint64_t val)
+{
+	uint8_t *ptr = bin_grow(w, 8);
+	bin_put_u32(ptr, (uint32_t)val);
+	bin_put_u32(ptr + 4, (uint32_t)(val >> 32));
+}
+
+static inline void bin_write(struct bin_writer *w, const void *data,
+		size_t size)
+{
+	memcpy(bin_grow(w, size), data, size);
+}
+
+static void bin_write_obj(struct bin_writer *w, obs_data_t *data);
+
+static void bin_write_array(struct bin_writer *w, obs_data_array_t *array)
+{
+	size_t count = array ? array->objects.num : 0;
+
+	bin_w32(w, (uint32_t)count);
+
+	for (size_t i = 0; i < count; i++)
+		bin_write_obj(w, array->objects.array[i]);
+}
+
+static void bin_write_item(struct bin_writer *w, struct obs_data_item *item)
+{
+	void *ptr = get_item_data(item);
+	struct obs_data_number *num = ptr;
+
+	uint64_t bits;
+
+	bin_w32(w, bin_string_index(w, get_item_name(item)));
+
+	switch (item->type) {
+	case OBS_DATA_STRING:
+		bin_w8(w, BIN_STRING);
+		bin_w32(w, bin_string_index(w, ptr));
+		break;
+	case OBS_DATA_NUMBER:
+		if (num->type == OBS_DATA_NUM_INT) {
+			bin_w8(w, BIN_INT);
+			bin_w64(w, (uint64_t)num->int_val);
+		} else {
+			memcpy(&bits, &num->double_val, sizeof(bits));
+			bin_w8(w, BIN_DOUBLE);
+			bin_w64(w, bits);
+		}
+		break;
+	case OBS_DATA_BOOLEAN:
+		bin_w8(w, *(bool*)ptr ? BIN_TRUE : BIN_FALSE);
+		break;
+	case OBS_DATA_OBJECT:
+		bin_w8(w, BIN_OBJECT);
+		bin_write_obj(w, *(obs_data_t**)ptr);
+		break;
+	case OBS_DATA_ARRAY:
+		bin_w8(w, BIN_ARRAY);
+		bin_write_array(w, *(obs_data_array_t**)ptr);
+		break;
+	case OBS_DATA_NULL:
+		break;
+	}
+}
+
+static inline bool bin_item_writable(struct obs_data_item *item)
+{
+	return obs_data_item_has_user_value(item) &&
+		item->type != OBS_DATA_NULL;
+}
+
+static void bin_write_obj(struct bin_writer *w, obs_data_t *data)
+{
+	struct obs_data_item *item;
+	size_t count = 0;
+
+	for (item = data ? data->first_item : NULL; item; item = item->next) {
+		if (bin_item_writable(item))
+			count++;
+	}
+
+	bin_w32(w, (uint32_t)count);
+
+	for (item = data ? data->first_item : NULL; item; item = item->next) {
+		if (bin_item_writable(item))
+			bin_write_item(w, item);
+	}
+}
+
+void *obs_data_get_binary(obs_data_t *data, size_t *size)
+{
+	struct bin_writer w = {0};
+	struct bin_writer out = {0};
+	size_t offsets_pos;
+	uint32_t offset = 0;
+
+	if (!data || !size)
+		return NULL;
+
+	bin_write_obj(&w, data);
+
+	da_reserve(out.body, 16 + w.strings.num * 4 + w.string_data_size +
+			w.body.num);
+
+	bin_write(&out, BIN_MAGIC, 4);
+	bin_w32(&out, BIN_VERSION);
+	bin_w32(&out, (uint32_t)w.strings.num);
+	bin_w32(&out, (uint32_t)w.string_data_size);
+
+	offsets_pos = out.body.num;
+	bin_grow(&out, w.strings.num * 4);
+
+	for (size_t i = 0; i < w.strings.num; i++) {
+		const char *str = w.strings.array[i];
+		size_t len = strlen(str) + 1;
+
+		bin_put_u32(out.body.array + offsets_pos + i * 4, offset);
+		bin_write(&out, str, len);
+		offset += (uint32_t)len;
+	}
+
+	bin_write(&out, w.body.array, w.body.num);
+
+	da_free(w.body);
+	da_free(w.strings);
+	bfree(w.string_table);
+
+	*size = out.body.num;
+	return out.body.array;
+}
+
+struct bin_reader {
+	const uint8_t *pos;
+	const uint8_t *end;
+
+	const uint8_t *string_offsets;
+	const char    *string_data;
+	uint32_t      string_count;
+	uint32_t      string_data_size;
+
+	int           depth;
+	const char    *error;
+};
+
+static inline bool bin_error(struct bin_reader *r, const char *error)
+{
+	if (!r->error)
+		r->error = error;
+	return false;
+}
+
+static inline uint32_t bin_get_u32(const uint8_t *ptr)
+{
+	return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) |
+		((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+static inline bool bin_read_u32(struct bin_reader *r, uint32_t *val)
+{
+	if (r->end - r->pos < 4)
+		return bin_error(r, "unexpected end of data");
+
+	*val = bin_get_u32(r->pos);
+	r->pos += 4;
+	return true;
+}
+
+static inline bool bin_read_u64(struct bin_reader *r, uint64_t *val)
+{
+	uint32_t low, high;
+
+	if (!bin_read_u32(r, &low) || !bin_read_u32(r, &high))
+		return false;
+
+	*val = (uint64_t)low | ((uint64_t)high << 32);
+	return true;
+}
+
+static inline bool bin_read_u8(struct bin_reader *r, uint8_t *val)
+{
+	if (r->pos == r->end)
+		return bin_error(r, "unexpected end of data");
+
+	*val = *(r->pos++);
+	return true;
+}
+
+static const char *bin_read_string(struct bin_reader *r)
+{
+	uint32_t idx, offset;
+
+	if (!bin_read_u32(r, &idx))
+		return NULL;
+
+	if (idx >= r->string_count) {
+		bin_error(r, "invalid string index");
+		return NULL;
+	}
+
+	offset = bin_get_u32(r->string_offsets + idx * 4);
+	if (offset >= r->string_data_size) {
+		bin_error(r, "invalid string offset");
+		return NULL;
+	}
+
+	/* the string table is validated to end with a NUL, so this is always
+	 * terminated within the table */
+	return r->string_data + offset;
+}
+
+static inline bool bin_enter_block(struct bin_reader *r)
+{
+	if (++r->depth > BIN_MAX_DEPTH)
+		return bin_error(r, "maximum depth reached");
+	return true;
+}
+
+static bool bin_read_obj(struct bin_reader *r, obs_data_t *data);
+
+static bool bin_read_array(struct bin_reader *r, obs_data_array_t *array)
+{
+	size_t max_count;
+	uint32_t count;
+
+	if (!bin_read_u32(r, &count) || !bin_enter_block(r))
+		return false;
+
+	/* every object takes at least its item count, so don't trust counts
+	 * that couldn't possibly fit in the remaining data */
+	max_count = (size_t)(r->end - r->pos) / 4;
+	if (count > max_count)
+		return bin_error(r, "invalid object count");
+
+	da_reserve(array->objects, count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		obs_data_t *obj = obs_data_create();
+		obs_data_array_push_back(array, obj);
+		obs_data_release(obj);
+
+		if (!bin_read_obj(r, obj))
+			return false;
+	}
+
+	r->depth--;
+	return true;
+}
+
+static bool bin_read_item(struct bin_reader *r, obs_data_t *data,
+		struct obs_data_item **last)
+{
+	struct obs_data_number num;
+	struct obs_data_item *item;
+	const char *name;
+	const char *str;
+	uint8_t type;
+	uint64_t val;
+	bool b;
+
+	name = bin_read_string(r);
+	if (!name || !bin_read_u8(r, &type))
+		return false;
+
+	switch (type) {
+	case BIN_STRING:
+		str = bin_read_string(r);
+		if (!str)
+			return false;
+
+		item = add_loaded_item(data, *last, name, str,
+				strlen(str) + 1, OBS_DATA_STRING);
+		break;
+
+	case BIN_INT:
+	case BIN_DOUBLE:
+		if (!bin_read_u64(r, &val))
+			return false;
+
+		if (type == BIN_INT) {
+			num.type    = OBS_DATA_NUM_INT;
+			num.int_val = (long long)val;
+		} else {
+			num.type = OBS_DATA_NUM_DOUBLE;
+			memcpy(&num.double_val, &val, sizeof(double));
+		}
+
+		item = add_loaded_item(data, *last, name, &num,
+				sizeof(struct obs_data_number),
+				OBS_DATA_NUMBER);
+		break;
+
+	case BIN_FALSE:
+	case BIN_TRUE:
+		b = type == BIN_TRUE;
+		item = add_loaded_item(data, *last, name, &b, sizeof(bool),
+				OBS_DATA_BOOLEAN);
+		break;
+
+	case BIN_OBJECT: {
+		obs_data_t *obj = obs_data_create();
+		item = add_loaded_item(data, *last, name, &obj,
+				sizeof(obs_data_t*), OBS_DATA_OBJECT);
+		obs_data_release(obj);
+
+		if (item && !bin_read_obj(r, obj))
+			return false;
+		break;
+	}
+	case BIN_ARRAY: {
+		obs_data_array_t *array = obs_data_array_create();
+		item = add_loaded_item(data, *last, name, &array,
+				sizeof(obs_data_array_t*), OBS_DATA_ARRAY);
+		obs_data_array_release(array);
+
+		if (item && !bin_read_array(r, array))
+			return false;
+		break;
+	}
+	default:
+		return bin_error(r, "invalid item type");
+	}
+
+	if (!item)
+		return bin_error(r, "duplicate item name");
+
+	*last = item;
+	return true;
+}
+
+static bool bin_read_obj(struct bin_reader *r, obs_data_t *data)
+{
+	struct obs_data_item *last = NULL;
+	uint32_t count;
+
+	if (!bin_read_u32(r, &count) || !bin_enter_block(r))
+		return false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (!bin_read_item(r, data, &last))
+			return false;
+	}
+
+	r->depth--;
+	return true;
+}
+
+static bool bin_read_header(struct bin_reader *r)
+{
+	uint32_t version;
+	size_t offsets_size;
+
+	if (r->end - r->pos < 4 || memcmp(r->pos, BIN_MAGIC, 4) != 0)
+		return bin_error(r, "invalid header");
+	r->pos += 4;
+
+	if (!bin_read_u32(r, &version) ||
+	    !bin_read_u32(r, &r->string_count) ||
+	    !bin_read_u32(r, &r->string_data_size))
+		return false;
+
+	if (version != BIN_VERSION)
+		return bin_error(r, "unsupported version");
+
+	offsets_size = (size_t)r->string_count * 4;
+	if ((size_t)(r->end - r->pos) < offsets_size ||
+	    (size_t)(r->end - r->pos) - offsets_size < r->string_data_size)
+		return bin_error(r, "invalid string table");
+
+	r->string_offsets = r->pos;
+	r->pos += offsets_size;
+	r->string_data = (const char*)r->pos;
+	r->pos += r->string_data_size;
+
+	if (r->string_count && (!r->string_data_size ||
+	    r->string_data[r->string_data_size - 1] != 0))
+		return bin_error(r, "invalid string table");
+
+	return true;
+}
+
+obs_data_t *obs_data_create_from_binary(const void *bin, size_t size)
+{
+	struct bin_reader reader = {0};
+	obs_data_t *data;
+
+	if (!bin)
+		return NULL;
+
+	reader.pos = bin;
+	reader.end = reader.pos + size;
+
+	data = obs_data_create();
+
+	if (bin_read_header(&reader) && bin_read_obj(&reader, data) &&
+	    reader.pos != reader.end)
+		bin_error(&reader, "trailing data");
+
+	if (reader.error) {
+		blog(LOG_ERROR, "obs-data.c: [obs_data_create_from_binary] "
+		                "Failed reading binary data: %s",
+		                reader.error);
+		obs_data_release(data);
+		data = NULL;
+	}
+
+	return data;
+}
+
+obs_data_t *obs_data_create_from_binary_file(const char *file)
+{
+	obs_data_t *data = NULL;
+	size_t size = 0;
+
+	void *bin = os_quick_read_file(file, &size);
+	if (bin) {
+		data = obs_data_create_from_binary(bin, size);
+		bfree(bin);
+	}
+
+	return data;
+}
+
+bool obs_data_save_binary(obs_data_t *data, const char *file)
+{
+	size_t size = 0;
+	void *bin = obs_data_get_binary(data, &size);
+	bool success = false;
+
+	if (bin) {
+		success = os_quick_write_file(file, bin, size);
+		bfree(bin);
+	}
+
+	return success;
+}
+
+bool obs_data_save_binary_safe(obs_data_t *data, const char *file,
+		const char *temp_ext, const char *backup_ext)
+{
+	size_t size = 0;
+	void *bin = obs_data_get_binary(data, &size);
+	bool success = false;
+
+	if (bin) {
+		success = os_quick_write_file_safe(file, bin, size, temp_ext,
+				backup_ext);
+		bfree(bin);
+	}
+
+	return success;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -632,21 +1947,24 @@ obs_data_t *obs_data_create()
 obs_data_t *obs_data_create_from_json(const char *json_string)
 {
 	obs_data_t *data = obs_data_create();
+	struct json_reader reader = {0};
 
-	json_error_t error;
-	json_t *root = json_loads(json_string, JSON_REJECT_DUPLICATES, &error);
+	if (!json_string)
+		json_string = "";
 
-	if (root) {
-		obs_data_add_json_object_data(data, root);
-		json_decref(root);
-	} else {
+	reader.start = json_string;
+	reader.pos   = json_string;
+
+	if (!json_read_root(&reader, data)) {
 		blog(LOG_ERROR, "obs-data.c: [obs_data_create_from_json] "
 		                "Failed reading json string (%d): %s",
-		                error.line, error.text);
+		                json_error_line(&reader), reader.error);
 		obs_data_release(data);
 		data = NULL;
 	}
 
+	dstr_free(&reader.key);
+	dstr_free(&reader.str);
 	return data;
 }
 
@@ -705,12 +2023,16 @@ static inline void obs_data_destroy(struct obs_data *data)
 
 	while (item) {
 		struct obs_data_item *next = item->next;
+
+		/* items still referenced elsewhere outlive the object, so
+		 * make sure they no longer point back to it */
+		item->parent = NULL;
 		obs_data_item_release(&item);
 		item = next;
 	}
 
-	/* NOTE: don't use bfree for json text, allocated by json */
-	free(data->json);
+	bfree(data->hash_table);
+	bfree(data->json);
 	bfree(data);
 }
 
@@ -724,15 +2046,14 @@ void obs_data_release(obs_data_t *data)
 
 const char *obs_data_get_json(obs_data_t *data)
 {
+	struct dstr json = {0};
+
 	if (!data) return NULL;
 
-	/* NOTE: don't use libobs bfree for json text */
-	free(data->json);
-	data->json = NULL;
+	bfree(data->json);
 
-	json_t *root = obs_data_to_json(data);
-	data->json = json_dumps(root, JSON_PRESERVE_ORDER | JSON_INDENT(4));
-	json_decref(root);
+	json_write_obj(&json, data, 0);
+	data->json = json.array;
 
 	return data->json;
 }
@@ -766,6 +2087,11 @@ static struct obs_data_item *get_item(struct obs_data *data, const char *name)
 {
 	if (!data) return NULL;
 
+	if (data->hash_table) {
+		size_t idx = hash_find_slot(data, name, hash_item_name(name));
+		return data->hash_table[idx];
+	}
+
 	struct obs_data_item *item = data->first_item;
 
 	while (item) {
@@ -786,33 +2112,21 @@ static void set_item_data(struct obs_data *data, struct obs_data_item **item,
 	obs_data_item_t *new_item = NULL;
 
 	if ((!item || (item && !*item)) && data) {
+		struct obs_data_item *prev = NULL;
+		struct obs_data_item *next = data->first_item;
+
 		new_item = obs_data_item_create(name, ptr, size, type,
 				default_data, autoselect_data);
+		if (!new_item)
+			return;
 
-		obs_data_item_t *prev = obs_data_first(data);
-		obs_data_item_t *next = obs_data_first(data);
-		obs_data_item_next(&next);
-		for (; prev && next; obs_data_item_next(&prev),
-				obs_data_item_next(&next)) {
-			if (strcmp(get_item_name(next), name) > 0)
-				break;
+		/* items are kept sorted by name */
+		while (next && strcmp(get_item_name(next), name) < 0) {
+			prev = next;
+			next = next->next;
 		}
 
-		new_item->parent = data;
-		if (prev && strcmp(get_item_name(prev), name) < 0) {
-			prev->next     = new_item;
-			new_item->next = next;
-
-		} else {
-			data->first_item = new_item;
-			new_item->next   = prev;
-		}
-
-		if (!prev)
-			data->first_item = new_item;
-
-		obs_data_item_release(&prev);
-		obs_data_item_release(&next);
+		obs_data_item_attach(data, prev, new_item);
 
 	} else if (default_data) {
 		obs_data_item_set_default_data(item, ptr, size, type);
@@ -16,9 +16,12 @@
 ******************************************************************************/
 
 #include "graphics/vec4.h"
+#include "util/profiler.h"
 #include "obs.h"
 #include "obs-internal.h"
 
+static volatile long display_counter = 0;
+
 bool obs_display_init(struct obs_display *display,
 		const struct gs_init_data *graphics_data)
 {
@@ -47,6 +50,7 @@ bool obs_display_init(struct obs_display *display,
 	}
 
 	display->enabled = true;
+	display->visible = true;
 	return true;
 }
 
@@ -58,6 +62,9 @@ obs_display_t *obs_display_create(const struct gs_init_data *graphics_data,
 	gs_enter_context(obs->video.graphics);
 
 	display->background_color = background_color;
+	display->profile_name = profile_store_name(
+			obs_get_profiler_name_store(), "render_display(%ld)",
+			os_atomic_inc_long(&display_counter));
 
 	if (!obs_display_init(display, graphics_data)) {
 		obs_display_destroy(display);
@@ -232,3 +239,25 @@ void obs_display_set_background_color(obs_display_t *display, uint32_t color)
 	if (display)
 		display->background_color = color;
 }
+
+void obs_display_set_visible(obs_display_t *display, bool visible)
+{
+	if (display)
+		os_atomic_set_bool(&display->visible, visible);
+}
+
+bool obs_display_visible(obs_display_t *display)
+{
+	return display ? os_atomic_load_bool(&display->visible) : false;
+}
+
+void obs_display_set_max_fps(obs_display_t *display, uint32_t fps)
+{
+	if (display)
+		os_atomic_set_long(&display->max_fps, (long)fps);
+}
+
+uint32_t obs_display_get_max_fps(obs_display_t *display)
+{
+	return display ? (uint32_t)os_atomic_load_long(&display->max_fps) : 0;
+}
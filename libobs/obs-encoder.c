@@ -182,7 +182,8 @@ static inline bool has_scaling(const struct obs_encoder *encoder)
 static inline bool gpu_encode_available(const struct obs_encoder *encoder)
 {
     return (encoder->info.caps & OBS_ENCODER_CAP_PASS_TEXTURE) != 0 &&
-		obs->video.using_nv12_tex;
+		obs->video.using_nv12_tex &&
+		encoder->media == obs->video.video;
 }
 
 static void add_connection(struct obs_encoder *encoder)
@@ -252,6 +253,7 @@ static void obs_encoder_actually_destroy(obs_encoder_t *encoder)
 		if (encoder->context.data)
 			encoder->info.destroy(encoder->context.data);
 		da_free(encoder->callbacks);
+		da_free(encoder->pending_latency);
 		pthread_mutex_destroy(&encoder->init_mutex);
 		pthread_mutex_destroy(&encoder->callbacks_mutex);
 		pthread_mutex_destroy(&encoder->outputs_mutex);
@@ -498,6 +500,7 @@ void obs_encoder_shutdown(obs_encoder_t *encoder)
 		encoder->first_received  = false;
 		encoder->offset_usec     = 0;
 		encoder->start_ts        = 0;
+		da_resize(encoder->pending_latency, 0);
 	}
 	pthread_mutex_unlock(&encoder->init_mutex);
 }
@@ -875,8 +878,47 @@ void send_off_encoder_packet(obs_encoder_t *encoder, bool success,
 	}
 }
 
+/* frames whose packets never come out (dropped by the encoder) would
+ * otherwise accumulate */
+#define MAX_PENDING_LATENCY 64
+
+static inline void push_pending_latency(struct obs_encoder *encoder,
+		const struct encoder_frame *frame,
+		const struct video_latency_stamps *latency)
+{
+	struct encoder_pending_latency pending;
+
+	if (encoder->pending_latency.num == MAX_PENDING_LATENCY)
+		da_erase(encoder->pending_latency, 0);
+
+	pending.pts = frame->pts;
+	pending.latency = *latency;
+	pending.latency.encode_submit = os_gettime_ns();
+	da_push_back(encoder->pending_latency, &pending);
+}
+
+static inline bool pop_pending_latency(struct obs_encoder *encoder,
+		const struct encoder_packet *pkt,
+		struct video_latency_stamps *latency)
+{
+	for (size_t i = 0; i < encoder->pending_latency.num; i++) {
+		struct encoder_pending_latency *pending =
+			encoder->pending_latency.array + i;
+
+		if (pending->pts == pkt->pts) {
+			*latency = pending->latency;
+			latency->encode_complete = os_gettime_ns();
+			da_erase(encoder->pending_latency, i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static const char *do_encode_name = "do_encode";
-void do_encode(struct obs_encoder *encoder, struct encoder_frame *frame)
+void do_encode(struct obs_encoder *encoder, struct encoder_frame *frame,
+		const struct video_latency_stamps *latency)
 {
 	profile_start(do_encode_name);
 	if (!encoder->profile_encoder_encode_name)
@@ -885,6 +927,7 @@ void do_encode(struct obs_encoder *encoder, struct encoder_frame *frame)
 					"encode(%s)", encoder->context.name);
 
 	struct encoder_packet pkt = {0};
+	struct video_latency_stamps pkt_latency;
 	bool received = false;
 	bool success;
 
@@ -892,11 +935,22 @@ void do_encode(struct obs_encoder *encoder, struct encoder_frame *frame)
 	pkt.timebase_den = encoder->timebase_den;
 	pkt.encoder = encoder;
 
+	if (latency && latency->render)
+		push_pending_latency(encoder, frame, latency);
+
 	profile_start(encoder->profile_encoder_encode_name);
 	success = encoder->info.encode(encoder->context.data, frame, &pkt,
 			&received);
 	profile_end(encoder->profile_encoder_encode_name);
+
+	/* the stamps are handed to the outputs while they receive the
+	 * packet, see output_packet_received in obs-output.c */
+	if (success && received && encoder->pending_latency.num &&
+	    pop_pending_latency(encoder, &pkt, &pkt_latency))
+		encoder->packet_latency = &pkt_latency;
+
 	send_off_encoder_packet(encoder, success, received, &pkt);
+	encoder->packet_latency = NULL;
 
 	profile_end(do_encode_name);
 }
@@ -909,6 +963,7 @@ static void receive_video(void *param, struct video_data *frame)
 	struct obs_encoder    *encoder  = param;
 	struct obs_encoder    *pair     = encoder->paired_encoder;
 	struct encoder_frame  enc_frame;
+	struct video_latency_stamps latency = {0};
 
 	if (!encoder->first_received && pair) {
 		if (!pair->first_received ||
@@ -927,10 +982,13 @@ static void receive_video(void *param, struct video_data *frame)
 	if (!encoder->start_ts)
 		encoder->start_ts = frame->timestamp;
 
-	enc_frame.frames = 1;
-	enc_frame.pts    = encoder->cur_pts;
+	enc_frame.frames  = 1;
+	enc_frame.pts     = encoder->cur_pts;
+
+	if (os_atomic_load_bool(&obs->video.latency_tracking))
+		video_output_get_frame_latency(encoder->media, &latency);
 
-	do_encode(encoder, &enc_frame);
+	do_encode(encoder, &enc_frame, &latency);
 
 	encoder->cur_pts += encoder->timebase_num;
 
@@ -1058,7 +1116,7 @@ static void send_audio_data(struct obs_encoder *encoder)
 	enc_frame.frames = (uint32_t)encoder->framesize;
 	enc_frame.pts    = encoder->cur_pts;
 
-	do_encode(encoder, &enc_frame);
+	do_encode(encoder, &enc_frame, NULL);
 
 	encoder->cur_pts += encoder->framesize;
 }
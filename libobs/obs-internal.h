@@ -24,6 +24,7 @@
 #include "util/threading.h"
 #include "util/platform.h"
 #include "util/profiler.h"
+#include "util/metrics.h"
 #include "callback/signal.h"
 #include "callback/proc.h"
 
@@ -37,6 +38,7 @@
 #include "obs.h"
 
 #define NUM_TEXTURES 2
+#define NUM_COPY_SURFACES 4
 #define MICROSECOND_DEN 1000000
 #define NUM_ENCODE_TEXTURES 3
 #define NUM_ENCODE_TEXTURE_FRAMES_TO_WAIT 1
@@ -203,7 +205,12 @@ extern void obs_view_free(struct obs_view *view);
 struct obs_display {
 	bool                            size_changed;
 	bool                            enabled;
+	volatile bool                   visible;
 	uint32_t                        cx, cy;
+	volatile long                   max_fps;
+	uint64_t                        last_render_time;
+	bool                            deferred;
+	const char                      *profile_name;
 	uint32_t                        background_color;
 	gs_swapchain_t                  *swap;
 	pthread_mutex_t                 draw_callbacks_mutex;
@@ -225,6 +232,9 @@ extern void obs_display_free(struct obs_display *display);
 struct obs_vframe_info {
 	uint64_t timestamp;
 	int count;
+
+	uint64_t capture_ts;
+	uint64_t render_ts;
 };
 
 struct obs_tex_frame {
@@ -237,16 +247,47 @@ struct obs_tex_frame {
 	bool released;
 };
 
+/* staging surfaces may stay mapped while video outputs still reference
+ * their data, so there are more of them than there are render textures */
+struct obs_copy_surface {
+	gs_stagesurf_t                  *surface;
+	bool                            copied;
+	bool                            mapped;
+	volatile bool                   referenced;
+};
+
+struct obs_scaled_video_input {
+	void (*callback)(void *param, struct video_data *frame);
+	void *param;
+};
+
+/* an additional video output at a different resolution, which is scaled from
+ * the main texture on the GPU and shared by every raw video consumer that
+ * requests that resolution */
+struct obs_scaled_video {
+	video_t                         *video;
+	uint32_t                        width;
+	uint32_t                        height;
+	gs_texture_t                    *textures[NUM_TEXTURES];
+	gs_stagesurf_t                  *surfaces[NUM_TEXTURES];
+	bool                            textures_output[NUM_TEXTURES];
+	bool                            textures_copied[NUM_TEXTURES];
+	struct circlebuf                vframe_info_buffer;
+	bool                            started;
+	DARRAY(struct obs_scaled_video_input) inputs;
+};
+
 struct obs_core_video {
 	graphics_t                      *graphics;
-	gs_stagesurf_t                  *copy_surfaces[NUM_TEXTURES];
+	struct obs_copy_surface         copy_surfaces[NUM_COPY_SURFACES];
+	int                             cur_copy_surface;
+	int                             prev_copy_surface;
 	gs_texture_t                    *render_textures[NUM_TEXTURES];
 	gs_texture_t                    *output_textures[NUM_TEXTURES];
 	gs_texture_t                    *convert_textures[NUM_TEXTURES];
 	gs_texture_t                    *convert_uv_textures[NUM_TEXTURES];
 	bool                            textures_rendered[NUM_TEXTURES];
 	bool                            textures_output[NUM_TEXTURES];
-	bool                            textures_copied[NUM_TEXTURES];
 	bool                            textures_converted[NUM_TEXTURES];
 	bool                            using_nv12_tex;
 	struct circlebuf                vframe_info_buffer;
@@ -263,10 +304,12 @@ struct obs_core_video {
 	gs_effect_t                     *bilinear_lowres_effect;
 	gs_effect_t                     *premultiplied_alpha_effect;
 	gs_samplerstate_t               *point_sampler;
-	gs_stagesurf_t                  *mapped_surface;
 	int                             cur_texture;
 	long                            raw_active;
+	long                            scaled_active;
 	long                            gpu_encoder_active;
+	pthread_mutex_t                 scaled_videos_mutex;
+	DARRAY(struct obs_scaled_video*) scaled_videos;
 	pthread_mutex_t                 gpu_encoder_mutex;
 	struct circlebuf                gpu_encoder_queue;
 	struct circlebuf                gpu_encoder_avail_queue;
@@ -279,6 +322,26 @@ struct obs_core_video {
 
 	uint64_t                        video_time;
 	uint64_t                        video_avg_frame_time_ns;
+	uint64_t                        latency_capture_ts;
+	uint64_t                        latency_render_ts;
+	metric_t                        *render_time_metric;
+	metric_t                        *download_time_metric;
+	metric_t                        *lagged_frames_metric;
+	metric_t                        *culled_items_metric;
+	metric_t                        *frame_jitter_metric;
+	metric_t                        *texture_pool_used_metric;
+	metric_t                        *texture_pool_free_metric;
+
+	uint64_t                        pacing_spin_ns;
+	volatile long                   frame_jitter[OBS_FRAME_JITTER_BUCKETS];
+
+	volatile bool                   scene_culling;
+	volatile bool                   latency_tracking;
+	volatile bool                   deferred_displays;
+	uint32_t                        culled_items;
+	uint32_t                        last_culled_items;
+	uint64_t                        total_draw_calls;
+	uint32_t                        last_draw_calls;
 	double                          video_fps;
 	video_t                         *video;
 	pthread_t                       video_thread;
@@ -326,6 +389,7 @@ struct obs_core_audio {
 	struct circlebuf                buffered_timestamps;
 	int                             buffering_wait_ticks;
 	int                             total_buffering_ticks;
+	metric_t                        *buffering_metric;
 
 	float                           user_volume;
 
@@ -340,12 +404,14 @@ struct obs_core_data {
 	struct obs_source               *first_source;
 	struct obs_source               *first_audio_source;
 	struct obs_display              *first_display;
+	struct obs_canvas               *first_canvas;
 	struct obs_output               *first_output;
 	struct obs_encoder              *first_encoder;
 	struct obs_service              *first_service;
 
 	pthread_mutex_t                 sources_mutex;
 	pthread_mutex_t                 displays_mutex;
+	pthread_mutex_t                 canvases_mutex;
 	pthread_mutex_t                 outputs_mutex;
 	pthread_mutex_t                 encoders_mutex;
 	pthread_mutex_t                 services_mutex;
@@ -420,6 +486,17 @@ struct obs_core {
 	bool                            name_store_owned;
 	profiler_name_store_t           *name_store;
 
+	/* video and audio are paced by a virtual clock rather than by the
+	 * system clock, see obs_set_offline_clock */
+	bool                            offline_clock;
+
+	/* source of video revisions, see obs_bump_video_revision */
+	volatile long                   video_revision_counter;
+
+	/* see obs_set_thread_priority/obs_set_precise_frame_pacing */
+	volatile long                   thread_priority;
+	volatile bool                   precise_pacing;
+
 	/* segmented into multiple sub-structures to keep things a bit more
 	 * clean and organized */
 	struct obs_core_video           video;
@@ -446,6 +523,33 @@ extern void stop_raw_video(video_t *video,
 		void (*callback)(void *param, struct video_data *frame),
 		void *param);
 
+/* ------------------------------------------------------------------------- */
+/* canvases */
+
+struct obs_canvas {
+	char                            *name;
+	uint32_t                        width;
+	uint32_t                        height;
+	uint32_t                        fps_divisor;
+	struct obs_view                 view;
+	video_t                         *video;
+
+	gs_texture_t                    *render_texture;
+	gs_texture_t                    *output_texture;
+	gs_stagesurf_t                  *copy_surfaces[NUM_TEXTURES];
+	bool                            textures_copied[NUM_TEXTURES];
+	struct obs_vframe_info          vframe_info[NUM_TEXTURES];
+	int                             cur_texture;
+	uint64_t                        next_frame_ts;
+
+	struct obs_canvas               *next;
+	struct obs_canvas               **prev_next;
+};
+
+/* unlinks and destroys the canvas even if its video output is still in use */
+extern void obs_canvas_free(struct obs_canvas *canvas);
+
+
 /* ------------------------------------------------------------------------- */
 /* obs shared context data */
 
@@ -537,6 +641,9 @@ struct async_frame {
 	struct obs_source_frame *frame;
 	long unused_count;
 	bool used;
+
+	/* when the source output the frame, for latency stats */
+	uint64_t received_ts;
 };
 
 enum audio_action_type {
@@ -653,6 +760,7 @@ struct obs_source {
 	bool                            async_flip;
 	bool                            async_active;
 	bool                            async_update_texture;
+	metric_t                        *async_frames_metric;
 	bool                            async_unbuffered;
 	bool                            async_decoupled;
 	struct obs_source_frame         *async_preload_frame;
@@ -666,6 +774,18 @@ struct obs_source {
 	uint32_t                        async_convert_width;
 	uint32_t                        async_convert_height;
 
+	/* frames are copied to the async texture's upload buffer by the
+	 * thread that outputs them if the renderer supports it */
+	pthread_mutex_t                 async_upload_mutex;
+	gs_texture_t                    *async_upload_tex;
+	uint8_t                         *async_upload_ptr;
+	uint32_t                        async_upload_linesize;
+	uint32_t                        async_upload_rows;
+	uint32_t                        async_upload_width;
+	uint32_t                        async_upload_height;
+	enum video_format               async_upload_format;
+	struct obs_source_frame         *async_upload_frame;
+
 	/* async video deinterlacing */
 	uint64_t                        deinterlace_offset;
 	uint64_t                        deinterlace_frame_ts;
@@ -687,6 +807,11 @@ struct obs_source {
 	enum obs_allow_direct_render    allow_direct;
 	bool                            rendering_filter;
 
+	/* render cache for cacheable sources with filters */
+	volatile long                   video_revision;
+	gs_texrender_t                  *filter_cache;
+	long                            filter_cache_revision;
+
 	/* sources specific hotkeys */
 	obs_hotkey_pair_id              mute_unmute_key;
 	obs_hotkey_id                   push_to_mute_key;
@@ -790,6 +915,27 @@ static inline enum gs_color_format convert_video_format(
 	return GS_BGRX;
 }
 
+/* applies the priority set with obs_set_thread_priority to the calling
+ * thread if it changed since the last call */
+static inline void obs_update_thread_priority(long *cur_priority)
+{
+	long priority = os_atomic_load_long(&obs->thread_priority);
+
+	if (priority != *cur_priority) {
+		if (!os_set_thread_priority((enum os_thread_priority)priority))
+			blog(LOG_WARNING, "Failed to set thread priority %ld",
+					priority);
+		*cur_priority = priority;
+	}
+}
+
+/* upper limits of the frame jitter histogram buckets, in obs-video.c */
+extern const uint64_t obs_frame_jitter_limits[OBS_FRAME_JITTER_BUCKETS];
+
+extern void obs_bump_video_revision(volatile long *revision);
+extern long obs_source_get_video_revision(obs_source_t *source);
+extern long obs_scene_get_video_revision(obs_scene_t *scene);
+
 extern void obs_source_activate(obs_source_t *source, enum view_type type);
 extern void obs_source_deactivate(obs_source_t *source, enum view_type type);
 extern void obs_source_video_tick(obs_source_t *source, float seconds);
@@ -847,6 +993,25 @@ struct caption_text {
 	struct caption_text *next;
 };
 
+/* histogram of latencies in microseconds, in the same layout as metric
+ * histograms (see metric_get_bucket), up to UINT32_MAX us */
+#define LATENCY_BUCKETS     (METRIC_SUB_BUCKETS * 29)
+
+/* latency stamps of a video packet the output has received, until it's been
+ * sent.  keyed on the system dts, which interleaving leaves untouched */
+struct output_pending_latency {
+	int64_t                         sys_dts_usec;
+	struct video_latency_stamps     latency;
+};
+
+struct latency_histogram {
+	uint32_t                        buckets[LATENCY_BUCKETS];
+	uint64_t                        count;
+	uint64_t                        total_us;
+	uint64_t                        min_us;
+	uint64_t                        max_us;
+};
+
 struct obs_output {
 	struct obs_context_data         context;
 	struct obs_output_info          info;
@@ -919,6 +1084,10 @@ struct obs_output {
 	volatile bool                   delay_capturing;
 
 	char                            *last_error_message;
+
+	pthread_mutex_t                 latency_mutex;
+	struct latency_histogram        latency[OBS_LATENCY_STAGE_COUNT];
+	DARRAY(struct output_pending_latency) pending_latency;
 };
 
 static inline void do_output_signal(struct obs_output *output,
@@ -931,6 +1100,8 @@ static inline void do_output_signal(struct obs_output *output,
 }
 
 extern void process_delay(void *data, struct encoder_packet *packet);
+extern void output_packet_received(struct obs_output *output,
+		const struct encoder_packet *packet);
 extern void obs_output_cleanup_delay(obs_output_t *output);
 extern bool obs_output_delay_start(obs_output_t *output);
 extern void obs_output_delay_stop(obs_output_t *output);
@@ -962,6 +1133,13 @@ struct encoder_callback {
 	void *param;
 };
 
+/* latency stamps of a video frame waiting for its packet, which can come out
+ * of the encoder frames later/out of order */
+struct encoder_pending_latency {
+	int64_t                         pts;
+	struct video_latency_stamps     latency;
+};
+
 struct obs_encoder {
 	struct obs_context_data         context;
 	struct obs_encoder_info         info;
@@ -1021,6 +1199,11 @@ struct obs_encoder {
 	DARRAY(struct encoder_callback) callbacks;
 
 	const char                      *profile_encoder_encode_name;
+
+	DARRAY(struct encoder_pending_latency) pending_latency;
+
+	/* stamps of the packet being passed to the callbacks, or NULL */
+	const struct video_latency_stamps *packet_latency;
 };
 
 extern struct obs_encoder_info *find_encoder(const char *id);
@@ -1043,7 +1226,8 @@ extern void obs_encoder_remove_output(struct obs_encoder *encoder,
 extern bool start_gpu_encode(obs_encoder_t *encoder);
 extern void stop_gpu_encode(obs_encoder_t *encoder);
 
-extern void do_encode(struct obs_encoder *encoder, struct encoder_frame *frame);
+extern void do_encode(struct obs_encoder *encoder, struct encoder_frame *frame,
+		const struct video_latency_stamps *latency);
 extern void send_off_encoder_packet(obs_encoder_t *encoder, bool success,
 		bool received, struct encoder_packet *pkt);
 
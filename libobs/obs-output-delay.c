@@ -117,6 +117,7 @@ void process_delay(void *data, struct encoder_packet *packet)
 {
 	struct obs_output *output = data;
 	uint64_t t = os_gettime_ns();
+	output_packet_received(output, packet);
 	push_packet(output, packet, t);
 	while (pop_packet(output, t));
 }
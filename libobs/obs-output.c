@@ -105,6 +105,7 @@ obs_output_t *obs_output_create(const char *id, const char *name,
 	pthread_mutex_init_value(&output->interleaved_mutex);
 	pthread_mutex_init_value(&output->delay_mutex);
 	pthread_mutex_init_value(&output->caption_mutex);
+	pthread_mutex_init_value(&output->latency_mutex);
 
 	if (pthread_mutex_init(&output->interleaved_mutex, NULL) != 0)
 		goto fail;
@@ -112,6 +113,8 @@ obs_output_t *obs_output_create(const char *id, const char *name,
 		goto fail;
 	if (pthread_mutex_init(&output->caption_mutex, NULL) != 0)
 		goto fail;
+	if (pthread_mutex_init(&output->latency_mutex, NULL) != 0)
+		goto fail;
 	if (os_event_init(&output->stopping_event, OS_EVENT_TYPE_MANUAL) != 0)
 		goto fail;
 	if (!init_output_handlers(output, name, settings, hotkey_data))
@@ -206,7 +209,9 @@ void obs_output_destroy(obs_output_t *output)
 		os_event_destroy(output->stopping_event);
 		pthread_mutex_destroy(&output->caption_mutex);
 		pthread_mutex_destroy(&output->interleaved_mutex);
+		pthread_mutex_destroy(&output->latency_mutex);
 		pthread_mutex_destroy(&output->delay_mutex);
+		da_free(output->pending_latency);
 		os_event_destroy(output->reconnect_stop_event);
 		obs_context_data_free(&output->context);
 		circlebuf_free(&output->delay_data);
@@ -235,6 +240,11 @@ bool obs_output_actual_start(obs_output_t *output)
 		output->last_error_message = NULL;
 	}
 
+	pthread_mutex_lock(&output->latency_mutex);
+	memset(output->latency, 0, sizeof(output->latency));
+	da_resize(output->pending_latency, 0);
+	pthread_mutex_unlock(&output->latency_mutex);
+
 	if (output->context.data)
 		success = output->info.start(output->context.data);
 
@@ -397,7 +407,7 @@ void obs_output_stop(obs_output_t *output)
 
 	} else if (!stopping(output)) {
 		do_output_signal(output, "stopping");
-		obs_output_actual_stop(output, false, os_gettime_ns());
+		obs_output_actual_stop(output, false, obs_gettime_ns());
 	}
 }
 
@@ -1049,6 +1059,211 @@ static bool add_caption(struct obs_output *output, struct encoder_packet *out)
 }
 #endif
 
+/* ------------------------------------------------------------------------- */
+/* End-to-end latency */
+
+static inline void add_latency(struct latency_histogram *hist, uint64_t usec)
+{
+	if (!hist->count || usec < hist->min_us)
+		hist->min_us = usec;
+	if (usec > hist->max_us)
+		hist->max_us = usec;
+
+	/* the histogram stops at 2^32 us, which is over an hour */
+	if (usec > UINT32_MAX)
+		usec = UINT32_MAX;
+
+	hist->buckets[metric_get_bucket(usec)]++;
+	hist->total_us += usec;
+	hist->count++;
+}
+
+static inline uint64_t latency_origin(const struct video_latency_stamps *l)
+{
+	return l->capture ? l->capture : l->render;
+}
+
+static void record_latency(struct obs_output *output,
+		const struct video_latency_stamps *latency,
+		enum obs_latency_stage first, enum obs_latency_stage last)
+{
+	const uint64_t stamps[OBS_LATENCY_STAGE_COUNT] = {
+		[OBS_LATENCY_RENDER]          = latency->capture ?
+			latency->render : 0,
+		[OBS_LATENCY_CONVERT]         = latency->convert,
+		[OBS_LATENCY_ENCODE_SUBMIT]   = latency->encode_submit,
+		[OBS_LATENCY_ENCODE_COMPLETE] = latency->encode_complete,
+		[OBS_LATENCY_INTERLEAVE]      = latency->interleave,
+		[OBS_LATENCY_SEND]            = latency->send,
+	};
+	uint64_t origin = latency_origin(latency);
+
+	if (!origin)
+		return;
+
+	for (int i = first; i <= (int)last; i++) {
+		if (stamps[i] >= origin)
+			add_latency(&output->latency[i],
+					(stamps[i] - origin) / 1000);
+	}
+}
+
+/* enough for a long stream delay; packets that are never delivered or sent
+ * are normally dropped as soon as a later one is */
+#define MAX_PENDING_LATENCY 4096
+
+/* picks up the stamps the encoder attached to a video packet while it's
+ * being passed to the output's callbacks */
+void output_packet_received(struct obs_output *output,
+		const struct encoder_packet *packet)
+{
+	struct output_pending_latency pending;
+	const struct video_latency_stamps *latency;
+
+	if (packet->type != OBS_ENCODER_VIDEO || !packet->encoder)
+		return;
+
+	latency = packet->encoder->packet_latency;
+	if (!latency || !latency->render)
+		return;
+
+	pending.sys_dts_usec = packet->sys_dts_usec;
+	pending.latency = *latency;
+
+	pthread_mutex_lock(&output->latency_mutex);
+	if (output->pending_latency.num == MAX_PENDING_LATENCY)
+		da_erase(output->pending_latency, 0);
+	da_push_back(output->pending_latency, &pending);
+	pthread_mutex_unlock(&output->latency_mutex);
+}
+
+static size_t find_pending_latency(struct obs_output *output,
+		const struct encoder_packet *packet)
+{
+	for (size_t i = 0; i < output->pending_latency.num; i++) {
+		struct output_pending_latency *pending =
+			output->pending_latency.array + i;
+
+		if (pending->sys_dts_usec == packet->sys_dts_usec)
+			return i;
+	}
+
+	return DARRAY_INVALID;
+}
+
+/* stamps a video packet as it's handed to the output */
+static void packet_delivered(struct obs_output *output,
+		const struct encoder_packet *packet)
+{
+	struct video_latency_stamps *latency;
+	size_t idx;
+
+	if (packet->type != OBS_ENCODER_VIDEO)
+		return;
+
+	pthread_mutex_lock(&output->latency_mutex);
+
+	idx = find_pending_latency(output, packet);
+	if (idx != DARRAY_INVALID) {
+		latency = &output->pending_latency.array[idx].latency;
+		latency->interleave = os_gettime_ns();
+		record_latency(output, latency, OBS_LATENCY_RENDER,
+				OBS_LATENCY_INTERLEAVE);
+
+		/* anything older was dropped before being delivered */
+		if (idx)
+			da_erase_range(output->pending_latency, 0, idx);
+	}
+
+	pthread_mutex_unlock(&output->latency_mutex);
+}
+
+void obs_output_packet_sent(obs_output_t *output,
+		const struct encoder_packet *packet)
+{
+	struct video_latency_stamps *latency;
+	size_t idx;
+
+	if (!obs_output_valid(output, "obs_output_packet_sent"))
+		return;
+	if (!obs_ptr_valid(packet, "obs_output_packet_sent"))
+		return;
+	if (packet->type != OBS_ENCODER_VIDEO)
+		return;
+
+	pthread_mutex_lock(&output->latency_mutex);
+
+	idx = find_pending_latency(output, packet);
+	if (idx != DARRAY_INVALID) {
+		latency = &output->pending_latency.array[idx].latency;
+		latency->send = os_gettime_ns();
+		record_latency(output, latency, OBS_LATENCY_SEND,
+				OBS_LATENCY_SEND);
+
+		/* anything older was dropped before being sent */
+		da_erase_range(output->pending_latency, 0, idx + 1);
+	}
+
+	pthread_mutex_unlock(&output->latency_mutex);
+}
+
+static uint64_t get_latency_percentile(const struct latency_histogram *hist,
+		double percentile)
+{
+	uint64_t target = (uint64_t)((double)hist->count * percentile);
+	uint64_t total = 0;
+	uint64_t val;
+
+	for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+		total += hist->buckets[i];
+		if (total > target) {
+			val = metric_get_bucket_value(i);
+			if (val < hist->min_us) val = hist->min_us;
+			if (val > hist->max_us) val = hist->max_us;
+			return val;
+		}
+	}
+
+	return hist->max_us;
+}
+
+bool obs_output_get_latency_stats(obs_output_t *output,
+		struct obs_output_latency_stats *stats)
+{
+	bool found = false;
+
+	if (!obs_output_valid(output, "obs_output_get_latency_stats"))
+		return false;
+	if (!obs_ptr_valid(stats, "obs_output_get_latency_stats"))
+		return false;
+
+	memset(stats, 0, sizeof(*stats));
+
+	pthread_mutex_lock(&output->latency_mutex);
+
+	for (size_t i = 0; i < OBS_LATENCY_STAGE_COUNT; i++) {
+		const struct latency_histogram *hist = &output->latency[i];
+		struct obs_latency_stage_stats *stage = &stats->stages[i];
+
+		if (!hist->count)
+			continue;
+
+		stage->count   = hist->count;
+		stage->min_ms  = hist->min_us / 1000.0;
+		stage->max_ms  = hist->max_us / 1000.0;
+		stage->mean_ms = (double)hist->total_us / hist->count / 1000.0;
+		stage->p50_ms  = get_latency_percentile(hist, 0.50) / 1000.0;
+		stage->p95_ms  = get_latency_percentile(hist, 0.95) / 1000.0;
+		stage->p99_ms  = get_latency_percentile(hist, 0.99) / 1000.0;
+		found = true;
+	}
+
+	pthread_mutex_unlock(&output->latency_mutex);
+	return found;
+}
+
+/* ------------------------------------------------------------------------- */
+
 static inline void send_interleaved(struct obs_output *output)
 {
 	struct encoder_packet out = output->interleaved_packets.array[0];
@@ -1088,6 +1303,7 @@ static inline void send_interleaved(struct obs_output *output)
 #endif
 	}
 
+	packet_delivered(output, &out);
 	output->info.encoded_packet(output->context.data, &out);
 	obs_encoder_packet_release(&out);
 }
@@ -1429,15 +1645,18 @@ static void interleave_packets(void *data, struct encoder_packet *packet)
 
 	if (packet->type == OBS_ENCODER_AUDIO)
 		packet->track_idx = get_track_index(output, packet);
+	if (!output->active_delay_ns)
+		output_packet_received(output, packet);
 
-	pthread_mutex_lock(&output->interleaved_mutex);
+	os_mutex_lock_named(&output->interleaved_mutex, "interleaved_mutex");
 
 	/* if first video frame is not a keyframe, discard until received */
 	if (!output->received_video &&
 	    packet->type == OBS_ENCODER_VIDEO &&
 	    !packet->keyframe) {
 		discard_unused_audio_packets(output, packet->dts_usec);
-		pthread_mutex_unlock(&output->interleaved_mutex);
+		os_mutex_unlock_named(&output->interleaved_mutex,
+				"interleaved_mutex");
 
 		if (output->active_delay_ns)
 			obs_encoder_packet_release(packet);
@@ -1474,7 +1693,7 @@ static void interleave_packets(void *data, struct encoder_packet *packet)
 		}
 	}
 
-	pthread_mutex_unlock(&output->interleaved_mutex);
+	os_mutex_unlock_named(&output->interleaved_mutex, "interleaved_mutex");
 }
 
 static void default_encoded_callback(void *param, struct encoder_packet *packet)
@@ -1484,7 +1703,10 @@ static void default_encoded_callback(void *param, struct encoder_packet *packet)
 	if (data_active(output)) {
 		if (packet->type == OBS_ENCODER_AUDIO)
 			packet->track_idx = get_track_index(output, packet);
+		if (!output->active_delay_ns)
+			output_packet_received(output, packet);
 
+		packet_delivered(output, packet);
 		output->info.encoded_packet(output->context.data, packet);
 
 		if (packet->type == OBS_ENCODER_VIDEO)
@@ -1572,9 +1794,11 @@ static void hook_data_capture(struct obs_output *output, bool encoded,
 	encoded_callback_t encoded_callback;
 
 	if (encoded) {
-		pthread_mutex_lock(&output->interleaved_mutex);
+		os_mutex_lock_named(&output->interleaved_mutex,
+				"interleaved_mutex");
 		reset_packet_data(output);
-		pthread_mutex_unlock(&output->interleaved_mutex);
+		os_mutex_unlock_named(&output->interleaved_mutex,
+				"interleaved_mutex");
 
 		encoded_callback = (has_video && has_audio) ?
 			interleave_packets : default_encoded_callback;
@@ -1764,10 +1988,10 @@ static bool begin_delayed_capture(obs_output_t *output)
 	if (delay_capturing(output))
 		return false;
 
-	pthread_mutex_lock(&output->interleaved_mutex);
+	os_mutex_lock_named(&output->interleaved_mutex, "interleaved_mutex");
 	reset_packet_data(output);
 	os_atomic_set_bool(&output->delay_capturing, true);
-	pthread_mutex_unlock(&output->interleaved_mutex);
+	os_mutex_unlock_named(&output->interleaved_mutex, "interleaved_mutex");
 
 	if (reconnecting(output)) {
 		signal_reconnect_success(output);
@@ -32,6 +32,8 @@ static void get_ungrouped_transform(obs_sceneitem_t *group,
 		float *rot);
 static inline bool crop_enabled(const struct obs_sceneitem_crop *crop);
 static inline bool item_texture_enabled(const struct obs_scene_item *item);
+static uint32_t scene_getwidth(void *data);
+static uint32_t scene_getheight(void *data);
 static void init_hotkeys(obs_scene_t *scene, obs_sceneitem_t *item,
 		const char *name);
 
@@ -96,6 +98,8 @@ static void *scene_create(obs_data_t *settings, struct obs_source *source)
 	signal_handler_add_array(obs_source_get_signal_handler(source),
 			obs_scene_signals);
 
+	obs_bump_video_revision(&scene->video_revision);
+
 	if (pthread_mutexattr_init(&attr) != 0)
 		goto fail;
 	if (pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE) != 0)
@@ -120,9 +124,11 @@ fail:
 	return NULL;
 }
 
-#define audio_lock(scene) pthread_mutex_lock(&scene->audio_mutex)
+#define audio_lock(scene) \
+	os_mutex_lock_named(&scene->audio_mutex, "scene_audio_mutex")
 #define video_lock(scene) pthread_mutex_lock(&scene->video_mutex)
-#define audio_unlock(scene) pthread_mutex_unlock(&scene->audio_mutex)
+#define audio_unlock(scene) \
+	os_mutex_unlock_named(&scene->audio_mutex, "scene_audio_mutex")
 #define video_unlock(scene) pthread_mutex_unlock(&scene->video_mutex)
 
 static inline void full_lock(struct obs_scene *scene)
@@ -180,6 +186,12 @@ static void scene_destroy(void *data)
 
 	remove_all_items(scene);
 
+	if (scene->render_cache) {
+		obs_enter_graphics();
+		gs_texrender_destroy(scene->render_cache);
+		obs_leave_graphics();
+	}
+
 	pthread_mutex_destroy(&scene->video_mutex);
 	pthread_mutex_destroy(&scene->audio_mutex);
 	bfree(scene);
@@ -224,8 +236,16 @@ static void scene_enum_all_sources(void *data,
 	scene_enum_sources(data, enum_callback, param, false);
 }
 
+static inline void scene_changed(struct obs_scene *scene)
+{
+	if (scene)
+		obs_bump_video_revision(&scene->video_revision);
+}
+
 static inline void detach_sceneitem(struct obs_scene_item *item)
 {
+	scene_changed(item->parent);
+
 	if (item->prev)
 		item->prev->next = item->next;
 	else
@@ -243,6 +263,8 @@ static inline void attach_sceneitem(struct obs_scene *parent,
 	item->prev   = prev;
 	item->parent = parent;
 
+	scene_changed(parent);
+
 	if (prev) {
 		item->next = prev->next;
 		if (prev->next)
@@ -413,9 +435,16 @@ static void update_item_transform(struct obs_scene_item *item, bool update_tex)
 	calldata_set_ptr(&params, "item", item);
 	signal_parent(item->parent, "item_transform", &params);
 
+	scene_changed(item->parent);
+
 	if (!update_tex)
 		return;
 
+	/* crop or scale filter may have changed */
+	item->render_revision = 0;
+	if (item->item_render)
+		gs_texrender_reset(item->item_render);
+
 	if (item->item_render && !item_texture_enabled(item)) {
 		obs_enter_graphics();
 		gs_texrender_destroy(item->item_render);
@@ -503,6 +532,15 @@ static void render_item_texture(struct obs_scene_item *item)
 		}
 	}
 
+	/* the default effect only needs the texture, so items drawn with it
+	 * can share draw calls with each other */
+	if (effect == obs->video.default_effect && type != OBS_SCALE_POINT) {
+		gs_sprite_batch_draw(effect, "Draw", tex,
+				os_atomic_load_long(&item->texture_version),
+				0, 0);
+		return;
+	}
+
 	while (gs_effect_loop(effect, "Draw"))
 		obs_source_draw(tex, 0, 0, 0, 0, 0);
 }
@@ -540,6 +578,13 @@ static inline void render_item(struct obs_scene_item *item)
 			obs_source_video_render(item->source);
 			gs_blend_state_pop();
 			gs_texrender_end(item->item_render);
+
+			/* textures of sources that don't change every frame can
+			 * be kept in the sprite atlas until they're rerendered */
+			if (item->render_revision)
+				obs_bump_video_revision(&item->texture_version);
+			else
+				os_atomic_set_long(&item->texture_version, 0);
 		}
 	}
 
@@ -553,6 +598,32 @@ static inline void render_item(struct obs_scene_item *item)
 	gs_matrix_pop();
 }
 
+long obs_scene_get_video_revision(obs_scene_t *scene)
+{
+	struct obs_scene_item *item;
+	long revision = os_atomic_load_long(&scene->video_revision);
+
+	video_lock(scene);
+
+	for (item = scene->first_item; item; item = item->next) {
+		long item_revision;
+
+		if (!item->user_visible)
+			continue;
+
+		item_revision = obs_source_get_video_revision(item->source);
+		if (!item_revision) {
+			revision = 0;
+			break;
+		}
+		if (item_revision > revision)
+			revision = item_revision;
+	}
+
+	video_unlock(scene);
+	return revision;
+}
+
 static void scene_video_tick(void *data, float seconds)
 {
 	struct obs_scene *scene = data;
@@ -561,8 +632,16 @@ static void scene_video_tick(void *data, float seconds)
 	video_lock(scene);
 	item = scene->first_item;
 	while (item) {
-		if (item->item_render)
-			gs_texrender_reset(item->item_render);
+		/* keep the item's texture while the source's output is known
+		 * to be the same as when the texture was rendered */
+		if (item->item_render) {
+			long revision = obs_source_get_video_revision(
+					item->source);
+
+			if (!revision || revision != item->render_revision)
+				gs_texrender_reset(item->item_render);
+			item->render_revision = revision;
+		}
 		item = item->next;
 	}
 	video_unlock(scene);
@@ -613,11 +692,272 @@ static void update_transforms_and_prune_sources(obs_scene_t *scene,
 		resize_group(group_sceneitem);
 }
 
+/* ------------------------------------------------------------------------- */
+/* occlusion culling */
+
+#define MAX_OCCLUDERS 8
+
+/* scaled rects that should line up can be off by float rounding */
+#define CULL_EPSILON 0.01f
+
+struct cull_rect {
+	float left, top, right, bottom;
+};
+
+/* the rect the item's pixels are actually drawn to, which can be smaller
+ * than its bounding box when the source is scaled to fit within it */
+static void get_item_rect(const struct obs_scene_item *item,
+		struct cull_rect *rect)
+{
+	float cx = (float)calc_cx(item, obs_source_get_width(item->source));
+	float cy = (float)calc_cy(item, obs_source_get_height(item->source));
+	const float corners[4][2] = {{0, 0}, {cx, 0}, {0, cy}, {cx, cy}};
+
+	for (size_t i = 0; i < 4; i++) {
+		struct vec3 pos;
+
+		vec3_set(&pos, corners[i][0], corners[i][1], 0.0f);
+		vec3_transform(&pos, &pos, &item->draw_transform);
+
+		if (i == 0 || pos.x < rect->left)   rect->left   = pos.x;
+		if (i == 0 || pos.x > rect->right)  rect->right  = pos.x;
+		if (i == 0 || pos.y < rect->top)    rect->top    = pos.y;
+		if (i == 0 || pos.y > rect->bottom) rect->bottom = pos.y;
+	}
+}
+
+static inline bool rect_contains(const struct cull_rect *outer,
+		const struct cull_rect *inner)
+{
+	return inner->left   >= outer->left   - CULL_EPSILON &&
+	       inner->top    >= outer->top    - CULL_EPSILON &&
+	       inner->right  <= outer->right  + CULL_EPSILON &&
+	       inner->bottom <= outer->bottom + CULL_EPSILON;
+}
+
+static inline float rect_area(const struct cull_rect *rect)
+{
+	return (rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+/* the item's whole box must be drawn with opaque pixels, and must be axis
+ * aligned so that its bounding rect doesn't include uncovered corners.
+ * bounds other than stretch can leave bars within the box uncovered */
+static bool item_is_opaque(const struct obs_scene_item *item)
+{
+	const struct obs_source *source = item->source;
+
+	if (item->is_group || !source || source->filters.num)
+		return false;
+	if (item->bounds_type != OBS_BOUNDS_NONE &&
+	    item->bounds_type != OBS_BOUNDS_STRETCH)
+		return false;
+	if (fmodf(item->rot, 90.0f) != 0.0f)
+		return false;
+	if (!obs_source_get_width(item->source) ||
+	    !obs_source_get_height(item->source))
+		return false;
+
+	if ((source->info.output_flags & OBS_SOURCE_ASYNC) != 0)
+		return source->async_active && source->async_texture &&
+			format_is_yuv(source->async_format);
+
+	return (source->info.output_flags & OBS_SOURCE_OPAQUE) != 0;
+}
+
+static void add_occluder(struct cull_rect *occluders, size_t *num,
+		const struct cull_rect *rect)
+{
+	size_t smallest = 0;
+
+	if (*num < MAX_OCCLUDERS) {
+		occluders[(*num)++] = *rect;
+		return;
+	}
+
+	/* keep the occluders that cover the most */
+	for (size_t i = 1; i < MAX_OCCLUDERS; i++) {
+		if (rect_area(&occluders[i]) < rect_area(&occluders[smallest]))
+			smallest = i;
+	}
+
+	if (rect_area(rect) > rect_area(&occluders[smallest]))
+		occluders[smallest] = *rect;
+}
+
+/* marks items that are completely covered by opaque items above them,
+ * assumes video lock */
+static void cull_scene_items(struct obs_scene *scene)
+{
+	struct cull_rect occluders[MAX_OCCLUDERS];
+	struct obs_scene_item *item = scene->first_item;
+	size_t num_occluders = 0;
+	uint32_t culled = 0;
+
+	if (!item)
+		return;
+	while (item->next)
+		item = item->next;
+
+	for (; item; item = item->prev) {
+		struct cull_rect rect;
+
+		item->culled = false;
+		if (!item->user_visible)
+			continue;
+
+		get_item_rect(item, &rect);
+
+		for (size_t i = 0; i < num_occluders; i++) {
+			if (rect_contains(&occluders[i], &rect)) {
+				item->culled = true;
+				culled++;
+				break;
+			}
+		}
+
+		if (!item->culled && item_is_opaque(item))
+			add_occluder(occluders, &num_occluders, &rect);
+	}
+
+	/* scenes are only rendered within the graphics context.  a scene can
+	 * be rendered by several views in one frame, so only count it once */
+	if (scene->last_cull_time != obs->video.video_time) {
+		scene->last_cull_time = obs->video.video_time;
+		obs->video.culled_items += culled;
+	}
+}
+
+static inline void clear_culled_items(struct obs_scene *scene)
+{
+	struct obs_scene_item *item = scene->first_item;
+
+	while (item) {
+		item->culled = false;
+		item = item->next;
+	}
+}
+
+/* assumes video lock */
+static void render_scene_items(struct obs_scene *scene)
+{
+	struct obs_scene_item *item;
+
+	gs_sprite_batch_begin();
+
+	item = scene->first_item;
+	while (item) {
+		if (item->user_visible && !item->culled)
+			render_item(item);
+
+		item = item->next;
+	}
+
+	gs_sprite_batch_end();
+}
+
+/* items that reach past the edges of the scene are still drawn there when
+ * the scene isn't cached, so a texture of the scene would cut them off.
+ * assumes video lock */
+static bool items_within_scene(struct obs_scene *scene, uint32_t cx,
+		uint32_t cy)
+{
+	struct cull_rect bounds = {0.0f, 0.0f, (float)cx, (float)cy};
+	struct obs_scene_item *item;
+
+	for (item = scene->first_item; item; item = item->next) {
+		struct cull_rect rect;
+
+		if (!item->user_visible)
+			continue;
+
+		get_item_rect(item, &rect);
+		if (!rect_contains(&bounds, &rect))
+			return false;
+	}
+
+	return true;
+}
+
+/* renders the items to a texture once the scene's revision has stayed the
+ * same since the last render, and keeps drawing that texture until the
+ * revision changes.  scenes that change every frame are drawn directly so
+ * they don't pay for the extra copy.  assumes video lock */
+static bool render_scene_cached(struct obs_scene *scene)
+{
+	gs_effect_t *effect = obs->video.default_effect;
+	gs_texture_t *tex;
+	uint32_t cx = scene_getwidth(scene);
+	uint32_t cy = scene_getheight(scene);
+	long revision;
+
+	if (scene->is_group || !cx || !cy)
+		return false;
+
+	revision = obs_scene_get_video_revision(scene);
+	if (!revision || revision != scene->last_revision) {
+		scene->last_revision = revision;
+		return false;
+	}
+
+	tex = scene->render_cache ?
+		gs_texrender_get_texture(scene->render_cache) : NULL;
+	if (revision != scene->render_cache_revision || !tex ||
+	    gs_texture_get_width(tex) != cx ||
+	    gs_texture_get_height(tex) != cy) {
+		struct vec4 clear_color;
+
+		if (!items_within_scene(scene, cx, cy))
+			return false;
+
+		if (!scene->render_cache) {
+			scene->render_cache = gs_texrender_create(GS_RGBA,
+					GS_ZS_NONE);
+			scene->render_cache_revision = 0;
+		}
+
+		gs_texrender_reset(scene->render_cache);
+		if (!gs_texrender_begin(scene->render_cache, cx, cy))
+			return false;
+
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		/* the texture holds premultiplied color and the coverage of
+		 * the items, so drawing it gives the same color as drawing
+		 * the items one by one */
+		gs_blend_state_push();
+		gs_blend_function_separate(
+				GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA,
+				GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+		render_scene_items(scene);
+		gs_blend_state_pop();
+
+		gs_texrender_end(scene->render_cache);
+		scene->render_cache_revision = revision;
+
+		tex = gs_texrender_get_texture(scene->render_cache);
+	}
+
+	gs_blend_state_push();
+	gs_blend_function_separate(
+			GS_BLEND_ONE, GS_BLEND_INVSRCALPHA,
+			GS_BLEND_ONE, GS_BLEND_ONE);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"),
+			tex);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprite(tex, 0, cx, cy);
+
+	gs_blend_state_pop();
+	return true;
+}
+
 static void scene_video_render(void *data, gs_effect_t *effect)
 {
 	DARRAY(struct obs_scene_item*) remove_items;
 	struct obs_scene *scene = data;
-	struct obs_scene_item *item;
 
 	da_init(remove_items);
 
@@ -628,16 +968,16 @@ static void scene_video_render(void *data, gs_effect_t *effect)
 				NULL);
 	}
 
+	if (os_atomic_load_bool(&obs->video.scene_culling))
+		cull_scene_items(scene);
+	else
+		clear_culled_items(scene);
+
 	gs_blend_state_push();
 	gs_reset_blend_state();
 
-	item = scene->first_item;
-	while (item) {
-		if (item->user_visible)
-			render_item(item);
-
-		item = item->next;
-	}
+	if (!render_scene_cached(scene))
+		render_scene_items(scene);
 
 	gs_blend_state_pop();
 
@@ -667,6 +1007,7 @@ static void set_visibility(struct obs_scene_item *item, bool vis)
 	os_atomic_set_long(&item->active_refs, vis ? 1 : 0);
 	item->visible = vis;
 	item->user_visible = vis;
+	scene_changed(item->parent);
 
 	pthread_mutex_unlock(&item->actions_mutex);
 }
@@ -1594,7 +1935,7 @@ static obs_sceneitem_t *obs_scene_add_internal(obs_scene_t *scene,
 
 	struct item_action action = {
 		.visible = true,
-		.timestamp = os_gettime_ns()
+		.timestamp = obs_gettime_ns()
 	};
 
 	if (!scene)
@@ -1650,6 +1991,7 @@ static obs_sceneitem_t *obs_scene_add_internal(obs_scene_t *scene,
 	}
 
 	full_lock(scene);
+	scene_changed(scene);
 
 	if (insert_after) {
 		obs_sceneitem_t *next = insert_after->next;
@@ -2047,7 +2389,7 @@ bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible)
 	uint8_t stack[256];
 	struct item_action action = {
 		.visible = visible,
-		.timestamp = os_gettime_ns()
+		.timestamp = obs_gettime_ns()
 	};
 
 	if (!item)
@@ -2070,6 +2412,7 @@ bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible)
 	}
 
 	item->user_visible = visible;
+	scene_changed(item->parent);
 
 	calldata_init_fixed(&cd, stack, sizeof(stack));
 	calldata_set_ptr(&cd, "item", item);
@@ -2155,6 +2498,7 @@ bool obs_scene_reorder_items(obs_scene_t *scene,
 	}
 
 	scene->first_item = item_order[0];
+	scene_changed(scene);
 
 	obs_sceneitem_t *prev = NULL;
 	for (size_t i = 0; i < item_order_size; i++) {
@@ -2501,6 +2845,7 @@ obs_sceneitem_t *obs_scene_insert_group(obs_scene_t *scene,
 	full_lock(scene);
 	full_lock(sub_scene);
 	sub_scene->first_item = items[0];
+	scene_changed(sub_scene);
 
 	for (size_t i = count; i > 0; i--) {
 		size_t idx = i - 1;
@@ -2643,6 +2988,7 @@ void obs_sceneitem_group_add_item(obs_sceneitem_t *group, obs_sceneitem_t *item)
 		groupscene->first_item = item;
 	}
 	item->parent = groupscene;
+	scene_changed(groupscene);
 	item->next = NULL;
 	apply_group_transform(item, group);
 	resize_group(group);
@@ -2681,6 +3027,7 @@ void obs_sceneitem_group_remove_item(obs_sceneitem_t *group,
 	group->prev = item;
 	item->next = group;
 	item->parent = scene;
+	scene_changed(scene);
 
 	/* ------------------------- */
 
@@ -2792,6 +3139,7 @@ bool obs_scene_reorder_items2(obs_scene_t *scene,
 	}
 
 	scene->first_item = item_order[0].item;
+	scene_changed(scene);
 
 	obs_sceneitem_t *prev = NULL;
 	for (size_t i = 0; i < item_order_size; i++) {
@@ -47,8 +47,11 @@ struct obs_scene_item {
 	bool                  visible;
 	bool                  selected;
 	bool                  locked;
+	bool                  culled;
 
 	gs_texrender_t        *item_render;
+	long                  render_revision;
+	volatile long         texture_version;
 	struct obs_sceneitem_crop crop;
 
 	struct vec2           pos;
@@ -93,6 +96,18 @@ struct obs_scene {
 
 	int64_t               id_counter;
 
+	/* bumped when items are added, removed, moved or hidden */
+	volatile long         video_revision;
+
+	/* frame time the culled items were last counted for */
+	uint64_t              last_cull_time;
+
+	/* the items drawn to a texture, which is drawn again for as long as
+	 * the scene's video revision stays the same */
+	gs_texrender_t        *render_cache;
+	long                  render_cache_revision;
+	long                  last_revision;
+
 	pthread_mutex_t       video_mutex;
 	pthread_mutex_t       audio_mutex;
 	struct obs_scene_item *first_item;
@@ -196,19 +196,18 @@ void set_deinterlace_texture_size(obs_source_t *source)
 		source->async_prev_texrender =
 			gs_texrender_create(GS_BGRX, GS_ZS_NONE);
 
-		source->async_prev_texture = gs_texture_create(
+		source->async_prev_texture = gs_texture_pool_acquire(
 				source->async_convert_width,
 				source->async_convert_height,
-				source->async_texture_format,
-				1, NULL, GS_DYNAMIC);
+				source->async_texture_format, GS_DYNAMIC);
 
 	} else {
 		enum gs_color_format format = convert_video_format(
 				source->async_format);
 
-		source->async_prev_texture = gs_texture_create(
+		source->async_prev_texture = gs_texture_pool_acquire(
 				source->async_width, source->async_height,
-				format, 1, NULL, GS_DYNAMIC);
+				format, GS_DYNAMIC);
 	}
 }
 
@@ -217,7 +216,7 @@ static inline struct obs_source_frame *get_prev_frame(obs_source_t *source,
 {
 	struct obs_source_frame *frame = NULL;
 
-	pthread_mutex_lock(&source->async_mutex);
+	os_mutex_lock_named(&source->async_mutex, "async_mutex");
 
 	*updated = source->cur_async_frame != NULL;
 	frame = source->prev_async_frame;
@@ -226,7 +225,7 @@ static inline struct obs_source_frame *get_prev_frame(obs_source_t *source,
 	if (frame)
 		os_atomic_inc_long(&frame->refs);
 
-	pthread_mutex_unlock(&source->async_mutex);
+	os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 
 	return frame;
 }
@@ -375,12 +374,12 @@ static void enable_deinterlacing(obs_source_t *source,
 	source->deinterlace_mode = mode;
 	source->deinterlace_effect = get_effect(mode);
 
-	pthread_mutex_lock(&source->async_mutex);
+	os_mutex_lock_named(&source->async_mutex, "async_mutex");
 	if (source->prev_async_frame) {
 		remove_async_frame(source, source->prev_async_frame);
 		source->prev_async_frame = NULL;
 	}
-	pthread_mutex_unlock(&source->async_mutex);
+	os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 
 	obs_leave_graphics();
 }
@@ -388,7 +387,7 @@ static void enable_deinterlacing(obs_source_t *source,
 static void disable_deinterlacing(obs_source_t *source)
 {
 	obs_enter_graphics();
-	gs_texture_destroy(source->async_prev_texture);
+	gs_texture_pool_release(source->async_prev_texture);
 	gs_texrender_destroy(source->async_prev_texrender);
 	source->deinterlace_mode = OBS_DEINTERLACE_MODE_DISABLE;
 	source->async_prev_texture = NULL;
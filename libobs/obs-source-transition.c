@@ -372,7 +372,7 @@ bool obs_transition_start(obs_source_t *transition,
 		duration_ms = transition->transition_fixed_duration;
 
 	if (!active || (!same_as_dest && !same_as_source)) {
-		transition->transition_start_time = os_gettime_ns();
+		transition->transition_start_time = obs_gettime_ns();
 		transition->transition_duration =
 			(uint64_t)duration_ms * 1000000ULL;
 	}
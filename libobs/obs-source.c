@@ -164,6 +164,8 @@ bool obs_source_init(struct obs_source *source)
 		return false;
 	if (pthread_mutex_init(&source->async_mutex, NULL) != 0)
 		return false;
+	if (pthread_mutex_init(&source->async_upload_mutex, NULL) != 0)
+		return false;
 
 	if (is_audio_source(source) || is_composite_source(source))
 		allocate_audio_output_buffer(source);
@@ -179,7 +181,8 @@ bool obs_source_init(struct obs_source *source)
 	source->audio_mixers = 0xFF;
 
 	if (is_audio_source(source)) {
-		pthread_mutex_lock(&obs->data.audio_sources_mutex);
+		os_mutex_lock_named(&obs->data.audio_sources_mutex,
+				"audio_sources_mutex");
 
 		source->next_audio_source = obs->data.first_audio_source;
 		source->prev_next_audio_source =
@@ -189,7 +192,8 @@ bool obs_source_init(struct obs_source *source)
 				&source->next_audio_source;
 		obs->data.first_audio_source = source;
 
-		pthread_mutex_unlock(&obs->data.audio_sources_mutex);
+		os_mutex_unlock_named(&obs->data.audio_sources_mutex,
+				"audio_sources_mutex");
 	}
 
 	source->private_settings = obs_data_create();
@@ -232,7 +236,7 @@ static void obs_source_hotkey_push_to_mute(void *data,
 		obs_hotkey_id id, obs_hotkey_t *key, bool pressed)
 {
 	struct audio_action action = {
-		.timestamp = os_gettime_ns(),
+		.timestamp = obs_gettime_ns(),
 		.type      = AUDIO_ACTION_PTM,
 		.set       = pressed
 	};
@@ -253,7 +257,7 @@ static void obs_source_hotkey_push_to_talk(void *data,
 		obs_hotkey_id id, obs_hotkey_t *key, bool pressed)
 {
 	struct audio_action action = {
-		.timestamp = os_gettime_ns(),
+		.timestamp = obs_gettime_ns(),
 		.type      = AUDIO_ACTION_PTT,
 		.set       = pressed
 	};
@@ -352,6 +356,7 @@ static obs_source_t *obs_source_create_internal(const char *id,
 
 	source->flags = source->default_flags;
 	source->enabled = true;
+	obs_bump_video_revision(&source->video_revision);
 
 	if (!private) {
 		obs_source_dosignal(source, "source_create", NULL);
@@ -406,11 +411,11 @@ static void duplicate_filters(obs_source_t *dst, obs_source_t *src,
 
 	da_init(filters);
 
-	pthread_mutex_lock(&src->filter_mutex);
+	os_mutex_lock_named(&src->filter_mutex, "filter_mutex");
 	for (size_t i = 0; i < src->filters.num; i++)
 		obs_source_addref(src->filters.array[i]);
 	da_copy(filters, src->filters);
-	pthread_mutex_unlock(&src->filter_mutex);
+	os_mutex_unlock_named(&src->filter_mutex, "filter_mutex");
 
 	for (size_t i = filters.num; i > 0; i--) {
 		obs_source_t *src_filter = filters.array[i - 1];
@@ -533,14 +538,16 @@ void obs_source_destroy(struct obs_source *source)
 	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 		obs_transition_clear(source);
 
-	pthread_mutex_lock(&obs->data.audio_sources_mutex);
+	os_mutex_lock_named(&obs->data.audio_sources_mutex,
+			"audio_sources_mutex");
 	if (source->prev_next_audio_source) {
 		*source->prev_next_audio_source = source->next_audio_source;
 		if (source->next_audio_source)
 			source->next_audio_source->prev_next_audio_source =
 				source->prev_next_audio_source;
 	}
-	pthread_mutex_unlock(&obs->data.audio_sources_mutex);
+	os_mutex_unlock_named(&obs->data.audio_sources_mutex,
+			"audio_sources_mutex");
 
 	if (source->filter_parent)
 		obs_source_filter_remove_refless(source->filter_parent, source);
@@ -571,16 +578,20 @@ void obs_source_destroy(struct obs_source *source)
 		obs_source_frame_decref(source->async_cache.array[i].frame);
 
 	gs_enter_context(obs->video.graphics);
+	if (source->async_upload_tex)
+		gs_texture_upload_cancel(source->async_upload_tex);
 	if (source->async_texrender)
 		gs_texrender_destroy(source->async_texrender);
 	if (source->async_prev_texrender)
 		gs_texrender_destroy(source->async_prev_texrender);
 	if (source->async_texture)
-		gs_texture_destroy(source->async_texture);
+		gs_texture_pool_release(source->async_texture);
 	if (source->async_prev_texture)
-		gs_texture_destroy(source->async_prev_texture);
+		gs_texture_pool_release(source->async_prev_texture);
 	if (source->filter_texrender)
 		gs_texrender_destroy(source->filter_texrender);
+	if (source->filter_cache)
+		gs_texrender_destroy(source->filter_cache);
 	gs_leave_context();
 
 	for (i = 0; i < MAX_AV_PLANES; i++)
@@ -606,6 +617,8 @@ void obs_source_destroy(struct obs_source *source)
 	pthread_mutex_destroy(&source->audio_cb_mutex);
 	pthread_mutex_destroy(&source->audio_mutex);
 	pthread_mutex_destroy(&source->async_mutex);
+	pthread_mutex_destroy(&source->async_upload_mutex);
+	metric_destroy(source->async_frames_metric);
 	obs_data_release(source->private_settings);
 	obs_context_data_free(&source->context);
 
@@ -804,6 +817,7 @@ static void obs_source_deferred_update(obs_source_t *source)
 				source->context.settings);
 
 	source->defer_update = false;
+	obs_bump_video_revision(&source->video_revision);
 }
 
 void obs_source_update(obs_source_t *source, obs_data_t *settings)
@@ -1000,11 +1014,42 @@ static inline struct obs_source_frame *get_closest_frame(obs_source_t *source,
 bool set_async_texture_size(struct obs_source *source,
 		const struct obs_source_frame *frame);
 
+/* async_mutex must be held */
+static struct async_frame *find_async_frame(obs_source_t *source,
+		const struct obs_source_frame *frame)
+{
+	for (size_t i = 0; i < source->async_cache.num; i++) {
+		struct async_frame *af = &source->async_cache.array[i];
+		if (af->frame == frame)
+			return af;
+	}
+
+	return NULL;
+}
+
+/* tracks the oldest new frame shown on the main output for end-to-end
+ * latency stats */
+static inline void track_frame_latency(obs_source_t *source,
+		const struct obs_source_frame *frame)
+{
+	uint64_t *capture_ts = &obs->video.latency_capture_ts;
+	struct async_frame *af;
+
+	if (!frame || !os_atomic_load_bool(&obs->video.latency_tracking) ||
+	    os_atomic_load_long(&source->activate_refs) == 0)
+		return;
+
+	af = find_async_frame(source, frame);
+	if (af && af->received_ts &&
+	    (!*capture_ts || af->received_ts < *capture_ts))
+		*capture_ts = af->received_ts;
+}
+
 static void async_tick(obs_source_t *source)
 {
 	uint64_t sys_time = obs->video.video_time;
 
-	pthread_mutex_lock(&source->async_mutex);
+	os_mutex_lock_named(&source->async_mutex, "async_mutex");
 
 	if (deinterlacing_enabled(source)) {
 		deinterlace_process_last_frame(source, sys_time);
@@ -1017,10 +1062,13 @@ static void async_tick(obs_source_t *source)
 
 		source->cur_async_frame = get_closest_frame(source,
 				sys_time);
+		track_frame_latency(source, source->cur_async_frame);
 	}
 
 	source->last_sys_timestamp = sys_time;
-	pthread_mutex_unlock(&source->async_mutex);
+	metric_set(source->async_frames_metric,
+			(long long)source->async_frames.num);
+	os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 
 	if (source->cur_async_frame)
 		source->async_update_texture = set_async_texture_size(source,
@@ -1241,7 +1289,7 @@ static void source_output_audio_data(obs_source_t *source,
 	size_t sample_rate = audio_output_get_sample_rate(obs->audio.audio);
 	struct audio_data in = *data;
 	uint64_t diff;
-	uint64_t os_time = os_gettime_ns();
+	uint64_t os_time = obs_gettime_ns();
 	int64_t sync_offset;
 	bool using_direct_ts = false;
 	bool push_back = false;
@@ -1416,6 +1464,22 @@ static inline bool init_gpu_conversion(struct obs_source *source,
 	return false;
 }
 
+/* unmaps the upload buffer while holding the mutex, so that the source's
+ * thread can't still be copying a frame to it.  call within the graphics
+ * context */
+static void reset_async_upload(struct obs_source *source)
+{
+	os_mutex_lock_named(&source->async_upload_mutex,
+			"async_upload_mutex");
+	if (source->async_upload_tex)
+		gs_texture_upload_cancel(source->async_upload_tex);
+	source->async_upload_tex   = NULL;
+	source->async_upload_ptr   = NULL;
+	source->async_upload_frame = NULL;
+	os_mutex_unlock_named(&source->async_upload_mutex,
+			"async_upload_mutex");
+}
+
 bool set_async_texture_size(struct obs_source *source,
 		const struct obs_source_frame *frame)
 {
@@ -1432,8 +1496,10 @@ bool set_async_texture_size(struct obs_source *source,
 
 	gs_enter_context(obs->video.graphics);
 
-	gs_texture_destroy(source->async_texture);
-	gs_texture_destroy(source->async_prev_texture);
+	reset_async_upload(source);
+
+	gs_texture_pool_release(source->async_texture);
+	gs_texture_pool_release(source->async_prev_texture);
 	gs_texrender_destroy(source->async_texrender);
 	gs_texrender_destroy(source->async_prev_texrender);
 	source->async_texture = NULL;
@@ -1447,20 +1513,19 @@ bool set_async_texture_size(struct obs_source *source,
 		source->async_texrender =
 			gs_texrender_create(GS_BGRX, GS_ZS_NONE);
 
-		source->async_texture = gs_texture_create(
+		source->async_texture = gs_texture_pool_acquire(
 				source->async_convert_width,
 				source->async_convert_height,
-				source->async_texture_format,
-				1, NULL, GS_DYNAMIC);
+				source->async_texture_format, GS_DYNAMIC);
 
 	} else {
 		enum gs_color_format format = convert_video_format(
 				frame->format);
 		source->async_gpu_conversion = false;
 
-		source->async_texture = gs_texture_create(
+		source->async_texture = gs_texture_pool_acquire(
 				frame->width, frame->height,
-				format, 1, NULL, GS_DYNAMIC);
+				format, GS_DYNAMIC);
 	}
 
 	if (deinterlacing_enabled(source))
@@ -1542,11 +1607,12 @@ static inline void set_eparami(gs_effect_t *effect, const char *name, int val)
 
 static bool update_async_texrender(struct obs_source *source,
 		const struct obs_source_frame *frame,
-		gs_texture_t *tex, gs_texrender_t *texrender)
+		gs_texture_t *tex, gs_texrender_t *texrender, bool uploaded)
 {
 	gs_texrender_reset(texrender);
 
-	upload_raw_frame(tex, frame);
+	if (!uploaded)
+		upload_raw_frame(tex, frame);
 
 	uint32_t cx = source->async_width;
 	uint32_t cy = source->async_height;
@@ -1589,9 +1655,9 @@ static bool update_async_texrender(struct obs_source *source,
 	return true;
 }
 
-bool update_async_texture(struct obs_source *source,
+static bool update_async_texture_internal(struct obs_source *source,
 		const struct obs_source_frame *frame,
-		gs_texture_t *tex, gs_texrender_t *texrender)
+		gs_texture_t *tex, gs_texrender_t *texrender, bool uploaded)
 {
 	enum convert_type type      = get_convert_type(frame->format);
 	uint8_t           *ptr;
@@ -1607,11 +1673,13 @@ bool update_async_texture(struct obs_source *source,
 			sizeof frame->color_range_max);
 
 	if (source->async_gpu_conversion && texrender)
-		return update_async_texrender(source, frame, tex, texrender);
+		return update_async_texrender(source, frame, tex, texrender,
+				uploaded);
 
 	if (type == CONVERT_NONE) {
-		gs_texture_set_image(tex, frame->data[0], frame->linesize[0],
-				false);
+		if (!uploaded)
+			gs_texture_set_image(tex, frame->data[0],
+					frame->linesize[0], false);
 		return true;
 	}
 
@@ -1640,6 +1708,130 @@ bool update_async_texture(struct obs_source *source,
 	return true;
 }
 
+bool update_async_texture(struct obs_source *source,
+		const struct obs_source_frame *frame,
+		gs_texture_t *tex, gs_texrender_t *texrender)
+{
+	return update_async_texture_internal(source, frame, tex, texrender,
+			false);
+}
+
+static inline uint32_t get_upload_linesize(
+		const struct obs_source_frame *frame)
+{
+	enum convert_type type = get_convert_type(frame->format);
+
+	/* planar frames are uploaded as one texture, see upload_raw_frame */
+	if (type == CONVERT_420 || type == CONVERT_NV12)
+		return frame->width;
+	return frame->linesize[0];
+}
+
+static bool async_upload_enabled(const struct obs_source *source)
+{
+	enum convert_type type = get_convert_type(source->async_format);
+
+	/* buffered sources rarely render the frame that was output last, so
+	 * the copy would usually be wasted */
+	if (!source->async_unbuffered)
+		return false;
+
+	/* async filters and deinterlacing use the frame data itself */
+	if (!source->async_texture || source->filters.num ||
+	    deinterlacing_enabled(source))
+		return false;
+
+	return type == CONVERT_NONE ||
+		(source->async_gpu_conversion && source->async_texrender);
+}
+
+/* maps the async texture's next upload buffer so that the next frame can be
+ * copied to it as soon as it's output, see copy_async_upload */
+static void prepare_async_upload(struct obs_source *source)
+{
+	gs_texture_t *tex = source->async_texture;
+	uint8_t *ptr;
+	uint32_t linesize;
+
+	if (!gs_texture_upload_map(tex, &ptr, &linesize))
+		return;
+
+	os_mutex_lock_named(&source->async_upload_mutex,
+			"async_upload_mutex");
+	source->async_upload_tex      = tex;
+	source->async_upload_ptr      = ptr;
+	source->async_upload_linesize = linesize;
+	source->async_upload_rows     = gs_texture_get_height(tex);
+	source->async_upload_width    = source->async_width;
+	source->async_upload_height   = source->async_height;
+	source->async_upload_format   = source->async_format;
+	source->async_upload_frame    = NULL;
+	os_mutex_unlock_named(&source->async_upload_mutex,
+			"async_upload_mutex");
+}
+
+static inline void update_async_upload(struct obs_source *source)
+{
+	bool enabled = async_upload_enabled(source);
+
+	if (enabled && !source->async_upload_ptr)
+		prepare_async_upload(source);
+	else if (!enabled && source->async_upload_ptr)
+		reset_async_upload(source);
+}
+
+/* starts transferring a frame that was already copied to the upload buffer,
+ * returns false if the frame has to be uploaded normally */
+static bool upload_async_frame(struct obs_source *source,
+		const struct obs_source_frame *frame)
+{
+	bool uploaded = false;
+
+	if (!source->async_upload_ptr || !async_upload_enabled(source))
+		return false;
+
+	/* don't wait for a copy that's still in progress */
+	if (pthread_mutex_trylock(&source->async_upload_mutex) != 0)
+		return false;
+
+	if (source->async_upload_frame == frame &&
+	    source->async_upload_tex == source->async_texture) {
+		gs_texture_upload_async(source->async_texture);
+		source->async_upload_tex   = NULL;
+		source->async_upload_ptr   = NULL;
+		source->async_upload_frame = NULL;
+		uploaded = true;
+	}
+
+	pthread_mutex_unlock(&source->async_upload_mutex);
+	return uploaded;
+}
+
+/* called from the thread outputting the frame */
+static void copy_async_upload(struct obs_source *source,
+		struct obs_source_frame *frame)
+{
+	os_mutex_lock_named(&source->async_upload_mutex,
+			"async_upload_mutex");
+
+	source->async_upload_frame = NULL;
+
+	if (source->async_upload_ptr &&
+	    source->async_upload_width  == frame->width  &&
+	    source->async_upload_height == frame->height &&
+	    source->async_upload_format == frame->format) {
+		gs_copy_image_rows(source->async_upload_ptr,
+				source->async_upload_linesize,
+				frame->data[0], get_upload_linesize(frame),
+				source->async_upload_rows, false);
+
+		source->async_upload_frame = frame;
+	}
+
+	os_mutex_unlock_named(&source->async_upload_mutex,
+			"async_upload_mutex");
+}
+
 static inline void obs_source_draw_texture(struct obs_source *source,
 		gs_effect_t *effect, float *color_matrix,
 		float const *color_range_min, float const *color_range_max)
@@ -1719,15 +1911,21 @@ static void obs_source_update_async_video(obs_source_t *source)
 			}
 
 			if (source->async_update_texture) {
-				update_async_texture(source, frame,
+				bool uploaded = upload_async_frame(source,
+						frame);
+
+				update_async_texture_internal(source, frame,
 						source->async_texture,
-						source->async_texrender);
+						source->async_texrender,
+						uploaded);
 				source->async_update_texture = false;
 			}
 
 			obs_source_release_frame(source, frame);
 		}
 	}
+
+	update_async_upload(source);
 }
 
 static inline void obs_source_render_async_video(obs_source_t *source)
@@ -1736,14 +1934,73 @@ static inline void obs_source_render_async_video(obs_source_t *source)
 		obs_source_draw_async_texture(source);
 }
 
+void obs_bump_video_revision(volatile long *revision)
+{
+	os_atomic_set_long(revision,
+			os_atomic_inc_long(&obs->video_revision_counter));
+}
+
+void obs_source_video_changed(obs_source_t *source)
+{
+	if (!obs_source_valid(source, "obs_source_video_changed"))
+		return;
+
+	obs_bump_video_revision(&source->video_revision);
+}
+
+static inline long own_video_revision(const obs_source_t *source)
+{
+	uint32_t flags = source->info.output_flags;
+
+	if ((flags & OBS_SOURCE_CACHEABLE) == 0 ||
+	    (flags & OBS_SOURCE_ASYNC) != 0)
+		return 0;
+
+	return os_atomic_load_long(&source->video_revision);
+}
+
+/* returns the highest revision of anything the source's video depends on, or
+ * 0 if its output may change without the revision being bumped */
+long obs_source_get_video_revision(obs_source_t *source)
+{
+	obs_scene_t *scene;
+	long revision;
+
+	scene = obs_scene_from_source(source);
+	if (!scene)
+		scene = obs_group_from_source(source);
+
+	revision = scene ? obs_scene_get_video_revision(scene) :
+		own_video_revision(source);
+	if (!revision || !source->enabled)
+		return revision;
+
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
+
+	for (size_t i = 0; i < source->filters.num; i++) {
+		long filter_revision =
+			own_video_revision(source->filters.array[i]);
+
+		if (!filter_revision) {
+			revision = 0;
+			break;
+		}
+		if (filter_revision > revision)
+			revision = filter_revision;
+	}
+
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
+	return revision;
+}
+
 static inline void obs_source_render_filters(obs_source_t *source)
 {
 	obs_source_t *first_filter;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 	first_filter = source->filters.array[0];
 	obs_source_addref(first_filter);
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
 	source->rendering_filter = true;
 	obs_source_video_render(first_filter);
@@ -1752,6 +2009,58 @@ static inline void obs_source_render_filters(obs_source_t *source)
 	obs_source_release(first_filter);
 }
 
+/* renders the filter chain to a texture, and keeps drawing that texture
+ * until the revision of the source or one of its filters changes */
+static bool obs_source_render_filters_cached(obs_source_t *source)
+{
+	gs_effect_t *effect = obs->video.default_effect;
+	gs_texture_t *tex;
+	long revision = obs_source_get_video_revision(source);
+	uint32_t cx = obs_source_get_width(source);
+	uint32_t cy = obs_source_get_height(source);
+
+	if (!revision || !cx || !cy)
+		return false;
+
+	if (!source->filter_cache) {
+		source->filter_cache = gs_texrender_create(GS_RGBA,
+				GS_ZS_NONE);
+		source->filter_cache_revision = 0;
+	}
+
+	tex = gs_texrender_get_texture(source->filter_cache);
+	if (revision != source->filter_cache_revision || !tex ||
+	    gs_texture_get_width(tex) != cx ||
+	    gs_texture_get_height(tex) != cy) {
+		struct vec4 clear_color;
+
+		gs_texrender_reset(source->filter_cache);
+		if (!gs_texrender_begin(source->filter_cache, cx, cy))
+			return false;
+
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		gs_blend_state_push();
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+		obs_source_render_filters(source);
+		gs_blend_state_pop();
+
+		gs_texrender_end(source->filter_cache);
+		source->filter_cache_revision = revision;
+
+		tex = gs_texrender_get_texture(source->filter_cache);
+	}
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"),
+			tex);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprite(tex, 0, cx, cy);
+
+	return true;
+}
+
 void obs_source_default_render(obs_source_t *source)
 {
 	gs_effect_t    *effect     = obs->video.default_effect;
@@ -1808,8 +2117,10 @@ static inline void render_video(obs_source_t *source)
 		return;
 	}
 
-	if (source->filters.num && !source->rendering_filter)
-		obs_source_render_filters(source);
+	if (source->filters.num && !source->rendering_filter) {
+		if (!obs_source_render_filters_cached(source))
+			obs_source_render_filters(source);
+	}
 
 	else if (source->info.video_render)
 		obs_source_main_render(source);
@@ -1874,13 +2185,13 @@ static uint32_t get_recurse_width(obs_source_t *source)
 {
 	uint32_t width;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	width = (source->filters.num) ?
 		get_base_width(source->filters.array[0]) :
 		get_base_width(source);
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
 	return width;
 }
@@ -1889,13 +2200,13 @@ static uint32_t get_recurse_height(obs_source_t *source)
 {
 	uint32_t height;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	height = (source->filters.num) ?
 		get_base_height(source->filters.array[0]) :
 		get_base_height(source);
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
 	return height;
 }
@@ -1970,17 +2281,17 @@ void obs_source_filter_add(obs_source_t *source, obs_source_t *filter)
 	if (!obs_ptr_valid(filter, "obs_source_filter_add"))
 		return;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	if (da_find(source->filters, &filter, 0) != DARRAY_INVALID) {
 		blog(LOG_WARNING, "Tried to add a filter that was already "
 		                  "present on the source");
-		pthread_mutex_unlock(&source->filter_mutex);
+		os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 		return;
 	}
 
 	if (!filter_compatible(source, filter)) {
-		pthread_mutex_unlock(&source->filter_mutex);
+		os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 		return;
 	}
 
@@ -1992,7 +2303,9 @@ void obs_source_filter_add(obs_source_t *source, obs_source_t *filter)
 
 	da_insert(source->filters, 0, &filter);
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
+
+	obs_bump_video_revision(&source->video_revision);
 
 	calldata_init_fixed(&cd, stack, sizeof(stack));
 	calldata_set_ptr(&cd, "source", source);
@@ -2012,11 +2325,11 @@ static bool obs_source_filter_remove_refless(obs_source_t *source,
 	uint8_t stack[128];
 	size_t idx;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	idx = da_find(source->filters, &filter, 0);
 	if (idx == DARRAY_INVALID) {
-		pthread_mutex_unlock(&source->filter_mutex);
+		os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 		return false;
 	}
 
@@ -2027,7 +2340,9 @@ static bool obs_source_filter_remove_refless(obs_source_t *source,
 
 	da_erase(source->filters, idx);
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
+
+	obs_bump_video_revision(&source->video_revision);
 
 	calldata_init_fixed(&cd, stack, sizeof(stack));
 	calldata_set_ptr(&cd, "source", source);
@@ -2151,12 +2466,14 @@ void obs_source_filter_set_order(obs_source_t *source, obs_source_t *filter,
 	if (!obs_ptr_valid(filter, "obs_source_filter_set_order"))
 		return;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 	success = move_filter_dir(source, filter, movement);
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
-	if (success)
+	if (success) {
+		obs_bump_video_revision(&source->video_revision);
 		obs_source_dosignal(source, NULL, "reorder_filters");
+	}
 }
 
 obs_data_t *obs_source_get_settings(const obs_source_t *source)
@@ -2173,7 +2490,7 @@ struct obs_source_frame *filter_async_video(obs_source_t *source,
 {
 	size_t i;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	for (i = source->filters.num; i > 0; i--) {
 		struct obs_source *filter = source->filters.array[i-1];
@@ -2189,7 +2506,7 @@ struct obs_source_frame *filter_async_video(obs_source_t *source,
 		}
 	}
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
 	return in;
 }
@@ -2352,12 +2669,12 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 {
 	struct obs_source_frame *new_frame = NULL;
 
-	pthread_mutex_lock(&source->async_mutex);
+	os_mutex_lock_named(&source->async_mutex, "async_mutex");
 
 	if (source->async_frames.num >= MAX_ASYNC_FRAMES) {
 		free_async_cache(source);
 		source->last_frame_ts = 0;
-		pthread_mutex_unlock(&source->async_mutex);
+		os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 		return NULL;
 	}
 
@@ -2392,6 +2709,7 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 		new_af.frame = new_frame;
 		new_af.used = true;
 		new_af.unused_count = 0;
+		new_af.received_ts = 0;
 		new_frame->refs = 1;
 
 		da_push_back(source->async_cache, &new_af);
@@ -2399,7 +2717,7 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 
 	os_atomic_inc_long(&new_frame->refs);
 
-	pthread_mutex_unlock(&source->async_mutex);
+	os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 
 	copy_frame_data(new_frame, frame);
 
@@ -2420,18 +2738,34 @@ void obs_source_output_video(obs_source_t *source,
 	struct obs_source_frame *output = !!frame ?
 		cache_video(source, frame) : NULL;
 
+	if (output)
+		copy_async_upload(source, output);
+
 	/* ------------------------------------------- */
-	pthread_mutex_lock(&source->async_mutex);
+	os_mutex_lock_named(&source->async_mutex, "async_mutex");
 	if (output) {
 		if (os_atomic_dec_long(&output->refs) == 0) {
 			obs_source_frame_destroy(output);
 			output = NULL;
 		} else {
+			struct async_frame *af = find_async_frame(source,
+					output);
+			if (af)
+				af->received_ts = os_gettime_ns();
+
 			da_push_back(source->async_frames, &output);
 			source->async_active = true;
 		}
 	}
-	pthread_mutex_unlock(&source->async_mutex);
+
+	if (!source->async_frames_metric)
+		source->async_frames_metric = metric_create(METRIC_GAUGE,
+				"obs_source_async_frames",
+				"Async video frames queued by the source",
+				"source", source->context.name);
+	metric_set(source->async_frames_metric,
+			(long long)source->async_frames.num);
+	os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 }
 
 static inline bool preload_frame_changed(obs_source_t *source,
@@ -2485,7 +2819,7 @@ void obs_source_show_preloaded_video(obs_source_t *source)
 
 	pthread_mutex_lock(&source->audio_buf_mutex);
 	sys_ts = (source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY)
-		? os_gettime_ns()
+		? obs_gettime_ns()
 		: 0;
 	reset_audio_timing(source, source->last_frame_ts, sys_ts);
 	reset_audio_data(source, sys_ts);
@@ -2680,7 +3014,7 @@ void obs_source_output_audio(obs_source_t *source,
 
 	process_audio(source, audio);
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 	output = filter_async_audio(source, &source->audio_data);
 
 	if (output) {
@@ -2692,12 +3026,12 @@ void obs_source_output_audio(obs_source_t *source,
 		data.frames    = output->frames;
 		data.timestamp = output->timestamp;
 
-		pthread_mutex_lock(&source->audio_mutex);
+		os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 		source_output_audio_data(source, &data);
-		pthread_mutex_unlock(&source->audio_mutex);
+		os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 	}
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 }
 
 void remove_async_frame(obs_source_t *source, struct obs_source_frame *frame)
@@ -2838,7 +3172,7 @@ struct obs_source_frame *obs_source_get_frame(obs_source_t *source)
 	if (!obs_source_valid(source, "obs_source_get_frame"))
 		return NULL;
 
-	pthread_mutex_lock(&source->async_mutex);
+	os_mutex_lock_named(&source->async_mutex, "async_mutex");
 
 	frame = source->cur_async_frame;
 	source->cur_async_frame = NULL;
@@ -2847,7 +3181,7 @@ struct obs_source_frame *obs_source_get_frame(obs_source_t *source)
 		os_atomic_inc_long(&frame->refs);
 	}
 
-	pthread_mutex_unlock(&source->async_mutex);
+	os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 
 	return frame;
 }
@@ -2861,14 +3195,14 @@ void obs_source_release_frame(obs_source_t *source,
 	if (!source) {
 		obs_source_frame_destroy(frame);
 	} else {
-		pthread_mutex_lock(&source->async_mutex);
+		os_mutex_lock_named(&source->async_mutex, "async_mutex");
 
 		if (os_atomic_dec_long(&frame->refs) == 0)
 			obs_source_frame_destroy(frame);
 		else
 			remove_async_frame(source, frame);
 
-		pthread_mutex_unlock(&source->async_mutex);
+		os_mutex_unlock_named(&source->async_mutex, "async_mutex");
 	}
 }
 
@@ -2889,6 +3223,12 @@ void obs_source_set_name(obs_source_t *source, const char *name)
 		char *prev_name = bstrdup(source->context.name);
 		obs_context_data_setname(&source->context, name);
 
+		/* recreated with the new name on the next async frame */
+		os_mutex_lock_named(&source->async_mutex, "async_mutex");
+		metric_destroy(source->async_frames_metric);
+		source->async_frames_metric = NULL;
+		os_mutex_unlock_named(&source->async_mutex, "async_mutex");
+
 		calldata_init(&data);
 		calldata_set_ptr(&data, "source", source);
 		calldata_set_string(&data, "new_name", source->context.name);
@@ -3127,7 +3467,7 @@ void obs_source_set_volume(obs_source_t *source, float volume)
 {
 	if (obs_source_valid(source, "obs_source_set_volume")) {
 		struct audio_action action = {
-			.timestamp = os_gettime_ns(),
+			.timestamp = obs_gettime_ns(),
 			.type      = AUDIO_ACTION_VOL,
 			.vol       = volume
 		};
@@ -3559,14 +3899,14 @@ void obs_source_enum_filters(obs_source_t *source,
 	if (!obs_ptr_valid(callback, "obs_source_enum_filters"))
 		return;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	for (size_t i = source->filters.num; i > 0; i--) {
 		struct obs_source *filter = source->filters.array[i - 1];
 		callback(source, filter, param);
 	}
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 }
 
 obs_source_t *obs_source_get_filter_by_name(obs_source_t *source,
@@ -3579,7 +3919,7 @@ obs_source_t *obs_source_get_filter_by_name(obs_source_t *source,
 	if (!obs_ptr_valid(name, "obs_source_get_filter_by_name"))
 		return NULL;
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	for (size_t i = 0; i < source->filters.num; i++) {
 		struct obs_source *cur_filter = source->filters.array[i];
@@ -3590,7 +3930,7 @@ obs_source_t *obs_source_get_filter_by_name(obs_source_t *source,
 		}
 	}
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
 	return filter;
 }
@@ -3610,6 +3950,7 @@ void obs_source_set_enabled(obs_source_t *source, bool enabled)
 		return;
 
 	source->enabled = enabled;
+	obs_bump_video_revision(&source->video_revision);
 
 	calldata_init_fixed(&data, stack, sizeof(stack));
 	calldata_set_ptr(&data, "source", source);
@@ -3629,7 +3970,7 @@ void obs_source_set_muted(obs_source_t *source, bool muted)
 	struct calldata data;
 	uint8_t stack[128];
 	struct audio_action action = {
-		.timestamp = os_gettime_ns(),
+		.timestamp = obs_gettime_ns(),
 		.type      = AUDIO_ACTION_MUTE,
 		.set       = muted
 	};
@@ -3682,9 +4023,9 @@ bool obs_source_push_to_mute_enabled(obs_source_t *source)
 	if (!obs_source_valid(source, "obs_source_push_to_mute_enabled"))
 		return false;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	enabled = source->push_to_mute_enabled;
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 
 	return enabled;
 }
@@ -3694,7 +4035,7 @@ void obs_source_enable_push_to_mute(obs_source_t *source, bool enabled)
 	if (!obs_source_valid(source, "obs_source_enable_push_to_mute"))
 		return;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	bool changed = source->push_to_mute_enabled != enabled;
 	if (obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO && changed)
 		blog(LOG_INFO, "source '%s' %s push-to-mute",
@@ -3706,7 +4047,7 @@ void obs_source_enable_push_to_mute(obs_source_t *source, bool enabled)
 	if (changed)
 		source_signal_push_to_changed(source, "push_to_mute_changed",
 				enabled);
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 }
 
 uint64_t obs_source_get_push_to_mute_delay(obs_source_t *source)
@@ -3715,9 +4056,9 @@ uint64_t obs_source_get_push_to_mute_delay(obs_source_t *source)
 	if (!obs_source_valid(source, "obs_source_get_push_to_mute_delay"))
 		return 0;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	delay = source->push_to_mute_delay;
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 
 	return delay;
 }
@@ -3727,11 +4068,11 @@ void obs_source_set_push_to_mute_delay(obs_source_t *source, uint64_t delay)
 	if (!obs_source_valid(source, "obs_source_set_push_to_mute_delay"))
 		return;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	source->push_to_mute_delay = delay;
 
 	source_signal_push_to_delay(source, "push_to_mute_delay", delay);
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 }
 
 bool obs_source_push_to_talk_enabled(obs_source_t *source)
@@ -3740,9 +4081,9 @@ bool obs_source_push_to_talk_enabled(obs_source_t *source)
 	if (!obs_source_valid(source, "obs_source_push_to_talk_enabled"))
 		return false;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	enabled = source->push_to_talk_enabled;
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 
 	return enabled;
 }
@@ -3752,7 +4093,7 @@ void obs_source_enable_push_to_talk(obs_source_t *source, bool enabled)
 	if (!obs_source_valid(source, "obs_source_enable_push_to_talk"))
 		return;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	bool changed = source->push_to_talk_enabled != enabled;
 	if (obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO && changed)
 		blog(LOG_INFO, "source '%s' %s push-to-talk",
@@ -3764,7 +4105,7 @@ void obs_source_enable_push_to_talk(obs_source_t *source, bool enabled)
 	if (changed)
 		source_signal_push_to_changed(source, "push_to_talk_changed",
 				enabled);
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 }
 
 uint64_t obs_source_get_push_to_talk_delay(obs_source_t *source)
@@ -3773,9 +4114,9 @@ uint64_t obs_source_get_push_to_talk_delay(obs_source_t *source)
 	if (!obs_source_valid(source, "obs_source_get_push_to_talk_delay"))
 		return 0;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	delay = source->push_to_talk_delay;
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 
 	return delay;
 }
@@ -3785,11 +4126,11 @@ void obs_source_set_push_to_talk_delay(obs_source_t *source, uint64_t delay)
 	if (!obs_source_valid(source, "obs_source_set_push_to_talk_delay"))
 		return;
 
-	pthread_mutex_lock(&source->audio_mutex);
+	os_mutex_lock_named(&source->audio_mutex, "audio_mutex");
 	source->push_to_talk_delay = delay;
 
 	source_signal_push_to_delay(source, "push_to_talk_delay", delay);
-	pthread_mutex_unlock(&source->audio_mutex);
+	os_mutex_unlock_named(&source->audio_mutex, "audio_mutex");
 }
 
 void *obs_source_get_type_data(obs_source_t *source)
@@ -140,6 +140,25 @@ enum obs_balance_type {
  */
 #define OBS_SOURCE_CAP_DISABLED (1<<10)
 
+/**
+ * Source always draws fully opaque pixels over its whole area
+ *
+ * Used by scenes to skip rendering items that are completely covered by
+ * this source.  Async sources don't need this flag, as they're treated as
+ * opaque while they show a frame in a format without alpha.
+ */
+#define OBS_SOURCE_OPAQUE (1<<11)
+
+/**
+ * Source only draws something different after its settings change, or after
+ * it calls obs_source_video_changed
+ *
+ * Lets libobs keep the rendered output of the source's filters (and of scenes
+ * made up of such sources) in a texture instead of rendering them again every
+ * frame.  Filters must also have this flag for their output to be cached.
+ */
+#define OBS_SOURCE_CACHEABLE (1<<12)
+
 /** @} */
 
 typedef void (*obs_source_enum_proc_t)(obs_source_t *parent,
@@ -23,6 +23,7 @@ static void *gpu_encode_thread(void *unused)
 	uint64_t interval = video_output_get_frame_time(obs->video.video);
 	DARRAY(obs_encoder_t *) encoders;
 	int wait_frames = NUM_ENCODE_TEXTURE_FRAMES_TO_WAIT;
+	long priority = OS_THREAD_PRIORITY_NORMAL;
 
 	UNUSED_PARAMETER(unused);
 	da_init(encoders);
@@ -39,6 +40,8 @@ static void *gpu_encode_thread(void *unused)
 		if (os_atomic_load_bool(&video->gpu_encode_stop))
 			break;
 
+		obs_update_thread_priority(&priority);
+
 		if (wait_frames) {
 			wait_frames--;
 			continue;
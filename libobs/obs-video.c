@@ -38,6 +38,9 @@ static uint64_t tick_sources(uint64_t cur_time, uint64_t last_time)
 	delta_time = cur_time - last_time;
 	seconds = (float)((double)delta_time / 1000000000.0);
 
+	/* set by async sources that get a new frame this tick */
+	obs->video.latency_capture_ts = 0;
+
 	/* ------------------------------------- */
 	/* call tick callbacks                   */
 
@@ -54,7 +57,7 @@ static uint64_t tick_sources(uint64_t cur_time, uint64_t last_time)
 	/* ------------------------------------- */
 	/* call the tick function of each source */
 
-	pthread_mutex_lock(&data->sources_mutex);
+	os_mutex_lock_named(&data->sources_mutex, "sources_mutex");
 
 	source = data->first_source;
 	while (source) {
@@ -67,7 +70,7 @@ static uint64_t tick_sources(uint64_t cur_time, uint64_t last_time)
 		}
 	}
 
-	pthread_mutex_unlock(&data->sources_mutex);
+	os_mutex_unlock_named(&data->sources_mutex, "sources_mutex");
 
 	return cur_time;
 }
@@ -75,9 +78,43 @@ static uint64_t tick_sources(uint64_t cur_time, uint64_t last_time)
 /* in obs-display.c */
 extern void render_display(struct obs_display *display);
 
-static inline void render_displays(void)
+static inline bool display_due(struct obs_display *display,
+		uint64_t video_time, uint64_t interval)
+{
+	uint32_t max_fps = (uint32_t)os_atomic_load_long(&display->max_fps);
+
+	if (!display->enabled || !os_atomic_load_bool(&display->visible) ||
+	    !display->cx || !display->cy)
+		return false;
+	if (!max_fps)
+		return true;
+
+	/* half a frame of slack, so a cap that evenly divides the output
+	 * frame rate isn't missed due to timing jitter */
+	return video_time - display->last_render_time + interval / 2 >=
+		1000000000ULL / max_fps;
+}
+
+static inline void render_display_profiled(struct obs_display *display,
+		uint64_t video_time)
+{
+	profile_start(display->profile_name);
+	render_display(display);
+	profile_end(display->profile_name);
+
+	display->last_render_time = video_time;
+	display->deferred = false;
+}
+
+/* with deferred rendering, displays are only rendered while there's time
+ * left in the frame, and displays that were skipped go first next frame */
+static inline void render_displays(uint64_t frame_start, uint64_t interval)
 {
 	struct obs_display *display;
+	uint64_t video_time = obs->video.video_time;
+	uint64_t budget_end = frame_start + interval * 3 / 4;
+	bool defer = os_atomic_load_bool(&obs->video.deferred_displays);
+	size_t rendered = 0;
 
 	if (!obs->data.valid)
 		return;
@@ -88,9 +125,34 @@ static inline void render_displays(void)
 	pthread_mutex_lock(&obs->data.displays_mutex);
 
 	display = obs->data.first_display;
-	while (display) {
-		render_display(display);
-		display = display->next;
+	for (; defer && display; display = display->next) {
+		if (!display->deferred)
+			continue;
+		if (!display_due(display, video_time, interval)) {
+			display->deferred = false;
+			continue;
+		}
+		if (rendered && os_gettime_ns() >= budget_end)
+			continue;
+
+		render_display_profiled(display, video_time);
+		rendered++;
+	}
+
+	display = obs->data.first_display;
+	for (; display; display = display->next) {
+		if (defer && display->deferred)
+			continue;
+		if (!display_due(display, video_time, interval))
+			continue;
+
+		if (defer && rendered && os_gettime_ns() >= budget_end) {
+			display->deferred = true;
+			continue;
+		}
+
+		render_display_profiled(display, video_time);
+		rendered++;
 	}
 
 	pthread_mutex_unlock(&obs->data.displays_mutex);
@@ -107,12 +169,30 @@ static inline void set_render_size(uint32_t width, uint32_t height)
 	gs_set_viewport(0, 0, width, height);
 }
 
-static inline void unmap_last_surface(struct obs_core_video *video)
+/* unmaps any surface that video outputs no longer reference */
+static inline void reclaim_copy_surfaces(struct obs_core_video *video)
+{
+	for (size_t i = 0; i < NUM_COPY_SURFACES; i++) {
+		struct obs_copy_surface *copy = &video->copy_surfaces[i];
+
+		if (copy->mapped && !os_atomic_load_bool(&copy->referenced)) {
+			gs_stagesurface_unmap(copy->surface);
+			copy->mapped = false;
+		}
+	}
+}
+
+static inline int get_free_copy_surface(struct obs_core_video *video)
 {
-	if (video->mapped_surface) {
-		gs_stagesurface_unmap(video->mapped_surface);
-		video->mapped_surface = NULL;
+	for (int i = 0; i < NUM_COPY_SURFACES; i++) {
+		struct obs_copy_surface *copy = &video->copy_surfaces[i];
+
+		if (!copy->copied && !copy->mapped &&
+		    i != video->prev_copy_surface)
+			return i;
 	}
+
+	return -1;
 }
 
 static const char *render_main_texture_name = "render_main_texture";
@@ -149,13 +229,13 @@ static inline void render_main_texture(struct obs_core_video *video,
 }
 
 static inline gs_effect_t *get_scale_effect_internal(
-		struct obs_core_video *video)
+		struct obs_core_video *video, uint32_t width, uint32_t height)
 {
 	/* if the dimension is under half the size of the original image,
 	 * bicubic/lanczos can't sample enough pixels to create an accurate
 	 * image, so use the bilinear low resolution effect instead */
-	if (video->output_width  < (video->base_width  / 2) &&
-	    video->output_height < (video->base_height / 2)) {
+	if (width  < (video->base_width  / 2) &&
+	    height < (video->base_height / 2)) {
 		return video->bilinear_lowres_effect;
 	}
 
@@ -186,7 +266,8 @@ static inline gs_effect_t *get_scale_effect(struct obs_core_video *video,
 	} else {
 		/* if the scale method couldn't be loaded, use either bicubic
 		 * or bilinear by default */
-		gs_effect_t *effect = get_scale_effect_internal(video);
+		gs_effect_t *effect = get_scale_effect_internal(video,
+				width, height);
 		if (!effect)
 			effect = !!video->bicubic_effect ?
 				video->bicubic_effect :
@@ -195,23 +276,20 @@ static inline gs_effect_t *get_scale_effect(struct obs_core_video *video,
 	}
 }
 
-static const char *render_output_texture_name = "render_output_texture";
-static inline void render_output_texture(struct obs_core_video *video,
-		int cur_texture, int prev_texture)
+/* scales the main texture to the target, converting it to packed YUV if the
+ * output format isn't RGBA */
+static void draw_output_texture(struct obs_core_video *video,
+		gs_effect_t *effect, gs_texture_t *texture,
+		gs_texture_t *target)
 {
-	profile_start(render_output_texture_name);
-
-	gs_texture_t *texture = video->render_textures[prev_texture];
-	gs_texture_t *target  = video->output_textures[cur_texture];
 	uint32_t     width   = gs_texture_get_width(target);
 	uint32_t     height  = gs_texture_get_height(target);
 	struct vec2  base_i;
 
 	vec2_set(&base_i,
-		1.0f / (float)video->base_width,
-		1.0f / (float)video->base_height);
+		1.0f / (float)gs_texture_get_width(texture),
+		1.0f / (float)gs_texture_get_height(texture));
 
-	gs_effect_t    *effect  = get_scale_effect(video, width, height);
 	gs_technique_t *tech;
 
 	if (video->ovi.output_format == VIDEO_FORMAT_RGBA) {
@@ -227,9 +305,6 @@ static inline void render_output_texture(struct obs_core_video *video,
 			"base_dimension_i");
 	size_t      passes, i;
 
-	if (!video->textures_rendered[prev_texture])
-		goto end;
-
 	gs_set_render_target(target, NULL);
 	set_render_size(width, height);
 
@@ -248,6 +323,22 @@ static inline void render_output_texture(struct obs_core_video *video,
 	}
 	gs_technique_end(tech);
 	gs_enable_blending(true);
+}
+
+static const char *render_output_texture_name = "render_output_texture";
+static inline void render_output_texture(struct obs_core_video *video,
+		int cur_texture, int prev_texture)
+{
+	profile_start(render_output_texture_name);
+
+	if (!video->textures_rendered[prev_texture])
+		goto end;
+
+	draw_output_texture(video,
+			get_scale_effect(video, video->output_width,
+				video->output_height),
+			video->render_textures[prev_texture],
+			video->output_textures[cur_texture]);
 
 	video->textures_output[cur_texture] = true;
 
@@ -255,6 +346,48 @@ end:
 	profile_end(render_output_texture_name);
 }
 
+/* scaled videos are rendered from the same main texture as the output
+ * texture, and are staged on the next frame, so they have the same latency
+ * as the main output without GPU conversion */
+static const char *render_scaled_videos_name = "render_scaled_videos";
+static void render_scaled_videos(struct obs_core_video *video,
+		int cur_texture, int prev_texture)
+{
+	profile_start(render_scaled_videos_name);
+
+	pthread_mutex_lock(&video->scaled_videos_mutex);
+
+	for (size_t i = 0; i < video->scaled_videos.num; i++) {
+		struct obs_scaled_video *scaled = video->scaled_videos.array[i];
+
+		if (!scaled->started)
+			continue;
+
+		if (scaled->textures_output[prev_texture]) {
+			gs_stage_texture(scaled->surfaces[cur_texture],
+					scaled->textures[prev_texture]);
+			scaled->textures_copied[cur_texture] = true;
+		} else {
+			scaled->textures_copied[cur_texture] = false;
+		}
+
+		if (video->textures_rendered[prev_texture]) {
+			draw_output_texture(video,
+					get_scale_effect(video, scaled->width,
+						scaled->height),
+					video->render_textures[prev_texture],
+					scaled->textures[cur_texture]);
+			scaled->textures_output[cur_texture] = true;
+		} else {
+			scaled->textures_output[cur_texture] = false;
+		}
+	}
+
+	pthread_mutex_unlock(&video->scaled_videos_mutex);
+
+	profile_end(render_scaled_videos_name);
+}
+
 static inline void set_eparam(gs_effect_t *effect, const char *name, float val)
 {
 	gs_eparam_t *param = gs_effect_get_param_by_name(effect, name);
@@ -366,13 +499,13 @@ end:
 
 static const char *stage_output_texture_name = "stage_output_texture";
 static inline void stage_output_texture(struct obs_core_video *video,
-		int cur_texture, int prev_texture)
+		int prev_texture)
 {
 	profile_start(stage_output_texture_name);
 
 	gs_texture_t   *texture;
 	bool        texture_ready;
-	gs_stagesurf_t *copy = video->copy_surfaces[cur_texture];
+	int         copy_idx;
 
 	if (video->gpu_conversion) {
 		texture = video->convert_textures[prev_texture];
@@ -382,14 +515,22 @@ static inline void stage_output_texture(struct obs_core_video *video,
 		texture_ready = video->textures_output[prev_texture];
 	}
 
-	unmap_last_surface(video);
+	reclaim_copy_surfaces(video);
+
+	video->prev_copy_surface = video->cur_copy_surface;
+	video->cur_copy_surface = -1;
 
 	if (!texture_ready)
 		goto end;
 
-	gs_stage_texture(copy, texture);
+	copy_idx = get_free_copy_surface(video);
+	if (copy_idx == -1)
+		goto end;
+
+	gs_stage_texture(video->copy_surfaces[copy_idx].surface, texture);
 
-	video->textures_copied[cur_texture] = true;
+	video->copy_surfaces[copy_idx].copied = true;
+	video->cur_copy_surface = copy_idx;
 
 end:
 	profile_end(stage_output_texture_name);
@@ -488,7 +629,7 @@ end:
 #endif
 
 static inline void render_video(struct obs_core_video *video,
-		bool raw_active, const bool gpu_active,
+		bool raw_active, const bool gpu_active, bool scaled_active,
 		int cur_texture, int prev_texture)
 {
 	gs_begin_scene();
@@ -508,6 +649,9 @@ static inline void render_video(struct obs_core_video *video,
 #endif
 	}
 
+	if (scaled_active)
+		render_scaled_videos(video, cur_texture, prev_texture);
+
 	if (raw_active || gpu_active) {
 		if (video->gpu_conversion) {
 			if (video->using_nv12_tex)
@@ -525,7 +669,7 @@ static inline void render_video(struct obs_core_video *video,
 		}
 #endif
 		if (raw_active)
-			stage_output_texture(video, cur_texture, prev_texture);
+			stage_output_texture(video, prev_texture);
 	}
 
 	gs_set_render_target(NULL, NULL);
@@ -534,19 +678,26 @@ static inline void render_video(struct obs_core_video *video,
 	gs_end_scene();
 }
 
-static inline bool download_frame(struct obs_core_video *video,
-		int prev_texture, struct video_data *frame)
+static inline struct obs_copy_surface *download_frame(
+		struct obs_core_video *video, struct video_data *frame)
 {
-	gs_stagesurf_t *surface = video->copy_surfaces[prev_texture];
+	struct obs_copy_surface *copy;
 
-	if (!video->textures_copied[prev_texture])
-		return false;
+	if (video->prev_copy_surface == -1)
+		return NULL;
 
-	if (!gs_stagesurface_map(surface, &frame->data[0], &frame->linesize[0]))
-		return false;
+	copy = &video->copy_surfaces[video->prev_copy_surface];
+	if (!copy->copied)
+		return NULL;
 
-	video->mapped_surface = surface;
-	return true;
+	copy->copied = false;
+
+	if (!gs_stagesurface_map(copy->surface, &frame->data[0],
+				&frame->linesize[0]))
+		return NULL;
+
+	copy->mapped = true;
+	return copy;
 }
 
 static inline uint32_t calc_linesize(uint32_t pos, uint32_t linesize)
@@ -696,18 +847,104 @@ static inline void copy_rgbx_frame(
 	}
 }
 
+static void release_copy_surface(void *param)
+{
+	struct obs_copy_surface *copy = param;
+	os_atomic_set_bool(&copy->referenced, false);
+}
+
+/* always leave enough surfaces free for staging and downloading */
+static inline bool can_reference_surface(struct obs_core_video *video)
+{
+	int referenced = 0;
+
+	for (size_t i = 0; i < NUM_COPY_SURFACES; i++) {
+		if (os_atomic_load_bool(&video->copy_surfaces[i].referenced))
+			referenced++;
+	}
+
+	return referenced < NUM_COPY_SURFACES - 2;
+}
+
+/* if the mapped data is already laid out the way the output expects, the
+ * video output can read it directly from the mapped surface */
+static bool get_frame_ref(struct obs_core_video *video,
+		struct video_data *ref, const struct video_data *input,
+		const struct video_output_info *info)
+{
+	memset(ref, 0, sizeof(*ref));
+
+	if (video->gpu_conversion) {
+		if (input->linesize[0] == video->output_width*4) {
+			for (size_t i = 0; i < 3; i++) {
+				if (video->plane_linewidth[i] == 0)
+					break;
+
+				ref->linesize[i] = video->plane_linewidth[i];
+				ref->data[i] =
+					input->data[0] + video->plane_offsets[i];
+			}
+
+		} else if (video->using_nv12_tex) {
+			ref->data[0] = input->data[0];
+			ref->data[1] = input->data[0] +
+				input->linesize[0] * info->height;
+			ref->linesize[0] = input->linesize[0];
+			ref->linesize[1] = input->linesize[0];
+
+		} else {
+			return false;
+		}
+
+	} else if (!format_is_yuv(info->format)) {
+		ref->data[0] = input->data[0];
+		ref->linesize[0] = input->linesize[0];
+
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+/* sets the latency stamps of the frame locked on the video output */
+static inline void set_frame_latency(video_t *video,
+		const struct obs_vframe_info *vframe_info)
+{
+	struct video_latency_stamps latency = {0};
+
+	if (!os_atomic_load_bool(&obs->video.latency_tracking))
+		return;
+
+	latency.capture = vframe_info->capture_ts;
+	latency.render  = vframe_info->render_ts;
+	latency.convert = os_gettime_ns();
+	video_output_set_frame_latency(video, &latency);
+}
+
 static inline void output_video_data(struct obs_core_video *video,
-		struct video_data *input_frame, int count)
+		struct video_data *input_frame, struct obs_copy_surface *copy,
+		const struct obs_vframe_info *vframe_info)
 {
 	const struct video_output_info *info;
 	struct video_frame output_frame;
+	struct video_data ref;
 	bool locked;
 
 	info = video_output_get_info(video->video);
 
-	locked = video_output_lock_frame(video->video, &output_frame, count,
-			input_frame->timestamp);
-	if (locked) {
+	locked = video_output_lock_frame(video->video, &output_frame,
+			vframe_info->count, input_frame->timestamp);
+	if (!locked)
+		return;
+
+	if (can_reference_surface(video) &&
+	    get_frame_ref(video, &ref, input_frame, info)) {
+		os_atomic_set_bool(&copy->referenced, true);
+		video_output_set_frame_ref(video->video, &ref,
+				release_copy_surface, copy);
+
+	} else {
 		if (video->gpu_conversion) {
 			set_gpu_converted_data(video, &output_frame,
 					input_frame, info);
@@ -717,13 +954,253 @@ static inline void output_video_data(struct obs_core_video *video,
 		} else {
 			copy_rgbx_frame(&output_frame, input_frame, info);
 		}
+	}
+
+	set_frame_latency(video->video, vframe_info);
+
+	video_output_unlock_frame(video->video);
+}
+
+static const char *output_scaled_videos_name = "output_scaled_videos";
+static void output_scaled_videos(struct obs_core_video *video,
+		int prev_texture)
+{
+	profile_start(output_scaled_videos_name);
 
-		video_output_unlock_frame(video->video);
+	pthread_mutex_lock(&video->scaled_videos_mutex);
+
+	for (size_t i = 0; i < video->scaled_videos.num; i++) {
+		struct obs_scaled_video *scaled = video->scaled_videos.array[i];
+		gs_stagesurf_t *surface = scaled->surfaces[prev_texture];
+		const struct video_output_info *info;
+		struct obs_vframe_info vframe_info;
+		struct video_frame output_frame;
+		struct video_data frame;
+
+		if (!scaled->textures_copied[prev_texture])
+			continue;
+
+		scaled->textures_copied[prev_texture] = false;
+		circlebuf_pop_front(&scaled->vframe_info_buffer, &vframe_info,
+				sizeof(vframe_info));
+
+		memset(&frame, 0, sizeof(frame));
+		if (!gs_stagesurface_map(surface, &frame.data[0],
+					&frame.linesize[0]))
+			continue;
+
+		info = video_output_get_info(scaled->video);
+
+		if (video_output_lock_frame(scaled->video, &output_frame,
+					vframe_info.count,
+					vframe_info.timestamp)) {
+			if (format_is_yuv(info->format))
+				convert_frame(&output_frame, &frame, info);
+			else
+				copy_rgbx_frame(&output_frame, &frame, info);
+
+			set_frame_latency(scaled->video, &vframe_info);
+
+			video_output_unlock_frame(scaled->video);
+		}
+
+		gs_stagesurface_unmap(surface);
+	}
+
+	pthread_mutex_unlock(&video->scaled_videos_mutex);
+
+	profile_end(output_scaled_videos_name);
+}
+
+/* returns whether a canvas frame is due at this video time, and how many
+ * canvas frames it accounts for */
+static bool canvas_frame_due(struct obs_canvas *canvas, uint64_t video_time,
+		uint64_t interval_ns, int *count)
+{
+	uint64_t canvas_interval = interval_ns * canvas->fps_divisor;
+
+	if (!canvas->next_frame_ts)
+		canvas->next_frame_ts = video_time;
+	if (video_time < canvas->next_frame_ts)
+		return false;
+
+	*count = 1 + (int)((video_time - canvas->next_frame_ts) /
+			canvas_interval);
+	canvas->next_frame_ts += canvas_interval * (uint64_t)*count;
+	return true;
+}
+
+static void render_canvas_texture(struct obs_core_video *video,
+		struct obs_canvas *canvas, int cur_texture)
+{
+	struct vec4 clear_color;
+	gs_texture_t *texture = canvas->render_texture;
+
+	vec4_set(&clear_color, 0.0f, 0.0f, 0.0f, 0.0f);
+
+	gs_set_render_target(canvas->render_texture, NULL);
+	gs_clear(GS_CLEAR_COLOR, &clear_color, 1.0f, 0);
+
+	set_render_size(canvas->width, canvas->height);
+	obs_view_render(&canvas->view);
+
+	if (video->ovi.output_format != VIDEO_FORMAT_RGBA) {
+		draw_output_texture(video, video->default_effect,
+				canvas->render_texture,
+				canvas->output_texture);
+		texture = canvas->output_texture;
+	}
+
+	gs_stage_texture(canvas->copy_surfaces[cur_texture], texture);
+	canvas->textures_copied[cur_texture] = true;
+}
+
+static void output_canvas_frame(struct obs_canvas *canvas, int prev_texture)
+{
+	gs_stagesurf_t *surface = canvas->copy_surfaces[prev_texture];
+	struct obs_vframe_info *vframe_info =
+		&canvas->vframe_info[prev_texture];
+	const struct video_output_info *info;
+	struct video_frame output_frame;
+	struct video_data frame;
+
+	if (!canvas->textures_copied[prev_texture])
+		return;
+
+	canvas->textures_copied[prev_texture] = false;
+
+	memset(&frame, 0, sizeof(frame));
+	if (!gs_stagesurface_map(surface, &frame.data[0], &frame.linesize[0]))
+		return;
+
+	info = video_output_get_info(canvas->video);
+
+	if (video_output_lock_frame(canvas->video, &output_frame,
+				vframe_info->count, vframe_info->timestamp)) {
+		if (format_is_yuv(info->format))
+			convert_frame(&output_frame, &frame, info);
+		else
+			copy_rgbx_frame(&output_frame, &frame, info);
+
+		set_frame_latency(canvas->video, vframe_info);
+
+		video_output_unlock_frame(canvas->video);
+	}
+
+	gs_stagesurface_unmap(surface);
+}
+
+/* canvases are rendered after the main texture, so sources that appear on
+ * several canvases have already been ticked and have their textures ready.
+ * each canvas frame is staged and then downloaded on the next canvas frame */
+static const char *render_canvases_name = "render_canvases";
+static void render_canvases(struct obs_core_video *video,
+		uint64_t interval_ns)
+{
+	struct obs_canvas *canvas;
+
+	profile_start(render_canvases_name);
+
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+
+	canvas = obs->data.first_canvas;
+	while (canvas) {
+		int cur_texture = canvas->cur_texture;
+		int prev_texture = cur_texture == 0 ?
+			NUM_TEXTURES - 1 : cur_texture - 1;
+		int count;
+
+		if (!video_output_active(canvas->video)) {
+			memset(canvas->textures_copied, 0,
+					sizeof(canvas->textures_copied));
+			canvas->next_frame_ts = 0;
+
+		} else if (canvas_frame_due(canvas, video->video_time,
+					interval_ns, &count)) {
+			struct obs_vframe_info *vframe_info =
+				&canvas->vframe_info[cur_texture];
+
+			vframe_info->timestamp  = video->video_time;
+			vframe_info->count      = count;
+			vframe_info->capture_ts = video->latency_capture_ts;
+			vframe_info->render_ts  = os_gettime_ns();
+
+			gs_begin_scene();
+			render_canvas_texture(video, canvas, cur_texture);
+			gs_set_render_target(NULL, NULL);
+			gs_end_scene();
+
+			output_canvas_frame(canvas, prev_texture);
+
+			if (++canvas->cur_texture == NUM_TEXTURES)
+				canvas->cur_texture = 0;
+		}
+
+		canvas = canvas->next;
 	}
+
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+
+	profile_end(render_canvases_name);
+}
+
+static void push_scaled_vframe_info(struct obs_core_video *video,
+		const struct obs_vframe_info *vframe_info)
+{
+	pthread_mutex_lock(&video->scaled_videos_mutex);
+
+	for (size_t i = 0; i < video->scaled_videos.num; i++) {
+		struct obs_scaled_video *scaled = video->scaled_videos.array[i];
+
+		circlebuf_push_back(&scaled->vframe_info_buffer, vframe_info,
+				sizeof(*vframe_info));
+		scaled->started = true;
+	}
+
+	pthread_mutex_unlock(&video->scaled_videos_mutex);
+}
+
+const uint64_t obs_frame_jitter_limits[OBS_FRAME_JITTER_BUCKETS] = {
+	100000ULL,
+	250000ULL,
+	500000ULL,
+	1000000ULL,
+	2000000ULL,
+	4000000ULL,
+	8000000ULL,
+	UINT64_MAX
+};
+
+static inline void record_frame_jitter(struct obs_core_video *video,
+		uint64_t target)
+{
+	uint64_t t = os_gettime_ns();
+	uint64_t late = t > target ? t - target : 0;
+	size_t bucket = 0;
+
+	while (late >= obs_frame_jitter_limits[bucket])
+		bucket++;
+
+	os_atomic_inc_long(&video->frame_jitter[bucket]);
+	metric_observe(video->frame_jitter_metric, late / 1000);
+}
+
+static inline bool sleepto_frame(struct obs_core_video *video, uint64_t t)
+{
+	bool slept;
+
+	if (os_atomic_load_bool(&obs->precise_pacing))
+		slept = os_sleepto_ns_precise(t, &video->pacing_spin_ns);
+	else
+		slept = os_sleepto_ns(t);
+
+	if (slept)
+		record_frame_jitter(video, t);
+	return slept;
 }
 
 static inline void video_sleep(struct obs_core_video *video,
-		bool raw_active, const bool gpu_active,
+		bool raw_active, const bool gpu_active, bool scaled_active,
 		uint64_t *p_time, uint64_t interval_ns)
 {
 	struct obs_vframe_info vframe_info;
@@ -731,7 +1208,10 @@ static inline void video_sleep(struct obs_core_video *video,
 	uint64_t t = cur_time + interval_ns;
 	int count;
 
-	if (os_sleepto_ns(t)) {
+	if (obs->offline_clock) {
+		*p_time = t;
+		count = 1;
+	} else if (sleepto_frame(video, t)) {
 		*p_time = t;
 		count = 1;
 	} else {
@@ -742,8 +1222,13 @@ static inline void video_sleep(struct obs_core_video *video,
 	video->total_frames += count;
 	video->lagged_frames += count - 1;
 
+	if (count > 1)
+		metric_add(video->lagged_frames_metric, count - 1);
+
 	vframe_info.timestamp = cur_time;
 	vframe_info.count = count;
+	vframe_info.capture_ts = video->latency_capture_ts;
+	vframe_info.render_ts = video->latency_render_ts;
 
 	if (raw_active)
 		circlebuf_push_back(&video->vframe_info_buffer, &vframe_info,
@@ -751,6 +1236,8 @@ static inline void video_sleep(struct obs_core_video *video,
 	if (gpu_active)
 		circlebuf_push_back(&video->vframe_info_buffer_gpu,
 				&vframe_info, sizeof(vframe_info));
+	if (scaled_active)
+		push_scaled_vframe_info(video, &vframe_info);
 }
 
 static const char *output_frame_gs_context_name = "gs_context(video->graphics)";
@@ -758,14 +1245,15 @@ static const char *output_frame_render_video_name = "render_video";
 static const char *output_frame_download_frame_name = "download_frame";
 static const char *output_frame_gs_flush_name = "gs_flush";
 static const char *output_frame_output_video_data_name = "output_video_data";
-static inline void output_frame(bool raw_active, const bool gpu_active)
+static inline void output_frame(bool raw_active, const bool gpu_active,
+		bool scaled_active)
 {
 	struct obs_core_video *video = &obs->video;
 	int cur_texture  = video->cur_texture;
 	int prev_texture = cur_texture == 0 ? NUM_TEXTURES-1 : cur_texture-1;
 	struct video_data frame;
 	bool active = raw_active || gpu_active;
-	bool frame_ready;
+	struct obs_copy_surface *copy = NULL;
 
 	memset(&frame, 0, sizeof(struct video_data));
 
@@ -773,15 +1261,31 @@ static inline void output_frame(bool raw_active, const bool gpu_active)
 	gs_enter_context(video->graphics);
 
 	profile_start(output_frame_render_video_name);
-	render_video(video, raw_active, gpu_active, cur_texture, prev_texture);
+	video->latency_render_ts = os_gettime_ns();
+	render_video(video, raw_active, gpu_active, scaled_active,
+			cur_texture, prev_texture);
+	metric_observe(video->render_time_metric,
+			(os_gettime_ns() - video->latency_render_ts) / 1000);
 	profile_end(output_frame_render_video_name);
 
 	if (raw_active) {
+		uint64_t download_start = os_gettime_ns();
+
 		profile_start(output_frame_download_frame_name);
-		frame_ready = download_frame(video, prev_texture, &frame);
+		copy = download_frame(video, &frame);
 		profile_end(output_frame_download_frame_name);
+
+		metric_observe(video->download_time_metric,
+				(os_gettime_ns() - download_start) / 1000);
 	}
 
+	if (scaled_active)
+		output_scaled_videos(video, prev_texture);
+
+	if (obs->data.first_canvas)
+		render_canvases(video, video_output_get_frame_time(
+					video->video));
+
 	profile_start(output_frame_gs_flush_name);
 	gs_flush();
 	profile_end(output_frame_gs_flush_name);
@@ -789,14 +1293,14 @@ static inline void output_frame(bool raw_active, const bool gpu_active)
 	gs_leave_context();
 	profile_end(output_frame_gs_context_name);
 
-	if (raw_active && frame_ready) {
+	if (raw_active && copy) {
 		struct obs_vframe_info vframe_info;
 		circlebuf_pop_front(&video->vframe_info_buffer, &vframe_info,
 				sizeof(vframe_info));
 
 		frame.timestamp = vframe_info.timestamp;
 		profile_start(output_frame_output_video_data_name);
-		output_video_data(video, &frame, vframe_info.count);
+		output_video_data(video, &frame, copy, &vframe_info);
 		profile_end(output_frame_output_video_data_name);
 	}
 
@@ -819,7 +1323,10 @@ static void clear_base_frame_data(void)
 static void clear_raw_frame_data(void)
 {
 	struct obs_core_video *video = &obs->video;
-	memset(video->textures_copied, 0, sizeof(video->textures_copied));
+	for (size_t i = 0; i < NUM_COPY_SURFACES; i++)
+		video->copy_surfaces[i].copied = false;
+	video->cur_copy_surface  = -1;
+	video->prev_copy_surface = -1;
 	circlebuf_free(&video->vframe_info_buffer);
 }
 
@@ -831,6 +1338,38 @@ static void clear_gpu_frame_data(void)
 }
 #endif
 
+/* textures released to the pool that haven't been reused for this long are
+ * destroyed, so VRAM used by sources that went away is eventually freed */
+#define TEXTURE_POOL_MAX_IDLE_NS (30ULL * 1000000000ULL)
+
+static void update_texture_pool(struct obs_core_video *video)
+{
+	struct gs_texture_pool_stats stats;
+
+	gs_enter_context(video->graphics);
+	gs_texture_pool_trim(TEXTURE_POOL_MAX_IDLE_NS);
+	gs_texture_pool_get_stats(&stats);
+	gs_leave_context();
+
+	metric_set(video->texture_pool_used_metric,
+			(long long)stats.used_bytes);
+	metric_set(video->texture_pool_free_metric,
+			(long long)stats.free_bytes);
+}
+
+static void count_draw_calls(struct obs_core_video *video)
+{
+	struct gs_draw_stats stats;
+
+	gs_enter_context(video->graphics);
+	gs_get_draw_stats(&stats);
+	gs_leave_context();
+
+	video->last_draw_calls =
+		(uint32_t)(stats.draw_calls - video->total_draw_calls);
+	video->total_draw_calls = stats.draw_calls;
+}
+
 static const char *tick_sources_name = "tick_sources";
 static const char *render_displays_name = "render_displays";
 static const char *output_frame_name = "output_frame";
@@ -844,6 +1383,7 @@ void *obs_graphics_thread(void *param)
 	bool gpu_was_active = false;
 	bool raw_was_active = false;
 	bool was_active = false;
+	long priority = OS_THREAD_PRIORITY_NORMAL;
 
 	obs->video.video_time = os_gettime_ns();
 
@@ -860,12 +1400,15 @@ void *obs_graphics_thread(void *param)
 		uint64_t frame_start = os_gettime_ns();
 		uint64_t frame_time_ns;
 		bool raw_active = obs->video.raw_active > 0;
+		bool scaled_active = obs->video.scaled_active > 0;
 #ifdef _WIN32
 		bool gpu_active = obs->video.gpu_encoder_active > 0;
 #else
 		const bool gpu_active = 0;
 #endif
-		bool active = raw_active || gpu_active;
+		bool active = raw_active || gpu_active || scaled_active;
+
+		obs_update_thread_priority(&priority);
 
 		if (!was_active && active)
 			clear_base_frame_data();
@@ -886,24 +1429,41 @@ void *obs_graphics_thread(void *param)
 		profile_end(tick_sources_name);
 
 		profile_start(output_frame_name);
-		output_frame(raw_active, gpu_active);
+		output_frame(raw_active, gpu_active, scaled_active);
 		profile_end(output_frame_name);
 
 		profile_start(render_displays_name);
-		render_displays();
+		render_displays(frame_start, interval);
 		profile_end(render_displays_name);
 
+		obs->video.last_culled_items = obs->video.culled_items;
+		obs->video.culled_items = 0;
+		if (obs->video.last_culled_items)
+			metric_add(obs->video.culled_items_metric,
+					obs->video.last_culled_items);
+
+		count_draw_calls(&obs->video);
+
 		frame_time_ns = os_gettime_ns() - frame_start;
 
 		profile_end(video_thread_name);
 
 		profile_reenable_thread();
 
-		video_sleep(&obs->video, raw_active, gpu_active,
+		video_sleep(&obs->video, raw_active, gpu_active, scaled_active,
 				&obs->video.video_time, interval);
 
+		/* with the offline clock, audio is kept in step with video
+		 * here and the frame rate is measured against real time */
+		if (obs->offline_clock) {
+			audio_output_tick(obs->audio.audio,
+					obs->video.video_time);
+			fps_total_ns += os_gettime_ns() - frame_start;
+		} else {
+			fps_total_ns += (obs->video.video_time - last_time);
+		}
+
 		frame_time_total_ns += frame_time_ns;
-		fps_total_ns += (obs->video.video_time - last_time);
 		fps_total_frames++;
 
 		if (fps_total_ns >= 1000000000ULL) {
@@ -912,6 +1472,8 @@ void *obs_graphics_thread(void *param)
 			obs->video.video_avg_frame_time_ns =
 				frame_time_total_ns / (uint64_t)fps_total_frames;
 
+			update_texture_pool(&obs->video);
+
 			frame_time_total_ns = 0;
 			fps_total_ns = 0;
 			fps_total_frames = 0;
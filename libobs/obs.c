@@ -40,6 +40,7 @@ static inline void make_video_info(struct video_output_info *vi,
 	vi->range   = ovi->range;
 	vi->colorspace = ovi->colorspace;
 	vi->cache_size = 6;
+	vi->offline = obs->offline_clock;
 }
 
 #define PIXEL_SIZE 4
@@ -215,25 +216,28 @@ static bool obs_init_textures(struct obs_video_info *ovi)
 		video->conversion_height : ovi->output_height;
 	size_t i;
 
-	for (i = 0; i < NUM_TEXTURES; i++) {
+	for (i = 0; i < NUM_COPY_SURFACES; i++) {
+		gs_stagesurf_t *surface;
+
 #ifdef _WIN32
-		if (video->using_nv12_tex) {
-			video->copy_surfaces[i] = gs_stagesurface_create_nv12(
+		if (video->using_nv12_tex)
+			surface = gs_stagesurface_create_nv12(
 					ovi->output_width, ovi->output_height);
-			if (!video->copy_surfaces[i])
-				return false;
-
-		} else {
+		else
 #endif
-			video->copy_surfaces[i] = gs_stagesurface_create(
+			surface = gs_stagesurface_create(
 					ovi->output_width, output_height,
 					GS_RGBA);
-			if (!video->copy_surfaces[i])
-				return false;
-#ifdef _WIN32
-		}
-#endif
+		if (!surface)
+			return false;
 
+		video->copy_surfaces[i].surface = surface;
+	}
+
+	video->cur_copy_surface  = -1;
+	video->prev_copy_surface = -1;
+
+	for (i = 0; i < NUM_TEXTURES; i++) {
 		video->render_textures[i] = gs_texture_create(
 				ovi->base_width, ovi->base_height,
 				GS_RGBA, 1, NULL, GS_RENDER_TARGET);
@@ -424,6 +428,9 @@ static int obs_init_video(struct obs_video_info *ovi)
 		return OBS_VIDEO_FAIL;
 	}
 
+	video_output_set_thread_priority(video->video,
+			(enum os_thread_priority)obs->thread_priority);
+
 	gs_enter_context(video->graphics);
 
 	if (ovi->gpu_conversion && !obs_init_gpu_conversion(ovi))
@@ -439,6 +446,35 @@ static int obs_init_video(struct obs_video_info *ovi)
 		return OBS_VIDEO_FAIL;
 	if (pthread_mutex_init(&video->gpu_encoder_mutex, NULL) < 0)
 		return OBS_VIDEO_FAIL;
+	if (pthread_mutex_init(&video->scaled_videos_mutex, NULL) < 0)
+		return OBS_VIDEO_FAIL;
+
+	video->render_time_metric = metric_create(METRIC_HISTOGRAM,
+			"obs_video_render_time_us",
+			"Time spent rendering each frame", NULL, NULL);
+	video->download_time_metric = metric_create(METRIC_HISTOGRAM,
+			"obs_video_download_time_us",
+			"Time spent waiting for frames to download from the GPU",
+			NULL, NULL);
+	video->lagged_frames_metric = metric_create(METRIC_COUNTER,
+			"obs_video_lagged_frames_total",
+			"Frames missed due to rendering lag", NULL, NULL);
+	video->culled_items_metric = metric_create(METRIC_COUNTER,
+			"obs_scene_culled_items_total",
+			"Scene items skipped because they were fully covered",
+			NULL, NULL);
+	video->frame_jitter_metric = metric_create(METRIC_HISTOGRAM,
+			"obs_video_frame_jitter_us",
+			"How late the graphics thread woke up for each frame",
+			NULL, NULL);
+	video->texture_pool_used_metric = metric_create(METRIC_GAUGE,
+			"obs_texture_pool_bytes",
+			"Size of the textures handed out by the texture pool or "
+			"kept for reuse", "state", "used");
+	video->texture_pool_free_metric = metric_create(METRIC_GAUGE,
+			"obs_texture_pool_bytes",
+			"Size of the textures handed out by the texture pool or "
+			"kept for reuse", "state", "free");
 
 	errorcode = pthread_create(&video->video_thread, NULL,
 			obs_graphics_thread, obs);
@@ -465,6 +501,8 @@ static void stop_video(void)
 
 }
 
+static void free_scaled_videos(void);
+
 static void obs_free_video(void)
 {
 	struct obs_core_video *video = &obs->video;
@@ -476,21 +514,30 @@ static void obs_free_video(void)
 		if (!video->graphics)
 			return;
 
+		free_scaled_videos();
+
 		gs_enter_context(video->graphics);
 
-		if (video->mapped_surface) {
-			gs_stagesurface_unmap(video->mapped_surface);
-			video->mapped_surface = NULL;
+		/* the video output has been closed at this point, so nothing
+		 * references the mapped surfaces any more */
+		for (size_t i = 0; i < NUM_COPY_SURFACES; i++) {
+			struct obs_copy_surface *copy = &video->copy_surfaces[i];
+
+			if (copy->mapped)
+				gs_stagesurface_unmap(copy->surface);
+			gs_stagesurface_destroy(copy->surface);
 		}
 
+		memset(video->copy_surfaces, 0, sizeof(video->copy_surfaces));
+		video->cur_copy_surface  = -1;
+		video->prev_copy_surface = -1;
+
 		for (size_t i = 0; i < NUM_TEXTURES; i++) {
-			gs_stagesurface_destroy(video->copy_surfaces[i]);
 			gs_texture_destroy(video->render_textures[i]);
 			gs_texture_destroy(video->convert_textures[i]);
 			gs_texture_destroy(video->convert_uv_textures[i]);
 			gs_texture_destroy(video->output_textures[i]);
 
-			video->copy_surfaces[i]       = NULL;
 			video->render_textures[i]     = NULL;
 			video->convert_textures[i]    = NULL;
 			video->convert_uv_textures[i] = NULL;
@@ -506,8 +553,6 @@ static void obs_free_video(void)
 				sizeof(video->textures_rendered));
 		memset(&video->textures_output, 0,
 				sizeof(video->textures_output));
-		memset(&video->textures_copied, 0,
-				sizeof(video->textures_copied));
 		memset(&video->textures_converted, 0,
 				sizeof(video->textures_converted));
 
@@ -515,9 +560,27 @@ static void obs_free_video(void)
 		pthread_mutex_init_value(&video->gpu_encoder_mutex);
 		da_free(video->gpu_encoders);
 
+		pthread_mutex_destroy(&video->scaled_videos_mutex);
+		pthread_mutex_init_value(&video->scaled_videos_mutex);
+
 		video->gpu_encoder_active = 0;
 		video->cur_texture = 0;
 	}
+
+	metric_destroy(video->render_time_metric);
+	metric_destroy(video->download_time_metric);
+	metric_destroy(video->lagged_frames_metric);
+	metric_destroy(video->culled_items_metric);
+	metric_destroy(video->frame_jitter_metric);
+	metric_destroy(video->texture_pool_used_metric);
+	metric_destroy(video->texture_pool_free_metric);
+	video->render_time_metric = NULL;
+	video->download_time_metric = NULL;
+	video->lagged_frames_metric = NULL;
+	video->culled_items_metric = NULL;
+	video->frame_jitter_metric = NULL;
+	video->texture_pool_used_metric = NULL;
+	video->texture_pool_free_metric = NULL;
 }
 
 static void obs_free_graphics(void)
@@ -571,10 +634,19 @@ static bool obs_init_audio(struct audio_output_info *ai)
 	audio->monitoring_device_name = bstrdup("Default");
 	audio->monitoring_device_id = bstrdup("default");
 
+	audio->buffering_metric = metric_create(METRIC_GAUGE,
+			"obs_audio_buffering_ticks",
+			"Audio ticks buffered to compensate for source latency",
+			NULL, NULL);
+
 	errorcode = audio_output_open(&audio->audio, ai);
-	if (errorcode == AUDIO_OUTPUT_SUCCESS)
+	if (errorcode == AUDIO_OUTPUT_SUCCESS) {
+		audio_output_set_thread_priority(audio->audio,
+				(enum os_thread_priority)obs->thread_priority);
+		audio_output_set_precise_timing(audio->audio,
+				obs->precise_pacing);
 		return true;
-	else if (errorcode == AUDIO_OUTPUT_INVALIDPARAM)
+	} else if (errorcode == AUDIO_OUTPUT_INVALIDPARAM)
 		blog(LOG_ERROR, "Invalid audio parameters specified");
 	else
 		blog(LOG_ERROR, "Could not open audio output");
@@ -596,6 +668,7 @@ static void obs_free_audio(void)
 	bfree(audio->monitoring_device_name);
 	bfree(audio->monitoring_device_id);
 	pthread_mutex_destroy(&audio->monitoring_mutex);
+	metric_destroy(audio->buffering_metric);
 
 	memset(audio, 0, sizeof(struct obs_core_audio));
 }
@@ -608,6 +681,7 @@ static bool obs_init_data(void)
 	assert(data != NULL);
 
 	pthread_mutex_init_value(&obs->data.displays_mutex);
+	pthread_mutex_init_value(&obs->data.canvases_mutex);
 	pthread_mutex_init_value(&obs->data.draw_callbacks_mutex);
 
 	if (pthread_mutexattr_init(&attr) != 0)
@@ -620,6 +694,8 @@ static bool obs_init_data(void)
 		goto fail;
 	if (pthread_mutex_init(&data->displays_mutex, &attr) != 0)
 		goto fail;
+	if (pthread_mutex_init(&data->canvases_mutex, &attr) != 0)
+		goto fail;
 	if (pthread_mutex_init(&data->outputs_mutex, &attr) != 0)
 		goto fail;
 	if (pthread_mutex_init(&data->encoders_mutex, &attr) != 0)
@@ -662,6 +738,26 @@ void obs_main_view_free(struct obs_view *view)
 					unfreed); \
 	} while (false)
 
+static void obs_free_canvases(void)
+{
+	struct obs_core_data *data = &obs->data;
+	int unfreed = 0;
+
+	while (data->first_canvas) {
+		struct obs_canvas *canvas = data->first_canvas;
+
+		if (video_output_active(canvas->video))
+			blog(LOG_WARNING, "\tcanvas '%s' is still in use",
+					canvas->name);
+
+		obs_canvas_free(canvas);
+		unfreed++;
+	}
+
+	if (unfreed)
+		blog(LOG_INFO, "\t%d canvas(es) were remaining", unfreed);
+}
+
 static void obs_free_data(void)
 {
 	struct obs_core_data *data = &obs->data;
@@ -672,15 +768,19 @@ static void obs_free_data(void)
 
 	blog(LOG_INFO, "Freeing OBS context data");
 
-	FREE_OBS_LINKED_LIST(source);
+	/* outputs and encoders go first so that nothing is connected to the
+	 * canvases' video outputs anymore when the canvases are freed */
 	FREE_OBS_LINKED_LIST(output);
 	FREE_OBS_LINKED_LIST(encoder);
+	obs_free_canvases();
+	FREE_OBS_LINKED_LIST(source);
 	FREE_OBS_LINKED_LIST(display);
 	FREE_OBS_LINKED_LIST(service);
 
 	pthread_mutex_destroy(&data->sources_mutex);
 	pthread_mutex_destroy(&data->audio_sources_mutex);
 	pthread_mutex_destroy(&data->displays_mutex);
+	pthread_mutex_destroy(&data->canvases_mutex);
 	pthread_mutex_destroy(&data->outputs_mutex);
 	pthread_mutex_destroy(&data->encoders_mutex);
 	pthread_mutex_destroy(&data->services_mutex);
@@ -820,6 +920,7 @@ static bool obs_init(const char *locale, const char *module_config_path,
 
 	pthread_mutex_init_value(&obs->audio.monitoring_mutex);
 	pthread_mutex_init_value(&obs->video.gpu_encoder_mutex);
+	pthread_mutex_init_value(&obs->video.scaled_videos_mutex);
 
 	obs->name_store_owned = !store;
 	obs->name_store = store ? store : profiler_name_store_create();
@@ -956,6 +1057,36 @@ struct obs_cmdline_args obs_get_cmdline_args(void)
 	return cmdline_args;
 }
 
+static bool log_thread_cpu_usage(void *param,
+		const struct os_thread_info *info)
+{
+	uint64_t end_time = info->end_time_ns ? info->end_time_ns :
+		os_gettime_ns();
+	uint64_t lifetime = end_time - info->start_time_ns;
+	double usage = lifetime ?
+		(double)info->cpu_time_ns / (double)lifetime * 100.0 : 0.0;
+
+	blog(LOG_INFO, "\t%s%s%s%s: %.3f ms CPU, %.2f%% of %.3f s%s",
+			info->name ? info->name : "(unnamed)",
+			info->owner ? " (" : "",
+			info->owner ? info->owner : "",
+			info->owner ? ")" : "",
+			(double)info->cpu_time_ns / 1000000.0,
+			usage,
+			(double)lifetime / 1000000000.0,
+			info->end_time_ns ? "" : " (still running)");
+
+	UNUSED_PARAMETER(param);
+	return true;
+}
+
+static void log_thread_usage(void)
+{
+	blog(LOG_INFO, "Thread CPU usage:");
+	os_enum_threads(log_thread_cpu_usage, NULL);
+	os_thread_registry_free();
+}
+
 void obs_shutdown(void)
 {
 	struct obs_module *module;
@@ -1023,6 +1154,8 @@ void obs_shutdown(void)
 	bfree(core);
 	bfree(cmdline_args.argv);
 
+	log_thread_usage();
+
 #ifdef _WIN32
 	uninitialize_com();
 #endif
@@ -1161,6 +1294,10 @@ bool obs_reset_audio(const struct obs_audio_info *oai)
 	if (obs->audio.audio && audio_output_active(obs->audio.audio))
 		return false;
 
+	/* offline audio is ticked from the graphics thread */
+	if (obs->offline_clock && obs->video.thread_initialized)
+		return false;
+
 	obs_free_audio();
 	if (!oai)
 		return true;
@@ -1170,6 +1307,7 @@ bool obs_reset_audio(const struct obs_audio_info *oai)
 	ai.format = AUDIO_FORMAT_FLOAT_PLANAR;
 	ai.speakers = oai->speakers;
 	ai.input_callback = audio_callback;
+	ai.offline = obs->offline_clock;
 
 	blog(LOG_INFO, "---------------------------------");
 	blog(LOG_INFO, "audio settings reset:\n"
@@ -1408,7 +1546,7 @@ void obs_enum_sources(bool (*enum_proc)(void*, obs_source_t*), void *param)
 
 	if (!obs) return;
 
-	pthread_mutex_lock(&obs->data.sources_mutex);
+	os_mutex_lock_named(&obs->data.sources_mutex, "sources_mutex");
 	source = obs->data.first_source;
 
 	while (source) {
@@ -1427,7 +1565,7 @@ void obs_enum_sources(bool (*enum_proc)(void*, obs_source_t*), void *param)
 		source = next_source;
 	}
 
-	pthread_mutex_unlock(&obs->data.sources_mutex);
+	os_mutex_unlock_named(&obs->data.sources_mutex, "sources_mutex");
 }
 
 void obs_enum_scenes(bool (*enum_proc)(void*, obs_source_t*), void *param)
@@ -1436,7 +1574,7 @@ void obs_enum_scenes(bool (*enum_proc)(void*, obs_source_t*), void *param)
 
 	if (!obs) return;
 
-	pthread_mutex_lock(&obs->data.sources_mutex);
+	os_mutex_lock_named(&obs->data.sources_mutex, "sources_mutex");
 	source = obs->data.first_source;
 
 	while (source) {
@@ -1452,7 +1590,7 @@ void obs_enum_scenes(bool (*enum_proc)(void*, obs_source_t*), void *param)
 		source = next_source;
 	}
 
-	pthread_mutex_unlock(&obs->data.sources_mutex);
+	os_mutex_unlock_named(&obs->data.sources_mutex, "sources_mutex");
 }
 
 static inline void obs_enum(void *pstart, pthread_mutex_t *mutex, void *proc,
@@ -1816,7 +1954,7 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
 	count = obs_data_array_count(array);
 	da_reserve(sources, count);
 
-	pthread_mutex_lock(&data->sources_mutex);
+	os_mutex_lock_named(&data->sources_mutex, "sources_mutex");
 
 	for (i = 0; i < count; i++) {
 		obs_data_t   *source_data = obs_data_array_item(array, i);
@@ -1849,11 +1987,313 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
 	for (i = 0; i < sources.num; i++)
 		obs_source_release(sources.array[i]);
 
-	pthread_mutex_unlock(&data->sources_mutex);
+	os_mutex_unlock_named(&data->sources_mutex, "sources_mutex");
 
 	da_free(sources);
 }
 
+/* ------------------------------------------------------------------------- */
+/* Parallel source loading */
+
+struct source_load_task {
+	obs_data_t   *data;
+	obs_source_t *source;
+	const char   *name;
+	size_t       level;
+	int          state;
+	bool         is_scene;
+	DARRAY(struct source_load_task*) children;
+};
+
+struct source_load_ctx {
+	DARRAY(struct source_load_task) tasks;
+	DARRAY(struct source_load_task*) by_name;
+
+	/* tasks of the current stage, picked up by the worker threads */
+	DARRAY(struct source_load_task*) queue;
+	void (*run)(struct source_load_ctx *ctx,
+			struct source_load_task *task);
+	volatile long next_task;
+};
+
+static int cmp_task_name(const void *a, const void *b)
+{
+	const struct source_load_task *task_a =
+		*(const struct source_load_task *const*)a;
+	const struct source_load_task *task_b =
+		*(const struct source_load_task *const*)b;
+	return strcmp(task_a->name, task_b->name);
+}
+
+static struct source_load_task *find_load_task(struct source_load_ctx *ctx,
+		const char *name)
+{
+	struct source_load_task key = {.name = name};
+	struct source_load_task *key_ptr = &key;
+	struct source_load_task **task;
+
+	task = bsearch(&key_ptr, ctx->by_name.array, ctx->by_name.num,
+			sizeof(struct source_load_task*), cmp_task_name);
+	return task ? *task : NULL;
+}
+
+/* finds the sources a scene or group contains.  this only reads the task's
+ * own data, so it's safe to do for different tasks on different threads */
+static void find_task_children(struct source_load_ctx *ctx,
+		struct source_load_task *task)
+{
+	obs_data_t *settings;
+	obs_data_array_t *items;
+	size_t count;
+
+	if (!task->is_scene)
+		return;
+
+	settings = obs_data_get_obj(task->data, "settings");
+	items = obs_data_get_array(settings, "items");
+	count = obs_data_array_count(items);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item_data = obs_data_array_item(items, i);
+		const char *name = obs_data_get_string(item_data, "name");
+		struct source_load_task *child = find_load_task(ctx, name);
+
+		if (child && child != task)
+			da_push_back(task->children, &child);
+
+		obs_data_release(item_data);
+	}
+
+	obs_data_array_release(items);
+	obs_data_release(settings);
+}
+
+/* scenes and groups have to be loaded after every source they contain, so
+ * their level is one more than the highest level of their items */
+static size_t get_load_level(struct source_load_task *task)
+{
+	if (task->state == 2)
+		return task->level;
+	if (task->state == 1)
+		return 0;
+
+	task->state = 1;
+	task->level = 0;
+
+	for (size_t i = 0; i < task->children.num; i++) {
+		size_t level = get_load_level(task->children.array[i]) + 1;
+		if (level > task->level)
+			task->level = level;
+	}
+
+	task->state = 2;
+	return task->level;
+}
+
+static void create_task_source(struct source_load_ctx *ctx,
+		struct source_load_task *task)
+{
+	const char *profile_name = profile_store_name(
+			obs_get_profiler_name_store(),
+			"obs_load_source(%s)", task->name);
+
+	profile_start(profile_name);
+	task->source = obs_load_source(task->data);
+	profile_end(profile_name);
+
+	UNUSED_PARAMETER(ctx);
+}
+
+static void load_task_source(struct source_load_ctx *ctx,
+		struct source_load_task *task)
+{
+	obs_source_t *source = task->source;
+	const char *profile_name;
+
+	if (!source)
+		return;
+
+	profile_name = profile_store_name(obs_get_profiler_name_store(),
+			"obs_source_load(%s)", task->name);
+	profile_start(profile_name);
+
+	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
+		obs_transition_load(source, task->data);
+	obs_source_load(source);
+	for (size_t i = source->filters.num; i > 0; i--) {
+		obs_source_t *filter = source->filters.array[i - 1];
+		obs_source_load(filter);
+	}
+
+	profile_end(profile_name);
+	UNUSED_PARAMETER(ctx);
+}
+
+static const char *load_sources_worker_name = "obs_load_sources_worker";
+
+static void run_queued_tasks(struct source_load_ctx *ctx)
+{
+	for (;;) {
+		long idx = os_atomic_inc_long(&ctx->next_task) - 1;
+		if ((size_t)idx >= ctx->queue.num)
+			break;
+
+		ctx->run(ctx, ctx->queue.array[idx]);
+	}
+}
+
+static void *load_sources_thread(void *param)
+{
+	struct source_load_ctx *ctx = param;
+
+	os_set_thread_name("obs_load_sources");
+
+	profile_start(load_sources_worker_name);
+	run_queued_tasks(ctx);
+	profile_end(load_sources_worker_name);
+	return NULL;
+}
+
+/* runs the queued tasks on up to num_threads threads, including the calling
+ * thread, and returns once all of them are done */
+static void run_load_queue(struct source_load_ctx *ctx,
+		void (*run)(struct source_load_ctx *ctx,
+			struct source_load_task *task),
+		size_t num_threads)
+{
+	pthread_t *threads;
+	size_t num_created = 0;
+
+	if (!ctx->queue.num)
+		return;
+
+	if (num_threads > ctx->queue.num)
+		num_threads = ctx->queue.num;
+
+	ctx->run = run;
+	ctx->next_task = 0;
+	threads = bzalloc(sizeof(pthread_t) * num_threads);
+
+	for (size_t i = 1; i < num_threads; i++) {
+		if (pthread_create(&threads[num_created], NULL,
+					load_sources_thread, ctx) == 0)
+			num_created++;
+	}
+
+	run_queued_tasks(ctx);
+
+	for (size_t i = 0; i < num_created; i++)
+		pthread_join(threads[i], NULL);
+
+	bfree(threads);
+}
+
+static void queue_tasks(struct source_load_ctx *ctx, bool scenes)
+{
+	da_resize(ctx->queue, 0);
+	for (size_t i = 0; i < ctx->tasks.num; i++) {
+		struct source_load_task *task = &ctx->tasks.array[i];
+		if (task->is_scene == scenes)
+			da_push_back(ctx->queue, &task);
+	}
+}
+
+void obs_load_sources_parallel(obs_data_array_t *array, obs_load_source_cb cb,
+		void *private_data)
+{
+	struct obs_core_data *data;
+	struct source_load_ctx ctx = {0};
+	size_t num_threads;
+	size_t max_level = 0;
+	size_t count;
+
+	if (!obs) return;
+
+	data = &obs->data;
+	count = obs_data_array_count(array);
+	da_reserve(ctx.tasks, count);
+	da_reserve(ctx.by_name, count);
+	da_reserve(ctx.queue, count);
+
+	for (size_t i = 0; i < count; i++) {
+		struct source_load_task *task = da_push_back_new(ctx.tasks);
+		const char *id;
+
+		task->data = obs_data_array_item(array, i);
+		task->name = obs_data_get_string(task->data, "name");
+
+		id = obs_data_get_string(task->data, "id");
+		task->is_scene = strcmp(id, "scene") == 0 ||
+		                 strcmp(id, "group") == 0;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		struct source_load_task *task = &ctx.tasks.array[i];
+		da_push_back(ctx.by_name, &task);
+	}
+
+	qsort(ctx.by_name.array, ctx.by_name.num,
+			sizeof(struct source_load_task*), cmp_task_name);
+
+	num_threads = (size_t)os_get_logical_cores();
+	if (!num_threads)
+		num_threads = 1;
+
+	queue_tasks(&ctx, true);
+	run_load_queue(&ctx, find_task_children, num_threads);
+
+	for (size_t i = 0; i < count; i++) {
+		size_t level = get_load_level(&ctx.tasks.array[i]);
+		if (level > max_level)
+			max_level = level;
+	}
+
+	/* creating and loading a source that isn't a scene or group doesn't
+	 * depend on any other source, so those all run on the worker threads.
+	 * sources_mutex is only taken to link each source in to the list, so
+	 * it can't be held here. */
+	queue_tasks(&ctx, false);
+	run_load_queue(&ctx, create_task_source, num_threads);
+	run_load_queue(&ctx, load_task_source, num_threads);
+
+	/* scenes and groups are cheap to create and load, and the frontend
+	 * handles their signals synchronously, so they're done on the calling
+	 * thread.  loading resolves scene items, so they're loaded level by
+	 * level. */
+	for (size_t i = 0; i < count; i++) {
+		struct source_load_task *task = &ctx.tasks.array[i];
+		if (task->is_scene)
+			create_task_source(&ctx, task);
+	}
+
+	for (size_t level = 0; level <= max_level; level++) {
+		for (size_t i = 0; i < count; i++) {
+			struct source_load_task *task = &ctx.tasks.array[i];
+			if (task->is_scene && task->level == level)
+				load_task_source(&ctx, task);
+		}
+	}
+
+	os_mutex_lock_named(&data->sources_mutex, "sources_mutex");
+
+	for (size_t i = 0; i < count; i++) {
+		struct source_load_task *task = &ctx.tasks.array[i];
+
+		if (task->source && cb)
+			cb(private_data, task->source);
+
+		obs_source_release(task->source);
+		obs_data_release(task->data);
+		da_free(task->children);
+	}
+
+	os_mutex_unlock_named(&data->sources_mutex, "sources_mutex");
+
+	da_free(ctx.queue);
+	da_free(ctx.by_name);
+	da_free(ctx.tasks);
+}
+
 obs_data_t *obs_save_source(obs_source_t *source)
 {
 	obs_data_array_t *filters = obs_data_array_create();
@@ -1913,7 +2353,7 @@ obs_data_t *obs_save_source(obs_source_t *source)
 	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 		obs_transition_save(source, source_data);
 
-	pthread_mutex_lock(&source->filter_mutex);
+	os_mutex_lock_named(&source->filter_mutex, "filter_mutex");
 
 	if (source->filters.num) {
 		for (size_t i = source->filters.num; i > 0; i--) {
@@ -1926,7 +2366,7 @@ obs_data_t *obs_save_source(obs_source_t *source)
 		obs_data_set_array(source_data, "filters", filters);
 	}
 
-	pthread_mutex_unlock(&source->filter_mutex);
+	os_mutex_unlock_named(&source->filter_mutex, "filter_mutex");
 
 	obs_data_release(settings);
 	obs_data_array_release(filters);
@@ -1945,7 +2385,7 @@ obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
 
 	array = obs_data_array_create();
 
-	pthread_mutex_lock(&data->sources_mutex);
+	os_mutex_lock_named(&data->sources_mutex, "sources_mutex");
 
 	source = data->first_source;
 
@@ -1961,7 +2401,7 @@ obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
 		source = (obs_source_t*)source->context.next;
 	}
 
-	pthread_mutex_unlock(&data->sources_mutex);
+	os_mutex_unlock_named(&data->sources_mutex, "sources_mutex");
 
 	return array;
 }
@@ -2119,6 +2559,167 @@ uint64_t obs_get_video_frame_time(void)
 	return obs ? obs->video.video_time : 0;
 }
 
+bool obs_set_offline_clock(bool enable)
+{
+	if (!obs)
+		return false;
+
+	if (obs->video.video || obs->audio.audio) {
+		blog(LOG_WARNING, "obs_set_offline_clock: Cannot change the "
+		                  "clock while video or audio is initialized");
+		return false;
+	}
+
+	obs->offline_clock = enable;
+	blog(LOG_INFO, "Offline clock %s", enable ? "enabled" : "disabled");
+	return true;
+}
+
+bool obs_offline_clock_enabled(void)
+{
+	return obs ? obs->offline_clock : false;
+}
+
+uint64_t obs_gettime_ns(void)
+{
+	if (obs && obs->offline_clock && obs->video.video_time)
+		return obs->video.video_time;
+	return os_gettime_ns();
+}
+
+void obs_set_scene_culling(bool enable)
+{
+	if (!obs)
+		return;
+
+	os_atomic_set_bool(&obs->video.scene_culling, enable);
+	blog(LOG_INFO, "Scene culling %s", enable ? "enabled" : "disabled");
+}
+
+bool obs_scene_culling_enabled(void)
+{
+	return obs ? os_atomic_load_bool(&obs->video.scene_culling) : false;
+}
+
+void obs_set_latency_tracking(bool enable)
+{
+	if (!obs)
+		return;
+
+	os_atomic_set_bool(&obs->video.latency_tracking, enable);
+	blog(LOG_INFO, "Latency tracking %s", enable ? "enabled" : "disabled");
+}
+
+bool obs_latency_tracking_enabled(void)
+{
+	return obs ? os_atomic_load_bool(&obs->video.latency_tracking) : false;
+}
+
+uint32_t obs_get_scene_culled_items(void)
+{
+	return obs ? obs->video.last_culled_items : 0;
+}
+
+uint32_t obs_get_frame_draw_calls(void)
+{
+	return obs ? obs->video.last_draw_calls : 0;
+}
+
+void obs_set_deferred_display_rendering(bool enable)
+{
+	if (!obs)
+		return;
+
+	os_atomic_set_bool(&obs->video.deferred_displays, enable);
+	blog(LOG_INFO, "Deferred display rendering %s",
+			enable ? "enabled" : "disabled");
+}
+
+bool obs_deferred_display_rendering_enabled(void)
+{
+	return obs ? os_atomic_load_bool(&obs->video.deferred_displays) :
+		false;
+}
+
+void obs_set_precise_frame_pacing(bool enable)
+{
+	if (!obs)
+		return;
+
+	os_atomic_set_bool(&obs->precise_pacing, enable);
+	audio_output_set_precise_timing(obs->audio.audio, enable);
+	blog(LOG_INFO, "Precise frame pacing %s",
+			enable ? "enabled" : "disabled");
+}
+
+bool obs_precise_frame_pacing_enabled(void)
+{
+	return obs ? os_atomic_load_bool(&obs->precise_pacing) : false;
+}
+
+static const char *thread_priority_names[] = {
+	"normal",
+	"high",
+	"realtime (round robin)",
+	"realtime (FIFO)"
+};
+
+void obs_set_thread_priority(enum os_thread_priority priority)
+{
+	struct obs_core_video *video;
+
+	if (!obs)
+		return;
+	if (priority < OS_THREAD_PRIORITY_NORMAL ||
+	    priority > OS_THREAD_PRIORITY_REALTIME_FIFO)
+		return;
+
+	video = &obs->video;
+	os_atomic_set_long(&obs->thread_priority, (long)priority);
+
+	/* media-io threads pick it up on their next wake-up, the graphics
+	 * and gpu encode threads check obs->thread_priority themselves */
+	audio_output_set_thread_priority(obs->audio.audio, priority);
+	video_output_set_thread_priority(video->video, priority);
+
+	if (video->video) {
+		pthread_mutex_lock(&video->scaled_videos_mutex);
+		for (size_t i = 0; i < video->scaled_videos.num; i++)
+			video_output_set_thread_priority(
+					video->scaled_videos.array[i]->video,
+					priority);
+		pthread_mutex_unlock(&video->scaled_videos_mutex);
+	}
+
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+	for (struct obs_canvas *canvas = obs->data.first_canvas; canvas;
+			canvas = canvas->next)
+		video_output_set_thread_priority(canvas->video, priority);
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+
+	blog(LOG_INFO, "Thread priority set to %s",
+			thread_priority_names[priority]);
+}
+
+enum os_thread_priority obs_get_thread_priority(void)
+{
+	return obs ? (enum os_thread_priority)os_atomic_load_long(
+			&obs->thread_priority) : OS_THREAD_PRIORITY_NORMAL;
+}
+
+void obs_get_frame_jitter_histogram(uint32_t counts[OBS_FRAME_JITTER_BUCKETS])
+{
+	for (size_t i = 0; i < OBS_FRAME_JITTER_BUCKETS; i++)
+		counts[i] = obs ? (uint32_t)os_atomic_load_long(
+				&obs->video.frame_jitter[i]) : 0;
+}
+
+uint64_t obs_get_frame_jitter_bucket_limit(size_t bucket)
+{
+	return bucket < OBS_FRAME_JITTER_BUCKETS ?
+		obs_frame_jitter_limits[bucket] : UINT64_MAX;
+}
+
 double obs_get_active_fps(void)
 {
 	return obs ? obs->video.video_fps : 0.0;
@@ -2280,11 +2881,221 @@ uint32_t obs_get_lagged_frames(void)
 	return obs ? obs->video.lagged_frames : 0;
 }
 
+uint32_t obs_get_audio_buffering_ms(void)
+{
+	struct obs_core_audio *audio;
+	uint32_t sample_rate;
+
+	if (!obs || !obs->audio.audio)
+		return 0;
+
+	audio = &obs->audio;
+	sample_rate = audio_output_get_sample_rate(audio->audio);
+	return (uint32_t)((uint64_t)audio->total_buffering_ticks *
+			AUDIO_OUTPUT_FRAMES * 1000 / sample_rate);
+}
+
+/* raw video consumers that want a different resolution than the main output
+ * are given a scaled video output that's rendered on the GPU instead of each
+ * scaling every frame on the CPU */
+static bool use_scaled_video(video_t *v,
+		const struct video_scale_info *conversion)
+{
+	const struct video_output_info *voi;
+
+	if (!conversion || v != obs->video.video)
+		return false;
+
+	voi = video_output_get_info(v);
+
+	if (!conversion->width || !conversion->height)
+		return false;
+	if (conversion->width  == voi->width &&
+	    conversion->height == voi->height)
+		return false;
+
+	/* the GPU renders either RGBA or packed YUV, which must be converted
+	 * to the output format by the CPU */
+	switch (voi->format) {
+	case VIDEO_FORMAT_I420:
+	case VIDEO_FORMAT_NV12:
+	case VIDEO_FORMAT_I444:
+	case VIDEO_FORMAT_RGBA:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void scaled_video_destroy(struct obs_scaled_video *scaled)
+{
+	if (!scaled)
+		return;
+
+	video_output_close(scaled->video);
+
+	obs_enter_graphics();
+	for (size_t i = 0; i < NUM_TEXTURES; i++) {
+		gs_texture_destroy(scaled->textures[i]);
+		gs_stagesurface_destroy(scaled->surfaces[i]);
+	}
+	obs_leave_graphics();
+
+	circlebuf_free(&scaled->vframe_info_buffer);
+	da_free(scaled->inputs);
+	bfree(scaled);
+}
+
+/* must be called within the graphics context */
+static struct obs_scaled_video *scaled_video_create(uint32_t width,
+		uint32_t height)
+{
+	struct obs_scaled_video *scaled = bzalloc(sizeof(*scaled));
+	struct video_output_info voi = *video_output_get_info(obs->video.video);
+
+	voi.name   = "scaled video";
+	voi.width  = width;
+	voi.height = height;
+
+	if (video_output_open(&scaled->video, &voi) != VIDEO_OUTPUT_SUCCESS)
+		goto fail;
+
+	video_output_set_thread_priority(scaled->video,
+			(enum os_thread_priority)obs->thread_priority);
+
+	for (size_t i = 0; i < NUM_TEXTURES; i++) {
+		scaled->textures[i] = gs_texture_create(width, height,
+				GS_RGBA, 1, NULL, GS_RENDER_TARGET);
+		scaled->surfaces[i] = gs_stagesurface_create(width, height,
+				GS_RGBA);
+
+		if (!scaled->textures[i] || !scaled->surfaces[i])
+			goto fail;
+	}
+
+	scaled->width  = width;
+	scaled->height = height;
+
+	blog(LOG_INFO, "Created scaled video output (%"PRIu32"x%"PRIu32")",
+			width, height);
+	return scaled;
+
+fail:
+	blog(LOG_WARNING, "Failed to create scaled video output "
+			"(%"PRIu32"x%"PRIu32")", width, height);
+	scaled_video_destroy(scaled);
+	return NULL;
+}
+
+static void free_scaled_videos(void)
+{
+	struct obs_core_video *video = &obs->video;
+
+	for (size_t i = 0; i < video->scaled_videos.num; i++)
+		scaled_video_destroy(video->scaled_videos.array[i]);
+	da_free(video->scaled_videos);
+
+	os_atomic_set_long(&video->scaled_active, 0);
+}
+
+static bool start_scaled_video(const struct video_scale_info *conversion,
+		void (*callback)(void *param, struct video_data *frame),
+		void *param)
+{
+	struct obs_core_video *video = &obs->video;
+	struct obs_scaled_video *scaled = NULL;
+	struct obs_scaled_video_input input = {callback, param};
+
+	obs_enter_graphics();
+	pthread_mutex_lock(&video->scaled_videos_mutex);
+
+	for (size_t i = 0; i < video->scaled_videos.num; i++) {
+		struct obs_scaled_video *cur = video->scaled_videos.array[i];
+
+		if (cur->width  == conversion->width &&
+		    cur->height == conversion->height) {
+			scaled = cur;
+			break;
+		}
+	}
+
+	if (!scaled) {
+		scaled = scaled_video_create(conversion->width,
+				conversion->height);
+		if (scaled)
+			da_push_back(video->scaled_videos, &scaled);
+	}
+
+	if (scaled && video_output_connect(scaled->video, conversion,
+				callback, param))
+		da_push_back(scaled->inputs, &input);
+	else
+		scaled = NULL;
+
+	pthread_mutex_unlock(&video->scaled_videos_mutex);
+	obs_leave_graphics();
+
+	return scaled != NULL;
+}
+
+static bool stop_scaled_video(
+		void (*callback)(void *param, struct video_data *frame),
+		void *param)
+{
+	struct obs_core_video *video = &obs->video;
+	struct obs_scaled_video *destroy = NULL;
+	bool found = false;
+
+	pthread_mutex_lock(&video->scaled_videos_mutex);
+
+	for (size_t i = 0; i < video->scaled_videos.num && !found; i++) {
+		struct obs_scaled_video *scaled = video->scaled_videos.array[i];
+
+		for (size_t j = 0; j < scaled->inputs.num; j++) {
+			struct obs_scaled_video_input *input =
+				scaled->inputs.array + j;
+
+			if (input->callback != callback ||
+			    input->param != param)
+				continue;
+
+			video_output_disconnect(scaled->video, callback,
+					param);
+			da_erase(scaled->inputs, j);
+			found = true;
+
+			if (!scaled->inputs.num) {
+				da_erase(video->scaled_videos, i);
+				destroy = scaled;
+			}
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&video->scaled_videos_mutex);
+
+	scaled_video_destroy(destroy);
+	return found;
+}
+
 void start_raw_video(video_t *v, const struct video_scale_info *conversion,
 		void (*callback)(void *param, struct video_data *frame),
 		void *param)
 {
 	struct obs_core_video *video = &obs->video;
+
+	/* canvases render whenever their video outputs are in use */
+	if (v != video->video) {
+		video_output_connect(v, conversion, callback, param);
+		return;
+	}
+
+	if (use_scaled_video(v, conversion) &&
+	    start_scaled_video(conversion, callback, param)) {
+		os_atomic_inc_long(&video->scaled_active);
+		return;
+	}
+
 	os_atomic_inc_long(&video->raw_active);
 	video_output_connect(v, conversion, callback, param);
 }
@@ -2294,6 +3105,17 @@ void stop_raw_video(video_t *v,
 		void *param)
 {
 	struct obs_core_video *video = &obs->video;
+
+	if (v != video->video) {
+		video_output_disconnect(v, callback, param);
+		return;
+	}
+
+	if (stop_scaled_video(callback, param)) {
+		os_atomic_dec_long(&video->scaled_active);
+		return;
+	}
+
 	os_atomic_dec_long(&video->raw_active);
 	video_output_disconnect(v, callback, param);
 }
@@ -2411,6 +3233,7 @@ bool obs_video_active(void)
 		return false;
 
 	return os_atomic_load_long(&video->raw_active) > 0 ||
+	       os_atomic_load_long(&video->scaled_active) > 0 ||
 	       os_atomic_load_long(&video->gpu_encoder_active) > 0;
 }
 
@@ -53,6 +53,7 @@ struct obs_volmeter;
 
 typedef struct obs_display    obs_display_t;
 typedef struct obs_view       obs_view_t;
+typedef struct obs_canvas     obs_canvas_t;
 typedef struct obs_source     obs_source_t;
 typedef struct obs_scene      obs_scene_t;
 typedef struct obs_scene_item obs_sceneitem_t;
@@ -240,6 +241,36 @@ struct obs_source_frame {
 	bool                prev_frame;
 };
 
+/**
+ * Pipeline stages of a video frame, for end-to-end latency stats.  The
+ * latency of each stage is measured from when the frame was captured by an
+ * async source, or from the start of composition if no async source had a
+ * new frame.
+ */
+enum obs_latency_stage {
+	OBS_LATENCY_RENDER,
+	OBS_LATENCY_CONVERT,
+	OBS_LATENCY_ENCODE_SUBMIT,
+	OBS_LATENCY_ENCODE_COMPLETE,
+	OBS_LATENCY_INTERLEAVE,
+	OBS_LATENCY_SEND,
+	OBS_LATENCY_STAGE_COUNT
+};
+
+struct obs_latency_stage_stats {
+	uint64_t            count;
+	double              min_ms;
+	double              mean_ms;
+	double              p50_ms;
+	double              p95_ms;
+	double              p99_ms;
+	double              max_ms;
+};
+
+struct obs_output_latency_stats {
+	struct obs_latency_stage_stats stages[OBS_LATENCY_STAGE_COUNT];
+};
+
 /** Access to the argc/argv used to start OBS. What you see is what you get. */
 struct obs_cmdline_args {
 	int argc;
@@ -658,6 +689,17 @@ typedef void (*obs_load_source_cb)(void *private_data, obs_source_t *source);
 EXPORT void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
 		void *private_data);
 
+/**
+ * Loads sources from a data array.  Sources other than scenes and groups are
+ * created and loaded on multiple threads, so their create and load callbacks
+ * may run concurrently with those of other sources.  Scenes and groups are
+ * created and loaded on the calling thread after the sources they contain,
+ * filters are loaded after their parent, and the callback is called in array
+ * order once everything has been loaded.
+ */
+EXPORT void obs_load_sources_parallel(obs_data_array_t *array,
+		obs_load_source_cb cb, void *private_data);
+
 /** Saves sources to a data array */
 EXPORT obs_data_array_t *obs_save_sources(void);
 
@@ -711,12 +753,100 @@ EXPORT void obs_remove_raw_video_callback(
 
 EXPORT uint64_t obs_get_video_frame_time(void);
 
+/**
+ * Enables or disables the offline clock.  With the offline clock, the
+ * graphics thread renders frames back to back instead of waiting for the
+ * next frame time, audio is mixed from the graphics thread as video time
+ * advances, and video outputs receive every frame rather than skipping
+ * frames when they fall behind.  Video and audio time then advance as fast
+ * as the pipeline can process them.
+ *
+ *   Must be called before the first call to obs_reset_audio and
+ * obs_reset_video.
+ */
+EXPORT bool obs_set_offline_clock(bool enable);
+EXPORT bool obs_offline_clock_enabled(void);
+
+/**
+ * Returns the current libobs time in nanoseconds: the system time, or the
+ * time of the frame being rendered when the offline clock is enabled.
+ * Sources that timestamp their own data should use this instead of
+ * os_gettime_ns.
+ */
+EXPORT uint64_t obs_gettime_ns(void);
+
+/**
+ * Enables or disables scene culling.  When enabled, scenes skip rendering
+ * items that are completely covered by opaque items above them.  Disabled by
+ * default.
+ */
+EXPORT void obs_set_scene_culling(bool enable);
+EXPORT bool obs_scene_culling_enabled(void);
+
+/**
+ * Enables or disables end-to-end latency tracking.  When enabled, video frames
+ * are stamped as they pass through each stage of the pipeline, and outputs
+ * collect the stats returned by obs_output_get_latency_stats.  Disabled by
+ * default.
+ */
+EXPORT void obs_set_latency_tracking(bool enable);
+EXPORT bool obs_latency_tracking_enabled(void);
+
+/** Returns the number of scene items culled during the last frame */
+EXPORT uint32_t obs_get_scene_culled_items(void);
+
+/** Returns the number of draw calls made by the graphics thread during the
+ * last frame, including displays */
+EXPORT uint32_t obs_get_frame_draw_calls(void);
+
+/**
+ * Enables or disables deferred display rendering.  When enabled, displays
+ * are only rendered while time is left in the current frame after outputs
+ * have been rendered, and displays that don't fit are rendered first on the
+ * next frame.  At least one display is always rendered per frame.  Disabled
+ * by default.
+ */
+EXPORT void obs_set_deferred_display_rendering(bool enable);
+EXPORT bool obs_deferred_display_rendering_enabled(void);
+
+/**
+ * Enables or disables precise frame pacing.  When enabled, the graphics and
+ * audio threads sleep until shortly before each frame is due and spin for
+ * the rest, which reduces wake-up jitter at the cost of some CPU time.
+ * Disabled by default.
+ */
+EXPORT void obs_set_precise_frame_pacing(bool enable);
+EXPORT bool obs_precise_frame_pacing_enabled(void);
+
+/**
+ * Sets the scheduling priority of the graphics, audio, video and GPU encoder
+ * threads.  Raising the priority usually requires extra privileges; threads
+ * that can't be raised stay at their current priority.
+ */
+EXPORT void obs_set_thread_priority(enum os_thread_priority priority);
+EXPORT enum os_thread_priority obs_get_thread_priority(void);
+
+#define OBS_FRAME_JITTER_BUCKETS 8
+
+/**
+ * Gets how many frames the graphics thread woke up for late, sorted by how
+ * late it was.  Bucket i counts wake-ups that were late by less than
+ * obs_get_frame_jitter_bucket_limit(i) nanoseconds (the last bucket has no
+ * limit).
+ */
+EXPORT void obs_get_frame_jitter_histogram(
+		uint32_t counts[OBS_FRAME_JITTER_BUCKETS]);
+EXPORT uint64_t obs_get_frame_jitter_bucket_limit(size_t bucket);
+
 EXPORT double obs_get_active_fps(void);
 EXPORT uint64_t obs_get_average_frame_time_ns(void);
 
 EXPORT uint32_t obs_get_total_frames(void);
 EXPORT uint32_t obs_get_lagged_frames(void);
 
+/** Returns the amount of audio buffering currently applied, in milliseconds */
+EXPORT uint32_t obs_get_audio_buffering_ms(void);
+
 EXPORT bool obs_nv12_tex_active(void);
 
 EXPORT void obs_apply_private_data(obs_data_t *settings);
@@ -750,6 +880,52 @@ EXPORT obs_source_t *obs_view_get_source(obs_view_t *view,
 EXPORT void obs_view_render(obs_view_t *view);
 
 
+/* ------------------------------------------------------------------------- */
+/* Canvas context */
+
+/**
+ * Creates an additional canvas with its own resolution and video output.
+ *
+ *   A canvas is rendered by the graphics thread in the same pass as the main
+ * view, so sources shown on several canvases are only ticked and captured
+ * once.  Encoders and outputs can be attached to the canvas with
+ * obs_encoder_set_video and obs_output_set_media.  The canvas uses the
+ * output format of the main video, and its frame rate is the main frame rate
+ * divided by fps_divisor.  The canvas is only rendered while its video output
+ * is in use.
+ */
+EXPORT obs_canvas_t *obs_canvas_create(const char *name, uint32_t width,
+		uint32_t height, uint32_t fps_divisor);
+
+/**
+ * Destroys this canvas.  Fails with a warning and returns false if anything is
+ * still connected to the canvas's video output.
+ */
+EXPORT bool obs_canvas_destroy(obs_canvas_t *canvas);
+
+EXPORT const char *obs_canvas_get_name(const obs_canvas_t *canvas);
+
+/** Sets the source to be used for this canvas */
+EXPORT void obs_canvas_set_source(obs_canvas_t *canvas, uint32_t channel,
+		obs_source_t *source);
+
+/** Gets the source currently in use for this canvas */
+EXPORT obs_source_t *obs_canvas_get_source(obs_canvas_t *canvas,
+		uint32_t channel);
+
+/**
+ * Gets the view of this canvas, which can be used to preview it.  The view
+ * belongs to the canvas and must not be destroyed.
+ */
+EXPORT obs_view_t *obs_canvas_get_view(obs_canvas_t *canvas);
+
+/** Gets the video output of this canvas */
+EXPORT video_t *obs_canvas_get_video(const obs_canvas_t *canvas);
+
+EXPORT uint32_t obs_canvas_get_width(const obs_canvas_t *canvas);
+EXPORT uint32_t obs_canvas_get_height(const obs_canvas_t *canvas);
+
+
 /* ------------------------------------------------------------------------- */
 /* Display context */
 
@@ -794,6 +970,20 @@ EXPORT bool obs_display_enabled(obs_display_t *display);
 EXPORT void obs_display_set_background_color(obs_display_t *display,
 		uint32_t color);
 
+/**
+ * Tells libobs whether the window of the display can currently be seen.
+ * Displays of hidden or minimized windows are not rendered.
+ */
+EXPORT void obs_display_set_visible(obs_display_t *display, bool visible);
+EXPORT bool obs_display_visible(obs_display_t *display);
+
+/**
+ * Limits how often the display is rendered, in frames per second.  0 (the
+ * default) renders it with every output frame.
+ */
+EXPORT void obs_display_set_max_fps(obs_display_t *display, uint32_t fps);
+EXPORT uint32_t obs_display_get_max_fps(obs_display_t *display);
+
 
 /* ------------------------------------------------------------------------- */
 /* Sources */
@@ -1135,6 +1325,12 @@ EXPORT void obs_source_output_audio(obs_source_t *source,
 /** Signal an update to any currently used properties via 'update_properties' */
 EXPORT void obs_source_update_properties(obs_source_t *source);
 
+/**
+ * Tells libobs that a source with the OBS_SOURCE_CACHEABLE flag will draw
+ * something different on its next render
+ */
+EXPORT void obs_source_video_changed(obs_source_t *source);
+
 /** Gets the current async video frame */
 EXPORT struct obs_source_frame *obs_source_get_frame(obs_source_t *source);
 
@@ -1722,6 +1918,13 @@ EXPORT void obs_output_output_caption_text1(obs_output_t *output,
 EXPORT float obs_output_get_congestion(obs_output_t *output);
 EXPORT int obs_output_get_connect_time_ms(obs_output_t *output);
 
+/**
+ * Gets the end-to-end latency of the video packets this output received
+ * since it was last started.  Returns false if no latency was recorded.
+ */
+EXPORT bool obs_output_get_latency_stats(obs_output_t *output,
+		struct obs_output_latency_stats *stats);
+
 EXPORT bool obs_output_reconnecting(const obs_output_t *output);
 
 /** Pass a string of the last output error, for UI use */
@@ -1780,6 +1983,13 @@ EXPORT void obs_output_end_data_capture(obs_output_t *output);
  */
 EXPORT void obs_output_signal_stop(obs_output_t *output, int code);
 
+/**
+ * Records that a packet has been written to its destination (for example,
+ * to the network socket), for end-to-end latency stats.
+ */
+EXPORT void obs_output_packet_sent(obs_output_t *output,
+		const struct encoder_packet *packet);
+
 
 /* ------------------------------------------------------------------------- */
 /* Encoders */
@@ -0,0 +1,542 @@
+#include <limits.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "metrics.h"
+#include "base.h"
+#include "bmem.h"
+#include "darray.h"
+#include "dstr.h"
+#include "platform.h"
+#include "threading.h"
+
+#define SUB_BUCKETS     METRIC_SUB_BUCKETS
+#define NUM_BUCKETS     (SUB_BUCKETS * 61)
+
+struct metric {
+	enum metric_type   type;
+	char               *name;
+	char               *help;
+	char               *label;
+	char               *label_value;
+
+	/* counter/gauge value, or sum of histogram values */
+	volatile long long value;
+
+	volatile long long count;
+	volatile long long min;
+	volatile long long max;
+	volatile long      *buckets;
+};
+
+struct metrics_snapshot_entry {
+	enum metric_type   type;
+	char               *name;
+	char               *help;
+	char               *label;
+	char               *label_value;
+
+	long long          value;
+	uint64_t           count;
+	uint64_t           min;
+	uint64_t           max;
+	long               *buckets;
+};
+
+struct metrics_snapshot {
+	DARRAY(struct metrics_snapshot_entry) entries;
+};
+
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(metric_t*) metrics;
+
+/* ------------------------------------------------------------------------- */
+/* Registration */
+
+metric_t *metric_create(enum metric_type type, const char *name,
+		const char *help, const char *label, const char *label_value)
+{
+	metric_t *metric;
+
+	if (!name || !*name)
+		return NULL;
+
+	metric = bzalloc(sizeof(metric_t));
+	metric->type = type;
+	metric->name = bstrdup(name);
+	metric->help = bstrdup(help ? help : "");
+	metric->min = LLONG_MAX;
+
+	if (label && *label) {
+		metric->label = bstrdup(label);
+		metric->label_value = bstrdup(label_value ? label_value : "");
+	}
+
+	if (type == METRIC_HISTOGRAM)
+		metric->buckets = bzalloc(sizeof(long) * NUM_BUCKETS);
+
+	pthread_mutex_lock(&metrics_mutex);
+	da_push_back(metrics, &metric);
+	pthread_mutex_unlock(&metrics_mutex);
+
+	return metric;
+}
+
+void metric_destroy(metric_t *metric)
+{
+	if (!metric)
+		return;
+
+	pthread_mutex_lock(&metrics_mutex);
+	da_erase_item(metrics, &metric);
+	if (!metrics.num)
+		da_free(metrics);
+	pthread_mutex_unlock(&metrics_mutex);
+
+	bfree((void*)metric->buckets);
+	bfree(metric->name);
+	bfree(metric->help);
+	bfree(metric->label);
+	bfree(metric->label_value);
+	bfree(metric);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Updating */
+
+size_t metric_get_bucket(uint64_t val)
+{
+	int msb = 0;
+
+	if (val < SUB_BUCKETS)
+		return (size_t)val;
+
+	while (val >> (msb + 1))
+		msb++;
+
+	return (size_t)(msb - 3) * SUB_BUCKETS +
+		(size_t)((val >> (msb - 4)) - SUB_BUCKETS);
+}
+
+uint64_t metric_get_bucket_value(size_t idx)
+{
+	size_t group = idx / SUB_BUCKETS;
+	uint64_t sub = idx % SUB_BUCKETS;
+
+	if (!group)
+		return sub;
+
+	return ((SUB_BUCKETS + sub) << (group - 1)) +
+		((1ULL << (group - 1)) >> 1);
+}
+
+void metric_add(metric_t *metric, long long val)
+{
+	if (metric)
+		os_atomic_add_llong(&metric->value, val);
+}
+
+void metric_set(metric_t *metric, long long val)
+{
+	if (metric)
+		os_atomic_set_llong(&metric->value, val);
+}
+
+void metric_observe(metric_t *metric, uint64_t val)
+{
+	long long cur;
+
+	if (!metric || !metric->buckets)
+		return;
+	if (val > LLONG_MAX)
+		val = LLONG_MAX;
+
+	os_atomic_inc_long(&metric->buckets[metric_get_bucket(val)]);
+	os_atomic_add_llong(&metric->value, (long long)val);
+	os_atomic_add_llong(&metric->count, 1);
+
+	cur = os_atomic_load_llong(&metric->min);
+	while ((long long)val < cur &&
+	       !os_atomic_compare_swap_llong(&metric->min, cur, (long long)val))
+		cur = os_atomic_load_llong(&metric->min);
+
+	cur = os_atomic_load_llong(&metric->max);
+	while ((long long)val > cur &&
+	       !os_atomic_compare_swap_llong(&metric->max, cur, (long long)val))
+		cur = os_atomic_load_llong(&metric->max);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Snapshots */
+
+static int entry_compare(const void *first, const void *second)
+{
+	const struct metrics_snapshot_entry *a = first;
+	const struct metrics_snapshot_entry *b = second;
+	int val = strcmp(a->name, b->name);
+
+	if (val != 0)
+		return val;
+
+	return strcmp(a->label_value ? a->label_value : "",
+			b->label_value ? b->label_value : "");
+}
+
+static void add_entry(metrics_snapshot_t *snap, metric_t *metric)
+{
+	struct metrics_snapshot_entry *entry = da_push_back_new(snap->entries);
+
+	entry->type        = metric->type;
+	entry->name        = bstrdup(metric->name);
+	entry->help        = bstrdup(metric->help);
+	entry->label       = metric->label ? bstrdup(metric->label) : NULL;
+	entry->label_value = metric->label_value ?
+		bstrdup(metric->label_value) : NULL;
+	entry->value       = os_atomic_load_llong(&metric->value);
+
+	if (!metric->buckets)
+		return;
+
+	entry->buckets = bmalloc(sizeof(long) * NUM_BUCKETS);
+	for (size_t i = 0; i < NUM_BUCKETS; i++) {
+		entry->buckets[i] = os_atomic_load_long(&metric->buckets[i]);
+		entry->count += (uint64_t)entry->buckets[i];
+	}
+
+	if (entry->count) {
+		entry->min = (uint64_t)os_atomic_load_llong(&metric->min);
+		entry->max = (uint64_t)os_atomic_load_llong(&metric->max);
+	}
+}
+
+metrics_snapshot_t *metrics_snapshot_create(void)
+{
+	metrics_snapshot_t *snap = bzalloc(sizeof(metrics_snapshot_t));
+
+	pthread_mutex_lock(&metrics_mutex);
+	da_reserve(snap->entries, metrics.num);
+	for (size_t i = 0; i < metrics.num; i++)
+		add_entry(snap, metrics.array[i]);
+	pthread_mutex_unlock(&metrics_mutex);
+
+	qsort(snap->entries.array, snap->entries.num,
+			sizeof(struct metrics_snapshot_entry), entry_compare);
+	return snap;
+}
+
+void metrics_snapshot_free(metrics_snapshot_t *snap)
+{
+	if (!snap)
+		return;
+
+	for (size_t i = 0; i < snap->entries.num; i++) {
+		struct metrics_snapshot_entry *entry = &snap->entries.array[i];
+		bfree(entry->name);
+		bfree(entry->help);
+		bfree(entry->label);
+		bfree(entry->label_value);
+		bfree(entry->buckets);
+	}
+
+	da_free(snap->entries);
+	bfree(snap);
+}
+
+size_t metrics_snapshot_size(metrics_snapshot_t *snap)
+{
+	return snap ? snap->entries.num : 0;
+}
+
+void metrics_snapshot_enumerate(metrics_snapshot_t *snap,
+		metrics_entry_enum_func func, void *param)
+{
+	if (!snap || !func)
+		return;
+
+	for (size_t i = 0; i < snap->entries.num; i++) {
+		if (!func(param, &snap->entries.array[i]))
+			break;
+	}
+}
+
+enum metric_type metrics_snapshot_entry_type(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->type : METRIC_COUNTER;
+}
+
+const char *metrics_snapshot_entry_name(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->name : NULL;
+}
+
+const char *metrics_snapshot_entry_help(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->help : NULL;
+}
+
+const char *metrics_snapshot_entry_label(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->label : NULL;
+}
+
+const char *metrics_snapshot_entry_label_value(
+		metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->label_value : NULL;
+}
+
+long long metrics_snapshot_entry_value(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->value : 0;
+}
+
+uint64_t metrics_snapshot_entry_count(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->count : 0;
+}
+
+uint64_t metrics_snapshot_entry_min(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->min : 0;
+}
+
+uint64_t metrics_snapshot_entry_max(metrics_snapshot_entry_t *entry)
+{
+	return entry ? entry->max : 0;
+}
+
+uint64_t metrics_snapshot_entry_percentile(metrics_snapshot_entry_t *entry,
+		double percentile)
+{
+	uint64_t target;
+	uint64_t total = 0;
+
+	if (!entry || !entry->buckets || !entry->count)
+		return 0;
+
+	target = (uint64_t)((double)entry->count * percentile);
+
+	for (size_t i = 0; i < NUM_BUCKETS; i++) {
+		total += (uint64_t)entry->buckets[i];
+		if (total > target) {
+			uint64_t val = metric_get_bucket_value(i);
+			if (val < entry->min) val = entry->min;
+			if (val > entry->max) val = entry->max;
+			return val;
+		}
+	}
+
+	return entry->max;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Prometheus export */
+
+static void cat_escaped(struct dstr *out, const char *str, bool quotes)
+{
+	for (; *str; str++) {
+		if (*str == '\\')
+			dstr_cat(out, "\\\\");
+		else if (*str == '\n')
+			dstr_cat(out, "\\n");
+		else if (*str == '"' && quotes)
+			dstr_cat(out, "\\\"");
+		else
+			dstr_cat_ch(out, *str);
+	}
+}
+
+static void cat_sample(struct dstr *out, struct metrics_snapshot_entry *entry,
+		const char *suffix, const char *quantile)
+{
+	dstr_cat(out, entry->name);
+	if (suffix)
+		dstr_cat(out, suffix);
+
+	if (entry->label || quantile) {
+		dstr_cat_ch(out, '{');
+
+		if (entry->label) {
+			dstr_catf(out, "%s=\"", entry->label);
+			cat_escaped(out, entry->label_value, true);
+			dstr_cat_ch(out, '"');
+		}
+		if (quantile) {
+			if (entry->label)
+				dstr_cat_ch(out, ',');
+			dstr_catf(out, "quantile=\"%s\"", quantile);
+		}
+
+		dstr_cat_ch(out, '}');
+	}
+
+	dstr_cat_ch(out, ' ');
+}
+
+static const char *prometheus_type(enum metric_type type)
+{
+	switch (type) {
+	case METRIC_COUNTER:   return "counter";
+	case METRIC_GAUGE:     return "gauge";
+	case METRIC_HISTOGRAM: return "summary";
+	}
+
+	return "untyped";
+}
+
+static const struct {
+	const char *name;
+	double     val;
+} quantiles[] = {
+	{"0.5",  0.5},
+	{"0.9",  0.9},
+	{"0.99", 0.99},
+};
+
+char *metrics_snapshot_get_prometheus(metrics_snapshot_t *snap)
+{
+	struct dstr out = {0};
+	const char *prev_name = NULL;
+
+	if (!snap)
+		return NULL;
+
+	dstr_reserve(&out, 4096);
+
+	for (size_t i = 0; i < snap->entries.num; i++) {
+		struct metrics_snapshot_entry *entry = &snap->entries.array[i];
+
+		/* metrics with the same name but different labels are
+		 * sorted next to each other, and share their help/type */
+		if (!prev_name || strcmp(prev_name, entry->name) != 0) {
+			dstr_catf(&out, "# HELP %s ", entry->name);
+			cat_escaped(&out, entry->help, false);
+			dstr_catf(&out, "\n# TYPE %s %s\n", entry->name,
+					prometheus_type(entry->type));
+			prev_name = entry->name;
+		}
+
+		if (entry->type != METRIC_HISTOGRAM) {
+			cat_sample(&out, entry, NULL, NULL);
+			dstr_catf(&out, "%lld\n", entry->value);
+			continue;
+		}
+
+		for (size_t q = 0; q < sizeof(quantiles) / sizeof(*quantiles);
+				q++) {
+			cat_sample(&out, entry, NULL, quantiles[q].name);
+			dstr_catf(&out, "%"PRIu64"\n",
+					metrics_snapshot_entry_percentile(
+						entry, quantiles[q].val));
+		}
+
+		cat_sample(&out, entry, "_sum", NULL);
+		dstr_catf(&out, "%lld\n", entry->value);
+		cat_sample(&out, entry, "_count", NULL);
+		dstr_catf(&out, "%"PRIu64"\n", entry->count);
+	}
+
+	if (!out.array)
+		dstr_copy(&out, "");
+	return out.array;
+}
+
+bool metrics_dump_prometheus(const char *filename)
+{
+	metrics_snapshot_t *snap;
+	struct dstr temp_path = {0};
+	char *text;
+	bool success = false;
+
+	if (!filename || !*filename)
+		return false;
+
+	snap = metrics_snapshot_create();
+	text = metrics_snapshot_get_prometheus(snap);
+	metrics_snapshot_free(snap);
+
+	/* scrapers must never see a partially written file */
+	dstr_printf(&temp_path, "%s.tmp", filename);
+
+	if (os_quick_write_utf8_file(temp_path.array, text, strlen(text),
+				false))
+		success = os_rename(temp_path.array, filename) == 0;
+
+	dstr_free(&temp_path);
+	bfree(text);
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Periodic dumps */
+
+static pthread_mutex_t dump_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t dump_thread;
+static os_event_t *dump_stop_event = NULL;
+static char *dump_filename = NULL;
+static uint32_t dump_interval_ms = 0;
+
+static void *dump_thread_func(void *unused)
+{
+	os_set_thread_name("metrics: dump thread");
+
+	do {
+		if (!metrics_dump_prometheus(dump_filename))
+			blog(LOG_WARNING, "metrics: Failed to write '%s'",
+					dump_filename);
+	} while (os_event_timedwait(dump_stop_event, dump_interval_ms) ==
+			ETIMEDOUT);
+
+	UNUSED_PARAMETER(unused);
+	return NULL;
+}
+
+bool metrics_dump_start(const char *filename, uint32_t interval_ms)
+{
+	bool success = false;
+
+	if (!filename || !*filename || !interval_ms)
+		return false;
+
+	metrics_dump_stop();
+
+	pthread_mutex_lock(&dump_mutex);
+
+	if (os_event_init(&dump_stop_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+
+	dump_filename = bstrdup(filename);
+	dump_interval_ms = interval_ms;
+
+	if (pthread_create(&dump_thread, NULL, dump_thread_func, NULL) != 0) {
+		bfree(dump_filename);
+		dump_filename = NULL;
+		os_event_destroy(dump_stop_event);
+		dump_stop_event = NULL;
+		goto fail;
+	}
+
+	success = true;
+
+fail:
+	pthread_mutex_unlock(&dump_mutex);
+	return success;
+}
+
+void metrics_dump_stop(void)
+{
+	pthread_mutex_lock(&dump_mutex);
+
+	if (dump_stop_event) {
+		os_event_signal(dump_stop_event);
+		pthread_join(dump_thread, NULL);
+
+		os_event_destroy(dump_stop_event);
+		dump_stop_event = NULL;
+
+		bfree(dump_filename);
+		dump_filename = NULL;
+	}
+
+	pthread_mutex_unlock(&dump_mutex);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "c99defs.h"
+
+/*
+ * Metrics registry
+ *
+ *   Counters, gauges and histograms that can be updated from any thread
+ * without locking, and read back as a snapshot or in the Prometheus text
+ * exposition format.  Each metric has a name, a help string, and optionally
+ * a single label (for example, the name of the source it belongs to).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum metric_type {
+	METRIC_COUNTER,
+	METRIC_GAUGE,
+	METRIC_HISTOGRAM
+};
+
+typedef struct metric metric_t;
+typedef struct metrics_snapshot metrics_snapshot_t;
+typedef struct metrics_snapshot_entry metrics_snapshot_entry_t;
+
+/* ------------------------------------------------------------------------- */
+/* Registration */
+
+EXPORT metric_t *metric_create(enum metric_type type, const char *name,
+		const char *help, const char *label, const char *label_value);
+EXPORT void metric_destroy(metric_t *metric);
+
+/* ------------------------------------------------------------------------- */
+/* Updating (lock-free, metric may be NULL) */
+
+EXPORT void metric_add(metric_t *metric, long long val);
+EXPORT void metric_set(metric_t *metric, long long val);
+EXPORT void metric_observe(metric_t *metric, uint64_t val);
+
+static inline void metric_inc(metric_t *metric)
+{
+	metric_add(metric, 1);
+}
+
+/* histograms are log-linear: values 0-15 each get their own bucket, and every
+ * power of 2 after that is split in to 16 buckets, so any value is accurate to
+ * within 1/16 */
+#define METRIC_SUB_BUCKETS 16
+
+/** Returns the index of the histogram bucket a value is counted in */
+EXPORT size_t metric_get_bucket(uint64_t val);
+
+/** Returns the middle of the range of values a histogram bucket holds */
+EXPORT uint64_t metric_get_bucket_value(size_t idx);
+
+/* ------------------------------------------------------------------------- */
+/* Snapshots */
+
+EXPORT metrics_snapshot_t *metrics_snapshot_create(void);
+EXPORT void metrics_snapshot_free(metrics_snapshot_t *snap);
+
+typedef bool (*metrics_entry_enum_func)(void *param,
+		metrics_snapshot_entry_t *entry);
+
+EXPORT size_t metrics_snapshot_size(metrics_snapshot_t *snap);
+EXPORT void metrics_snapshot_enumerate(metrics_snapshot_t *snap,
+		metrics_entry_enum_func func, void *param);
+
+EXPORT enum metric_type metrics_snapshot_entry_type(
+		metrics_snapshot_entry_t *entry);
+EXPORT const char *metrics_snapshot_entry_name(
+		metrics_snapshot_entry_t *entry);
+EXPORT const char *metrics_snapshot_entry_help(
+		metrics_snapshot_entry_t *entry);
+EXPORT const char *metrics_snapshot_entry_label(
+		metrics_snapshot_entry_t *entry);
+EXPORT const char *metrics_snapshot_entry_label_value(
+		metrics_snapshot_entry_t *entry);
+
+/** Value of a counter or gauge, or the sum of a histogram's values */
+EXPORT long long metrics_snapshot_entry_value(
+		metrics_snapshot_entry_t *entry);
+
+EXPORT uint64_t metrics_snapshot_entry_count(
+		metrics_snapshot_entry_t *entry);
+EXPORT uint64_t metrics_snapshot_entry_min(metrics_snapshot_entry_t *entry);
+EXPORT uint64_t metrics_snapshot_entry_max(metrics_snapshot_entry_t *entry);
+EXPORT uint64_t metrics_snapshot_entry_percentile(
+		metrics_snapshot_entry_t *entry, double percentile);
+
+/* ------------------------------------------------------------------------- */
+/* Prometheus export */
+
+/** Returns the metrics in the Prometheus text format, free with bfree */
+EXPORT char *metrics_snapshot_get_prometheus(metrics_snapshot_t *snap);
+EXPORT bool metrics_dump_prometheus(const char *filename);
+
+/** Periodically writes the metrics to a file, for node_exporter's textfile
+ * collector or similar */
+EXPORT bool metrics_dump_start(const char *filename, uint32_t interval_ms);
+EXPORT void metrics_dump_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
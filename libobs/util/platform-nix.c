@@ -167,6 +167,23 @@ void os_sleep_ms(uint32_t duration)
 	usleep(duration*1000);
 }
 
+void os_sleepto_ns_coarse(uint64_t time_target)
+{
+#if defined(__linux__)
+	/* absolute sleep on the same clock as os_gettime_ns, so time spent
+	 * being preempted before the call doesn't add to the sleep */
+	struct timespec req;
+	req.tv_sec = (time_t)(time_target / 1000000000);
+	req.tv_nsec = (long)(time_target % 1000000000);
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &req, NULL)
+			== EINTR)
+		;
+#else
+	os_sleepto_ns(time_target);
+#endif
+}
+
 #if !defined(__APPLE__)
 
 uint64_t os_gettime_ns(void)
@@ -213,6 +213,19 @@ bool os_sleepto_ns(uint64_t time_target)
 	}
 }
 
+void os_sleepto_ns_coarse(uint64_t time_target)
+{
+	uint64_t t = os_gettime_ns();
+	uint32_t milliseconds;
+
+	if (t >= time_target)
+		return;
+
+	milliseconds = (uint32_t)((time_target - t)/1000000);
+	if (milliseconds > 1)
+		Sleep(milliseconds-1);
+}
+
 void os_sleep_ms(uint32_t duration)
 {
 	/* windows 8+ appears to have decreased sleep precision */
@@ -20,6 +20,11 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <locale.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "c99defs.h"
 #include "platform.h"
 #include "bmem.h"
@@ -255,8 +260,17 @@ bool os_quick_write_mbs_file(const char *path, const char *str, size_t len)
 	return true;
 }
 
-bool os_quick_write_utf8_file(const char *path, const char *str, size_t len,
-		bool marker)
+static inline void sync_file(FILE *f)
+{
+#ifdef _WIN32
+	_commit(_fileno(f));
+#else
+	fsync(fileno(f));
+#endif
+}
+
+static bool quick_write_file(const char *path, const void *data,
+		size_t len, bool marker, bool sync)
 {
 	FILE *f = os_fopen(path, "wb");
 	if (!f)
@@ -270,28 +284,36 @@ bool os_quick_write_utf8_file(const char *path, const char *str, size_t len,
 	}
 
 	if (len) {
-		if (fwrite(str, len, 1, f) != 1) {
+		if (fwrite(data, len, 1, f) != 1) {
 			fclose(f);
 			return false;
 		}
 	}
 	fflush(f);
+	if (sync)
+		sync_file(f);
 	fclose(f);
 
 	return true;
 }
 
-bool os_quick_write_utf8_file_safe(const char *path, const char *str,
-		size_t len, bool marker, const char *temp_ext,
-		const char *backup_ext)
+bool os_quick_write_utf8_file(const char *path, const char *str, size_t len,
+		bool marker)
+{
+	return quick_write_file(path, str, len, marker, false);
+}
+
+static bool quick_write_file_safe(const char *func, const char *path,
+		const void *data, size_t len, bool marker,
+		const char *temp_ext, const char *backup_ext)
 {
 	struct dstr backup_path = {0};
 	struct dstr temp_path = {0};
 	bool success = false;
 
 	if (!temp_ext || !*temp_ext) {
-		blog(LOG_ERROR, "os_quick_write_utf8_file_safe: invalid "
-		                "temporary extension specified");
+		blog(LOG_ERROR, "%s: invalid temporary extension specified",
+				func);
 		return false;
 	}
 
@@ -300,9 +322,12 @@ bool os_quick_write_utf8_file_safe(const char *path, const char *str,
 		dstr_cat(&temp_path, ".");
 	dstr_cat(&temp_path, temp_ext);
 
-	if (!os_quick_write_utf8_file(temp_path.array, str, len, marker)) {
-		blog(LOG_ERROR, "os_quick_write_utf8_file_safe: failed to "
-			"write to %s", temp_path.array);
+	/* make sure the data has reached the disk before the temporary file
+	 * replaces the original, otherwise a crash or power loss right after
+	 * the rename can leave an empty file behind */
+	if (!quick_write_file(temp_path.array, data, len, marker, true)) {
+		blog(LOG_ERROR, "%s: failed to write to %s", func,
+				temp_path.array);
 		goto cleanup;
 	}
 
@@ -322,6 +347,54 @@ cleanup:
 	return success;
 }
 
+bool os_quick_write_utf8_file_safe(const char *path, const char *str,
+		size_t len, bool marker, const char *temp_ext,
+		const char *backup_ext)
+{
+	return quick_write_file_safe("os_quick_write_utf8_file_safe", path,
+			str, len, marker, temp_ext, backup_ext);
+}
+
+void *os_quick_read_file(const char *path, size_t *size)
+{
+	FILE *f = os_fopen(path, "rb");
+	int64_t file_size;
+	void *data = NULL;
+
+	*size = 0;
+
+	if (!f)
+		return NULL;
+
+	file_size = os_fgetsize(f);
+	if (file_size > 0 && (uint64_t)file_size <= SIZE_MAX) {
+		data = bmalloc((size_t)file_size);
+
+		if (fread(data, 1, (size_t)file_size, f) ==
+				(size_t)file_size) {
+			*size = (size_t)file_size;
+		} else {
+			bfree(data);
+			data = NULL;
+		}
+	}
+
+	fclose(f);
+	return data;
+}
+
+bool os_quick_write_file(const char *path, const void *data, size_t size)
+{
+	return quick_write_file(path, data, size, false, false);
+}
+
+bool os_quick_write_file_safe(const char *path, const void *data,
+		size_t size, const char *temp_ext, const char *backup_ext)
+{
+	return quick_write_file_safe("os_quick_write_file_safe", path, data,
+			size, false, temp_ext, backup_ext);
+}
+
 int64_t os_get_file_size(const char *path)
 {
 	FILE* f = os_fopen(path, "rb");
@@ -785,3 +858,42 @@ char *os_generate_formatted_filename(const char *extension, bool space,
 
 	return sf.array;
 }
+
+/* ------------------------------------------------------------------------- */
+
+#define DEFAULT_SPIN_NS  500000ULL
+#define MIN_SPIN_NS       50000ULL
+#define MAX_SPIN_NS     2000000ULL
+
+bool os_sleepto_ns_precise(uint64_t time_target, uint64_t *spin_ns)
+{
+	uint64_t spin = *spin_ns ? *spin_ns : DEFAULT_SPIN_NS;
+	uint64_t t = os_gettime_ns();
+
+	if (t >= time_target)
+		return false;
+
+	if (time_target - t > spin) {
+		uint64_t wake_target = time_target - spin;
+		uint64_t late;
+
+		os_sleepto_ns_coarse(wake_target);
+
+		/* keep the spin at about twice the average wake-up delay */
+		t = os_gettime_ns();
+		late = t > wake_target ? t - wake_target : 0;
+		spin = (spin * 7 + late * 2) / 8;
+
+		if (spin < MIN_SPIN_NS)
+			spin = MIN_SPIN_NS;
+		else if (spin > MAX_SPIN_NS)
+			spin = MAX_SPIN_NS;
+	}
+
+	*spin_ns = spin;
+
+	while (os_gettime_ns() < time_target)
+		;
+
+	return true;
+}
@@ -57,6 +57,13 @@ EXPORT char *os_quick_read_mbs_file(const char *path);
 EXPORT bool os_quick_write_mbs_file(const char *path, const char *str,
 		size_t len);
 
+/* binary files, read data is freed with bfree */
+EXPORT void *os_quick_read_file(const char *path, size_t *size);
+EXPORT bool os_quick_write_file(const char *path, const void *data,
+		size_t size);
+EXPORT bool os_quick_write_file_safe(const char *path, const void *data,
+		size_t size, const char *temp_ext, const char *backup_ext);
+
 EXPORT int64_t os_get_file_size(const char *path);
 EXPORT int64_t os_get_free_space(const char *path);
 
@@ -103,6 +110,22 @@ EXPORT void                   os_end_high_performance(os_performance_token_t *);
 EXPORT bool os_sleepto_ns(uint64_t time_target);
 EXPORT void os_sleep_ms(uint32_t duration);
 
+/**
+ * Sleeps to a specific time (in nanoseconds) without spinning, so the wake-up
+ * may be late by the scheduler's granularity.  On Linux this is an absolute
+ * sleep on the same clock as os_gettime_ns.
+ */
+EXPORT void os_sleepto_ns_coarse(uint64_t time_target);
+
+/**
+ * Sleeps until shortly before a specific time (in nanoseconds), then spins
+ * until the time is reached.  spin_ns holds the length of the spin, and is
+ * adjusted after each call to cover how late the sleep tends to wake up; set
+ * it to 0 before the first call.  Returns false if already at or past target
+ * time.
+ */
+EXPORT bool os_sleepto_ns_precise(uint64_t time_target, uint64_t *spin_ns);
+
 EXPORT uint64_t os_gettime_ns(void);
 
 EXPORT int os_get_config_path(char *dst, size_t size, const char *name);
@@ -32,8 +32,11 @@ struct profiler_snapshot_entry {
 
 typedef struct profiler_time_entry profiler_time_entry;
 
-typedef struct profile_call profile_call;
-struct profile_call {
+/* Calls are recorded in the order they were started, so the call tree can be
+ * rebuilt from each record's depth.  A record's end time is filled in once
+ * the call ends. */
+typedef struct profile_record profile_record;
+struct profile_record {
 	const char *name;
 #ifdef TRACK_OVERHEAD
 	uint64_t overhead_start;
@@ -43,9 +46,25 @@ struct profile_call {
 #ifdef TRACK_OVERHEAD
 	uint64_t overhead_end;
 #endif
-	uint64_t expected_time_between_calls;
-	DARRAY(profile_call) children;
-	profile_call *parent;
+	size_t depth;
+};
+
+/* Each thread records its calls into its own ring of records without any
+ * locking.  Records are published once their root call has ended, and are
+ * merged in to the profile entries by whoever holds root_mutex next: either
+ * a snapshot, or the thread itself once its ring is full. */
+typedef struct profile_thread profile_thread;
+struct profile_thread {
+	profile_record *records;
+	size_t capacity;
+
+	volatile long read_pos;
+	volatile long published_pos;
+	long write_pos;
+
+	DARRAY(long) open_calls;
+	bool exited;
+	bool orphaned;
 };
 
 typedef struct profile_times_table_entry profile_times_table_entry;
@@ -80,10 +99,9 @@ struct profile_entry {
 
 typedef struct profile_root_entry profile_root_entry;
 struct profile_root_entry {
-	pthread_mutex_t *mutex;
 	const char *name;
 	profile_entry *entry;
-	profile_call *prev_call;
+	uint64_t prev_start_time;
 };
 
 static inline uint64_t diff_ns_to_usec(uint64_t prev, uint64_t next)
@@ -228,52 +246,52 @@ static profile_entry *get_child(profile_entry *parent, const char *name)
 	return init_entry(da_push_back_new(parent->children), name);
 }
 
-static void merge_call(profile_entry *entry, profile_call *call,
-		profile_call *prev_call)
+static void merge_record(profile_entry *entry, profile_record *record,
+		uint64_t prev_start_time)
 {
-	const size_t num = call->children.num;
-	for (size_t i = 0; i < num; i++) {
-		profile_call *child = &call->children.array[i];
-		merge_call(get_child(entry, child->name), child, NULL);
-	}
-
-	if (entry->expected_time_between_calls != 0 && prev_call) {
+	if (entry->expected_time_between_calls != 0 && prev_start_time) {
 		migrate_old_entries(&entry->times_between_calls, true);
-		uint64_t usec = diff_ns_to_usec(prev_call->start_time,
-				call->start_time);
+		uint64_t usec = diff_ns_to_usec(prev_start_time,
+				record->start_time);
 		add_hashmap_entry(&entry->times_between_calls, usec, 1);
 	}
 
 	migrate_old_entries(&entry->times, true);
-	uint64_t usec = diff_ns_to_usec(call->start_time, call->end_time);
+	uint64_t usec = diff_ns_to_usec(record->start_time, record->end_time);
 	add_hashmap_entry(&entry->times, usec, 1);
 
 #ifdef TRACK_OVERHEAD
 	migrate_old_entries(&entry->overhead, true);
-	usec  = diff_ns_to_usec(call->overhead_start, call->start_time);
-	usec += diff_ns_to_usec(call->end_time, call->overhead_end);
+	usec  = diff_ns_to_usec(record->overhead_start, record->start_time);
+	usec += diff_ns_to_usec(record->end_time, record->overhead_end);
 	add_hashmap_entry(&entry->overhead, usec, 1);
 #endif
 }
 
-static bool enabled = false;
+static volatile bool enabled = false;
 static pthread_mutex_t root_mutex = PTHREAD_MUTEX_INITIALIZER;
 static DARRAY(profile_root_entry) root_entries;
+static DARRAY(profile_thread*) profile_threads;
+static long profile_epoch = 0;
+
+static pthread_key_t profile_thread_key;
+static bool profile_thread_key_valid = false;
 
-static THREAD_LOCAL profile_call *thread_context = NULL;
+static THREAD_LOCAL profile_thread *thread_profile = NULL;
+static THREAD_LOCAL long thread_profile_epoch = 0;
 static THREAD_LOCAL bool thread_enabled = true;
 
 void profiler_start(void)
 {
 	pthread_mutex_lock(&root_mutex);
-	enabled = true;
+	os_atomic_set_bool(&enabled, true);
 	pthread_mutex_unlock(&root_mutex);
 }
 
 void profiler_stop(void)
 {
 	pthread_mutex_lock(&root_mutex);
-	enabled = false;
+	os_atomic_set_bool(&enabled, false);
 	pthread_mutex_unlock(&root_mutex);
 }
 
@@ -282,9 +300,7 @@ void profile_reenable_thread(void)
 	if (thread_enabled)
 		return;
 
-	pthread_mutex_lock(&root_mutex);
-	thread_enabled = enabled;
-	pthread_mutex_unlock(&root_mutex);
+	thread_enabled = os_atomic_load_bool(&enabled);
 }
 
 static bool lock_root(void)
@@ -312,9 +328,6 @@ static profile_root_entry *get_root_entry(const char *name)
 
 	if (!r_entry) {
 		r_entry = da_push_back_new(root_entries);
-		r_entry->mutex = bmalloc(sizeof(pthread_mutex_t));
-		pthread_mutex_init(r_entry->mutex, NULL);
-
 		r_entry->name = name;
 		r_entry->entry = bzalloc(sizeof(profile_entry));
 		init_entry(r_entry->entry, name);
@@ -334,108 +347,485 @@ void profile_register_root(const char *name,
 	pthread_mutex_unlock(&root_mutex);
 }
 
-static void free_call_context(profile_call *context);
+/* ------------------------------------------------------------------------- */
+/* Per-thread call recording */
 
-static void merge_context(profile_call *context)
+#define PROFILE_THREAD_RECORDS 1024
+#define PROFILE_MAX_DEPTH      256
+
+static inline profile_record *get_record(profile_thread *thread, long pos)
 {
-	pthread_mutex_t *mutex = NULL;
-	profile_entry *entry = NULL;
-	profile_call *prev_call = NULL;
+	return &thread->records[(size_t)pos & (thread->capacity - 1)];
+}
 
-	if (!lock_root()) {
-		free_call_context(context);
-		return;
+/* merges all published records of a thread, root_mutex must be held */
+static void collect_thread(profile_thread *thread)
+{
+	profile_entry *entries[PROFILE_MAX_DEPTH];
+	long pos = thread->read_pos;
+	long end = os_atomic_load_long(&thread->published_pos);
+
+	while (pos < end) {
+		profile_record *record = get_record(thread, pos++);
+		profile_root_entry *r_entry = get_root_entry(record->name);
+
+		entries[0] = r_entry->entry;
+		merge_record(entries[0], record, r_entry->prev_start_time);
+		r_entry->prev_start_time = record->start_time;
+
+		while (pos < end) {
+			record = get_record(thread, pos);
+			if (!record->depth)
+				break;
+
+			/* children always directly follow their parent, so
+			 * the parent entry is always the one a level up */
+			entries[record->depth] = get_child(
+					entries[record->depth - 1],
+					record->name);
+			merge_record(entries[record->depth], record, 0);
+			pos++;
+		}
+	}
+
+	os_atomic_set_long(&thread->read_pos, end);
+}
+
+static void free_profile_thread(profile_thread *thread)
+{
+	da_free(thread->open_calls);
+	bfree(thread->records);
+	bfree(thread);
+}
+
+/* root_mutex must be held */
+static void collect_threads(void)
+{
+	for (size_t i = profile_threads.num; i > 0; i--) {
+		profile_thread *thread = profile_threads.array[i - 1];
+
+		collect_thread(thread);
+
+		if (thread->exited) {
+			free_profile_thread(thread);
+			da_erase(profile_threads, i - 1);
+		}
 	}
+}
+
+static void profile_thread_exit(void *data)
+{
+	profile_thread *thread = data;
+
+	pthread_mutex_lock(&root_mutex);
+	if (thread->orphaned)
+		free_profile_thread(thread);
+	else
+		thread->exited = true;
+	pthread_mutex_unlock(&root_mutex);
+}
 
-	profile_root_entry *r_entry = get_root_entry(context->name);
+static profile_thread *create_profile_thread(void)
+{
+	profile_thread *thread = bzalloc(sizeof(profile_thread));
+	thread->capacity = PROFILE_THREAD_RECORDS;
+	thread->records = bmalloc(sizeof(profile_record) * thread->capacity);
+	da_reserve(thread->open_calls, 32);
+
+	pthread_mutex_lock(&root_mutex);
 
-	mutex     = r_entry->mutex;
-	entry     = r_entry->entry;
-	prev_call = r_entry->prev_call;
+	/* a buffer from before profiler_free is only ours to free */
+	if (thread_profile && thread_profile->orphaned)
+		free_profile_thread(thread_profile);
 
-	r_entry->prev_call = context;
+	if (!profile_thread_key_valid)
+		profile_thread_key_valid = pthread_key_create(
+				&profile_thread_key, profile_thread_exit) == 0;
+	if (profile_thread_key_valid)
+		pthread_setspecific(profile_thread_key, thread);
 
-	pthread_mutex_lock(mutex);
+	da_push_back(profile_threads, &thread);
+	thread_profile_epoch = profile_epoch;
 	pthread_mutex_unlock(&root_mutex);
 
-	merge_call(entry, context, prev_call);
+	thread_profile = thread;
+	return thread;
+}
+
+/* makes room for another record once the ring is full: first by merging
+ * everything that has been published so far, and if the current root call
+ * alone fills the ring, by growing it */
+static void make_record_space(profile_thread *thread)
+{
+	pthread_mutex_lock(&root_mutex);
+
+	collect_thread(thread);
+
+	if (thread->write_pos - thread->read_pos >= (long)thread->capacity) {
+		size_t capacity = thread->capacity * 2;
+		profile_record *records =
+			bmalloc(sizeof(profile_record) * capacity);
+
+		for (long pos = thread->read_pos; pos < thread->write_pos;
+				pos++)
+			records[(size_t)pos & (capacity - 1)] =
+				*get_record(thread, pos);
+
+		bfree(thread->records);
+		thread->records = records;
+		thread->capacity = capacity;
+	}
+
+	pthread_mutex_unlock(&root_mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Trace recording
+ *
+ * Unlike the aggregated profile data, traces keep every individual
+ * profile_start/profile_end call with its timestamp, so single slow frames
+ * and the interaction between threads can be inspected.  Each thread records
+ * into its own ring buffer which only that thread writes to; readers copy
+ * the events out and discard any that may have been overwritten meanwhile. */
+
+#define TRACE_BUFFER_EVENTS (1 << 15)
+#define TRACE_BUFFER_MASK   (TRACE_BUFFER_EVENTS - 1)
+
+struct trace_event {
+	const char *name;
+	uint64_t time;
+	bool begin;
+};
+
+struct trace_buffer {
+	struct trace_event events[TRACE_BUFFER_EVENTS];
+	volatile long pos;
 
-	pthread_mutex_unlock(mutex);
+	long generation;
+	long thread_id;
+	long depth;
+	const char *thread_name;
+	bool exited;
+	bool orphaned;
+};
+
+static volatile bool trace_enabled = false;
+static volatile long trace_generation = 0;
+static long trace_epoch = 0;
+static long trace_next_thread_id = 1;
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct trace_buffer*) trace_buffers;
+
+static pthread_key_t trace_thread_key;
+static bool trace_thread_key_valid = false;
+
+static THREAD_LOCAL struct trace_buffer *thread_trace = NULL;
+static THREAD_LOCAL long thread_trace_generation = 0;
+static THREAD_LOCAL long thread_trace_epoch = 0;
+
+static void trace_thread_exit(void *data)
+{
+	struct trace_buffer *buf = data;
+
+	pthread_mutex_lock(&trace_mutex);
+	if (buf->orphaned)
+		bfree(buf);
+	else
+		buf->exited = true;
+	pthread_mutex_unlock(&trace_mutex);
+}
+
+/* buffers of exited threads are reused once their events are from an older
+ * trace, so threads that are frequently recreated don't keep allocating */
+static struct trace_buffer *find_unused_trace_buffer(long generation)
+{
+	for (size_t i = 0; i < trace_buffers.num; i++) {
+		struct trace_buffer *buf = trace_buffers.array[i];
+		if (buf->exited && buf->generation != generation) {
+			buf->exited = false;
+			return buf;
+		}
+	}
+
+	return NULL;
+}
+
+static struct trace_buffer *get_trace_buffer(void)
+{
+	struct trace_buffer *buf;
+	long generation;
+
+	pthread_mutex_lock(&trace_mutex);
+	generation = trace_generation;
+
+	if (thread_trace && thread_trace_epoch == trace_epoch) {
+		buf = thread_trace;
+	} else {
+		/* a buffer from before trace_free is only ours to free */
+		if (thread_trace && thread_trace->orphaned)
+			bfree(thread_trace);
+
+		buf = find_unused_trace_buffer(generation);
+		if (!buf) {
+			buf = bmalloc(sizeof(struct trace_buffer));
+			da_push_back(trace_buffers, &buf);
+		}
+
+		buf->exited = false;
+		buf->orphaned = false;
+		buf->thread_id = trace_next_thread_id++;
+		if (trace_thread_key_valid)
+			pthread_setspecific(trace_thread_key, buf);
+	}
+
+	buf->pos = 0;
+	buf->depth = 0;
+	buf->thread_name = NULL;
+	buf->generation = generation;
+
+	thread_trace = buf;
+	thread_trace_generation = generation;
+	thread_trace_epoch = trace_epoch;
+
+	pthread_mutex_unlock(&trace_mutex);
+	return buf;
+}
+
+static void trace_record(const char *name, bool begin)
+{
+	struct trace_buffer *buf = thread_trace;
+	uint64_t time = os_gettime_ns();
+	struct trace_event *event;
+	long pos;
+
+	if (!buf || thread_trace_generation !=
+			os_atomic_load_long(&trace_generation))
+		buf = get_trace_buffer();
+
+	/* threads are named after their outermost profile node */
+	if (begin) {
+		if (!buf->depth++)
+			buf->thread_name = name;
+	} else if (buf->depth) {
+		buf->depth--;
+	}
+
+	pos = buf->pos;
+	event = &buf->events[pos & TRACE_BUFFER_MASK];
+	event->name  = name;
+	event->time  = time;
+	event->begin = begin;
+	os_atomic_set_long(&buf->pos, pos + 1);
+}
+
+static inline void trace_event(const char *name, bool begin)
+{
+	if (trace_enabled)
+		trace_record(name, begin);
+}
 
-	free_call_context(prev_call);
+void profiler_trace_start(void)
+{
+	pthread_mutex_lock(&trace_mutex);
+	if (!trace_thread_key_valid)
+		trace_thread_key_valid = pthread_key_create(&trace_thread_key,
+				trace_thread_exit) == 0;
+
+	os_atomic_inc_long(&trace_generation);
+	os_atomic_set_bool(&trace_enabled, true);
+	pthread_mutex_unlock(&trace_mutex);
+}
+
+void profiler_trace_stop(void)
+{
+	os_atomic_set_bool(&trace_enabled, false);
+}
+
+bool profiler_trace_active(void)
+{
+	return os_atomic_load_bool(&trace_enabled);
+}
+
+static void trace_free(void)
+{
+	pthread_mutex_lock(&trace_mutex);
+	os_atomic_set_bool(&trace_enabled, false);
+
+	/* threads still holding a buffer will see the new epoch and allocate
+	 * a new one the next time they record */
+	trace_epoch++;
+
+	if (thread_trace && thread_trace->orphaned)
+		bfree(thread_trace);
+
+	/* other threads may be writing to their buffers right now, so those
+	 * are freed by their thread, either on exit or on the next record */
+	for (size_t i = 0; i < trace_buffers.num; i++) {
+		struct trace_buffer *buf = trace_buffers.array[i];
+
+		if (buf->exited || buf == thread_trace)
+			bfree(buf);
+		else
+			buf->orphaned = true;
+	}
+
+	if (thread_trace && trace_thread_key_valid)
+		pthread_setspecific(trace_thread_key, NULL);
+	thread_trace = NULL;
+
+	da_free(trace_buffers);
+	pthread_mutex_unlock(&trace_mutex);
+}
+
+/* returns the calling thread's profile data with room for another record, or
+ * NULL if nothing should be recorded */
+static profile_thread *get_recording_thread(void)
+{
+	profile_thread *thread = thread_profile;
+
+	if (thread_profile_epoch != profile_epoch)
+		thread = NULL;
+
+	/* don't bother recording new root calls while stopped */
+	if ((!thread || !thread->open_calls.num) &&
+	    !os_atomic_load_bool(&enabled)) {
+		thread_enabled = false;
+		return NULL;
+	}
+
+	if (!thread)
+		thread = create_profile_thread();
+
+	if (thread->open_calls.num == PROFILE_MAX_DEPTH) {
+		blog(LOG_ERROR, "Maximum profile depth reached");
+		thread_enabled = false;
+		return NULL;
+	}
+
+	if (thread->write_pos - thread->read_pos >= (long)thread->capacity)
+		make_record_space(thread);
+
+	return thread;
 }
 
 void profile_start(const char *name)
 {
+	trace_event(name, true);
+
 	if (!thread_enabled)
 		return;
 
-	profile_call new_call = {
-		.name = name,
 #ifdef TRACK_OVERHEAD
-		.overhead_start = os_gettime_ns(),
+	uint64_t overhead_start = os_gettime_ns();
 #endif
-		.parent = thread_context,
-	};
+	profile_thread *thread = get_recording_thread();
+	profile_record *record;
 
-	profile_call *call = NULL;
+	if (!thread)
+		return;
 
-	if (new_call.parent) {
-		size_t idx = da_push_back(new_call.parent->children, &new_call);
-		call = &new_call.parent->children.array[idx];
-	} else {
-		call = bmalloc(sizeof(profile_call));
-		memcpy(call, &new_call, sizeof(profile_call));
-	}
+	da_push_back(thread->open_calls, &thread->write_pos);
 
-	thread_context = call;
-	call->start_time = os_gettime_ns();
+	record = get_record(thread, thread->write_pos++);
+	record->name  = name;
+	record->depth = thread->open_calls.num - 1;
+#ifdef TRACK_OVERHEAD
+	record->overhead_start = overhead_start;
+#endif
+	record->start_time = os_gettime_ns();
 }
 
 void profile_end(const char *name)
 {
-	uint64_t end = os_gettime_ns();
+	trace_event(name, false);
+
 	if (!thread_enabled)
 		return;
 
-	profile_call *call = thread_context;
-	if (!call) {
+	uint64_t end = os_gettime_ns();
+
+	/* calls started before the profiler was freed have nothing left to
+	 * end, and the thread's old buffer is orphaned */
+	if (thread_profile_epoch != profile_epoch)
+		return;
+
+	profile_thread *thread = thread_profile;
+	if (!thread || !thread->open_calls.num) {
 		blog(LOG_ERROR, "Called profile end with no active profile");
 		return;
 	}
 
-	if (!call->name)
-		call->name = name;
+	profile_record *record = get_record(thread,
+			*(long*)da_end(thread->open_calls));
+
+	if (!record->name)
+		record->name = name;
 
-	if (call->name != name) {
+	if (record->name != name) {
 		blog(LOG_ERROR, "Called profile end with mismatching name: "
 				"start(\"%s\"[%p]) <-> end(\"%s\"[%p])",
-				call->name, call->name, name, name);
+				record->name, record->name, name, name);
 
-		profile_call *parent = call->parent;
-		while (parent && parent->parent &&  parent->name != name)
-			parent = parent->parent;
+		size_t idx = thread->open_calls.num - 1;
+		while (idx > 0 && get_record(thread,
+					thread->open_calls.array[idx])->name
+				!= name)
+			idx--;
 
-		if (!parent || parent->name != name)
+		if (get_record(thread, thread->open_calls.array[idx])->name
+				!= name)
 			return;
 
-		while (call->name != name) {
-			profile_end(call->name);
-			call = call->parent;
+		while (record->name != name) {
+			profile_end(record->name);
+			record = get_record(thread,
+					*(long*)da_end(thread->open_calls));
 		}
 	}
 
-	thread_context = call->parent;
+	da_pop_back(thread->open_calls);
 
-	call->end_time = end;
+	record->end_time = end;
 #ifdef TRACK_OVERHEAD
-	call->overhead_end = os_gettime_ns();
+	record->overhead_end = os_gettime_ns();
 #endif
 
-	if (call->parent)
+	if (thread->open_calls.num)
+		return;
+
+	if (!os_atomic_load_bool(&enabled)) {
+		thread->write_pos = thread->published_pos;
+		thread_enabled = false;
+		return;
+	}
+
+	os_atomic_set_long(&thread->published_pos, thread->write_pos);
+}
+
+void profile_add_call(const char *name, uint64_t start_time,
+		uint64_t end_time)
+{
+	if (!thread_enabled)
+		return;
+
+	profile_thread *thread = get_recording_thread();
+	profile_record *record;
+
+	if (!thread)
 		return;
 
-	merge_context(call);
+	record = get_record(thread, thread->write_pos++);
+	record->name       = name;
+	record->depth      = thread->open_calls.num;
+	record->start_time = start_time;
+	record->end_time   = end_time;
+#ifdef TRACK_OVERHEAD
+	record->overhead_start = start_time;
+	record->overhead_end   = end_time;
+#endif
+
+	if (!thread->open_calls.num)
+		os_atomic_set_long(&thread->published_pos, thread->write_pos);
 }
 
 static int profiler_time_entry_compare(const void *first, const void *second)
@@ -757,24 +1147,6 @@ void profiler_print_time_between_calls(profiler_snapshot_t *snap)
 			profile_print_entry_expected, snap);
 }
 
-static void free_call_children(profile_call *call)
-{
-	if (!call)
-		return;
-
-	const size_t num = call->children.num;
-	for (size_t i = 0; i < num; i++)
-		free_call_children(&call->children.array[i]);
-
-	da_free(call->children);
-}
-
-static void free_call_context(profile_call *context)
-{
-	free_call_children(context);
-	bfree(context);
-}
-
 static void free_hashmap(profile_times_table *map)
 {
 	map->size = 0;
@@ -802,27 +1174,197 @@ void profiler_free(void)
 	DARRAY(profile_root_entry) old_root_entries = {0};
 
 	pthread_mutex_lock(&root_mutex);
-	enabled = false;
+	os_atomic_set_bool(&enabled, false);
 	da_move(old_root_entries, root_entries);
-	pthread_mutex_unlock(&root_mutex);
 
-	for (size_t i = 0; i < old_root_entries.num; i++) {
-		profile_root_entry *entry = &old_root_entries.array[i];
+	/* threads still holding their buffers will see the new epoch and
+	 * create new ones instead of recording into the old ones */
+	profile_epoch++;
 
-		pthread_mutex_lock(entry->mutex);
-		pthread_mutex_unlock(entry->mutex);
+	if (thread_profile && thread_profile->orphaned)
+		free_profile_thread(thread_profile);
 
-		pthread_mutex_destroy(entry->mutex);
-		bfree(entry->mutex);
-		entry->mutex = NULL;
+	/* other threads may be in the middle of a call right now, so their
+	 * buffers are freed by their thread, either on exit or on the next
+	 * call */
+	for (size_t i = 0; i < profile_threads.num; i++) {
+		profile_thread *thread = profile_threads.array[i];
 
-		free_call_context(entry->prev_call);
+		if (thread->exited || thread == thread_profile)
+			free_profile_thread(thread);
+		else
+			thread->orphaned = true;
+	}
+
+	if (thread_profile && profile_thread_key_valid)
+		pthread_setspecific(profile_thread_key, NULL);
+	thread_profile = NULL;
+
+	da_free(profile_threads);
+	pthread_mutex_unlock(&root_mutex);
+
+	for (size_t i = 0; i < old_root_entries.num; i++) {
+		profile_root_entry *entry = &old_root_entries.array[i];
 
 		free_profile_entry(entry->entry);
 		bfree(entry->entry);
 	}
 
 	da_free(old_root_entries);
+
+	trace_free();
+}
+
+/* ------------------------------------------------------------------------- */
+/* Trace export */
+
+#define TRACE_WRITE_SIZE (64 * 1024)
+
+struct trace_writer {
+	FILE *file;
+	struct dstr buffer;
+	bool first;
+};
+
+static void trace_flush(struct trace_writer *w, bool force)
+{
+	if (w->buffer.len && (force || w->buffer.len >= TRACE_WRITE_SIZE)) {
+		fwrite(w->buffer.array, 1, w->buffer.len, w->file);
+		w->buffer.len = 0;
+		w->buffer.array[0] = 0;
+	}
+}
+
+static void trace_write_string(struct trace_writer *w, const char *str)
+{
+	dstr_cat_ch(&w->buffer, '"');
+
+	for (; str && *str; str++) {
+		char ch = *str;
+
+		if (ch == '"' || ch == '\\') {
+			dstr_cat_ch(&w->buffer, '\\');
+			dstr_cat_ch(&w->buffer, ch);
+		} else if ((unsigned char)ch < 0x20) {
+			dstr_catf(&w->buffer, "\\u%04x", (unsigned)ch);
+		} else {
+			dstr_cat_ch(&w->buffer, ch);
+		}
+	}
+
+	dstr_cat_ch(&w->buffer, '"');
+}
+
+static void trace_write_separator(struct trace_writer *w)
+{
+	if (!w->first)
+		dstr_cat(&w->buffer, ",\n");
+	w->first = false;
+}
+
+/* copies the valid events of a buffer that may still be written to */
+static void copy_trace_events(struct trace_buffer *buf,
+		struct trace_event **events, size_t *count)
+{
+	long end = os_atomic_load_long(&buf->pos);
+	long start = end > TRACE_BUFFER_EVENTS ? end - TRACE_BUFFER_EVENTS : 0;
+	long valid_start;
+	struct trace_event *copy;
+
+	copy = bmalloc(sizeof(struct trace_event) * (end - start + 1));
+	for (long i = start; i < end; i++)
+		copy[i - start] = buf->events[i & TRACE_BUFFER_MASK];
+
+	/* the writer may have wrapped around onto the oldest events while
+	 * they were being copied */
+	valid_start = os_atomic_load_long(&buf->pos) - TRACE_BUFFER_EVENTS + 1;
+	if (valid_start > start) {
+		long skip = valid_start < end ? valid_start - start :
+			end - start;
+		memmove(copy, copy + skip,
+				sizeof(struct trace_event) * (end - start - skip));
+		end -= skip;
+	}
+
+	*events = copy;
+	*count = (size_t)(end - start);
+}
+
+static void trace_write_buffer(struct trace_writer *w,
+		struct trace_buffer *buf)
+{
+	struct trace_event *events;
+	size_t count;
+	long depth = 0;
+
+	copy_trace_events(buf, &events, &count);
+
+	trace_write_separator(w);
+	dstr_catf(&w->buffer, "{\"name\":\"thread_name\",\"ph\":\"M\","
+			"\"pid\":1,\"tid\":%ld,\"args\":{\"name\":",
+			buf->thread_id);
+	trace_write_string(w, buf->thread_name);
+	dstr_cat(&w->buffer, "}}");
+
+	for (size_t i = 0; i < count; i++) {
+		struct trace_event *event = &events[i];
+
+		/* skip ends whose beginning is no longer in the buffer */
+		if (event->begin)
+			depth++;
+		else if (depth)
+			depth--;
+		else
+			continue;
+
+		trace_write_separator(w);
+		dstr_cat(&w->buffer, "{\"name\":");
+		trace_write_string(w, event->name);
+		dstr_catf(&w->buffer, ",\"ph\":\"%c\",\"ts\":%"PRIu64".%03d,"
+				"\"pid\":1,\"tid\":%ld}",
+				event->begin ? 'B' : 'E',
+				event->time / 1000,
+				(int)(event->time % 1000),
+				buf->thread_id);
+
+		trace_flush(w, false);
+	}
+
+	bfree(events);
+}
+
+bool profiler_trace_dump_json(const char *filename)
+{
+	DARRAY(struct trace_buffer*) buffers = {0};
+	struct trace_writer w = {0};
+	long generation;
+
+	w.file = os_fopen(filename, "wb");
+	if (!w.file)
+		return false;
+
+	pthread_mutex_lock(&trace_mutex);
+	generation = trace_generation;
+	for (size_t i = 0; i < trace_buffers.num; i++) {
+		struct trace_buffer *buf = trace_buffers.array[i];
+		if (buf->generation == generation)
+			da_push_back(buffers, &buf);
+	}
+	pthread_mutex_unlock(&trace_mutex);
+
+	w.first = true;
+	dstr_copy(&w.buffer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (size_t i = 0; i < buffers.num; i++)
+		trace_write_buffer(&w, buffers.array[i]);
+
+	dstr_cat(&w.buffer, "\n]}\n");
+	trace_flush(&w, true);
+
+	fclose(w.file);
+	dstr_free(&w.buffer);
+	da_free(buffers);
+	return true;
 }
 
 
@@ -929,13 +1471,12 @@ profiler_snapshot_t *profile_snapshot_create(void)
 	profiler_snapshot_t *snap = bzalloc(sizeof(profiler_snapshot_t));
 
 	pthread_mutex_lock(&root_mutex);
+	collect_threads();
+
 	da_reserve(snap->roots, root_entries.num);
-	for (size_t i = 0; i < root_entries.num; i++) {
-		pthread_mutex_lock(root_entries.array[i].mutex);
+	for (size_t i = 0; i < root_entries.num; i++)
 		add_entry_to_snapshot(root_entries.array[i].entry,
 				da_push_back_new(snap->roots));
-		pthread_mutex_unlock(root_entries.array[i].mutex);
-	}
 	pthread_mutex_unlock(&root_mutex);
 
 	for (size_t i = 0; i < snap->roots.num; i++)
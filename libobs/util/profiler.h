@@ -20,6 +20,11 @@ EXPORT void profile_register_root(const char *name,
 EXPORT void profile_start(const char *name);
 EXPORT void profile_end(const char *name);
 
+/** Records a call that has already ended as a child of the current call, for
+ * time spans that don't nest, such as how long a lock was held */
+EXPORT void profile_add_call(const char *name, uint64_t start_time,
+		uint64_t end_time);
+
 EXPORT void profile_reenable_thread(void);
 
 /* ------------------------------------------------------------------------- */
@@ -33,6 +38,15 @@ EXPORT void profiler_print_time_between_calls(profiler_snapshot_t *snap);
 
 EXPORT void profiler_free(void);
 
+/* ------------------------------------------------------------------------- */
+/* Trace recording */
+
+EXPORT void profiler_trace_start(void);
+EXPORT void profiler_trace_stop(void);
+EXPORT bool profiler_trace_active(void);
+
+EXPORT bool profiler_trace_dump_json(const char *filename);
+
 /* ------------------------------------------------------------------------- */
 /* Profiler name storage */
 
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "c99defs.h"
+
+/* private to the threading implementation, shared between threading.c and
+ * threading-posix.c / threading-windows.c */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implemented in threading.c */
+extern void os_thread_register(const char *name);
+
+/* implemented in threading-posix.c / threading-windows.c */
+extern uint64_t os_thread_current_id(void);
+extern void *os_thread_open_current(void);
+extern void os_thread_close(void *thread);
+extern uint64_t os_thread_get_cpu_time(void *thread);
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,17 +21,28 @@
 #include <mach/semaphore.h>
 #include <mach/task.h>
 #include <mach/mach_init.h>
+#include <mach/thread_act.h>
 #else
 #define _GNU_SOURCE
 #include <semaphore.h>
+#include <time.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <sched.h>
+
 #if defined(__FreeBSD__)
 #include <pthread_np.h>
 #endif
 
 #include "bmem.h"
 #include "threading.h"
+#include "threading-internal.h"
 
 struct os_event_data {
 	pthread_mutex_t mutex;
@@ -261,4 +272,112 @@ void os_set_thread_name(const char *name)
 		bfree(thread_name);
 	}
 #endif
+
+	os_thread_register(name);
+}
+
+bool os_set_thread_priority(enum os_thread_priority priority)
+{
+	struct sched_param param;
+	int policy = SCHED_OTHER;
+
+	memset(&param, 0, sizeof(param));
+
+	if (priority == OS_THREAD_PRIORITY_REALTIME_RR)
+		policy = SCHED_RR;
+	else if (priority == OS_THREAD_PRIORITY_REALTIME_FIFO)
+		policy = SCHED_FIFO;
+
+	/* stay in the lower part of the range to not starve the system's own
+	 * realtime threads (audio servers, interrupt handlers) */
+	if (policy != SCHED_OTHER) {
+		int min = sched_get_priority_min(policy);
+		int max = sched_get_priority_max(policy);
+		param.sched_priority = min + (max - min) / 4;
+	}
+
+	if (pthread_setschedparam(pthread_self(), policy, &param) != 0)
+		return false;
+
+#if defined(__linux__)
+	/* nice values apply to individual threads on linux */
+	if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid),
+				priority == OS_THREAD_PRIORITY_HIGH ? -10 : 0) != 0)
+		return priority != OS_THREAD_PRIORITY_HIGH;
+	return true;
+#else
+	return priority != OS_THREAD_PRIORITY_HIGH;
+#endif
+}
+
+uint64_t os_thread_current_id(void)
+{
+#if defined(__APPLE__)
+	uint64_t id = 0;
+	pthread_threadid_np(NULL, &id);
+	return id;
+#elif defined(__linux__)
+	return (uint64_t)syscall(SYS_gettid);
+#elif defined(__FreeBSD__)
+	return (uint64_t)pthread_getthreadid_np();
+#else
+	return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+#ifdef __APPLE__
+
+void *os_thread_open_current(void)
+{
+	mach_port_t *port = bmalloc(sizeof(mach_port_t));
+	*port = pthread_mach_thread_np(pthread_self());
+	return port;
+}
+
+uint64_t os_thread_get_cpu_time(void *thread)
+{
+	mach_port_t *port = thread;
+	thread_basic_info_data_t info;
+	mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+
+	if (thread_info(*port, THREAD_BASIC_INFO, (thread_info_t)&info,
+				&count) != KERN_SUCCESS)
+		return 0;
+
+	return (uint64_t)(info.user_time.seconds +
+			info.system_time.seconds) * 1000000000ULL +
+		(uint64_t)(info.user_time.microseconds +
+			info.system_time.microseconds) * 1000ULL;
+}
+
+#else
+
+void *os_thread_open_current(void)
+{
+	clockid_t *clock = bmalloc(sizeof(clockid_t));
+
+	if (pthread_getcpuclockid(pthread_self(), clock) != 0) {
+		bfree(clock);
+		return NULL;
+	}
+
+	return clock;
+}
+
+uint64_t os_thread_get_cpu_time(void *thread)
+{
+	clockid_t *clock = thread;
+	struct timespec ts;
+
+	if (clock_gettime(*clock, &ts) != 0)
+		return 0;
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif
+
+void os_thread_close(void *thread)
+{
+	bfree(thread);
 }
@@ -42,6 +42,29 @@ static inline bool os_atomic_compare_swap_long(volatile long *val,
 	return __sync_bool_compare_and_swap(val, old_val, new_val);
 }
 
+static inline long long os_atomic_add_llong(volatile long long *val,
+		long long add)
+{
+	return __sync_add_and_fetch(val, add);
+}
+
+static inline long long os_atomic_set_llong(volatile long long *ptr,
+		long long val)
+{
+	return __sync_lock_test_and_set(ptr, val);
+}
+
+static inline long long os_atomic_load_llong(const volatile long long *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static inline bool os_atomic_compare_swap_llong(volatile long long *val,
+		long long old_val, long long new_val)
+{
+	return __sync_bool_compare_and_swap(val, old_val, new_val);
+}
+
 static inline bool os_atomic_set_bool(volatile bool *ptr, bool val)
 {
 	return __sync_lock_test_and_set(ptr, val);
@@ -16,6 +16,7 @@
 
 #include "bmem.h"
 #include "threading.h"
+#include "threading-internal.h"
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -188,4 +189,60 @@ void os_set_thread_name(const char *name)
 #endif
 	}
 #endif
+
+	os_thread_register(name);
+}
+
+bool os_set_thread_priority(enum os_thread_priority priority)
+{
+	int win_priority = THREAD_PRIORITY_NORMAL;
+
+	switch (priority) {
+	case OS_THREAD_PRIORITY_NORMAL:
+		break;
+	case OS_THREAD_PRIORITY_HIGH:
+		win_priority = THREAD_PRIORITY_HIGHEST;
+		break;
+	case OS_THREAD_PRIORITY_REALTIME_RR:
+	case OS_THREAD_PRIORITY_REALTIME_FIFO:
+		win_priority = THREAD_PRIORITY_TIME_CRITICAL;
+		break;
+	}
+
+	return !!SetThreadPriority(GetCurrentThread(), win_priority);
+}
+
+uint64_t os_thread_current_id(void)
+{
+	return (uint64_t)GetCurrentThreadId();
+}
+
+void *os_thread_open_current(void)
+{
+	return OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE,
+			GetCurrentThreadId());
+}
+
+void os_thread_close(void *thread)
+{
+	CloseHandle((HANDLE)thread);
+}
+
+static inline uint64_t filetime_to_ns(const FILETIME *ft)
+{
+	ULARGE_INTEGER val;
+	val.LowPart  = ft->dwLowDateTime;
+	val.HighPart = ft->dwHighDateTime;
+	return val.QuadPart * 100;
+}
+
+uint64_t os_thread_get_cpu_time(void *thread)
+{
+	FILETIME create_time, exit_time, kernel_time, user_time;
+
+	if (!GetThreadTimes((HANDLE)thread, &create_time, &exit_time,
+				&kernel_time, &user_time))
+		return 0;
+
+	return filetime_to_ns(&kernel_time) + filetime_to_ns(&user_time);
 }
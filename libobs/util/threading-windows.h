@@ -44,6 +44,39 @@ static inline bool os_atomic_compare_swap_long(volatile long *val,
 	return _InterlockedCompareExchange(val, new_val, old_val) == old_val;
 }
 
+/* 64-bit operations are implemented with compare-exchange, which is the only
+ * 64-bit interlocked intrinsic that is also available on 32-bit x86 */
+static inline bool os_atomic_compare_swap_llong(volatile long long *val,
+		long long old_val, long long new_val)
+{
+	return _InterlockedCompareExchange64(val, new_val, old_val) == old_val;
+}
+
+static inline long long os_atomic_load_llong(const volatile long long *ptr)
+{
+	return _InterlockedCompareExchange64((volatile long long*)ptr, 0, 0);
+}
+
+static inline long long os_atomic_add_llong(volatile long long *val,
+		long long add)
+{
+	long long old_val;
+	do {
+		old_val = *val;
+	} while (!os_atomic_compare_swap_llong(val, old_val, old_val + add));
+	return old_val + add;
+}
+
+static inline long long os_atomic_set_llong(volatile long long *ptr,
+		long long val)
+{
+	long long old_val;
+	do {
+		old_val = *ptr;
+	} while (!os_atomic_compare_swap_llong(ptr, old_val, val));
+	return old_val;
+}
+
 static inline bool os_atomic_set_bool(volatile bool *ptr, bool val)
 {
 	return !!_InterlockedExchange8((volatile char*)ptr, (char)val);
@@ -0,0 +1,248 @@
+#include "bmem.h"
+#include "darray.h"
+#include "platform.h"
+#include "profiler.h"
+#include "threading.h"
+#include "threading-internal.h"
+
+/* threads that have exited are kept around so their totals can still be
+ * reported, but only up to this many */
+#define MAX_EXITED_THREADS 256
+
+struct thread_entry {
+	char     *name;
+	char     *owner;
+	uint64_t id;
+	uint64_t start_time_ns;
+	uint64_t end_time_ns;
+	uint64_t cpu_time_ns;
+	void     *handle;
+};
+
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct thread_entry*) registry;
+static size_t num_exited = 0;
+
+static pthread_once_t registry_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t registry_key;
+
+/* ------------------------------------------------------------------------- */
+
+static void thread_entry_free(struct thread_entry *entry)
+{
+	if (entry->handle)
+		os_thread_close(entry->handle);
+	bfree(entry->name);
+	bfree(entry->owner);
+	bfree(entry);
+}
+
+static inline void thread_entry_sample(struct thread_entry *entry)
+{
+	uint64_t cpu_time;
+
+	if (!entry->handle)
+		return;
+
+	cpu_time = os_thread_get_cpu_time(entry->handle);
+	if (cpu_time)
+		entry->cpu_time_ns = cpu_time;
+}
+
+/* the pointer stored in the thread key may outlive the entry if the registry
+ * was freed in the meantime, so it must be found in the list before it can be
+ * dereferenced */
+static bool thread_entry_valid(struct thread_entry *entry)
+{
+	if (!entry || da_find(registry, &entry, 0) == DARRAY_INVALID)
+		return false;
+	if (entry->end_time_ns)
+		return false;
+	return entry->id == os_thread_current_id();
+}
+
+static void prune_exited_threads(void)
+{
+	size_t i = 0;
+
+	while (num_exited > MAX_EXITED_THREADS && i < registry.num) {
+		struct thread_entry *entry = registry.array[i];
+
+		if (entry->end_time_ns) {
+			da_erase(registry, i);
+			thread_entry_free(entry);
+			num_exited--;
+		} else {
+			i++;
+		}
+	}
+}
+
+static void thread_exited(void *data)
+{
+	struct thread_entry *entry = data;
+
+	pthread_mutex_lock(&registry_mutex);
+
+	if (thread_entry_valid(entry)) {
+		thread_entry_sample(entry);
+		os_thread_close(entry->handle);
+		entry->handle = NULL;
+		entry->end_time_ns = os_gettime_ns();
+		num_exited++;
+
+		prune_exited_threads();
+	}
+
+	pthread_mutex_unlock(&registry_mutex);
+}
+
+static void create_registry_key(void)
+{
+	pthread_key_create(&registry_key, thread_exited);
+}
+
+/* must be called with the registry mutex held */
+static struct thread_entry *get_current_entry(void)
+{
+	struct thread_entry *entry;
+
+	pthread_once(&registry_key_once, create_registry_key);
+
+	entry = pthread_getspecific(registry_key);
+	if (thread_entry_valid(entry))
+		return entry;
+
+	entry = bzalloc(sizeof(struct thread_entry));
+	entry->id = os_thread_current_id();
+	entry->start_time_ns = os_gettime_ns();
+	entry->handle = os_thread_open_current();
+	da_push_back(registry, &entry);
+
+	pthread_setspecific(registry_key, entry);
+	return entry;
+}
+
+static inline void replace_string(char **dst, const char *src)
+{
+	bfree(*dst);
+	*dst = src ? bstrdup(src) : NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void os_thread_register(const char *name)
+{
+	pthread_mutex_lock(&registry_mutex);
+	replace_string(&get_current_entry()->name, name);
+	pthread_mutex_unlock(&registry_mutex);
+}
+
+void os_set_thread_owner(const char *owner)
+{
+	pthread_mutex_lock(&registry_mutex);
+	replace_string(&get_current_entry()->owner, owner);
+	pthread_mutex_unlock(&registry_mutex);
+}
+
+void os_enum_threads(os_enum_thread_cb cb, void *param)
+{
+	DARRAY(struct os_thread_info) threads;
+
+	if (!cb)
+		return;
+
+	da_init(threads);
+
+	pthread_mutex_lock(&registry_mutex);
+
+	da_reserve(threads, registry.num);
+	for (size_t i = 0; i < registry.num; i++) {
+		struct thread_entry *entry = registry.array[i];
+		struct os_thread_info *info = da_push_back_new(threads);
+
+		thread_entry_sample(entry);
+
+		info->name          = bstrdup(entry->name);
+		info->owner         = bstrdup(entry->owner);
+		info->id            = entry->id;
+		info->cpu_time_ns   = entry->cpu_time_ns;
+		info->start_time_ns = entry->start_time_ns;
+		info->end_time_ns   = entry->end_time_ns;
+	}
+
+	pthread_mutex_unlock(&registry_mutex);
+
+	for (size_t i = 0; i < threads.num; i++) {
+		if (!cb(param, threads.array + i))
+			break;
+	}
+
+	for (size_t i = 0; i < threads.num; i++) {
+		bfree((char*)threads.array[i].name);
+		bfree((char*)threads.array[i].owner);
+	}
+	da_free(threads);
+}
+
+void os_thread_registry_free(void)
+{
+	pthread_mutex_lock(&registry_mutex);
+
+	for (size_t i = 0; i < registry.num; i++)
+		thread_entry_free(registry.array[i]);
+	da_free(registry);
+	num_exited = 0;
+
+	pthread_mutex_unlock(&registry_mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Lock profiling */
+
+#define MAX_HELD_LOCKS 32
+
+struct held_lock {
+	pthread_mutex_t *mutex;
+	uint64_t        lock_time;
+};
+
+static THREAD_LOCAL struct held_lock held_locks[MAX_HELD_LOCKS];
+static THREAD_LOCAL size_t num_held_locks = 0;
+
+int os_profiled_mutex_lock(pthread_mutex_t *mutex, const char *wait_name)
+{
+	int ret;
+
+	profile_start(wait_name);
+	ret = pthread_mutex_lock(mutex);
+	profile_end(wait_name);
+
+	if (ret == 0 && num_held_locks < MAX_HELD_LOCKS) {
+		struct held_lock *held = &held_locks[num_held_locks++];
+		held->mutex     = mutex;
+		held->lock_time = os_gettime_ns();
+	}
+
+	return ret;
+}
+
+int os_profiled_mutex_unlock(pthread_mutex_t *mutex, const char *hold_name)
+{
+	/* locks are usually released in reverse order, but not always */
+	for (size_t i = num_held_locks; i > 0; i--) {
+		struct held_lock *held = &held_locks[i - 1];
+
+		if (held->mutex != mutex)
+			continue;
+
+		profile_add_call(hold_name, held->lock_time, os_gettime_ns());
+
+		memmove(held, held + 1,
+				(num_held_locks - i) * sizeof(struct held_lock));
+		num_held_locks--;
+		break;
+	}
+
+	return pthread_mutex_unlock(mutex);
+}
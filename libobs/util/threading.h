@@ -78,6 +78,71 @@ EXPORT int  os_sem_wait(os_sem_t *sem);
 
 EXPORT void os_set_thread_name(const char *name);
 
+enum os_thread_priority {
+	OS_THREAD_PRIORITY_NORMAL,
+	OS_THREAD_PRIORITY_HIGH,          /* nice -10 / THREAD_PRIORITY_HIGHEST */
+	OS_THREAD_PRIORITY_REALTIME_RR,   /* SCHED_RR / TIME_CRITICAL */
+	OS_THREAD_PRIORITY_REALTIME_FIFO, /* SCHED_FIFO / TIME_CRITICAL */
+};
+
+/** Sets the scheduling priority of the calling thread.  Raising the
+ * priority usually requires extra privileges, returns false if it failed. */
+EXPORT bool os_set_thread_priority(enum os_thread_priority priority);
+
+/* ------------------------------------------------------------------------- */
+/* Thread registry */
+
+/*
+ *   Threads that call os_set_thread_name are added to a registry along with
+ * the CPU time they have used, so that the cost of each thread (and of the
+ * source/output/encoder that owns it) can be reported.
+ */
+
+struct os_thread_info {
+	const char *name;
+	const char *owner;
+	uint64_t   id;
+	uint64_t   cpu_time_ns;
+	uint64_t   start_time_ns;
+	uint64_t   end_time_ns; /* 0 while the thread is still running */
+};
+
+typedef bool (*os_enum_thread_cb)(void *param,
+		const struct os_thread_info *info);
+
+/** Sets the name of the object (source, output, etc) the calling thread is
+ * working for */
+EXPORT void os_set_thread_owner(const char *owner);
+EXPORT void os_enum_threads(os_enum_thread_cb cb, void *param);
+EXPORT void os_thread_registry_free(void);
+
+/* ------------------------------------------------------------------------- */
+/* Lock profiling */
+
+/*
+ *   When built with OBS_LOCK_PROFILING defined, mutexes locked with
+ * os_mutex_lock_named/os_mutex_unlock_named record the time spent waiting
+ * for the lock as "lock_wait(name)" and the time it was held as
+ * "lock_hold(name)" in the profiler, as children of the current profiler
+ * call.  Otherwise they are plain pthread_mutex_lock/unlock calls.  The
+ * name must be a string literal.
+ */
+
+EXPORT int os_profiled_mutex_lock(pthread_mutex_t *mutex,
+		const char *wait_name);
+EXPORT int os_profiled_mutex_unlock(pthread_mutex_t *mutex,
+		const char *hold_name);
+
+#ifdef OBS_LOCK_PROFILING
+#define os_mutex_lock_named(mutex, name) \
+	os_profiled_mutex_lock(mutex, "lock_wait(" name ")")
+#define os_mutex_unlock_named(mutex, name) \
+	os_profiled_mutex_unlock(mutex, "lock_hold(" name ")")
+#else
+#define os_mutex_lock_named(mutex, name) pthread_mutex_lock(mutex)
+#define os_mutex_unlock_named(mutex, name) pthread_mutex_unlock(mutex)
+#endif
+
 #ifdef _MSC_VER
 #define THREAD_LOCAL __declspec(thread)
 #else
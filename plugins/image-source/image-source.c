@@ -26,8 +26,24 @@ struct image_source {
 	bool         active;
 
 	gs_image_file2_t if2;
+	long         texture_version;
 };
 
+/* texture versions have to be unique across sources, as a freed texture can
+ * be reallocated at the same address by another source */
+static volatile long texture_version_counter = 0;
+
+static inline void bump_texture_version(struct image_source *context)
+{
+	/* animated images change too often to be worth copying to the sprite
+	 * atlas */
+	if (context->if2.image.is_animated_gif)
+		context->texture_version = 0;
+	else
+		context->texture_version =
+			os_atomic_inc_long(&texture_version_counter);
+}
+
 
 static time_t get_modified_timestamp(const char *filename)
 {
@@ -61,9 +77,13 @@ static void image_source_load(struct image_source *context)
 		gs_image_file2_init_texture(&context->if2);
 		obs_leave_graphics();
 
+		bump_texture_version(context);
+
 		if (!context->if2.image.loaded)
 			warn("failed to load texture '%s'", file);
 	}
+
+	obs_source_video_changed(context->source);
 }
 
 static void image_source_unload(struct image_source *context)
@@ -151,9 +171,11 @@ static void image_source_render(void *data, gs_effect_t *effect)
 	if (!context->if2.image.texture)
 		return;
 
-	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"),
-			context->if2.image.texture);
-	gs_draw_sprite(context->if2.image.texture, 0,
+	/* drawn through the sprite batch so that consecutive images in a
+	 * scene can share draw calls */
+	effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_sprite_batch_draw(effect, "Draw", context->if2.image.texture,
+			context->texture_version,
 			context->if2.image.cx, context->if2.image.cy);
 }
 
@@ -190,6 +212,7 @@ static void image_source_tick(void *data, float seconds)
 				obs_enter_graphics();
 				gs_image_file2_update_texture(&context->if2);
 				obs_leave_graphics();
+				obs_source_video_changed(context->source);
 			}
 
 			context->active = false;
@@ -206,6 +229,7 @@ static void image_source_tick(void *data, float seconds)
 			obs_enter_graphics();
 			gs_image_file2_update_texture(&context->if2);
 			obs_leave_graphics();
+			obs_source_video_changed(context->source);
 		}
 	}
 
@@ -259,7 +283,8 @@ uint64_t image_source_get_memory_usage(void *data)
 static struct obs_source_info image_source_info = {
 	.id             = "image_source",
 	.type           = OBS_SOURCE_TYPE_INPUT,
-	.output_flags   = OBS_SOURCE_VIDEO,
+	.output_flags   = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW |
+	                  OBS_SOURCE_CACHEABLE,
 	.get_name       = image_source_get_name,
 	.create         = image_source_create,
 	.destroy        = image_source_destroy,
@@ -257,6 +257,7 @@ static void ffmpeg_source_open(struct ffmpeg_source *s)
 			.v_preload_cb = preload_frame,
 			.a_cb = get_audio,
 			.stop_cb = media_stopped,
+			.name = obs_source_get_name(s->source),
 			.path = s->input,
 			.format = s->input_format,
 			.buffering = s->buffering_mb * 1024 * 1024,
@@ -483,6 +483,7 @@ static void *send_thread(void *data)
 	ftl_status_t status_code;
 
 	os_set_thread_name("ftl-stream: send_thread");
+	os_set_thread_owner(obs_output_get_name(stream->output));
 
 	while (os_sem_wait(stream->send_sem) == 0) {
 		struct encoder_packet packet;
@@ -985,6 +986,7 @@ static void *connect_thread(void *data)
 	int ret;
 
 	os_set_thread_name("ftl-stream: connect_thread");
+	os_set_thread_owner(obs_output_get_name(stream->output));
 
 	blog(LOG_WARNING, "ftl-stream: connect thread");
 
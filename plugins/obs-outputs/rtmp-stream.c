@@ -48,6 +48,7 @@ static inline void free_packets(struct rtmp_stream *stream)
 		circlebuf_pop_front(&stream->packets, &packet, sizeof(packet));
 		obs_encoder_packet_release(&packet);
 	}
+	metric_set(stream->queued_packets_metric, 0);
 	pthread_mutex_unlock(&stream->packets_mutex);
 }
 
@@ -112,6 +113,8 @@ static void rtmp_stream_destroy(void *data)
 	os_event_destroy(stream->socket_available_event);
 	os_event_destroy(stream->send_thread_signaled_exit);
 	pthread_mutex_destroy(&stream->write_buf_mutex);
+	metric_destroy(stream->queued_packets_metric);
+	metric_destroy(stream->send_buffer_metric);
 
 	if (stream->write_buf)
 		bfree(stream->write_buf);
@@ -159,6 +162,15 @@ static void *rtmp_stream_create(obs_data_t *settings, obs_output_t *output)
 		goto fail;
 	}
 
+	stream->queued_packets_metric = metric_create(METRIC_GAUGE,
+			"rtmp_stream_queued_packets",
+			"Encoded packets waiting to be sent",
+			"output", obs_output_get_name(output));
+	stream->send_buffer_metric = metric_create(METRIC_GAUGE,
+			"rtmp_stream_send_buffer_bytes",
+			"Bytes queued in the socket thread's send buffer",
+			"output", obs_output_get_name(output));
+
 	UNUSED_PARAMETER(settings);
 	return stream;
 
@@ -217,6 +229,8 @@ static inline bool get_next_packet(struct rtmp_stream *stream,
 				sizeof(struct encoder_packet));
 		new_packet = true;
 	}
+	metric_set(stream->queued_packets_metric,
+			(long long)num_buffered_packets(stream));
 	pthread_mutex_unlock(&stream->packets_mutex);
 
 	return new_packet;
@@ -319,6 +333,7 @@ retry_send:
 
 	memcpy(stream->write_buf + stream->write_buf_len, data, len);
 	stream->write_buf_len += len;
+	metric_set(stream->send_buffer_metric, (long long)stream->write_buf_len);
 
 	pthread_mutex_unlock(&stream->write_buf_mutex);
 
@@ -359,6 +374,9 @@ static int send_packet(struct rtmp_stream *stream,
 	ret = RTMP_Write(&stream->rtmp, (char*)data, (int)size, (int)idx);
 	bfree(data);
 
+	if (!is_header && ret >= 0)
+		obs_output_packet_sent(stream->output, packet);
+
 	if (is_header)
 		bfree(packet->data);
 	else
@@ -455,6 +473,7 @@ static void *send_thread(void *data)
 	struct rtmp_stream *stream = data;
 
 	os_set_thread_name("rtmp-stream: send_thread");
+	os_set_thread_owner(obs_output_get_name(stream->output));
 
 	while (os_sem_wait(stream->send_sem) == 0) {
 		struct encoder_packet packet;
@@ -926,6 +945,7 @@ static void *connect_thread(void *data)
 	int ret;
 
 	os_set_thread_name("rtmp-stream: connect_thread");
+	os_set_thread_owner(obs_output_get_name(stream->output));
 
 	if (!init_connect(stream)) {
 		obs_output_signal_stop(stream->output, OBS_OUTPUT_BAD_PATH);
@@ -1122,6 +1142,8 @@ static void rtmp_stream_data(void *data, struct encoder_packet *packet)
 			add_packet(stream, &new_packet);
 	}
 
+	metric_set(stream->queued_packets_metric,
+			(long long)num_buffered_packets(stream));
 	pthread_mutex_unlock(&stream->packets_mutex);
 
 	if (added_packet)
@@ -4,6 +4,7 @@
 #include <util/circlebuf.h>
 #include <util/dstr.h>
 #include <util/threading.h>
+#include <util/metrics.h>
 #include <inttypes.h>
 #include "librtmp/rtmp.h"
 #include "librtmp/log.h"
@@ -50,6 +51,7 @@ struct rtmp_stream {
 	pthread_mutex_t  packets_mutex;
 	struct circlebuf packets;
 	bool             sent_headers;
+	metric_t         *queued_packets_metric;
 
 	bool             got_first_video;
 	int64_t          start_dts_offset;
@@ -100,6 +102,7 @@ struct rtmp_stream {
 	size_t           write_buf_len;
 	size_t           write_buf_size;
 	pthread_mutex_t  write_buf_mutex;
+	metric_t         *send_buffer_metric;
 	os_event_t       *buffer_space_available_event;
 	os_event_t       *buffer_has_data_event;
 	os_event_t       *socket_available_event;
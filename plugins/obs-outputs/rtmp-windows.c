@@ -7,6 +7,7 @@ static void fatal_sock_shutdown(struct rtmp_stream *stream)
 	closesocket(stream->rtmp.m_sb.sb_socket);
 	stream->rtmp.m_sb.sb_socket = -1;
 	stream->write_buf_len = 0;
+	metric_set(stream->send_buffer_metric, 0);
 	os_event_signal(stream->buffer_space_available_event);
 }
 
@@ -184,6 +185,8 @@ static enum data_ret write_data(struct rtmp_stream *stream, bool *can_write,
 					stream->write_buf + ret,
 					stream->write_buf_len - ret);
 		stream->write_buf_len -= ret;
+		metric_set(stream->send_buffer_metric,
+				(long long)stream->write_buf_len);
 
 		*last_send_time = os_gettime_ns() / 1000000;
 
@@ -0,0 +1,540 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <util/threading.h>
+#include <obs.h>
+
+#include "obs-bench.h"
+
+/* Headless audio pipeline benchmark.  Builds a synthetic audio graph of N
+ * sine wave sources shared by M scenes, each scene assigned to its own output
+ * channel, and connects all six mixes to a dummy output.  The time spent
+ * mixing each tick (audio_callback, scene audio rendering and source
+ * resampling) and sending each tick to the outputs (output resampling) is
+ * collected with the profiler and printed as JSON.
+ *
+ * Filters are loaded from the obs-filters module, which is searched for in
+ * the given module paths:
+ *
+ *   audio-bench --sources 16 --scenes 4 \
+ *       --filters noise_gate_filter,compressor_filter \
+ *       --module-path "build/plugins/%module%" "data/obs-plugins/%module%"
+ *
+ * When a baseline result file is given, the results are compared against it
+ * and the benchmark exits with status 2 if any of the compared values got
+ * worse by more than the threshold. */
+
+#define SAMPLE_INTERVAL_MS 100
+#define FILTER_MODULE "obs-filters"
+
+static bool verbose = false;
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (verbose || log_level <= LOG_WARNING) {
+		vfprintf(stderr, msg, args);
+		fprintf(stderr, "\n");
+	}
+
+	UNUSED_PARAMETER(param);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: audio-bench [options]\n"
+		"\n"
+		"options:\n"
+		"  --sources <count>           number of sources (default: 8)\n"
+		"  --scenes <count>            number of scenes (default: 4)\n"
+		"  --filters <id,...>          filters added to every source\n"
+		"  --samples-per-sec <hz>      mixer sample rate (default: "
+		"48000)\n"
+		"  --source-rate <hz>          source sample rate (default: "
+		"44100)\n"
+		"  --output-rate <hz>          output sample rate (default: "
+		"48000)\n"
+		"  --duration <seconds>        benchmark duration (default: 10)\n"
+		"  --output <file>             writes the results to a file\n"
+		"  --baseline <file>           compares with previous results\n"
+		"  --threshold <percent>       allowed regression (default: 10)\n"
+		"  --module-path <bin> <data>  adds a plugin search path\n"
+		"  --verbose                   prints all libobs log output\n");
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct bench_params {
+	int                 num_sources;
+	int                 num_scenes;
+	const char          *filters;
+	uint32_t            samples_per_sec;
+	uint32_t            source_rate;
+	uint32_t            output_rate;
+	double              duration;
+	const char          *output_file;
+	const char          *baseline_file;
+	double              threshold;
+	DARRAY(const char*) module_paths;
+};
+
+static bool parse_args(struct bench_params *params, int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+
+		if (strcmp(arg, "--sources") == 0 && i + 1 < argc) {
+			params->num_sources = atoi(argv[++i]);
+		} else if (strcmp(arg, "--scenes") == 0 && i + 1 < argc) {
+			params->num_scenes = atoi(argv[++i]);
+		} else if (strcmp(arg, "--filters") == 0 && i + 1 < argc) {
+			params->filters = argv[++i];
+		} else if (strcmp(arg, "--samples-per-sec") == 0 &&
+				i + 1 < argc) {
+			params->samples_per_sec = (uint32_t)atoi(argv[++i]);
+		} else if (strcmp(arg, "--source-rate") == 0 && i + 1 < argc) {
+			params->source_rate = (uint32_t)atoi(argv[++i]);
+		} else if (strcmp(arg, "--output-rate") == 0 && i + 1 < argc) {
+			params->output_rate = (uint32_t)atoi(argv[++i]);
+		} else if (strcmp(arg, "--duration") == 0 && i + 1 < argc) {
+			params->duration = atof(argv[++i]);
+		} else if (strcmp(arg, "--output") == 0 && i + 1 < argc) {
+			params->output_file = argv[++i];
+		} else if (strcmp(arg, "--baseline") == 0 && i + 1 < argc) {
+			params->baseline_file = argv[++i];
+		} else if (strcmp(arg, "--threshold") == 0 && i + 1 < argc) {
+			params->threshold = atof(argv[++i]);
+		} else if (strcmp(arg, "--module-path") == 0 && i + 2 < argc) {
+			da_push_back(params->module_paths, &argv[++i]);
+			da_push_back(params->module_paths, &argv[++i]);
+		} else if (strcmp(arg, "--verbose") == 0) {
+			verbose = true;
+		} else {
+			return false;
+		}
+	}
+
+	return params->num_sources > 0 &&
+		params->num_scenes > 0 && params->num_scenes <= MAX_CHANNELS &&
+		params->samples_per_sec && params->source_rate &&
+		params->output_rate && params->duration > 0.0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void load_filter_module(void *param, const struct obs_module_info *info)
+{
+	const char *file = strrchr(info->bin_path, '/');
+	obs_module_t *module;
+	bool *loaded = param;
+
+	file = file ? file + 1 : info->bin_path;
+	if (*loaded || astrcmp_n(file, FILTER_MODULE,
+				sizeof(FILTER_MODULE) - 1) != 0)
+		return;
+
+	if (obs_open_module(&module, info->bin_path, info->data_path) !=
+			MODULE_SUCCESS)
+		return;
+
+	*loaded = obs_init_module(module);
+}
+
+static bool add_filters(obs_source_t *source, const char *filters)
+{
+	char **ids = strlist_split(filters, ',', false);
+	bool success = true;
+
+	for (char **id = ids; *id; id++) {
+		struct dstr name = {0};
+		obs_source_t *filter;
+
+		dstr_printf(&name, "%s %s", obs_source_get_name(source), *id);
+		filter = obs_source_create_private(*id, name.array, NULL);
+		dstr_free(&name);
+
+		if (!filter) {
+			blog(LOG_ERROR, "Failed to create filter '%s'", *id);
+			success = false;
+			break;
+		}
+
+		obs_source_filter_add(source, filter);
+		obs_source_release(filter);
+	}
+
+	strlist_free(ids);
+	return success;
+}
+
+struct audio_graph {
+	DARRAY(obs_source_t*) sources;
+	DARRAY(obs_scene_t*)  scenes;
+};
+
+static bool create_graph(struct audio_graph *graph,
+		struct bench_params *params)
+{
+	for (int i = 0; i < params->num_sources; i++) {
+		obs_data_t *settings = obs_data_create();
+		struct dstr name = {0};
+		obs_source_t *source;
+
+		/* spread the sources over a few octaves so the filters see
+		 * different signals */
+		obs_data_set_double(settings, "frequency",
+				110.0 * (double)(1 + i % 16));
+		obs_data_set_int(settings, "samples_per_sec",
+				params->source_rate);
+
+		dstr_printf(&name, "audio %d", i);
+		source = obs_source_create("bench_audio", name.array, settings,
+				NULL);
+		dstr_free(&name);
+		obs_data_release(settings);
+
+		if (!source) {
+			blog(LOG_ERROR, "Failed to create audio source");
+			return false;
+		}
+
+		da_push_back(graph->sources, &source);
+
+		obs_source_set_audio_mixers(source, (1 << MAX_AUDIO_MIXES) - 1);
+		if (params->filters && !add_filters(source, params->filters))
+			return false;
+	}
+
+	for (int i = 0; i < params->num_scenes; i++) {
+		struct dstr name = {0};
+		obs_scene_t *scene;
+
+		dstr_printf(&name, "scene %d", i);
+		scene = obs_scene_create(name.array);
+		dstr_free(&name);
+
+		da_push_back(graph->scenes, &scene);
+
+		for (size_t j = 0; j < graph->sources.num; j++)
+			obs_scene_add(scene, graph->sources.array[j]);
+
+		obs_set_output_source(i, obs_scene_get_source(scene));
+	}
+
+	return true;
+}
+
+static void free_graph(struct audio_graph *graph)
+{
+	for (size_t i = 0; i < graph->scenes.num; i++) {
+		obs_set_output_source((uint32_t)i, NULL);
+		obs_scene_release(graph->scenes.array[i]);
+	}
+	for (size_t i = 0; i < graph->sources.num; i++)
+		obs_source_release(graph->sources.array[i]);
+
+	da_free(graph->scenes);
+	da_free(graph->sources);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static volatile long ticks = 0;
+
+static void receive_audio(void *param, size_t mix_idx, struct audio_data *data)
+{
+	if (mix_idx == 0)
+		os_atomic_inc_long(&ticks);
+
+	UNUSED_PARAMETER(param);
+	UNUSED_PARAMETER(data);
+}
+
+static void connect_mixes(uint32_t output_rate, bool connect)
+{
+	audio_t *audio = obs_get_audio();
+	struct audio_convert_info conv = {
+		.samples_per_sec = output_rate,
+		.format          = AUDIO_FORMAT_FLOAT_PLANAR,
+		.speakers        = audio_output_get_info(audio)->speakers
+	};
+
+	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+		if (connect)
+			audio_output_connect(audio, i, &conv, receive_audio,
+					NULL);
+		else
+			audio_output_disconnect(audio, i, receive_audio, NULL);
+	}
+}
+
+/* sums the CPU time of the threads whose name starts with 'prefix' */
+static double get_thread_cpu_ms(obs_data_array_t *threads, const char *prefix)
+{
+	size_t count = obs_data_array_count(threads);
+	double cpu_ms = 0.0;
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *thread = obs_data_array_item(threads, i);
+		const char *name = obs_data_get_string(thread, "name");
+
+		if (astrcmp_n(name, prefix, strlen(prefix)) == 0)
+			cpu_ms += obs_data_get_double(thread, "cpu_ms");
+
+		obs_data_release(thread);
+	}
+
+	return cpu_ms;
+}
+
+static void add_config(obs_data_t *results, struct bench_params *params)
+{
+	obs_data_t *config = obs_data_create();
+
+	obs_data_set_int(config, "sources", params->num_sources);
+	obs_data_set_int(config, "scenes", params->num_scenes);
+	obs_data_set_int(config, "mixes", MAX_AUDIO_MIXES);
+	obs_data_set_string(config, "filters",
+			params->filters ? params->filters : "");
+	obs_data_set_int(config, "samples_per_sec", params->samples_per_sec);
+	obs_data_set_int(config, "source_rate", params->source_rate);
+	obs_data_set_int(config, "output_rate", params->output_rate);
+	obs_data_set_obj(results, "config", config);
+
+	obs_data_release(config);
+}
+
+static obs_data_t *run_bench(struct bench_params *params)
+{
+	obs_data_t *results = obs_data_create();
+	obs_data_t *cpu_stats = obs_data_create();
+	obs_data_array_t *threads = obs_data_array_create();
+	struct audio_graph graph = {0};
+	profiler_snapshot_t *snap;
+	os_cpu_usage_info_t *cpu_info;
+	struct bench_thread_cpu *thread_cpu;
+	uint32_t max_buffering = 0;
+	uint64_t start_time, end_time, elapsed;
+	long total_ticks;
+
+	if (!create_graph(&graph, params)) {
+		obs_data_release(results);
+		results = NULL;
+		goto cleanup;
+	}
+
+	connect_mixes(params->output_rate, true);
+
+	cpu_info = os_cpu_usage_info_start();
+	thread_cpu = bench_thread_cpu_start();
+	os_atomic_set_long(&ticks, 0);
+	start_time = os_gettime_ns();
+	end_time = start_time + (uint64_t)(params->duration * 1000000000.0);
+
+	while (os_gettime_ns() < end_time) {
+		uint32_t buffering = obs_get_audio_buffering_ms();
+		if (buffering > max_buffering)
+			max_buffering = buffering;
+
+		os_sleep_ms(SAMPLE_INTERVAL_MS);
+	}
+
+	elapsed = os_gettime_ns() - start_time;
+	total_ticks = os_atomic_load_long(&ticks);
+
+	obs_data_set_double(cpu_stats, "process_percent",
+			os_cpu_usage_info_query(cpu_info));
+	bench_thread_cpu_stop(thread_cpu, threads, elapsed);
+	obs_data_set_array(cpu_stats, "threads", threads);
+	os_cpu_usage_info_destroy(cpu_info);
+
+	connect_mixes(params->output_rate, false);
+
+	/* thread names are truncated to 15 characters on Linux */
+	if (total_ticks) {
+		obs_data_set_double(cpu_stats, "audio_thread_us_per_tick",
+				get_thread_cpu_ms(threads, "audio-io") *
+				1000.0 / (double)total_ticks);
+		obs_data_set_double(cpu_stats, "sources_us_per_tick",
+				get_thread_cpu_ms(threads, "obs-bench") *
+				1000.0 / (double)total_ticks);
+	}
+
+	snap = profile_snapshot_create();
+	bench_add_time_stats(results, "mix_time_us", snap, "mix_audio");
+	bench_add_time_stats(results, "output_time_us", snap, "output_audio");
+	profile_snapshot_free(snap);
+
+	add_config(results, params);
+	obs_data_set_double(results, "duration_s",
+			(double)elapsed / 1000000000.0);
+	obs_data_set_int(results, "ticks", total_ticks);
+	obs_data_set_int(results, "buffering_ms",
+			obs_get_audio_buffering_ms());
+	obs_data_set_int(results, "max_buffering_ms", max_buffering);
+	obs_data_set_obj(results, "cpu", cpu_stats);
+
+cleanup:
+	free_graph(&graph);
+
+	obs_data_array_release(threads);
+	obs_data_release(cpu_stats);
+	return results;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Regression checks */
+
+struct compared_value {
+	const char *obj;
+	const char *name;
+};
+
+static const struct compared_value compared_values[] = {
+	{"mix_time_us",    "avg"},
+	{"mix_time_us",    "p99"},
+	{"output_time_us", "avg"},
+	{"output_time_us", "p99"},
+	{"cpu",            "audio_thread_us_per_tick"},
+	{"cpu",            "sources_us_per_tick"},
+};
+
+static double get_compared_value(obs_data_t *results,
+		const struct compared_value *value)
+{
+	obs_data_t *obj = obs_data_get_obj(results, value->obj);
+	double val = obs_data_get_double(obj, value->name);
+
+	obs_data_release(obj);
+	return val;
+}
+
+static bool compare_baseline(obs_data_t *results, const char *baseline_file,
+		double threshold)
+{
+	obs_data_t *baseline = obs_data_create_from_json_file(baseline_file);
+	size_t count = sizeof(compared_values) / sizeof(compared_values[0]);
+	bool success = true;
+
+	if (!baseline) {
+		fprintf(stderr, "Failed to load baseline '%s'\n",
+				baseline_file);
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const struct compared_value *value = &compared_values[i];
+		double prev = get_compared_value(baseline, value);
+		double cur = get_compared_value(results, value);
+		double change;
+
+		if (prev <= 0.0)
+			continue;
+
+		change = (cur - prev) * 100.0 / prev;
+		fprintf(stderr, "%-16s %-26s %10.2f -> %10.2f (%+.1f%%)%s\n",
+				value->obj, value->name, prev, cur, change,
+				change > threshold ? "  REGRESSION" : "");
+
+		if (change > threshold)
+			success = false;
+	}
+
+	obs_data_release(baseline);
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main(int argc, char *argv[])
+{
+	struct bench_params params = {0};
+	struct obs_audio_info oai;
+	profiler_name_store_t *names;
+	obs_data_t *results = NULL;
+	int ret = 1;
+
+	params.num_sources     = 8;
+	params.num_scenes      = 4;
+	params.samples_per_sec = 48000;
+	params.source_rate     = 44100;
+	params.output_rate     = 48000;
+	params.duration        = 10.0;
+	params.threshold       = 10.0;
+
+	if (!parse_args(&params, argc, argv)) {
+		usage();
+		da_free(params.module_paths);
+		return 1;
+	}
+
+	base_set_log_handler(do_log, NULL);
+
+	names = profiler_name_store_create();
+	profiler_start();
+
+	if (!obs_startup("en-US", NULL, names)) {
+		fprintf(stderr, "Failed to start libobs\n");
+		goto exit;
+	}
+
+	/* the audio pipeline does not depend on video, so no graphics
+	 * subsystem is initialized */
+	oai.samples_per_sec = params.samples_per_sec;
+	oai.speakers        = SPEAKERS_STEREO;
+	if (!obs_reset_audio(&oai)) {
+		fprintf(stderr, "obs_reset_audio failed\n");
+		goto exit;
+	}
+
+	bench_register_sources();
+
+	if (params.filters) {
+		bool loaded = false;
+
+		for (size_t i = 0; i + 1 < params.module_paths.num; i += 2)
+			obs_add_module_path(params.module_paths.array[i],
+					params.module_paths.array[i + 1]);
+		obs_find_modules(load_filter_module, &loaded);
+
+		if (!loaded) {
+			fprintf(stderr, "Failed to load " FILTER_MODULE "\n");
+			goto exit;
+		}
+	}
+
+	results = run_bench(&params);
+	if (!results)
+		goto exit;
+
+	if (params.output_file) {
+		if (!obs_data_save_json(results, params.output_file))
+			goto exit;
+	} else {
+		printf("%s\n", obs_data_get_json(results));
+	}
+
+	ret = 0;
+
+	if (params.baseline_file &&
+	    !compare_baseline(results, params.baseline_file, params.threshold))
+		ret = 2;
+
+exit:
+	obs_data_release(results);
+	obs_shutdown();
+
+	profiler_stop();
+	profiler_free();
+	profiler_name_store_free(names);
+
+	da_free(params.module_paths);
+	return ret;
+}
@@ -0,0 +1,789 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <media-io/format-conversion.h>
+#include <obs.h>
+
+/* Checks the CPU format conversion kernels in media-io/format-conversion.c
+ * and obs_source_frame_copy against straightforward scalar implementations,
+ * then measures their throughput at common resolutions.
+ *
+ * The verification covers odd widths, padded strides and differently aligned
+ * planes, within the limits the kernels are documented to support:
+ *
+ *   - compress_* / convert_*: the input must be 16-byte aligned, the input
+ *     linesize must cover at least four bytes per output luma byte, the luma
+ *     linesize must be a multiple of 4, and the height must be even
+ *   - decompress_420 / decompress_nv12: the luma linesize must be even and
+ *     the height must be even
+ *   - decompress_422: the input and output must be 4-byte aligned
+ *
+ * Throughput is reported as the number of bytes read plus bytes written per
+ * second.  Exits with a non-zero status if any kernel produces wrong output.
+ *
+ * usage: format-conversion-bench [--verify | --bench] [--min-time <ms>] */
+
+#define GUARD_SIZE     64
+#define GUARD_BYTE     0xA5
+#define DEFAULT_MIN_MS 250
+
+static uint32_t rand_state = 0x12345678;
+
+static inline uint32_t next_rand(void)
+{
+	/* xorshift32, so the results are the same on every platform */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+static void fill_random(uint8_t *data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		data[i] = (uint8_t)next_rand();
+}
+
+static inline void put32(uint8_t *dst, uint32_t val)
+{
+	dst[0] = (uint8_t)val;
+	dst[1] = (uint8_t)(val >> 8);
+	dst[2] = (uint8_t)(val >> 16);
+	dst[3] = (uint8_t)(val >> 24);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Image buffers with guard bytes after each plane, to catch kernels writing
+ * past the end of their output */
+
+struct image {
+	uint8_t  *mem[MAX_AV_PLANES];
+	uint8_t  *data[MAX_AV_PLANES];
+	uint32_t linesize[MAX_AV_PLANES];
+	uint32_t lines[MAX_AV_PLANES];
+	size_t   num_planes;
+};
+
+static void image_init(struct image *img, size_t num_planes,
+		const uint32_t linesize[], const uint32_t lines[],
+		size_t offset)
+{
+	memset(img, 0, sizeof(*img));
+	img->num_planes = num_planes;
+
+	for (size_t i = 0; i < num_planes; i++) {
+		size_t size = (size_t)linesize[i] * lines[i];
+
+		img->mem[i]      = bmalloc(offset + size + GUARD_SIZE);
+		img->data[i]     = img->mem[i] + offset;
+		img->linesize[i] = linesize[i];
+		img->lines[i]    = lines[i];
+
+		fill_random(img->mem[i], offset + size);
+		memset(img->data[i] + size, GUARD_BYTE, GUARD_SIZE);
+	}
+}
+
+static void image_free(struct image *img)
+{
+	for (size_t i = 0; i < img->num_planes; i++)
+		bfree(img->mem[i]);
+}
+
+static bool image_guards_intact(const struct image *img)
+{
+	for (size_t i = 0; i < img->num_planes; i++) {
+		const uint8_t *guard = img->data[i] +
+			(size_t)img->linesize[i] * img->lines[i];
+
+		for (size_t j = 0; j < GUARD_SIZE; j++) {
+			if (guard[j] != GUARD_BYTE)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+struct test_case {
+	const char *kernel;
+	uint32_t   width;
+	uint32_t   height;
+	uint32_t   pad;
+	uint32_t   offset;
+};
+
+static int failures = 0;
+
+static void fail(const struct test_case *tc, const char *format, ...)
+{
+	va_list args;
+
+	fprintf(stderr, "FAIL %s %ux%u (pad %u, offset %u): ", tc->kernel,
+			tc->width, tc->height, tc->pad, tc->offset);
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+
+	fprintf(stderr, "\n");
+	failures++;
+}
+
+/* compares the first 'bytes' bytes of the first 'lines' lines of a plane */
+static bool compare_plane(const struct test_case *tc,
+		const struct image *out, const struct image *ref,
+		size_t plane, uint32_t bytes, uint32_t lines)
+{
+	for (uint32_t y = 0; y < lines; y++) {
+		const uint8_t *a = out->data[plane] + y * out->linesize[plane];
+		const uint8_t *b = ref->data[plane] + y * ref->linesize[plane];
+
+		for (uint32_t x = 0; x < bytes; x++) {
+			if (a[x] != b[x]) {
+				fail(tc, "plane %d differs at byte %u, line %u "
+						"(got %u, expected %u)",
+						(int)plane, x, y, a[x], b[x]);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool check_guards(const struct test_case *tc, const struct image *out)
+{
+	if (!image_guards_intact(out)) {
+		fail(tc, "wrote past the end of the output");
+		return false;
+	}
+
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* UYVX (the packed 444 format the GPU conversion shaders output) to planar */
+
+typedef void (*compress_func_t)(const uint8_t *input, uint32_t in_linesize,
+		uint32_t start_y, uint32_t end_y,
+		uint8_t *output[], const uint32_t out_linesize[]);
+
+static void ref_compress(enum video_format format,
+		const uint8_t *input, uint32_t in_linesize,
+		uint32_t width, uint32_t height,
+		uint8_t *output[], const uint32_t out_linesize[])
+{
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *line = input + y * in_linesize;
+
+		for (uint32_t x = 0; x < width; x++) {
+			const uint8_t *px = line + x * 4;
+
+			output[0][y * out_linesize[0] + x] = px[1];
+			if (format == VIDEO_FORMAT_I444) {
+				output[1][y * out_linesize[1] + x] = px[0];
+				output[2][y * out_linesize[2] + x] = px[2];
+			}
+		}
+	}
+
+	if (format == VIDEO_FORMAT_I444)
+		return;
+
+	for (uint32_t y = 0; y < height / 2; y++) {
+		const uint8_t *line0 = input + y * 2 * in_linesize;
+		const uint8_t *line1 = line0 + in_linesize;
+
+		for (uint32_t x = 0; x < (width + 1) / 2; x++) {
+			const uint8_t *p0 = line0 + x * 8;
+			const uint8_t *p1 = line1 + x * 8;
+			uint8_t u = (uint8_t)
+				((p0[0] + p0[4] + p1[0] + p1[4]) >> 2);
+			uint8_t v = (uint8_t)
+				((p0[2] + p0[6] + p1[2] + p1[6]) >> 2);
+
+			if (format == VIDEO_FORMAT_I420) {
+				output[1][y * out_linesize[1] + x] = u;
+				output[2][y * out_linesize[2] + x] = v;
+			} else {
+				output[1][y * out_linesize[1] + x * 2]     = u;
+				output[1][y * out_linesize[1] + x * 2 + 1] = v;
+			}
+		}
+	}
+}
+
+static void get_compress_planes(enum video_format format,
+		uint32_t lum_linesize, uint32_t chroma_pad, uint32_t height,
+		size_t *num_planes, uint32_t linesize[], uint32_t lines[])
+{
+	linesize[0] = lum_linesize;
+	lines[0]    = height;
+
+	if (format == VIDEO_FORMAT_NV12) {
+		*num_planes = 2;
+		linesize[1] = lum_linesize + chroma_pad;
+		lines[1]    = height / 2;
+
+	} else if (format == VIDEO_FORMAT_I420) {
+		*num_planes = 3;
+		linesize[1] = linesize[2] = lum_linesize / 2 + chroma_pad;
+		lines[1]    = lines[2]    = height / 2;
+
+	} else {
+		*num_planes = 3;
+		linesize[1] = linesize[2] = lum_linesize + chroma_pad;
+		lines[1]    = lines[2]    = height;
+	}
+}
+
+static void verify_compress(const char *name, compress_func_t func,
+		enum video_format format, uint32_t width, uint32_t height,
+		uint32_t pad, uint32_t out_offset)
+{
+	struct test_case tc = {name, width, height, pad, out_offset};
+	uint32_t lum_linesize = ((width + 3) & ~3) + (pad & ~3);
+	uint32_t in_linesize = lum_linesize * 4 + pad * 16;
+	uint32_t linesize[MAX_AV_PLANES];
+	uint32_t lines[MAX_AV_PLANES];
+	size_t num_planes;
+	struct image in, out, ref;
+	uint32_t split;
+	bool ok;
+
+	image_init(&in, 1, &in_linesize, &height, (pad & 1) * 16);
+
+	get_compress_planes(format, lum_linesize, pad, height,
+			&num_planes, linesize, lines);
+	image_init(&out, num_planes, linesize, lines, out_offset);
+	image_init(&ref, num_planes, linesize, lines, 0);
+
+	/* convert in two slices, like a threaded caller would */
+	split = (height / 2) & ~1;
+	func(in.data[0], in_linesize, 0, split, out.data, out.linesize);
+	func(in.data[0], in_linesize, split, height, out.data, out.linesize);
+	ref_compress(format, in.data[0], in_linesize, width, height,
+			ref.data, ref.linesize);
+
+	/* chroma planes are only compared if luma matched, but each of them
+	 * is compared so that every wrong plane is reported */
+	ok = check_guards(&tc, &out) &&
+		compare_plane(&tc, &out, &ref, 0, width, height);
+
+	if (ok && format == VIDEO_FORMAT_I444) {
+		ok = compare_plane(&tc, &out, &ref, 1, width, height) && ok;
+		ok = compare_plane(&tc, &out, &ref, 2, width, height) && ok;
+	} else if (ok && format == VIDEO_FORMAT_I420) {
+		uint32_t chroma_width = (width + 1) / 2;
+		ok = compare_plane(&tc, &out, &ref, 1, chroma_width,
+				height / 2) && ok;
+		ok = compare_plane(&tc, &out, &ref, 2, chroma_width,
+				height / 2) && ok;
+	} else if (ok) {
+		ok = compare_plane(&tc, &out, &ref, 1,
+				(width + 1) / 2 * 2, height / 2) && ok;
+	}
+
+	image_free(&in);
+	image_free(&out);
+	image_free(&ref);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Planar and packed 422 to the 32-bit packed formats used for CPU-converted
+ * async textures */
+
+static void ref_decompress(enum video_format format,
+		const uint8_t *const input[], const uint32_t in_linesize[],
+		uint32_t width, uint32_t height,
+		uint8_t *output, uint32_t out_linesize)
+{
+	for (uint32_t y = 0; y < height; y++) {
+		uint8_t *out = output + y * out_linesize;
+
+		for (uint32_t x = 0; x < width; x++) {
+			const uint8_t *lum = input[0] + y * in_linesize[0];
+			const uint8_t *mp = lum + (x / 2) * 4;
+			const uint8_t *chroma;
+			uint32_t val;
+
+			switch (format) {
+			case VIDEO_FORMAT_I420:
+				val = (uint32_t)lum[x] << 16 |
+					(uint32_t)input[1][(y / 2) *
+						in_linesize[1] + x / 2] << 8 |
+					(uint32_t)input[2][(y / 2) *
+						in_linesize[2] + x / 2];
+				break;
+
+			case VIDEO_FORMAT_NV12:
+				chroma = input[1] + (y / 2) * in_linesize[1] +
+					(x / 2) * 2;
+				val = (uint32_t)lum[x] |
+					(uint32_t)chroma[0] << 8 |
+					(uint32_t)chroma[1] << 16;
+				break;
+
+			case VIDEO_FORMAT_YUY2:
+				/* Y0 U Y1 V, the second pixel gets Y1 */
+				val = (uint32_t)mp[(x & 1) * 2] |
+					(uint32_t)mp[1] << 8 |
+					(uint32_t)mp[2] << 16 |
+					(uint32_t)mp[3] << 24;
+				break;
+
+			default:
+				/* U Y0 V Y1, the second pixel gets Y1 */
+				val = (uint32_t)mp[0] |
+					(uint32_t)mp[(x & 1) ? 3 : 1] << 8 |
+					(uint32_t)mp[2] << 16 |
+					(uint32_t)mp[3] << 24;
+				break;
+			}
+
+			put32(out + x * 4, val);
+		}
+	}
+}
+
+static void verify_decompress(const char *name, enum video_format format,
+		uint32_t width, uint32_t height, uint32_t pad, uint32_t offset)
+{
+	struct test_case tc = {name, width, height, pad, offset};
+	uint32_t even_width = (width + 1) & ~1;
+	uint32_t out_linesize = even_width * 4 + pad * 4;
+	uint32_t linesize[MAX_AV_PLANES];
+	uint32_t lines[MAX_AV_PLANES];
+	size_t num_planes = 1;
+	struct image in, out, ref;
+	uint32_t split;
+
+	lines[0] = lines[1] = lines[2] = height;
+
+	if (format == VIDEO_FORMAT_I420) {
+		num_planes  = 3;
+		linesize[0] = even_width + pad * 2;
+		linesize[1] = linesize[2] = even_width / 2 + pad;
+		lines[1]    = lines[2]    = height / 2;
+
+	} else if (format == VIDEO_FORMAT_NV12) {
+		num_planes  = 2;
+		linesize[0] = even_width + pad * 2;
+		linesize[1] = even_width + pad * 2;
+		lines[1]    = height / 2;
+
+	} else {
+		linesize[0] = even_width * 2 + pad * 4;
+	}
+
+	image_init(&in, num_planes, linesize, lines, offset);
+	image_init(&out, 1, &out_linesize, &height, offset & ~3);
+	image_init(&ref, 1, &out_linesize, &height, 0);
+
+	split = (height / 2) & ~1;
+
+	switch (format) {
+	case VIDEO_FORMAT_I420:
+		decompress_420((const uint8_t *const *)in.data, in.linesize,
+				0, split, out.data[0], out_linesize);
+		decompress_420((const uint8_t *const *)in.data, in.linesize,
+				split, height, out.data[0], out_linesize);
+		break;
+
+	case VIDEO_FORMAT_NV12:
+		decompress_nv12((const uint8_t *const *)in.data, in.linesize,
+				0, split, out.data[0], out_linesize);
+		decompress_nv12((const uint8_t *const *)in.data, in.linesize,
+				split, height, out.data[0], out_linesize);
+		break;
+
+	default:
+		decompress_422(in.data[0], in.linesize[0], 0, split,
+				out.data[0], out_linesize,
+				format == VIDEO_FORMAT_YUY2);
+		decompress_422(in.data[0], in.linesize[0], split, height,
+				out.data[0], out_linesize,
+				format == VIDEO_FORMAT_YUY2);
+		break;
+	}
+
+	ref_decompress(format, (const uint8_t *const *)in.data, in.linesize,
+			width, height, ref.data[0], out_linesize);
+
+	if (check_guards(&tc, &out))
+		compare_plane(&tc, &out, &ref, 0, width * 4, height);
+
+	image_free(&in);
+	image_free(&out);
+	image_free(&ref);
+}
+
+/* ------------------------------------------------------------------------- */
+/* obs_source_frame_copy, used to cache every async frame a source outputs */
+
+static uint32_t get_plane_lines(enum video_format format, size_t plane,
+		uint32_t height)
+{
+	if (plane && (format == VIDEO_FORMAT_I420 ||
+	              format == VIDEO_FORMAT_NV12))
+		return height / 2;
+	return height;
+}
+
+static size_t get_num_planes(enum video_format format)
+{
+	switch (format) {
+	case VIDEO_FORMAT_I420:
+	case VIDEO_FORMAT_I444:
+		return 3;
+	case VIDEO_FORMAT_NV12:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static void init_src_frame(struct obs_source_frame *frame, struct image *img,
+		enum video_format format, uint32_t width, uint32_t height,
+		uint32_t pad, uint32_t offset)
+{
+	struct obs_source_frame tmp;
+	uint32_t lines[MAX_AV_PLANES];
+	size_t num_planes = get_num_planes(format);
+
+	/* use the standard linesizes, plus padding */
+	obs_source_frame_init(&tmp, format, width, height);
+	for (size_t i = 0; i < num_planes; i++) {
+		tmp.linesize[i] += pad;
+		lines[i] = get_plane_lines(format, i, height);
+	}
+	bfree(tmp.data[0]);
+
+	image_init(img, num_planes, tmp.linesize, lines, offset);
+
+	memset(frame, 0, sizeof(*frame));
+	frame->format = format;
+	frame->width  = width;
+	frame->height = height;
+	for (size_t i = 0; i < num_planes; i++) {
+		frame->data[i]     = img->data[i];
+		frame->linesize[i] = img->linesize[i];
+	}
+}
+
+static void verify_frame_copy(const char *name, enum video_format format,
+		uint32_t width, uint32_t height, uint32_t pad, uint32_t offset)
+{
+	struct test_case tc = {name, width, height, pad, offset};
+	enum video_format dst_format = format == VIDEO_FORMAT_Y800 ?
+		VIDEO_FORMAT_BGRX : format;
+	struct obs_source_frame src;
+	struct obs_source_frame *dst;
+	struct image in;
+	size_t num_planes = get_num_planes(format);
+
+	init_src_frame(&src, &in, format, width, height, pad, offset);
+	dst = obs_source_frame_create(dst_format, width, height);
+
+	obs_source_frame_copy(dst, &src);
+
+	for (size_t i = 0; i < num_planes; i++) {
+		uint32_t lines = get_plane_lines(format, i, height);
+		uint32_t bytes = dst->linesize[i] < src.linesize[i] ?
+			dst->linesize[i] : src.linesize[i];
+
+		for (uint32_t y = 0; y < lines; y++) {
+			const uint8_t *s = src.data[i] + y * src.linesize[i];
+			const uint8_t *d = dst->data[i] + y * dst->linesize[i];
+			bool match = true;
+			uint32_t x;
+
+			if (format == VIDEO_FORMAT_Y800) {
+				for (x = 0; x < width && match; x++)
+					match = d[x * 4]     == s[x] &&
+						d[x * 4 + 1] == s[x] &&
+						d[x * 4 + 2] == s[x] &&
+						d[x * 4 + 3] == s[x];
+			} else {
+				for (x = 0; x < bytes && match; x++)
+					match = d[x] == s[x];
+			}
+
+			if (!match) {
+				fail(&tc, "plane %d differs at byte %u, "
+						"line %u", (int)i, x - 1, y);
+				i = num_planes;
+				break;
+			}
+		}
+	}
+
+	obs_source_frame_destroy(dst);
+	image_free(&in);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const uint32_t test_widths[] = {
+	1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 130,
+	641, 1283
+};
+
+static const uint32_t test_heights[] = {1, 2, 3, 4, 9, 10, 34};
+
+static const uint32_t test_pads[] = {0, 1, 6};
+
+static const uint32_t test_offsets[] = {0, 1, 4, 8};
+
+static const enum video_format frame_formats[] = {
+	VIDEO_FORMAT_I420, VIDEO_FORMAT_NV12, VIDEO_FORMAT_I444,
+	VIDEO_FORMAT_YUY2, VIDEO_FORMAT_BGRA, VIDEO_FORMAT_Y800
+};
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static void verify_size(uint32_t width, uint32_t height, uint32_t pad,
+		uint32_t offset)
+{
+	if ((height & 1) == 0) {
+		verify_compress("compress_uyvx_to_i420", compress_uyvx_to_i420,
+				VIDEO_FORMAT_I420, width, height, pad, offset);
+		verify_compress("compress_uyvx_to_nv12", compress_uyvx_to_nv12,
+				VIDEO_FORMAT_NV12, width, height, pad, offset);
+		verify_compress("convert_uyvx_to_i444", convert_uyvx_to_i444,
+				VIDEO_FORMAT_I444, width, height, pad, offset);
+		verify_decompress("decompress_420", VIDEO_FORMAT_I420,
+				width, height, pad, offset);
+		verify_decompress("decompress_nv12", VIDEO_FORMAT_NV12,
+				width, height, pad, offset & ~1);
+	}
+
+	verify_decompress("decompress_422 (YUY2)", VIDEO_FORMAT_YUY2,
+			width, height, pad, offset & ~3);
+	verify_decompress("decompress_422 (UYVY)", VIDEO_FORMAT_UYVY,
+			width, height, pad, offset & ~3);
+
+	for (size_t i = 0; i < ARRAY_SIZE(frame_formats); i++)
+		verify_frame_copy("obs_source_frame_copy", frame_formats[i],
+				width, height, pad, offset);
+}
+
+static void verify_all(void)
+{
+	for (size_t w = 0; w < ARRAY_SIZE(test_widths); w++) {
+		for (size_t h = 0; h < ARRAY_SIZE(test_heights); h++) {
+			for (size_t p = 0; p < ARRAY_SIZE(test_pads); p++) {
+				for (size_t o = 0; o < ARRAY_SIZE(test_offsets);
+						o++)
+					verify_size(test_widths[w],
+							test_heights[h],
+							test_pads[p],
+							test_offsets[o]);
+			}
+		}
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct bench_size {
+	const char *name;
+	uint32_t   width;
+	uint32_t   height;
+};
+
+static const struct bench_size bench_sizes[] = {
+	{"720p",  1280,  720},
+	{"1080p", 1920, 1080},
+	{"4K",    3840, 2160},
+};
+
+enum bench_kernel {
+	BENCH_COMPRESS_I420,
+	BENCH_COMPRESS_NV12,
+	BENCH_CONVERT_I444,
+	BENCH_DECOMPRESS_420,
+	BENCH_DECOMPRESS_NV12,
+	BENCH_DECOMPRESS_422,
+	BENCH_COPY_I420,
+	BENCH_COPY_NV12,
+	BENCH_COPY_BGRA,
+	BENCH_COPY_Y800,
+	BENCH_COUNT
+};
+
+static const char *bench_names[BENCH_COUNT] = {
+	[BENCH_COMPRESS_I420]   = "compress_uyvx_to_i420",
+	[BENCH_COMPRESS_NV12]   = "compress_uyvx_to_nv12",
+	[BENCH_CONVERT_I444]    = "convert_uyvx_to_i444",
+	[BENCH_DECOMPRESS_420]  = "decompress_420",
+	[BENCH_DECOMPRESS_NV12] = "decompress_nv12",
+	[BENCH_DECOMPRESS_422]  = "decompress_422",
+	[BENCH_COPY_I420]       = "frame_copy (I420)",
+	[BENCH_COPY_NV12]       = "frame_copy (NV12)",
+	[BENCH_COPY_BGRA]       = "frame_copy (BGRA)",
+	[BENCH_COPY_Y800]       = "frame_copy (Y800)",
+};
+
+static const enum video_format bench_formats[BENCH_COUNT] = {
+	[BENCH_COMPRESS_I420]   = VIDEO_FORMAT_I420,
+	[BENCH_COMPRESS_NV12]   = VIDEO_FORMAT_NV12,
+	[BENCH_CONVERT_I444]    = VIDEO_FORMAT_I444,
+	[BENCH_DECOMPRESS_420]  = VIDEO_FORMAT_I420,
+	[BENCH_DECOMPRESS_NV12] = VIDEO_FORMAT_NV12,
+	[BENCH_DECOMPRESS_422]  = VIDEO_FORMAT_YUY2,
+	[BENCH_COPY_I420]       = VIDEO_FORMAT_I420,
+	[BENCH_COPY_NV12]       = VIDEO_FORMAT_NV12,
+	[BENCH_COPY_BGRA]       = VIDEO_FORMAT_BGRA,
+	[BENCH_COPY_Y800]       = VIDEO_FORMAT_Y800,
+};
+
+static size_t get_frame_size(enum video_format format, uint32_t width,
+		uint32_t height)
+{
+	size_t pixels = (size_t)width * height;
+
+	switch (format) {
+	case VIDEO_FORMAT_I420:
+	case VIDEO_FORMAT_NV12:
+		return pixels * 3 / 2;
+	case VIDEO_FORMAT_I444:
+		return pixels * 3;
+	case VIDEO_FORMAT_YUY2:
+		return pixels * 2;
+	case VIDEO_FORMAT_Y800:
+		return pixels;
+	default:
+		return pixels * 4;
+	}
+}
+
+/* returns the number of bytes read and written by one call */
+static size_t run_kernel(enum bench_kernel kernel, struct obs_source_frame *a,
+		struct obs_source_frame *b)
+{
+	enum video_format format = bench_formats[kernel];
+	uint32_t width = a->width, height = a->height;
+	size_t packed_size = (size_t)width * height * 4;
+
+	switch (kernel) {
+	case BENCH_COMPRESS_I420:
+		compress_uyvx_to_i420(a->data[0], a->linesize[0], 0, height,
+				b->data, b->linesize);
+		break;
+	case BENCH_COMPRESS_NV12:
+		compress_uyvx_to_nv12(a->data[0], a->linesize[0], 0, height,
+				b->data, b->linesize);
+		break;
+	case BENCH_CONVERT_I444:
+		convert_uyvx_to_i444(a->data[0], a->linesize[0], 0, height,
+				b->data, b->linesize);
+		break;
+	case BENCH_DECOMPRESS_420:
+		decompress_420((const uint8_t *const *)b->data, b->linesize,
+				0, height, a->data[0], a->linesize[0]);
+		break;
+	case BENCH_DECOMPRESS_NV12:
+		decompress_nv12((const uint8_t *const *)b->data, b->linesize,
+				0, height, a->data[0], a->linesize[0]);
+		break;
+	case BENCH_DECOMPRESS_422:
+		decompress_422(b->data[0], b->linesize[0], 0, height,
+				a->data[0], a->linesize[0], true);
+		break;
+	default:
+		obs_source_frame_copy(a, b);
+		return get_frame_size(format, width, height) +
+			get_frame_size(a->format, width, height);
+	}
+
+	return packed_size + get_frame_size(format, width, height);
+}
+
+static void bench_kernel(enum bench_kernel kernel, uint32_t min_ms)
+{
+	enum video_format format = bench_formats[kernel];
+	bool copy = kernel >= BENCH_COPY_I420;
+
+	printf("%-24s", bench_names[kernel]);
+
+	for (size_t i = 0; i < ARRAY_SIZE(bench_sizes); i++) {
+		const struct bench_size *size = &bench_sizes[i];
+		struct obs_source_frame *a, *b;
+		uint64_t start, elapsed;
+		size_t bytes = 0;
+		long calls = 0;
+
+		/* 'a' is the packed frame (or the copy destination), 'b' the
+		 * planar frame (or the copy source) */
+		a = obs_source_frame_create(copy ?
+				(format == VIDEO_FORMAT_Y800 ?
+				 VIDEO_FORMAT_BGRX : format) :
+				VIDEO_FORMAT_BGRA,
+				size->width, size->height);
+		b = obs_source_frame_create(format, size->width, size->height);
+		fill_random(a->data[0], get_frame_size(a->format,
+					size->width, size->height));
+		fill_random(b->data[0], get_frame_size(format,
+					size->width, size->height));
+
+		/* warm up the caches and page in the buffers */
+		run_kernel(kernel, a, b);
+
+		start = os_gettime_ns();
+		do {
+			bytes += run_kernel(kernel, a, b);
+			calls++;
+			elapsed = os_gettime_ns() - start;
+		} while (elapsed < (uint64_t)min_ms * 1000000ULL);
+
+		printf("  %5s %7.3f ms %6.2f GB/s", size->name,
+				(double)elapsed / (double)calls / 1000000.0,
+				(double)bytes / (double)elapsed);
+
+		obs_source_frame_destroy(a);
+		obs_source_frame_destroy(b);
+	}
+
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	bool verify = true;
+	bool bench = true;
+	uint32_t min_ms = DEFAULT_MIN_MS;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--verify") == 0) {
+			bench = false;
+		} else if (strcmp(argv[i], "--bench") == 0) {
+			verify = false;
+		} else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+			min_ms = (uint32_t)atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: format-conversion-bench "
+					"[--verify | --bench] "
+					"[--min-time <ms>]\n");
+			return 1;
+		}
+	}
+
+	if (verify) {
+		verify_all();
+		printf("verification: %s (%d failures)\n",
+				failures ? "FAILED" : "passed", failures);
+	}
+
+	if (bench) {
+		for (int i = 0; i < BENCH_COUNT; i++)
+			bench_kernel((enum bench_kernel)i, min_ms);
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/platform.h>
+
+#include "obs-bench.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+struct thread_time {
+	long long tid;
+	char      name[64];
+	uint64_t  cpu_ns;
+};
+
+struct bench_thread_cpu {
+	DARRAY(struct thread_time) threads;
+};
+
+#ifdef __linux__
+
+/* procfs files report a size of zero, so they can't be read with
+ * os_quick_read_utf8_file */
+static bool read_proc_line(const char *path, char *buf, size_t size)
+{
+	FILE *f = fopen(path, "r");
+	bool success;
+
+	if (!f)
+		return false;
+
+	success = fgets(buf, (int)size, f) != NULL;
+	fclose(f);
+	return success;
+}
+
+/* reads the thread name and utime + stime from /proc/self/task/<tid> */
+static bool read_thread_time(const char *tid, struct thread_time *tt)
+{
+	unsigned long long utime, stime;
+	char path[256];
+	char stat[1024];
+	char *fields;
+
+	snprintf(path, sizeof(path), "/proc/self/task/%s/comm", tid);
+	if (!read_proc_line(path, tt->name, sizeof(tt->name)))
+		return false;
+
+	tt->name[strcspn(tt->name, "\r\n")] = 0;
+
+	snprintf(path, sizeof(path), "/proc/self/task/%s/stat", tid);
+	if (!read_proc_line(path, stat, sizeof(stat)))
+		return false;
+
+	/* the thread name can contain spaces, so skip past its parentheses */
+	fields = strrchr(stat, ')');
+	if (!fields)
+		return false;
+
+	if (sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+				"%llu %llu", &utime, &stime) != 2)
+		return false;
+
+	tt->tid = atoll(tid);
+	tt->cpu_ns = (utime + stime) * 1000000000ULL /
+		(uint64_t)sysconf(_SC_CLK_TCK);
+	return true;
+}
+
+static void enum_threads(struct bench_thread_cpu *cpu)
+{
+	DIR *dir = opendir("/proc/self/task");
+	struct dirent *ent;
+
+	if (!dir)
+		return;
+
+	while ((ent = readdir(dir)) != NULL) {
+		struct thread_time tt = {0};
+
+		if (ent->d_name[0] == '.')
+			continue;
+		if (read_thread_time(ent->d_name, &tt))
+			da_push_back(cpu->threads, &tt);
+	}
+
+	closedir(dir);
+}
+
+#else
+
+static void enum_threads(struct bench_thread_cpu *cpu)
+{
+	UNUSED_PARAMETER(cpu);
+}
+
+#endif
+
+struct bench_thread_cpu *bench_thread_cpu_start(void)
+{
+	struct bench_thread_cpu *cpu = bzalloc(sizeof(*cpu));
+	enum_threads(cpu);
+	return cpu;
+}
+
+static uint64_t get_start_time(struct bench_thread_cpu *start, long long tid)
+{
+	for (size_t i = 0; i < start->threads.num; i++) {
+		if (start->threads.array[i].tid == tid)
+			return start->threads.array[i].cpu_ns;
+	}
+
+	return 0;
+}
+
+void bench_thread_cpu_stop(struct bench_thread_cpu *cpu,
+		obs_data_array_t *threads, uint64_t elapsed_ns)
+{
+	struct bench_thread_cpu end = {0};
+
+	enum_threads(&end);
+
+	for (size_t i = 0; i < end.threads.num; i++) {
+		struct thread_time *tt = &end.threads.array[i];
+		uint64_t cpu_ns = tt->cpu_ns - get_start_time(cpu, tt->tid);
+		obs_data_t *thread = obs_data_create();
+
+		obs_data_set_string(thread, "name", tt->name);
+		obs_data_set_int(thread, "tid", tt->tid);
+		obs_data_set_double(thread, "cpu_ms",
+				(double)cpu_ns / 1000000.0);
+		obs_data_set_double(thread, "cpu_percent",
+				(double)cpu_ns * 100.0 / (double)elapsed_ns);
+		obs_data_array_push_back(threads, thread);
+		obs_data_release(thread);
+	}
+
+	da_free(end.threads);
+	da_free(cpu->threads);
+	bfree(cpu);
+}
@@ -0,0 +1,422 @@
+#include <math.h>
+#include <util/bmem.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#include <util/dstr.h>
+#include <obs.h>
+
+#include "obs-bench.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+#define M_PI_X2 M_PI*2
+
+/* waits until the given libobs time.  the offline clock can't be slept on,
+ * so it's polled instead, and late packets are caught up rather than
+ * skipped so that every run generates the same data */
+static bool bench_sleepto_ns(uint64_t time_target, os_event_t *stop_signal)
+{
+	if (!obs_offline_clock_enabled())
+		return os_sleepto_ns(time_target);
+
+	while (obs_gettime_ns() < time_target) {
+		if (os_event_timedwait(stop_signal, 1) != ETIMEDOUT)
+			break;
+	}
+
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Async video: generates frames of the given size/format on its own thread,
+ * like a capture card or camera would */
+
+struct bench_async_video {
+	obs_source_t      *source;
+	pthread_t         thread;
+	os_event_t        *stop_signal;
+	bool              initialized;
+
+	uint32_t          width;
+	uint32_t          height;
+	uint32_t          fps;
+	enum video_format format;
+};
+
+static enum video_format get_frame_format(const char *format)
+{
+	if (astrcmpi(format, "NV12") == 0)
+		return VIDEO_FORMAT_NV12;
+	else if (astrcmpi(format, "YUY2") == 0)
+		return VIDEO_FORMAT_YUY2;
+	else if (astrcmpi(format, "BGRA") == 0)
+		return VIDEO_FORMAT_BGRA;
+	return VIDEO_FORMAT_I420;
+}
+
+static void fill_frame(struct obs_source_frame *frame, uint32_t frame_idx)
+{
+	uint32_t bar = frame_idx * 8 % frame->width;
+
+	for (uint32_t y = 0; y < frame->height; y++) {
+		uint8_t *line = frame->data[0] + frame->linesize[0] * y;
+
+		if (frame->format == VIDEO_FORMAT_BGRA) {
+			uint32_t *pixels = (uint32_t*)line;
+			for (uint32_t x = 0; x < frame->width; x++)
+				pixels[x] = (x >= bar && x < bar + 64) ?
+					0xFFFFFFFF : 0xFF000000 | (y & 0xFF);
+
+		} else if (frame->format == VIDEO_FORMAT_YUY2) {
+			for (uint32_t x = 0; x < frame->width; x++) {
+				line[x * 2] = (x >= bar && x < bar + 64) ?
+					235 : (uint8_t)(16 + y % 200);
+				line[x * 2 + 1] = 128;
+			}
+
+		} else {
+			for (uint32_t x = 0; x < frame->width; x++)
+				line[x] = (x >= bar && x < bar + 64) ?
+					235 : (uint8_t)(16 + y % 200);
+		}
+	}
+
+	if (frame->format == VIDEO_FORMAT_NV12) {
+		memset(frame->data[1], 128,
+				frame->linesize[1] * frame->height / 2);
+	} else if (frame->format == VIDEO_FORMAT_I420) {
+		memset(frame->data[1], 128,
+				frame->linesize[1] * frame->height / 2);
+		memset(frame->data[2], 128,
+				frame->linesize[2] * frame->height / 2);
+	}
+}
+
+static void *async_video_thread(void *data)
+{
+	struct bench_async_video *bav = data;
+	struct obs_source_frame *frame;
+	uint64_t interval = 1000000000ULL / bav->fps;
+	uint64_t start_time = obs_gettime_ns();
+	uint64_t cur_time = start_time;
+	uint32_t frame_idx = 0;
+
+	os_set_thread_name("obs-bench: async video");
+
+	frame = obs_source_frame_create(bav->format, bav->width, bav->height);
+
+	while (os_event_try(bav->stop_signal) == EAGAIN) {
+		fill_frame(frame, frame_idx++);
+
+		frame->timestamp = cur_time - start_time;
+		obs_source_output_video(bav->source, frame);
+
+		if (!bench_sleepto_ns(cur_time += interval, bav->stop_signal))
+			cur_time = os_gettime_ns();
+	}
+
+	obs_source_frame_destroy(frame);
+	return NULL;
+}
+
+static const char *bav_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Async Video (Benchmark)";
+}
+
+static void bav_destroy(void *data)
+{
+	struct bench_async_video *bav = data;
+
+	if (bav) {
+		if (bav->initialized) {
+			os_event_signal(bav->stop_signal);
+			pthread_join(bav->thread, NULL);
+		}
+
+		os_event_destroy(bav->stop_signal);
+		bfree(bav);
+	}
+}
+
+static void *bav_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct bench_async_video *bav = bzalloc(sizeof(*bav));
+	bav->source = source;
+	bav->width  = (uint32_t)obs_data_get_int(settings, "width");
+	bav->height = (uint32_t)obs_data_get_int(settings, "height");
+	bav->fps    = (uint32_t)obs_data_get_int(settings, "fps");
+	bav->format = get_frame_format(obs_data_get_string(settings,
+				"format"));
+
+	if (!bav->width || !bav->height || !bav->fps) {
+		bav_destroy(bav);
+		return NULL;
+	}
+
+	/* keep chroma planes evenly sized */
+	bav->width  = (bav->width  + 1) & ~1;
+	bav->height = (bav->height + 1) & ~1;
+
+	if (os_event_init(&bav->stop_signal, OS_EVENT_TYPE_MANUAL) != 0) {
+		bav_destroy(bav);
+		return NULL;
+	}
+
+	if (pthread_create(&bav->thread, NULL, async_video_thread, bav) != 0) {
+		bav_destroy(bav);
+		return NULL;
+	}
+
+	bav->initialized = true;
+	return bav;
+}
+
+static void bav_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "width", 1280);
+	obs_data_set_default_int(settings, "height", 720);
+	obs_data_set_default_int(settings, "fps", 30);
+	obs_data_set_default_string(settings, "format", "I420");
+}
+
+struct obs_source_info bench_async_video = {
+	.id           = "bench_async_video",
+	.type         = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_ASYNC_VIDEO,
+	.get_name     = bav_getname,
+	.create       = bav_create,
+	.destroy      = bav_destroy,
+	.get_defaults = bav_defaults,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Sync video: draws a colored quad every frame on the graphics thread */
+
+struct bench_sync_video {
+	obs_source_t *source;
+	uint32_t     width;
+	uint32_t     height;
+	uint32_t     color;
+};
+
+static const char *bsv_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Sync Video (Benchmark)";
+}
+
+static void bsv_update(void *data, obs_data_t *settings)
+{
+	struct bench_sync_video *bsv = data;
+	bsv->width  = (uint32_t)obs_data_get_int(settings, "width");
+	bsv->height = (uint32_t)obs_data_get_int(settings, "height");
+}
+
+static void *bsv_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct bench_sync_video *bsv = bzalloc(sizeof(*bsv));
+	bsv->source = source;
+	bsv_update(bsv, settings);
+	return bsv;
+}
+
+static void bsv_destroy(void *data)
+{
+	bfree(data);
+}
+
+static void bsv_tick(void *data, float seconds)
+{
+	struct bench_sync_video *bsv = data;
+	bsv->color = 0xFF000000 | ((bsv->color + 0x010203) & 0xFFFFFF);
+
+	UNUSED_PARAMETER(seconds);
+}
+
+static void bsv_render(void *data, gs_effect_t *effect)
+{
+	struct bench_sync_video *bsv = data;
+	gs_effect_t *solid = obs_get_base_effect(OBS_EFFECT_SOLID);
+	gs_eparam_t *color = gs_effect_get_param_by_name(solid, "color");
+	gs_technique_t *tech = gs_effect_get_technique(solid, "Solid");
+	struct vec4 colorf;
+
+	vec4_from_rgba(&colorf, bsv->color);
+	gs_effect_set_vec4(color, &colorf);
+
+	gs_technique_begin(tech);
+	gs_technique_begin_pass(tech, 0);
+
+	gs_draw_sprite(0, 0, bsv->width, bsv->height);
+
+	gs_technique_end_pass(tech);
+	gs_technique_end(tech);
+
+	UNUSED_PARAMETER(effect);
+}
+
+static uint32_t bsv_width(void *data)
+{
+	struct bench_sync_video *bsv = data;
+	return bsv->width;
+}
+
+static uint32_t bsv_height(void *data)
+{
+	struct bench_sync_video *bsv = data;
+	return bsv->height;
+}
+
+static void bsv_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "width", 1920);
+	obs_data_set_default_int(settings, "height", 1080);
+}
+
+struct obs_source_info bench_sync_video = {
+	.id           = "bench_sync_video",
+	.type         = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_VIDEO,
+	.get_name     = bsv_getname,
+	.create       = bsv_create,
+	.destroy      = bsv_destroy,
+	.update       = bsv_update,
+	.get_defaults = bsv_defaults,
+	.video_tick   = bsv_tick,
+	.video_render = bsv_render,
+	.get_width    = bsv_width,
+	.get_height   = bsv_height,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Audio: outputs a sine wave in 10ms packets on its own thread */
+
+#define AUDIO_PACKET_FRAMES 480
+
+struct bench_audio {
+	obs_source_t *source;
+	pthread_t    thread;
+	os_event_t   *stop_signal;
+	bool         initialized;
+
+	double       frequency;
+	uint32_t     sample_rate;
+};
+
+static void *audio_thread(void *data)
+{
+	struct bench_audio *ba = data;
+	float samples[2][AUDIO_PACKET_FRAMES];
+	double rate = ba->frequency / (double)ba->sample_rate;
+	uint64_t interval = AUDIO_PACKET_FRAMES * 1000000000ULL /
+		ba->sample_rate;
+	uint64_t start_time = obs_gettime_ns();
+	uint64_t cur_time = start_time;
+	double cos_val = 0.0;
+
+	struct obs_source_audio audio = {
+		.data            = {(uint8_t*)samples[0], (uint8_t*)samples[1]},
+		.frames          = AUDIO_PACKET_FRAMES,
+		.speakers        = SPEAKERS_STEREO,
+		.samples_per_sec = ba->sample_rate,
+		.format          = AUDIO_FORMAT_FLOAT_PLANAR
+	};
+
+	os_set_thread_name("obs-bench: audio");
+
+	while (os_event_try(ba->stop_signal) == EAGAIN) {
+		for (size_t i = 0; i < AUDIO_PACKET_FRAMES; i++) {
+			cos_val += rate * M_PI_X2;
+			if (cos_val > M_PI_X2)
+				cos_val -= M_PI_X2;
+
+			samples[0][i] = samples[1][i] =
+				(float)(cos(cos_val) * 0.5);
+		}
+
+		audio.timestamp = cur_time - start_time;
+		obs_source_output_audio(ba->source, &audio);
+
+		if (!bench_sleepto_ns(cur_time += interval, ba->stop_signal))
+			cur_time = os_gettime_ns();
+	}
+
+	return NULL;
+}
+
+static const char *ba_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Audio (Benchmark)";
+}
+
+static void ba_destroy(void *data)
+{
+	struct bench_audio *ba = data;
+
+	if (ba) {
+		if (ba->initialized) {
+			os_event_signal(ba->stop_signal);
+			pthread_join(ba->thread, NULL);
+		}
+
+		os_event_destroy(ba->stop_signal);
+		bfree(ba);
+	}
+}
+
+static void *ba_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct bench_audio *ba = bzalloc(sizeof(*ba));
+	ba->source      = source;
+	ba->frequency   = obs_data_get_double(settings, "frequency");
+	ba->sample_rate = (uint32_t)obs_data_get_int(settings,
+			"samples_per_sec");
+
+	if (!ba->sample_rate) {
+		ba_destroy(ba);
+		return NULL;
+	}
+
+	if (os_event_init(&ba->stop_signal, OS_EVENT_TYPE_MANUAL) != 0) {
+		ba_destroy(ba);
+		return NULL;
+	}
+
+	if (pthread_create(&ba->thread, NULL, audio_thread, ba) != 0) {
+		ba_destroy(ba);
+		return NULL;
+	}
+
+	ba->initialized = true;
+	return ba;
+}
+
+static void ba_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_double(settings, "frequency", 261.63);
+	obs_data_set_default_int(settings, "samples_per_sec", 48000);
+}
+
+struct obs_source_info bench_audio = {
+	.id           = "bench_audio",
+	.type         = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_AUDIO,
+	.get_name     = ba_getname,
+	.create       = ba_create,
+	.destroy      = ba_destroy,
+	.get_defaults = ba_defaults,
+};
+
+/* ------------------------------------------------------------------------- */
+
+void bench_register_sources(void)
+{
+	obs_register_source(&bench_async_video);
+	obs_register_source(&bench_sync_video);
+	obs_register_source(&bench_audio);
+}
@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <string.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/profiler.h>
+
+#include "obs-bench.h"
+
+struct time_stats {
+	const char              *name;
+	profiler_time_entries_t times;
+};
+
+static bool merge_entry_times(void *param, profiler_snapshot_entry_t *entry)
+{
+	struct time_stats *stats = param;
+	const char *name = profiler_snapshot_entry_name(entry);
+
+	if (astrcmp_n(name, stats->name, strlen(stats->name)) == 0) {
+		profiler_time_entries_t *times =
+			profiler_snapshot_entry_times(entry);
+		da_push_back_da(stats->times, (*times));
+	}
+
+	profiler_snapshot_enumerate_children(entry, merge_entry_times, param);
+	return true;
+}
+
+static int cmp_time_entry(const void *a, const void *b)
+{
+	const profiler_time_entry_t *entry_a = a;
+	const profiler_time_entry_t *entry_b = b;
+
+	if (entry_a->time_delta == entry_b->time_delta)
+		return 0;
+	return entry_a->time_delta < entry_b->time_delta ? -1 : 1;
+}
+
+static uint64_t get_percentile(struct time_stats *stats, uint64_t total,
+		double percentile)
+{
+	uint64_t target = (uint64_t)((double)total * percentile / 100.0);
+	uint64_t count = 0;
+
+	for (size_t i = 0; i < stats->times.num; i++) {
+		count += stats->times.array[i].count;
+		if (count > target)
+			return stats->times.array[i].time_delta;
+	}
+
+	return stats->times.num ?
+		stats->times.array[stats->times.num - 1].time_delta : 0;
+}
+
+bool bench_add_time_stats(obs_data_t *obj, const char *key,
+		profiler_snapshot_t *snap, const char *name)
+{
+	struct time_stats stats = {name};
+	obs_data_t *result = obs_data_create();
+	uint64_t total = 0;
+	uint64_t sum = 0;
+
+	profiler_snapshot_enumerate_roots(snap, merge_entry_times, &stats);
+
+	qsort(stats.times.array, stats.times.num,
+			sizeof(profiler_time_entry_t), cmp_time_entry);
+
+	for (size_t i = 0; i < stats.times.num; i++) {
+		total += stats.times.array[i].count;
+		sum += stats.times.array[i].count *
+			stats.times.array[i].time_delta;
+	}
+
+	obs_data_set_int(result, "count", (long long)total);
+	obs_data_set_double(result, "avg",
+			total ? (double)sum / (double)total : 0.0);
+	obs_data_set_int(result, "p50", get_percentile(&stats, total, 50.0));
+	obs_data_set_int(result, "p90", get_percentile(&stats, total, 90.0));
+	obs_data_set_int(result, "p99", get_percentile(&stats, total, 99.0));
+	obs_data_set_int(result, "max", get_percentile(&stats, total, 100.0));
+	obs_data_set_obj(obj, key, result);
+
+	obs_data_release(result);
+	da_free(stats.times);
+	return total != 0;
+}
@@ -0,0 +1,562 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <graphics/vec2.h>
+#include <obs.h>
+
+#include "obs-bench.h"
+
+/* Headless libobs pipeline benchmark.  Boots libobs without a UI, builds a
+ * scene from a JSON description, encodes it to a null output for the given
+ * duration and prints the collected statistics as JSON.
+ *
+ * On Linux the OpenGL renderer only needs an X display, so this can be run
+ * against a software rasterizer with e.g.:
+ *
+ *   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run obs-bench scene.json
+ *
+ * Scene description:
+ *
+ *   {
+ *       "duration": 10,
+ *       "video": {"base_width": 1920, "base_height": 1080,
+ *                 "output_width": 1280, "output_height": 720,
+ *                 "fps_num": 60, "fps_den": 1, "format": "NV12"},
+ *       "audio": {"samples_per_sec": 48000, "speakers": 2},
+ *       "video_encoder": {"id": "obs_x264", "settings": {...}},
+ *       "audio_encoder": {"id": "ffmpeg_aac", "settings": {...}},
+ *       "sources": [
+ *           {"id": "bench_async_video", "name": "camera",
+ *            "settings": {...}, "x": 0, "y": 0},
+ *           ...
+ *       ]
+ *   }
+ *
+ * Sources are created with obs_load_source, so any source type from the
+ * loaded modules can be used in addition to the synthetic bench_* sources
+ * in bench-sources.c.
+ *
+ * With --offline, libobs runs on its virtual clock: frames are rendered back
+ * to back and the duration is measured in video time, so "speed" in the
+ * results is how many times faster than real time the pipeline can run. */
+
+#define DEFAULT_RENDERER "libobs-opengl"
+#define SAMPLE_INTERVAL_MS 100
+#define STOP_TIMEOUT_MS 5000
+
+static bool verbose = false;
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (verbose || log_level <= LOG_WARNING) {
+		vfprintf(stderr, msg, args);
+		fprintf(stderr, "\n");
+	}
+
+	UNUSED_PARAMETER(param);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: obs-bench [options] <scene.json>\n"
+		"\n"
+		"options:\n"
+		"  --duration <seconds>        overrides the scene duration\n"
+		"  --output <file>             writes the results to a file\n"
+		"  --renderer <module>         graphics module (default: "
+		DEFAULT_RENDERER ")\n"
+		"  --module-path <bin> <data>  adds a plugin search path\n"
+		"  --trace <file>              records a Chrome/Perfetto trace\n"
+		"  --offline                   renders as fast as possible on a\n"
+		"                              virtual clock\n"
+		"  --verbose                   prints all libobs log output\n");
+}
+
+/* ------------------------------------------------------------------------- */
+
+static enum video_format get_video_format(const char *format)
+{
+	if (astrcmpi(format, "I420") == 0)
+		return VIDEO_FORMAT_I420;
+	else if (astrcmpi(format, "I444") == 0)
+		return VIDEO_FORMAT_I444;
+	else if (astrcmpi(format, "RGBA") == 0)
+		return VIDEO_FORMAT_RGBA;
+	return VIDEO_FORMAT_NV12;
+}
+
+static void video_defaults(obs_data_t *video)
+{
+	obs_data_set_default_int(video, "base_width", 1920);
+	obs_data_set_default_int(video, "base_height", 1080);
+	obs_data_set_default_int(video, "output_width", 1280);
+	obs_data_set_default_int(video, "output_height", 720);
+	obs_data_set_default_int(video, "fps_num", 60);
+	obs_data_set_default_int(video, "fps_den", 1);
+	obs_data_set_default_string(video, "format", "NV12");
+}
+
+static bool reset_video(obs_data_t *scene, const char *renderer)
+{
+	obs_data_t *video = obs_data_get_obj(scene, "video");
+	struct obs_video_info ovi = {0};
+	int ret;
+
+	if (!video)
+		video = obs_data_create();
+	video_defaults(video);
+
+	ovi.graphics_module = renderer;
+	ovi.base_width      = (uint32_t)obs_data_get_int(video, "base_width");
+	ovi.base_height     = (uint32_t)obs_data_get_int(video, "base_height");
+	ovi.output_width    = (uint32_t)obs_data_get_int(video, "output_width");
+	ovi.output_height   = (uint32_t)obs_data_get_int(video,
+			"output_height");
+	ovi.fps_num         = (uint32_t)obs_data_get_int(video, "fps_num");
+	ovi.fps_den         = (uint32_t)obs_data_get_int(video, "fps_den");
+	ovi.output_format   = get_video_format(
+			obs_data_get_string(video, "format"));
+	ovi.gpu_conversion  = true;
+	ovi.colorspace      = VIDEO_CS_709;
+	ovi.range           = VIDEO_RANGE_PARTIAL;
+	ovi.scale_type      = OBS_SCALE_BICUBIC;
+
+	obs_data_release(video);
+
+	ret = obs_reset_video(&ovi);
+	if (ret != OBS_VIDEO_SUCCESS) {
+		blog(LOG_ERROR, "obs_reset_video failed (%d)", ret);
+		return false;
+	}
+
+	return true;
+}
+
+static bool reset_audio(obs_data_t *scene)
+{
+	obs_data_t *audio = obs_data_get_obj(scene, "audio");
+	struct obs_audio_info oai;
+
+	if (!audio)
+		audio = obs_data_create();
+	obs_data_set_default_int(audio, "samples_per_sec", 48000);
+	obs_data_set_default_int(audio, "speakers", SPEAKERS_STEREO);
+
+	oai.samples_per_sec = (uint32_t)obs_data_get_int(audio,
+			"samples_per_sec");
+	oai.speakers = (enum speaker_layout)obs_data_get_int(audio,
+			"speakers");
+
+	obs_data_release(audio);
+
+	if (!obs_reset_audio(&oai)) {
+		blog(LOG_ERROR, "obs_reset_audio failed");
+		return false;
+	}
+
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static obs_scene_t *load_scene(obs_data_t *data)
+{
+	obs_data_array_t *sources = obs_data_get_array(data, "sources");
+	size_t count = obs_data_array_count(sources);
+	obs_scene_t *scene = obs_scene_create("obs-bench");
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *source_data = obs_data_array_item(sources, i);
+		obs_source_t *source = obs_load_source(source_data);
+		obs_sceneitem_t *item;
+		struct vec2 pos;
+
+		if (!source) {
+			blog(LOG_WARNING, "Failed to create source %d", (int)i);
+			obs_data_release(source_data);
+			continue;
+		}
+
+		vec2_set(&pos,
+			(float)obs_data_get_double(source_data, "x"),
+			(float)obs_data_get_double(source_data, "y"));
+
+		item = obs_scene_add(scene, source);
+		obs_sceneitem_set_pos(item, &pos);
+
+		obs_source_release(source);
+		obs_data_release(source_data);
+	}
+
+	obs_data_array_release(sources);
+	return scene;
+}
+
+static obs_encoder_t *create_encoder(obs_data_t *scene, const char *name,
+		const char *default_id, bool video)
+{
+	obs_data_t *data = obs_data_get_obj(scene, name);
+	obs_data_t *settings;
+	obs_encoder_t *encoder;
+	const char *id;
+
+	if (!data)
+		data = obs_data_create();
+	obs_data_set_default_string(data, "id", default_id);
+
+	id = obs_data_get_string(data, "id");
+	settings = obs_data_get_obj(data, "settings");
+
+	if (video) {
+		encoder = obs_video_encoder_create(id, name, settings, NULL);
+		if (encoder)
+			obs_encoder_set_video(encoder, obs_get_video());
+	} else {
+		encoder = obs_audio_encoder_create(id, name, settings, 0,
+				NULL);
+		if (encoder)
+			obs_encoder_set_audio(encoder, obs_get_audio());
+	}
+
+	if (!encoder)
+		blog(LOG_ERROR, "Failed to create %s '%s'", name, id);
+
+	obs_data_release(settings);
+	obs_data_release(data);
+	return encoder;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Output statistics */
+
+static const char *latency_stage_names[OBS_LATENCY_STAGE_COUNT] = {
+	[OBS_LATENCY_RENDER]          = "render",
+	[OBS_LATENCY_CONVERT]         = "convert",
+	[OBS_LATENCY_ENCODE_SUBMIT]   = "encode_submit",
+	[OBS_LATENCY_ENCODE_COMPLETE] = "encode_complete",
+	[OBS_LATENCY_INTERLEAVE]      = "interleave",
+	[OBS_LATENCY_SEND]            = "send",
+};
+
+/* adds the latency from capture to each pipeline stage, in milliseconds */
+static void add_latency_stats(obs_data_t *obj, obs_output_t *output)
+{
+	struct obs_output_latency_stats stats;
+	obs_data_t *result;
+
+	if (!obs_output_get_latency_stats(output, &stats))
+		return;
+
+	result = obs_data_create();
+
+	for (size_t i = 0; i < OBS_LATENCY_STAGE_COUNT; i++) {
+		struct obs_latency_stage_stats *stage = &stats.stages[i];
+		obs_data_t *stage_obj;
+
+		if (!stage->count)
+			continue;
+
+		stage_obj = obs_data_create();
+		obs_data_set_int(stage_obj, "count", (long long)stage->count);
+		obs_data_set_double(stage_obj, "avg", stage->mean_ms);
+		obs_data_set_double(stage_obj, "p50", stage->p50_ms);
+		obs_data_set_double(stage_obj, "p95", stage->p95_ms);
+		obs_data_set_double(stage_obj, "p99", stage->p99_ms);
+		obs_data_set_double(stage_obj, "max", stage->max_ms);
+		obs_data_set_obj(result, latency_stage_names[i], stage_obj);
+		obs_data_release(stage_obj);
+	}
+
+	obs_data_set_obj(obj, "latency_ms", result);
+	obs_data_release(result);
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct bench_params {
+	const char          *scene_file;
+	const char          *output_file;
+	const char          *renderer;
+	const char          *trace_file;
+	double              duration;
+	bool                offline;
+	DARRAY(const char*) module_paths;
+};
+
+static bool parse_args(struct bench_params *params, int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+
+		if (strcmp(arg, "--duration") == 0 && i + 1 < argc) {
+			params->duration = atof(argv[++i]);
+		} else if (strcmp(arg, "--output") == 0 && i + 1 < argc) {
+			params->output_file = argv[++i];
+		} else if (strcmp(arg, "--trace") == 0 && i + 1 < argc) {
+			params->trace_file = argv[++i];
+		} else if (strcmp(arg, "--renderer") == 0 && i + 1 < argc) {
+			params->renderer = argv[++i];
+		} else if (strcmp(arg, "--module-path") == 0 && i + 2 < argc) {
+			da_push_back(params->module_paths, &argv[++i]);
+			da_push_back(params->module_paths, &argv[++i]);
+		} else if (strcmp(arg, "--offline") == 0) {
+			params->offline = true;
+		} else if (strcmp(arg, "--verbose") == 0) {
+			verbose = true;
+		} else if (arg[0] != '-' && !params->scene_file) {
+			params->scene_file = arg;
+		} else {
+			return false;
+		}
+	}
+
+	return params->scene_file != NULL;
+}
+
+static inline bool bench_running(bool offline, uint64_t end_time,
+		uint64_t video_end_time)
+{
+	return offline ? obs_get_video_frame_time() < video_end_time :
+		os_gettime_ns() < end_time;
+}
+
+static obs_data_t *run_bench(obs_data_t *scene_data,
+		const struct bench_params *params)
+{
+	obs_data_t *results = obs_data_create();
+	obs_data_t *video_stats = obs_data_create();
+	obs_data_t *output_stats = obs_data_create();
+	obs_data_t *audio_stats = obs_data_create();
+	obs_data_t *encoder_stats = obs_data_create();
+	obs_data_t *cpu_stats = obs_data_create();
+	obs_data_array_t *threads = obs_data_array_create();
+	obs_encoder_t *venc = NULL;
+	obs_encoder_t *aenc = NULL;
+	obs_output_t *output = NULL;
+	obs_scene_t *scene;
+	profiler_snapshot_t *snap;
+	os_cpu_usage_info_t *cpu_info;
+	struct bench_thread_cpu *thread_cpu;
+	uint32_t start_total, start_lagged;
+	uint32_t max_buffering = 0;
+	uint64_t start_time, end_time, elapsed;
+	uint64_t duration_ns = (uint64_t)(params->duration * 1000000000.0);
+	uint64_t video_start_time;
+	bool have_frame_times;
+
+	scene = load_scene(scene_data);
+	obs_set_output_source(0, obs_scene_get_source(scene));
+
+	venc = create_encoder(scene_data, "video_encoder", "obs_x264", true);
+	aenc = create_encoder(scene_data, "audio_encoder", "ffmpeg_aac", false);
+	output = obs_output_create("null_output", "obs-bench", NULL, NULL);
+
+	if (!venc || !aenc || !output) {
+		obs_data_release(results);
+		results = NULL;
+		goto cleanup;
+	}
+
+	obs_output_set_video_encoder(output, venc);
+	obs_output_set_audio_encoder(output, aenc, 0);
+
+	obs_set_latency_tracking(true);
+
+	if (!obs_output_start(output)) {
+		blog(LOG_ERROR, "Failed to start output: %s",
+				obs_output_get_last_error(output));
+		obs_data_release(results);
+		results = NULL;
+		goto cleanup;
+	}
+
+	if (params->trace_file)
+		profiler_trace_start();
+
+	start_total = obs_get_total_frames();
+	start_lagged = obs_get_lagged_frames();
+	cpu_info = os_cpu_usage_info_start();
+	thread_cpu = bench_thread_cpu_start();
+	start_time = os_gettime_ns();
+	end_time = start_time + duration_ns;
+	video_start_time = obs_get_video_frame_time();
+
+	while (bench_running(params->offline, end_time,
+				video_start_time + duration_ns)) {
+		uint32_t buffering = obs_get_audio_buffering_ms();
+		if (buffering > max_buffering)
+			max_buffering = buffering;
+
+		os_sleep_ms(SAMPLE_INTERVAL_MS);
+	}
+
+	elapsed = os_gettime_ns() - start_time;
+
+	if (params->trace_file) {
+		profiler_trace_stop();
+		if (!profiler_trace_dump_json(params->trace_file))
+			blog(LOG_WARNING, "Failed to write trace to '%s'",
+					params->trace_file);
+	}
+
+	obs_data_set_double(cpu_stats, "process_percent",
+			os_cpu_usage_info_query(cpu_info));
+	bench_thread_cpu_stop(thread_cpu, threads, elapsed);
+	obs_data_set_array(cpu_stats, "threads", threads);
+	os_cpu_usage_info_destroy(cpu_info);
+
+	obs_data_set_int(video_stats, "total_frames",
+			obs_get_total_frames() - start_total);
+	obs_data_set_int(video_stats, "lagged_frames",
+			obs_get_lagged_frames() - start_lagged);
+	obs_data_set_double(video_stats, "average_frame_time_ms",
+			(double)obs_get_average_frame_time_ns() / 1000000.0);
+	obs_data_set_double(video_stats, "active_fps", obs_get_active_fps());
+
+	obs_data_set_int(audio_stats, "buffering_ms",
+			obs_get_audio_buffering_ms());
+	obs_data_set_int(audio_stats, "max_buffering_ms", max_buffering);
+
+	obs_output_stop(output);
+	for (int i = 0; i < STOP_TIMEOUT_MS / 10 && obs_output_active(output);
+			i++)
+		os_sleep_ms(10);
+
+	obs_data_set_int(output_stats, "total_frames",
+			obs_output_get_total_frames(output));
+	obs_data_set_int(output_stats, "dropped_frames",
+			obs_output_get_frames_dropped(output));
+	obs_data_set_int(output_stats, "skipped_frames",
+			video_output_get_skipped_frames(obs_get_video()));
+	add_latency_stats(output_stats, output);
+
+	snap = profile_snapshot_create();
+	have_frame_times = bench_add_time_stats(video_stats, "frame_time_us",
+			snap, "obs_graphics_thread(");
+	bench_add_time_stats(video_stats, "render_time_us", snap,
+			"render_video");
+	bench_add_time_stats(encoder_stats, "video_encode_time_us", snap,
+			"encode(video_encoder)");
+	bench_add_time_stats(encoder_stats, "audio_encode_time_us", snap,
+			"encode(audio_encoder)");
+	profile_snapshot_free(snap);
+
+	if (!have_frame_times) {
+		blog(LOG_ERROR, "No graphics thread frame times were recorded, "
+				"the profiler names may have changed");
+		obs_data_release(results);
+		results = NULL;
+		goto cleanup;
+	}
+
+	obs_data_set_double(results, "duration_s",
+			(double)elapsed / 1000000000.0);
+	obs_data_set_bool(results, "offline", params->offline);
+	obs_data_set_double(results, "speed", params->offline ?
+			(double)duration_ns / (double)elapsed : 1.0);
+	obs_data_set_obj(results, "video", video_stats);
+	obs_data_set_obj(results, "output", output_stats);
+	obs_data_set_obj(results, "audio", audio_stats);
+	obs_data_set_obj(results, "encoders", encoder_stats);
+	obs_data_set_obj(results, "cpu", cpu_stats);
+
+cleanup:
+	obs_set_output_source(0, NULL);
+	obs_output_release(output);
+	obs_encoder_release(venc);
+	obs_encoder_release(aenc);
+	obs_scene_release(scene);
+
+	obs_data_array_release(threads);
+	obs_data_release(cpu_stats);
+	obs_data_release(encoder_stats);
+	obs_data_release(audio_stats);
+	obs_data_release(output_stats);
+	obs_data_release(video_stats);
+	return results;
+}
+
+int main(int argc, char *argv[])
+{
+	struct bench_params params = {0};
+	profiler_name_store_t *names;
+	obs_data_t *scene_data;
+	obs_data_t *results = NULL;
+	int ret = 1;
+
+	params.renderer = DEFAULT_RENDERER;
+
+	if (!parse_args(&params, argc, argv)) {
+		usage();
+		da_free(params.module_paths);
+		return 1;
+	}
+
+	base_set_log_handler(do_log, NULL);
+
+	scene_data = obs_data_create_from_json_file(params.scene_file);
+	if (!scene_data) {
+		fprintf(stderr, "Failed to load '%s'\n", params.scene_file);
+		da_free(params.module_paths);
+		return 1;
+	}
+
+	obs_data_set_default_double(scene_data, "duration", 10.0);
+	if (params.duration <= 0.0)
+		params.duration = obs_data_get_double(scene_data, "duration");
+
+	names = profiler_name_store_create();
+	profiler_start();
+
+	if (!obs_startup("en-US", NULL, names)) {
+		fprintf(stderr, "Failed to start libobs\n");
+		goto exit;
+	}
+
+	if (params.offline)
+		obs_set_offline_clock(true);
+
+	if (!reset_audio(scene_data) ||
+	    !reset_video(scene_data, params.renderer))
+		goto exit;
+
+	bench_register_sources();
+
+	for (size_t i = 0; i + 1 < params.module_paths.num; i += 2)
+		obs_add_module_path(params.module_paths.array[i],
+				params.module_paths.array[i + 1]);
+	obs_load_all_modules();
+	obs_post_load_modules();
+
+	results = run_bench(scene_data, &params);
+	if (!results)
+		goto exit;
+
+	if (params.output_file) {
+		if (obs_data_save_json(results, params.output_file))
+			ret = 0;
+	} else {
+		printf("%s\n", obs_data_get_json(results));
+		ret = 0;
+	}
+
+exit:
+	obs_data_release(results);
+	obs_shutdown();
+
+	profiler_stop();
+	profiler_free();
+	profiler_name_store_free(names);
+
+	obs_data_release(scene_data);
+	da_free(params.module_paths);
+	return ret;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <util/profiler.h>
+#include <obs.h>
+
+/* synthetic sources used by benchmark scenes:
+ *
+ *   bench_async_video: width, height, fps, format (I420/NV12/YUY2/BGRA)
+ *   bench_sync_video:  width, height
+ *   bench_audio:       frequency, samples_per_sec */
+extern void bench_register_sources(void);
+
+/* fills 'threads' with the CPU time used by each thread of the process since
+ * the matching bench_thread_cpu_start call */
+struct bench_thread_cpu;
+extern struct bench_thread_cpu *bench_thread_cpu_start(void);
+extern void bench_thread_cpu_stop(struct bench_thread_cpu *cpu,
+		obs_data_array_t *threads, uint64_t elapsed_ns);
+
+/* finds every profiler entry whose name starts with 'name' and adds its call
+ * time distribution (count, avg, p50, p90, p99 and max, in microseconds) to
+ * 'obj' under 'key'.  returns false if no entry had any samples */
+extern bool bench_add_time_stats(obs_data_t *obj, const char *key,
+		profiler_snapshot_t *snap, const char *name);
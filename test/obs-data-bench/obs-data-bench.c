@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <obs-data.h>
+
+/* Generates a synthetic scene collection with the given number of sources
+ * and times loading and saving it through obs_data.
+ *
+ * usage: obs-data-bench [num_sources] [iterations] */
+
+#define DEFAULT_SOURCES    1500
+#define DEFAULT_ITERATIONS 5
+
+static obs_data_t *create_source(int idx)
+{
+	obs_data_t *source = obs_data_create();
+	obs_data_t *settings = obs_data_create();
+	obs_data_t *hotkeys = obs_data_create();
+	obs_data_array_t *filters = obs_data_array_create();
+	obs_data_array_t *empty = obs_data_array_create();
+	char str[256];
+
+	snprintf(str, sizeof(str), "Source %d", idx);
+	obs_data_set_string(source, "name", str);
+	obs_data_set_string(source, "id", "image_source");
+	obs_data_set_bool(source, "enabled", true);
+	obs_data_set_bool(source, "muted", false);
+	obs_data_set_double(source, "volume", 1.0);
+	obs_data_set_double(source, "balance", 0.5);
+	obs_data_set_int(source, "mixers", 0xFF);
+	obs_data_set_int(source, "sync", 0);
+	obs_data_set_int(source, "flags", 0);
+	obs_data_set_int(source, "deinterlace_mode", 0);
+
+	snprintf(str, sizeof(str), "/home/user/images/overlay_%d.png", idx);
+	obs_data_set_string(settings, "file", str);
+	obs_data_set_bool(settings, "unload", false);
+	obs_data_set_int(settings, "color", 0xFFFFFFFF);
+	obs_data_set_double(settings, "opacity", (double)(idx % 100) / 100.0);
+	obs_data_set_obj(source, "settings", settings);
+
+	for (int i = 0; i < 2; i++) {
+		obs_data_t *filter = obs_data_create();
+		obs_data_t *filter_settings = obs_data_create();
+
+		snprintf(str, sizeof(str), "Filter %d", i);
+		obs_data_set_string(filter, "name", str);
+		obs_data_set_string(filter, "id", "color_filter");
+		obs_data_set_double(filter_settings, "gamma", 0.25 * i);
+		obs_data_set_int(filter_settings, "opacity", 100);
+		obs_data_set_obj(filter, "settings", filter_settings);
+		obs_data_array_push_back(filters, filter);
+
+		obs_data_release(filter_settings);
+		obs_data_release(filter);
+	}
+	obs_data_set_array(source, "filters", filters);
+
+	obs_data_set_array(hotkeys, "libobs.mute", empty);
+	obs_data_set_array(hotkeys, "libobs.unmute", empty);
+	obs_data_set_array(hotkeys, "libobs.push-to-mute", empty);
+	obs_data_set_obj(source, "hotkeys", hotkeys);
+
+	obs_data_array_release(empty);
+	obs_data_array_release(filters);
+	obs_data_release(hotkeys);
+	obs_data_release(settings);
+	return source;
+}
+
+static obs_data_t *create_collection(int num_sources)
+{
+	obs_data_t *collection = obs_data_create();
+	obs_data_array_t *sources = obs_data_array_create();
+
+	for (int i = 0; i < num_sources; i++) {
+		obs_data_t *source = create_source(i);
+		obs_data_array_push_back(sources, source);
+		obs_data_release(source);
+	}
+
+	obs_data_set_string(collection, "name", "Benchmark");
+	obs_data_set_string(collection, "current_scene", "Source 0");
+	obs_data_set_array(collection, "sources", sources);
+
+	obs_data_array_release(sources);
+	return collection;
+}
+
+/* simulates the per-source settings queries done during scene load */
+static long long query_sources(obs_data_t *collection)
+{
+	obs_data_array_t *sources = obs_data_get_array(collection, "sources");
+	size_t count = obs_data_array_count(sources);
+	long long total = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *source = obs_data_array_item(sources, i);
+		obs_data_t *settings = obs_data_get_obj(source, "settings");
+
+		total += (long long)strlen(obs_data_get_string(source, "name"));
+		total += obs_data_get_int(source, "mixers");
+		total += obs_data_get_int(source, "deinterlace_mode");
+		total += obs_data_get_bool(source, "enabled");
+		total += obs_data_get_int(settings, "color");
+		total += (long long)obs_data_get_double(settings, "opacity");
+
+		obs_data_release(settings);
+		obs_data_release(source);
+	}
+
+	obs_data_array_release(sources);
+	return total;
+}
+
+static inline double ms_since(uint64_t start)
+{
+	return (double)(os_gettime_ns() - start) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	int num_sources = argc > 1 ? atoi(argv[1]) : DEFAULT_SOURCES;
+	int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+	double save_ms = 0.0;
+	double load_ms = 0.0;
+	double query_ms = 0.0;
+	double save_bin_ms = 0.0;
+	double load_bin_ms = 0.0;
+	double load_file_ms = 0.0;
+	long long query_total = 0;
+	obs_data_t *collection;
+	const char *json;
+	size_t json_size;
+	const char *bin_file = "obs-data-bench.bin";
+	size_t bin_size = 0;
+	void *bin;
+
+	if (num_sources <= 0 || iterations <= 0) {
+		printf("usage: obs-data-bench [num_sources] [iterations]\n");
+		return 1;
+	}
+
+	collection = create_collection(num_sources);
+	json = obs_data_get_json(collection);
+	json_size = strlen(json);
+
+	for (int i = 0; i < iterations; i++) {
+		uint64_t start = os_gettime_ns();
+		json = obs_data_get_json(collection);
+		save_ms += ms_since(start);
+
+		start = os_gettime_ns();
+		obs_data_t *loaded = obs_data_create_from_json(json);
+		load_ms += ms_since(start);
+
+		if (!loaded) {
+			printf("failed to load generated collection\n");
+			obs_data_release(collection);
+			return 1;
+		}
+
+		start = os_gettime_ns();
+		query_total += query_sources(loaded);
+		query_ms += ms_since(start);
+
+		obs_data_release(loaded);
+
+		start = os_gettime_ns();
+		bin = obs_data_get_binary(collection, &bin_size);
+		save_bin_ms += ms_since(start);
+
+		start = os_gettime_ns();
+		loaded = obs_data_create_from_binary(bin, bin_size);
+		load_bin_ms += ms_since(start);
+
+		if (!loaded || strcmp(obs_data_get_json(loaded), json) != 0) {
+			printf("binary round trip does not match json\n");
+			obs_data_release(loaded);
+			obs_data_release(collection);
+			bfree(bin);
+			return 1;
+		}
+
+		obs_data_release(loaded);
+		bfree(bin);
+	}
+
+	if (obs_data_save_binary(collection, bin_file)) {
+		for (int i = 0; i < iterations; i++) {
+			uint64_t start = os_gettime_ns();
+			obs_data_t *loaded =
+				obs_data_create_from_binary_file(bin_file);
+			load_file_ms += ms_since(start);
+			obs_data_release(loaded);
+		}
+		os_unlink(bin_file);
+	}
+
+	printf("sources:    %d\n", num_sources);
+	printf("json size:  %.2f MB\n", (double)json_size / (1024.0 * 1024.0));
+	printf("save json:  %.3f ms\n", save_ms / (double)iterations);
+	printf("load json:  %.3f ms\n", load_ms / (double)iterations);
+	printf("query:      %.3f ms (%lld)\n", query_ms / (double)iterations,
+			query_total);
+	printf("bin size:   %.2f MB\n", (double)bin_size / (1024.0 * 1024.0));
+	printf("save bin:   %.3f ms\n", save_bin_ms / (double)iterations);
+	printf("load bin:   %.3f ms\n", load_bin_ms / (double)iterations);
+	printf("load file:  %.3f ms\n", load_file_ms / (double)iterations);
+
+	obs_data_release(collection);
+
+	printf("memory leaks: %ld\n", bnum_allocs());
+	return 0;
+}
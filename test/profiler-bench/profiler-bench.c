@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <util/bmem.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+
+/* Measures the cost of a profile_start/profile_end pair, with the profiler
+ * disabled, enabled, and enabled while recording a trace.  A collector thread
+ * takes a snapshot every few milliseconds like the UI would, so merging the
+ * per-thread records is part of what gets measured.
+ *
+ * usage: profiler-bench [threads] [iterations] */
+
+#define DEFAULT_THREADS    4
+#define DEFAULT_ITERATIONS 1000000
+#define SNAPSHOT_INTERVAL  10
+
+static const char *bench_root  = "profiler_bench_root";
+static const char *bench_child = "profiler_bench_child";
+
+struct bench_thread {
+	pthread_t thread;
+	long      iterations;
+	bool      profile;
+	uint64_t  time_ns;
+};
+
+static volatile bool collecting = false;
+
+/* keeps the loop from being optimized away when nothing is profiled */
+static volatile long loop_counter = 0;
+
+static void *bench_thread(void *data)
+{
+	struct bench_thread *bt = data;
+	uint64_t start = os_gettime_ns();
+
+	if (bt->profile) {
+		for (long i = 0; i < bt->iterations; i++) {
+			profile_start(bench_root);
+			profile_start(bench_child);
+			loop_counter++;
+			profile_end(bench_child);
+			profile_end(bench_root);
+		}
+	} else {
+		for (long i = 0; i < bt->iterations; i++)
+			loop_counter++;
+	}
+
+	bt->time_ns = os_gettime_ns() - start;
+	return NULL;
+}
+
+static void *collector_thread(void *unused)
+{
+	while (os_atomic_load_bool(&collecting)) {
+		profiler_snapshot_t *snap = profile_snapshot_create();
+		profile_snapshot_free(snap);
+		os_sleep_ms(SNAPSHOT_INTERVAL);
+	}
+
+	UNUSED_PARAMETER(unused);
+	return NULL;
+}
+
+/* returns the average time each thread spent per iteration, in ns */
+static double run_threads(int num_threads, long iterations, bool profile)
+{
+	struct bench_thread *threads = bzalloc(sizeof(*threads) * num_threads);
+	pthread_t collector;
+	uint64_t total = 0;
+
+	os_atomic_set_bool(&collecting, true);
+	pthread_create(&collector, NULL, collector_thread, NULL);
+
+	for (int i = 0; i < num_threads; i++) {
+		threads[i].iterations = iterations;
+		threads[i].profile = profile;
+		pthread_create(&threads[i].thread, NULL, bench_thread,
+				&threads[i]);
+	}
+
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i].thread, NULL);
+		total += threads[i].time_ns;
+	}
+
+	os_atomic_set_bool(&collecting, false);
+	pthread_join(collector, NULL);
+
+	bfree(threads);
+	return (double)total / (double)num_threads / (double)iterations;
+}
+
+static void run_bench(const char *name, int num_threads, long iterations,
+		double baseline)
+{
+	/* each iteration is two start/end pairs */
+	double ns = run_threads(num_threads, iterations, true);
+	printf("%-10s %2d thread(s): %7.1f ns per call\n", name, num_threads,
+			(ns - baseline) / 2.0);
+}
+
+static void run_all(int num_threads, long iterations)
+{
+	double baseline = run_threads(num_threads, iterations, false);
+
+	profiler_stop();
+	run_bench("disabled", num_threads, iterations, baseline);
+
+	profiler_start();
+	profile_reenable_thread();
+	run_bench("enabled", num_threads, iterations, baseline);
+
+	profiler_trace_start();
+	run_bench("trace", num_threads, iterations, baseline);
+	profiler_trace_stop();
+}
+
+int main(int argc, char *argv[])
+{
+	int num_threads = argc > 1 ? atoi(argv[1]) : DEFAULT_THREADS;
+	long iterations = argc > 2 ? atol(argv[2]) : DEFAULT_ITERATIONS;
+
+	if (num_threads < 1 || iterations < 1) {
+		printf("usage: profiler-bench [threads] [iterations]\n");
+		return 1;
+	}
+
+	profiler_start();
+	profile_register_root(bench_root, 0);
+
+	run_all(1, iterations);
+	if (num_threads > 1)
+		run_all(num_threads, iterations);
+
+	profiler_stop();
+	profiler_free();
+
+	printf("Number of memory leaks: %ld\n", bnum_allocs());
+	return 0;
+}
@@ -0,0 +1,271 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <util/base.h>
+#include <util/platform.h>
+#include <graphics/vec2.h>
+#include <graphics/vec4.h>
+#include <obs.h>
+
+/* Checks that scene occlusion culling only skips items that are completely
+ * hidden.  Each case puts an opaque item on top of a full-canvas item and
+ * checks whether the bottom item is still rendered.
+ *
+ * Like obs-bench, this needs a renderer, which on Linux can be run against a
+ * software rasterizer with e.g.:
+ *
+ *   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run scene-culling-test
+ *
+ * Exits with a non-zero status if any case fails. */
+
+#define DEFAULT_RENDERER "libobs-opengl"
+#define BASE_CX          640
+#define BASE_CY          360
+#define SETTLE_MS        200
+#define MEASURE_MS       300
+
+static volatile long bottom_renders = 0;
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (log_level <= LOG_WARNING) {
+		vfprintf(stderr, msg, args);
+		fprintf(stderr, "\n");
+	}
+
+	UNUSED_PARAMETER(param);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Opaque solid rectangle, the bottom item counts its renders */
+
+struct rect_source {
+	uint32_t cx;
+	uint32_t cy;
+	bool     bottom;
+};
+
+static const char *rect_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Culling test rect";
+}
+
+static void *rect_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct rect_source *rs = bzalloc(sizeof(struct rect_source));
+
+	rs->cx     = (uint32_t)obs_data_get_int(settings, "width");
+	rs->cy     = (uint32_t)obs_data_get_int(settings, "height");
+	rs->bottom = obs_data_get_bool(settings, "bottom");
+
+	UNUSED_PARAMETER(source);
+	return rs;
+}
+
+static void rect_destroy(void *data)
+{
+	bfree(data);
+}
+
+static void rect_render(void *data, gs_effect_t *effect)
+{
+	struct rect_source *rs = data;
+	gs_effect_t *solid = obs_get_base_effect(OBS_EFFECT_SOLID);
+	gs_eparam_t *color = gs_effect_get_param_by_name(solid, "color");
+	struct vec4 white;
+
+	vec4_set(&white, 1.0f, 1.0f, 1.0f, 1.0f);
+	gs_effect_set_vec4(color, &white);
+
+	while (gs_effect_loop(solid, "Solid"))
+		gs_draw_sprite(NULL, 0, rs->cx, rs->cy);
+
+	if (rs->bottom)
+		os_atomic_inc_long(&bottom_renders);
+
+	UNUSED_PARAMETER(effect);
+}
+
+static uint32_t rect_width(void *data)
+{
+	struct rect_source *rs = data;
+	return rs->cx;
+}
+
+static uint32_t rect_height(void *data)
+{
+	struct rect_source *rs = data;
+	return rs->cy;
+}
+
+static struct obs_source_info rect_source_info = {
+	.id           = "culling_test_rect",
+	.type         = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW |
+	                OBS_SOURCE_OPAQUE,
+	.get_name     = rect_getname,
+	.create       = rect_create,
+	.destroy      = rect_destroy,
+	.video_render = rect_render,
+	.get_width    = rect_width,
+	.get_height   = rect_height,
+};
+
+static obs_source_t *create_rect(const char *name, uint32_t cx, uint32_t cy,
+		bool bottom)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_source_t *source;
+
+	obs_data_set_int(settings, "width", cx);
+	obs_data_set_int(settings, "height", cy);
+	obs_data_set_bool(settings, "bottom", bottom);
+
+	source = obs_source_create("culling_test_rect", name, settings, NULL);
+	obs_data_release(settings);
+	return source;
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct cull_case {
+	const char          *name;
+	uint32_t            cx;
+	uint32_t            cy;
+	enum obs_bounds_type bounds_type;
+	float               scale;
+	bool                expect_culled;
+};
+
+static const struct cull_case cases[] = {
+	/* scaled to fit, leaving bars on both sides uncovered */
+	{"letterboxed",     360, 360, OBS_BOUNDS_SCALE_INNER, 1.0f, false},
+	{"stretched",       360, 360, OBS_BOUNDS_STRETCH,     1.0f, true},
+	{"scaled to cover", 320, 180, OBS_BOUNDS_NONE,        2.0f, true},
+	{"partial cover",   320, 180, OBS_BOUNDS_NONE,        1.0f, false},
+};
+
+static bool run_case(const struct cull_case *cc)
+{
+	obs_scene_t *scene = obs_scene_create("scene-culling-test");
+	obs_source_t *bottom = create_rect("bottom", BASE_CX, BASE_CY, true);
+	obs_source_t *top = create_rect("top", cc->cx, cc->cy, false);
+	obs_sceneitem_t *item;
+	struct vec2 bounds;
+	struct vec2 scale;
+	long start_renders;
+	long renders;
+	uint32_t culled_items;
+	bool culled;
+
+	obs_scene_add(scene, bottom);
+	item = obs_scene_add(scene, top);
+
+	vec2_set(&scale, cc->scale, cc->scale);
+	obs_sceneitem_set_scale(item, &scale);
+
+	if (cc->bounds_type != OBS_BOUNDS_NONE) {
+		vec2_set(&bounds, (float)BASE_CX, (float)BASE_CY);
+		obs_sceneitem_set_bounds_type(item, cc->bounds_type);
+		obs_sceneitem_set_bounds(item, &bounds);
+	}
+
+	obs_set_output_source(0, obs_scene_get_source(scene));
+
+	os_sleep_ms(SETTLE_MS);
+	start_renders = os_atomic_load_long(&bottom_renders);
+	os_sleep_ms(MEASURE_MS);
+	renders = os_atomic_load_long(&bottom_renders) - start_renders;
+	culled_items = obs_get_scene_culled_items();
+
+	obs_set_output_source(0, NULL);
+	obs_source_release(top);
+	obs_source_release(bottom);
+	obs_scene_release(scene);
+
+	culled = renders == 0;
+
+	if (culled != cc->expect_culled) {
+		printf("FAIL %s: bottom item was %s (%ld renders)\n", cc->name,
+				culled ? "culled" : "rendered", renders);
+		return false;
+	}
+	if (culled_items != (cc->expect_culled ? 1 : 0)) {
+		printf("FAIL %s: %u culled items counted, expected %u\n",
+				cc->name, culled_items,
+				cc->expect_culled ? 1 : 0);
+		return false;
+	}
+
+	printf("ok   %s\n", cc->name);
+	return true;
+}
+
+static bool reset_video(const char *renderer)
+{
+	struct obs_video_info ovi = {0};
+	int ret;
+
+	ovi.graphics_module = renderer;
+	ovi.base_width      = BASE_CX;
+	ovi.base_height     = BASE_CY;
+	ovi.output_width    = BASE_CX;
+	ovi.output_height   = BASE_CY;
+	ovi.fps_num         = 30;
+	ovi.fps_den         = 1;
+	ovi.output_format   = VIDEO_FORMAT_NV12;
+	ovi.gpu_conversion  = true;
+	ovi.colorspace      = VIDEO_CS_709;
+	ovi.range           = VIDEO_RANGE_PARTIAL;
+	ovi.scale_type      = OBS_SCALE_BICUBIC;
+
+	ret = obs_reset_video(&ovi);
+	if (ret != OBS_VIDEO_SUCCESS) {
+		fprintf(stderr, "obs_reset_video failed (%d)\n", ret);
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *renderer = DEFAULT_RENDERER;
+	int failures = 0;
+
+	if (argc == 3 && strcmp(argv[1], "--renderer") == 0) {
+		renderer = argv[2];
+	} else if (argc != 1) {
+		fprintf(stderr, "usage: scene-culling-test "
+				"[--renderer <module>]\n");
+		return 1;
+	}
+
+	base_set_log_handler(do_log, NULL);
+
+	if (!obs_startup("en-US", NULL, NULL)) {
+		fprintf(stderr, "Failed to start libobs\n");
+		return 1;
+	}
+
+	if (!reset_video(renderer)) {
+		obs_shutdown();
+		return 1;
+	}
+
+	obs_register_source(&rect_source_info);
+	obs_set_scene_culling(true);
+
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		if (!run_case(&cases[i]))
+			failures++;
+	}
+
+	obs_shutdown();
+
+	printf("scene culling: %s (%d failures)\n",
+			failures ? "FAILED" : "passed", failures);
+	return failures ? 1 : 0;
+}